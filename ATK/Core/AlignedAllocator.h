@@ -0,0 +1,68 @@
+/**
+ * \file AlignedAllocator.h
+ */
+
+#ifndef ATK_CORE_ALIGNEDALLOCATOR_H
+#define ATK_CORE_ALIGNEDALLOCATOR_H
+
+#include <cstddef>
+#include <limits>
+#include <new>
+
+namespace ATK
+{
+  /// Allocator for aligned arrays that goes through the aligned global operator new
+  /*!
+   * boost::alignment::aligned_allocator calls the aligned allocation functions of the platform directly, so these
+   * allocations are not seen by the AllocationTripwire. This allocator is used by the aligned vectors of the filters.
+   */
+  template<typename T, std::size_t Alignment>
+  class AlignedAllocator
+  {
+  public:
+    using value_type = T;
+    /// The actual alignment of the arrays, never smaller than the one of T
+    static constexpr std::size_t alignment = Alignment < alignof(T) ? alignof(T) : Alignment;
+
+    template<typename U>
+    struct rebind
+    {
+      using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept
+    {
+    }
+
+    T* allocate(std::size_t size)
+    {
+      if(size > std::numeric_limits<std::size_t>::max() / sizeof(T))
+      {
+        throw std::bad_array_new_length();
+      }
+      return static_cast<T*>(::operator new(size * sizeof(T), std::align_val_t(alignment)));
+    }
+
+    void deallocate(T* ptr, std::size_t) noexcept
+    {
+      ::operator delete(ptr, std::align_val_t(alignment));
+    }
+  };
+
+  template<typename T, typename U, std::size_t Alignment>
+  bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) noexcept
+  {
+    return true;
+  }
+
+  template<typename T, typename U, std::size_t Alignment>
+  bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) noexcept
+  {
+    return false;
+  }
+}
+
+#endif
@@ -0,0 +1,101 @@
+/**
+ * \file AllocationTripwire.cpp
+ */
+
+#include "AllocationTripwire.h"
+#include <ATK/Core/Utilities.h>
+
+#include <boost/align/aligned_alloc.hpp>
+
+#include <cstdlib>
+#include <new>
+#include <string>
+
+namespace
+{
+  /// Number of allocations made by this thread, only incremented when the tripwire is enabled
+  thread_local gsl::index nb_allocations{0};
+
+#if ATK_ALLOCATION_TRIPWIRE == 1
+  /// Counts the allocation and calls the new handler until it succeeds
+  template<typename Function>
+  void* allocate(Function&& function)
+  {
+    ++nb_allocations;
+    while(true)
+    {
+      void* ptr = function();
+      if(ptr != nullptr)
+      {
+        return ptr;
+      }
+      auto handler = std::get_new_handler();
+      if(handler == nullptr)
+      {
+        throw std::bad_alloc();
+      }
+      handler();
+    }
+  }
+#endif
+}
+
+#if ATK_ALLOCATION_TRIPWIRE == 1
+// Array and nothrow versions of the default operators forward to these ones
+void* operator new(std::size_t size)
+{
+  return allocate([=](){return std::malloc(size == 0 ? 1 : size);});
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+  return allocate([=](){return boost::alignment::aligned_alloc(static_cast<std::size_t>(alignment), size == 0 ? 1 : size);});
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+  boost::alignment::aligned_free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+  boost::alignment::aligned_free(ptr);
+}
+#endif
+
+namespace ATK
+{
+  AllocationTripwire::AllocationTripwire(bool armed)
+  :armed(armed), start(nb_allocations)
+  {
+  }
+
+  gsl::index AllocationTripwire::get_nb_allocations() const
+  {
+    return nb_allocations - start;
+  }
+
+  void AllocationTripwire::check() const
+  {
+    auto allocations = get_nb_allocations();
+    if(armed && allocations != 0)
+    {
+      throw RuntimeError("Memory was allocated " + std::to_string(allocations) + " times during a real time processing call");
+    }
+  }
+
+  bool AllocationTripwire::is_available()
+  {
+    return ATK_ALLOCATION_TRIPWIRE == 1;
+  }
+}
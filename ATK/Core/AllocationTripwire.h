@@ -0,0 +1,48 @@
+/**
+ * \file AllocationTripwire.h
+ */
+
+#ifndef ATK_CORE_ALLOCATIONTRIPWIRE_H
+#define ATK_CORE_ALLOCATIONTRIPWIRE_H
+
+#include <ATK/config.h>
+#include <ATK/Core/config.h>
+
+#include <gsl/gsl>
+
+namespace ATK
+{
+  /// Counts the memory allocations made by the current thread during the lifetime of the tripwire
+  /*!
+   * Allocations are only tracked when AudioTK is built with ENABLE_ALLOCATION_TRIPWIRE, as the global operator new
+   * and its aligned version are then replaced by the Core library. The aligned vectors of the filters use
+   * AlignedAllocator, so that their allocations are tracked as well. This is meant for debug and test builds, to check that a real time thread
+   * doesn't allocate.
+   */
+  class ATK_CORE_EXPORT AllocationTripwire
+  {
+  public:
+    /*!
+     * @brief Constructor
+     * @param armed is false if check() must never throw
+     */
+    explicit AllocationTripwire(bool armed = true);
+
+    AllocationTripwire(const AllocationTripwire&) = delete;
+    AllocationTripwire& operator=(const AllocationTripwire&) = delete;
+
+    /// Returns the number of allocations since the construction of the tripwire
+    gsl::index get_nb_allocations() const;
+    /// Throws if the tripwire is armed and if something was allocated since its construction
+    void check() const;
+
+    /// Returns true if allocations are tracked in this build
+    static bool is_available();
+
+  private:
+    bool armed;
+    gsl::index start;
+  };
+}
+
+#endif
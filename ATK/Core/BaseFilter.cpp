@@ -5,10 +5,14 @@
 #include "BaseFilter.h"
 #include <ATK/Core/Utilities.h>
 
+#if ATK_ALLOCATION_TRIPWIRE == 1
+#include <ATK/Core/AllocationTripwire.h>
+#endif
 #if ATK_USE_THREADPOOL == 1
 #include <tbb/task_group.h>
 #endif
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <stdexcept>
@@ -21,13 +25,13 @@ namespace ATK
 {
   BaseFilter::BaseFilter(gsl::index nb_input_ports, gsl::index nb_output_ports)
   :nb_input_ports(nb_input_ports), nb_output_ports(nb_output_ports),
-   connections(nb_input_ports, std::make_pair(-1, nullptr)),
+   connections(nb_input_ports, std::make_pair(-1, nullptr)), exclusive_inputs(nb_input_ports), exclusive_generations(nb_input_ports),
    input_mandatory_connection(nb_input_ports)
   {
   }
   
   BaseFilter::BaseFilter(BaseFilter&& other) noexcept
-  :nb_input_ports(other.nb_input_ports), nb_output_ports(other.nb_output_ports), input_sampling_rate(other.input_sampling_rate), output_sampling_rate(other.output_sampling_rate), connections(std::move(other.connections)), input_delay(other.input_delay), output_delay(std::move(other.output_delay)), latency(std::move(other.latency)), input_mandatory_connection(std::move(other.input_mandatory_connection)), is_reset(std::move(other.is_reset))
+  :nb_input_ports(other.nb_input_ports), nb_output_ports(other.nb_output_ports), input_sampling_rate(other.input_sampling_rate), output_sampling_rate(other.output_sampling_rate), connections(std::move(other.connections)), input_delay(other.input_delay), output_delay(std::move(other.output_delay)), latency(std::move(other.latency)), max_block_size(other.max_block_size), exclusive_inputs(std::move(other.exclusive_inputs)), exclusive_generations(std::move(other.exclusive_generations)), converted_bytes(other.converted_bytes), input_mandatory_connection(std::move(other.input_mandatory_connection)), is_reset(std::move(other.is_reset)), plan_output_delay(other.plan_output_delay), connection_generation(other.connection_generation)
   {
   }
 
@@ -61,11 +65,128 @@ namespace ATK
     // Nothing to do by default
   }
 
+  gsl::index BaseFilter::get_input_buffer_size(gsl::index port, gsl::index size) const
+  {
+    return 0;
+  }
+
+  gsl::index BaseFilter::get_output_buffer_size(gsl::index port, gsl::index size) const
+  {
+    return 0;
+  }
+
+  void BaseFilter::set_input_buffer(gsl::index port, void* buffer, gsl::index bytes)
+  {
+    // No buffer by default
+  }
+
+  void BaseFilter::set_output_buffer(gsl::index port, void* buffer, gsl::index bytes)
+  {
+    // No buffer by default
+  }
+
+  void BaseFilter::preallocate(gsl::index size)
+  {
+    // Nothing to allocate by default
+  }
+
+  void BaseFilter::set_max_block_size(gsl::index size)
+  {
+    if(size <= max_block_size)
+    {
+      return;
+    }
+    max_block_size = size;
+#if ATK_ALLOCATION_TRIPWIRE == 1
+    warmed_up = false;
+#endif
+    preallocate(size);
+    for(const auto& connection: connections)
+    {
+      if(connection.second != nullptr)
+      {
+        connection.second->set_max_block_size(get_max_input_size(size));
+      }
+    }
+  }
+
+  gsl::index BaseFilter::get_input_size(gsl::index size) const
+  {
+    if(output_sampling_rate == 0)
+    {
+      return size;
+    }
+    return static_cast<gsl::index>((static_cast<uint64_t>(size) * input_sampling_rate + input_size_remainder) / output_sampling_rate);
+  }
+
+  gsl::index BaseFilter::get_max_input_size(gsl::index size) const
+  {
+    if(output_sampling_rate == 0)
+    {
+      return size;
+    }
+    return static_cast<gsl::index>((static_cast<uint64_t>(size) * input_sampling_rate + output_sampling_rate - 1) / output_sampling_rate);
+  }
+
+  void BaseFilter::commit_input_size(gsl::index size, gsl::index input_size)
+  {
+    last_input_size = input_size;
+    if(output_sampling_rate != 0)
+    {
+      input_size_remainder = (static_cast<uint64_t>(size) * input_sampling_rate + input_size_remainder) % output_sampling_rate;
+    }
+  }
+
+  gsl::index BaseFilter::get_max_block_size() const
+  {
+    return max_block_size;
+  }
+
+  std::int64_t BaseFilter::get_converted_bytes() const
+  {
+    return converted_bytes;
+  }
+
+  void BaseFilter::reset_converted_bytes()
+  {
+    converted_bytes = 0;
+  }
+
+  gsl::index BaseFilter::get_in_place_input(gsl::index output_port) const
+  {
+    return -1;
+  }
+
+  gsl::index BaseFilter::get_aliased_input(gsl::index output_port) const
+  {
+    return -1;
+  }
+
+  bool BaseFilter::can_use_input_array(gsl::index port) const
+  {
+    return false;
+  }
+
+  void BaseFilter::set_exclusive_input(gsl::index port, bool exclusive)
+  {
+    exclusive_inputs[port] = exclusive;
+    exclusive_generations[port] = connections[port].second != nullptr ? connections[port].second->connection_generation : 0;
+  }
+
+  bool BaseFilter::is_exclusive_input(gsl::index port) const
+  {
+    // Another reader may have been connected to the same filter since the plan was compiled
+    return exclusive_inputs[port] && connections[port].second != nullptr && connections[port].second->connection_generation == exclusive_generations[port];
+  }
+
   void BaseFilter::full_setup()
   {
 #if ATK_PROFILING == 1
     class_name = typeid(*this).name();
 #endif
+    // No fractional input sample nor input count is carried over from the blocks before the setup
+    input_size_remainder = 0;
+    last_input_size = 0;
     setup();
   }
 
@@ -78,6 +199,9 @@ namespace ATK
     if(input_port < nb_input_ports)
     {
       connections[input_port] = std::make_pair(output_port, &filter);
+      // Only an execution plan knows the other readers of the new connection, and the previous readers aren't alone anymore
+      exclusive_inputs[input_port] = false;
+      ++filter.connection_generation;
       if(filter.get_output_sampling_rate() != get_input_sampling_rate())
       {
         throw RuntimeError("Input sample rate from this filter must be equal to the output sample rate of the connected filter");
@@ -132,13 +256,21 @@ namespace ATK
 
   gsl::index BaseFilter::get_output_delay() const
   {
-    return output_delay;
+    return std::max(output_delay, plan_output_delay);
   }
 
   void BaseFilter::process(gsl::index size)
   {
+#if ATK_ALLOCATION_TRIPWIRE == 1
+    // The first block after set_max_block_size may still initialize some state
+    AllocationTripwire tripwire(warmed_up && size <= max_block_size);
+#endif
     reset();
     process_conditionnally<true>(size);
+#if ATK_ALLOCATION_TRIPWIRE == 1
+    warmed_up = max_block_size > 0;
+    tripwire.check();
+#endif
   }
 
   void BaseFilter::dryrun(gsl::index size)
@@ -170,6 +302,7 @@ namespace ATK
     {
       return;
     }
+    auto input_size = get_input_size(size);
     for(size_t port = 0; port < connections.size(); ++port)
     {
       if(connections[port].second == nullptr)
@@ -182,13 +315,21 @@ namespace ATK
       else
       {
         assert(output_sampling_rate);
-        connections[port].second->template process_conditionnally<must_process>(static_cast<uint64_t>(size) * input_sampling_rate / output_sampling_rate);
+        connections[port].second->template process_conditionnally<must_process>(input_size);
       }
     }
+    process_node<must_process>(size);
+    is_reset = false;
+  }
+
+  template<bool must_process>
+  void BaseFilter::process_node(gsl::index size)
+  {
 #if ATK_PROFILING == 1
     auto timer = std::chrono::steady_clock::now();
 #endif
-    prepare_process(static_cast<uint64_t>(size) * input_sampling_rate / output_sampling_rate);
+    auto input_size = get_input_size(size);
+    prepare_process(input_size);
 #if ATK_PROFILING == 1
     auto timer2 = std::chrono::steady_clock::now();
     input_conversion_time += (timer2 - timer);
@@ -209,10 +350,15 @@ namespace ATK
     process_time += (timer2 - timer);
     timer = timer2;
 #endif
-    is_reset = false;
     last_size = size;
+    commit_input_size(size, input_size);
   }
 
+  template void BaseFilter::process_conditionnally<true>(gsl::index size);
+  template void BaseFilter::process_conditionnally<false>(gsl::index size);
+  template void BaseFilter::process_node<true>(gsl::index size);
+  template void BaseFilter::process_node<false>(gsl::index size);
+
 #if ATK_USE_THREADPOOL == 1
   void BaseFilter::process_conditionnally_parallel(gsl::index size)
   {
@@ -230,6 +376,7 @@ namespace ATK
       {
         return;
       }
+      auto input_size = get_input_size(size);
       tbb::task_group g;
       for(gsl::index port = 0; port < connections.size(); ++port)
       {
@@ -242,14 +389,14 @@ namespace ATK
         {
           assert(output_sampling_rate);
           auto filter = connections[port];
-          g.run([=]{filter->process_conditionnally_parallel(uint64_t(size) * input_sampling_rate / output_sampling_rate); });
+          g.run([=]{filter.second->process_conditionnally_parallel(input_size); });
         }
       }
       g.wait();
 #if ATK_PROFILING == 1
       boost::timer::cpu_timer timer;
 #endif
-      prepare_process(size * input_sampling_rate / output_sampling_rate);
+      prepare_process(input_size);
 #if ATK_PROFILING == 1
       boost::timer::cpu_times const input_elapsed_times(timer.elapsed());
       input_conversion_time += (input_elapsed_times.system + input_elapsed_times.user);
@@ -266,6 +413,7 @@ namespace ATK
 #endif
       is_reset = false;
       last_size = size;
+      commit_input_size(size, input_size);
     }
   }
 #endif
@@ -279,6 +427,8 @@ namespace ATK
   {
     connections.resize(nb_ports, std::make_pair(-1, nullptr));
     input_mandatory_connection.resize(nb_ports);
+    exclusive_inputs.resize(nb_ports);
+    exclusive_generations.resize(nb_ports);
     nb_input_ports = nb_ports;
   }
   
@@ -25,9 +25,14 @@
 
 namespace ATK
 {
+  class ExecutionPlan;
+  class MemoryPlanner;
+
   /// Base class for all filters
   class BaseFilter
   {
+    friend class ExecutionPlan;
+    friend class MemoryPlanner;
   public:
     BaseFilter(const BaseFilter&) = delete;
     BaseFilter& operator=(const BaseFilter&) = delete;
@@ -57,7 +62,7 @@ namespace ATK
     ATK_CORE_EXPORT void dryrun(gsl::index size);
 
 #if ATK_USE_THREADPOOL == 1
-    /// Allows threaded processing
+    /// Allows threaded processing, ParallelExecutionPlan should be preferred
     ATK_CORE_EXPORT void process_parallel(gsl::index size);
 #endif
 
@@ -98,7 +103,7 @@ namespace ATK
     ATK_CORE_EXPORT gsl::index get_input_delay() const;
     /// Returns this filter output delay (additional pre-0 samples)
     ATK_CORE_EXPORT void set_output_delay(gsl::index delay);
-    /// Returns this filter output delay (additional pre-0 samples)
+    /// Returns this filter output delay (additional pre-0 samples), including the history kept for an execution plan
     ATK_CORE_EXPORT gsl::index get_output_delay() const;
     /*!
     * @brief Changes the filter's latency
@@ -110,6 +115,21 @@ namespace ATK
     /// Returns the pipeline global latency from this plugin
     ATK_CORE_EXPORT gsl::index get_global_latency() const;
 
+    /*!
+     * @brief Preallocates the buffers of this filter and of the filters it is connected to
+     * Processing blocks up to this size then doesn't allocate anymore after the first block. Must be called once the
+     * pipeline is connected and the sampling rates are set, the maximum size can only grow.
+     * @param size is the maximum number of samples that will be processed at once, at the output sampling rate
+     */
+    ATK_CORE_EXPORT void set_max_block_size(gsl::index size);
+    /// Returns the maximum block size, 0 if it was never set
+    ATK_CORE_EXPORT gsl::index get_max_block_size() const;
+
+    /// Returns the number of bytes copied to convert the inputs of this filter since the last reset
+    ATK_CORE_EXPORT std::int64_t get_converted_bytes() const;
+    /// Resets the number of bytes copied to convert the inputs
+    ATK_CORE_EXPORT void reset_converted_bytes();
+
     /// Resets the internal state of the filter (mandatory before processing a new clip in a DAW for instance)
     ATK_CORE_EXPORT virtual void full_setup();
 
@@ -133,11 +153,90 @@ namespace ATK
     virtual void prepare_process(gsl::index size) = 0;
     /// Prepares the filter by resizing the outputs arrays
     virtual void prepare_outputs(gsl::index size) = 0;
+    /*!
+     * @brief Returns the number of bytes the buffer of an input port requires, 0 if the input is directly used from the connected filter
+     * @param port is the input port
+     * @param size is the maximum number of samples to process
+     */
+    ATK_CORE_EXPORT virtual gsl::index get_input_buffer_size(gsl::index port, gsl::index size) const;
+    /*!
+     * @brief Returns the number of bytes the buffer of an output port requires
+     * @param port is the output port
+     * @param size is the maximum number of samples to process
+     */
+    ATK_CORE_EXPORT virtual gsl::index get_output_buffer_size(gsl::index port, gsl::index size) const;
+    /*!
+     * @brief Uses an external memory for the buffer of an input port, the previous content of the port is lost
+     * @param port is the input port
+     * @param buffer is the external memory, nullptr to go back to an internally allocated buffer
+     * @param bytes is the size of the external memory
+     */
+    ATK_CORE_EXPORT virtual void set_input_buffer(gsl::index port, void* buffer, gsl::index bytes);
+    /*!
+     * @brief Uses an external memory for the buffer of an output port, the previous content of the port is lost
+     * @param port is the output port
+     * @param buffer is the external memory, nullptr to go back to an internally allocated buffer
+     * @param bytes is the size of the external memory
+     */
+    ATK_CORE_EXPORT virtual void set_output_buffer(gsl::index port, void* buffer, gsl::index bytes);
+
+    /*!
+     * @brief Returns the input port whose buffer can be reused to compute an output port in place, -1 if there is none
+     * Filters that declare an in place input must read each input sample before writing the output sample with the
+     * same index, and must not read the input afterwards.
+     * @param output_port is the output port
+     */
+    ATK_CORE_EXPORT virtual gsl::index get_in_place_input(gsl::index output_port) const;
+    /*!
+     * @brief Returns the input port whose buffer is currently used by an output port, -1 if the output has its own buffer
+     * @param output_port is the output port
+     */
+    ATK_CORE_EXPORT virtual gsl::index get_aliased_input(gsl::index output_port) const;
+    /*!
+     * @brief Returns true if an input port can use the output array of the connected filter without a conversion
+     * The array is then used directly if the connected filter keeps enough history for the input delay.
+     * @param port is the input port
+     */
+    ATK_CORE_EXPORT virtual bool can_use_input_array(gsl::index port) const;
+    /*!
+     * @brief Indicates that this filter is the only reader of the output array connected to an input port
+     * The array can then be overwritten by an in place output.
+     * @param port is the input port
+     * @param exclusive is true if no other filter reads the array
+     */
+    void set_exclusive_input(gsl::index port, bool exclusive);
+    /// Returns true if the array connected to an input port is only read by this filter
+    /*!
+     * Connecting another filter to the same output after set_exclusive_input was called makes the port shared again.
+     */
+    bool is_exclusive_input(gsl::index port) const;
+
     /// Changes the internal check to allow a disconnected input port
     void allow_inactive_connection(unsigned int port);
     
     /// Use this call to recompute internal parameters
     ATK_CORE_EXPORT virtual void setup();
+    /*!
+     * @brief Allocates all the memory required to process blocks up to a given size
+     * @param size is the maximum number of samples that will be processed at once
+     */
+    ATK_CORE_EXPORT virtual void preallocate(gsl::index size);
+    /*!
+     * @brief Returns the number of input samples consumed by the next block
+     * When the sampling rates don't divide the block size, the fractional part is carried over to the next blocks so
+     * that no input sample is lost. The filter state is not modified, the count is committed when the block is processed.
+     * @param size is the number of output samples of the block
+     */
+    ATK_CORE_EXPORT virtual gsl::index get_input_size(gsl::index size) const;
+    /*!
+     * @brief Returns the largest number of input samples a block may consume
+     * @param size is the maximum number of output samples of a block
+     */
+    ATK_CORE_EXPORT virtual gsl::index get_max_input_size(gsl::index size) const;
+
+    /// Processes this filter only, the input filters must already have been processed
+    template<bool must_process>
+    void process_node(gsl::index size);
 
     /// Number of input ports
     gsl::index nb_input_ports{0};
@@ -159,10 +258,33 @@ namespace ATK
     gsl::index latency{0};
     /// Last processed size
     gsl::index last_size{0};
+    /// Number of input samples consumed by the last processed block
+    gsl::index last_input_size{0};
+    /// Maximum size of the blocks to process, 0 if unknown
+    gsl::index max_block_size{0};
+    /// Input ports whose connected output array is only read by this filter
+    boost::dynamic_bitset<> exclusive_inputs;
+    /// Connection generation of the connected filters when the input ports were marked exclusive
+    std::vector<std::uint64_t> exclusive_generations;
+    /// Number of bytes copied to convert the inputs
+    std::int64_t converted_bytes{0};
 
   private:
     boost::dynamic_bitset<> input_mandatory_connection;
     bool is_reset{false};
+    /// Additional output delay required by an execution plan, kept apart from output_delay
+    gsl::index plan_output_delay{0};
+    /// Incremented each time an input port is connected to this filter
+    std::uint64_t connection_generation{0};
+    /// Fractional input sample carried over between blocks, in units of 1 / output_sampling_rate
+    std::uint64_t input_size_remainder{0};
+
+    /// Updates the input accounting once a block is processed
+    void commit_input_size(gsl::index size, gsl::index input_size);
+#if ATK_ALLOCATION_TRIPWIRE == 1
+    /// Has a block been processed since set_max_block_size?
+    bool warmed_up{false};
+#endif
 #if ATK_PROFILING == 1
     std::string class_name;
     std::chrono::steady_clock::duration input_conversion_time{0};
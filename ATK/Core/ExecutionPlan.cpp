@@ -0,0 +1,336 @@
+/**
+ * \file ExecutionPlan.cpp
+ */
+
+#include "ExecutionPlan.h"
+#include <ATK/Core/Utilities.h>
+#if ATK_ALLOCATION_TRIPWIRE == 1
+#include <ATK/Core/AllocationTripwire.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+namespace ATK
+{
+  ExecutionPlan::ExecutionPlan() = default;
+
+  ExecutionPlan::ExecutionPlan(gsl::not_null<BaseFilter*> sink)
+  {
+    add_sink(sink);
+  }
+
+  ExecutionPlan::~ExecutionPlan()
+  {
+    restore_output_delays();
+  }
+
+  void ExecutionPlan::add_sink(gsl::not_null<BaseFilter*> sink)
+  {
+    if(std::find(sinks.begin(), sinks.end(), sink.get()) != sinks.end())
+    {
+      throw RuntimeError("Try to add a sink that was already added");
+    }
+    sinks.push_back(sink);
+    compiled = false;
+  }
+
+  void ExecutionPlan::remove_sink(gsl::not_null<const BaseFilter*> sink)
+  {
+    auto it = std::find(sinks.begin(), sinks.end(), sink.get());
+    if(it == sinks.end())
+    {
+      throw RuntimeError("Try to remove a sink that was not added");
+    }
+    sinks.erase(it);
+    compiled = false;
+  }
+
+  void ExecutionPlan::set_buffer_aliasing(bool aliasing)
+  {
+    buffer_aliasing = aliasing;
+    compiled = false;
+  }
+
+  bool ExecutionPlan::get_buffer_aliasing() const
+  {
+    return buffer_aliasing;
+  }
+
+  void ExecutionPlan::compile()
+  {
+    compiled = false;
+    restore_output_delays();
+    nodes.clear();
+    if(sinks.empty())
+    {
+      throw RuntimeError("No sink to process in the execution plan");
+    }
+    reference_sampling_rate = sinks.front()->get_output_sampling_rate();
+    if(reference_sampling_rate == 0)
+    {
+      throw RuntimeError("Output sampling rate is 0, must be non 0 to compute the needed size for filters processing");
+    }
+
+    // Depth first post-order traversal, with an explicit stack
+    enum class State {InProgress, Done};
+    std::unordered_map<const BaseFilter*, State> states;
+    std::unordered_map<const BaseFilter*, gsl::index> indices;
+    std::vector<std::pair<BaseFilter*, gsl::index>> stack;
+
+    for(auto sink: sinks)
+    {
+      if(states.find(sink) != states.end())
+      {
+        continue;
+      }
+      stack.emplace_back(sink, 0);
+      states[sink] = State::InProgress;
+      while(!stack.empty())
+      {
+        auto& [filter, port] = stack.back();
+        if(port < static_cast<gsl::index>(filter->connections.size()))
+        {
+          auto input = filter->connections[port].second;
+          ++port;
+          if(input == nullptr)
+          {
+            continue;
+          }
+          auto state = states.find(input);
+          if(state == states.end())
+          {
+            states[input] = State::InProgress;
+            stack.emplace_back(input, 0);
+          }
+          else if(state->second == State::InProgress)
+          {
+            throw RuntimeError("The pipeline has a cycle and can't be sorted");
+          }
+          continue;
+        }
+        states[filter] = State::Done;
+        indices[filter] = static_cast<gsl::index>(nodes.size());
+        nodes.push_back(Node{filter, filter->get_output_sampling_rate(), {}});
+        stack.pop_back();
+      }
+    }
+
+    // All the checks the recursive processing does at each call
+    for(auto& node: nodes)
+    {
+      auto filter = node.filter;
+      if(node.sampling_rate == 0)
+      {
+        throw RuntimeError("Output sampling rate is 0, must be non 0 to compute the needed size for filters processing");
+      }
+      for(gsl::index port = 0; port < static_cast<gsl::index>(filter->connections.size()); ++port)
+      {
+        auto input = filter->connections[port].second;
+        if(input == nullptr)
+        {
+          if(!filter->input_mandatory_connection[port])
+          {
+            throw RuntimeError("Input port " + std::to_string(port) + " is not connected");
+          }
+          continue;
+        }
+        if(input->get_output_sampling_rate() != filter->get_input_sampling_rate())
+        {
+          throw RuntimeError("Input sample rate from this filter must be equal to the output sample rate of the connected filter");
+        }
+        auto index = indices[input];
+        if(std::find(node.dependencies.begin(), node.dependencies.end(), index) == node.dependencies.end())
+        {
+          node.dependencies.push_back(index);
+        }
+      }
+    }
+    share_arrays(indices);
+    compiled = true;
+  }
+
+  void ExecutionPlan::share_arrays(const std::unordered_map<const BaseFilter*, gsl::index>& indices)
+  {
+    // Number of ports reading each output array
+    std::vector<std::vector<gsl::index>> nb_readers;
+    for(const auto& node: nodes)
+    {
+      nb_readers.emplace_back(node.filter->get_nb_output_ports(), 0);
+    }
+    for(const auto& node: nodes)
+    {
+      for(const auto& connection: node.filter->connections)
+      {
+        if(connection.second != nullptr)
+        {
+          ++nb_readers[indices.at(connection.second)][connection.first];
+        }
+      }
+    }
+
+    for(const auto& node: nodes)
+    {
+      auto filter = node.filter;
+      for(gsl::index port = 0; port < static_cast<gsl::index>(filter->connections.size()); ++port)
+      {
+        auto [output_port, input] = filter->connections[port];
+        if(input == nullptr)
+        {
+          continue;
+        }
+        if(buffer_aliasing && filter->can_use_input_array(port) && filter->get_input_delay() > input->get_output_delay())
+        {
+          // Keeping more history is cheaper than copying the whole array
+          if(input->plan_output_delay == 0)
+          {
+            raised_filters.push_back(input);
+          }
+          input->plan_output_delay = filter->get_input_delay();
+        }
+        // The outputs of the sinks are read after the processing
+        auto sink = std::find(sinks.begin(), sinks.end(), input) != sinks.end();
+        filter->set_exclusive_input(port, buffer_aliasing && !sink && nb_readers[indices.at(input)][output_port] == 1);
+      }
+    }
+  }
+
+  void ExecutionPlan::restore_output_delays()
+  {
+    for(auto filter: raised_filters)
+    {
+      filter->plan_output_delay = 0;
+    }
+    raised_filters.clear();
+  }
+
+  bool ExecutionPlan::is_compiled() const
+  {
+    return compiled;
+  }
+
+  void ExecutionPlan::invalidate()
+  {
+    compiled = false;
+  }
+
+  template<bool must_process>
+  void ExecutionPlan::process_nodes(gsl::index size)
+  {
+    if(!compiled)
+    {
+      throw RuntimeError("The execution plan must be compiled before processing");
+    }
+    if(size == 0)
+    {
+      return;
+    }
+    update_block_sizes(size);
+    for(const auto& node: nodes)
+    {
+      process_node<must_process>(node);
+    }
+  }
+
+  void ExecutionPlan::update_block_sizes(gsl::index size)
+  {
+    for(auto& node: nodes)
+    {
+      node.block_size = -1;
+    }
+    // The readers of a node are after it in the execution order
+    for(auto node = nodes.rbegin(); node != nodes.rend(); ++node)
+    {
+      if(node->block_size < 0)
+      {
+        node->block_size = get_node_size(*node, size);
+      }
+      auto input_size = node->filter->get_input_size(node->block_size);
+      for(auto dependency: node->dependencies)
+      {
+        if(nodes[dependency].block_size < 0)
+        {
+          nodes[dependency].block_size = input_size;
+        }
+      }
+    }
+  }
+
+  void ExecutionPlan::process(gsl::index size)
+  {
+#if ATK_ALLOCATION_TRIPWIRE == 1
+    // The first block after set_max_block_size may still initialize some state
+    AllocationTripwire tripwire(warmed_up && size <= max_block_size);
+#endif
+    process_nodes<true>(size);
+#if ATK_ALLOCATION_TRIPWIRE == 1
+    warmed_up = max_block_size > 0;
+    tripwire.check();
+#endif
+  }
+
+  void ExecutionPlan::dryrun(gsl::index size)
+  {
+    process_nodes<false>(size);
+  }
+
+  void ExecutionPlan::set_max_block_size(gsl::index size)
+  {
+    if(!compiled)
+    {
+      throw RuntimeError("The execution plan must be compiled before preallocating its filters");
+    }
+    for(const auto& node: nodes)
+    {
+      node.filter->set_max_block_size(get_node_size(node, size));
+    }
+    max_block_size = std::max(max_block_size, size);
+#if ATK_ALLOCATION_TRIPWIRE == 1
+    warmed_up = false;
+#endif
+  }
+
+  gsl::index ExecutionPlan::get_sampling_rate() const
+  {
+    return reference_sampling_rate;
+  }
+
+  gsl::index ExecutionPlan::get_nb_nodes() const
+  {
+    return static_cast<gsl::index>(nodes.size());
+  }
+
+  BaseFilter* ExecutionPlan::get_node(gsl::index index) const
+  {
+    return nodes[index].filter;
+  }
+
+  std::int64_t ExecutionPlan::get_converted_bytes() const
+  {
+    std::int64_t converted_bytes = 0;
+    for(const auto& node: nodes)
+    {
+      converted_bytes += node.filter->get_converted_bytes();
+    }
+    return converted_bytes;
+  }
+
+  void ExecutionPlan::reset_converted_bytes()
+  {
+    for(const auto& node: nodes)
+    {
+      node.filter->reset_converted_bytes();
+    }
+  }
+
+  gsl::index ExecutionPlan::get_node_index(gsl::not_null<const BaseFilter*> filter) const
+  {
+    auto it = std::find_if(nodes.begin(), nodes.end(), [&](const Node& node){return node.filter == filter.get();});
+    if(it == nodes.end())
+    {
+      return -1;
+    }
+    return static_cast<gsl::index>(it - nodes.begin());
+  }
+}
@@ -0,0 +1,162 @@
+/**
+ * \file ExecutionPlan.h
+ */
+
+#ifndef ATK_CORE_EXECUTIONPLAN_H
+#define ATK_CORE_EXECUTIONPLAN_H
+
+#include <ATK/Core/BaseFilter.h>
+
+#include <gsl/gsl>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ATK
+{
+  /// Flattened, topologically sorted view of a pipeline that can be processed without recursion
+  /*!
+   * The plan is compiled once from a set of sinks. All connections and sampling rates are checked at compile time,
+   * and processing a block then simply runs each filter in order.
+   * The plan must be compiled again if the pipeline topology or the sampling rates are modified.
+   * With buffer aliasing, the filters keep additional history for the plan until it is compiled again or destroyed, so
+   * they must outlive the plan.
+   */
+  class ATK_CORE_EXPORT ExecutionPlan
+  {
+  public:
+    /// Constructor of an empty plan
+    ExecutionPlan();
+    /*!
+     * @brief Constructor of a plan with a single sink
+     * @param sink is the last filter of the pipeline
+     */
+    explicit ExecutionPlan(gsl::not_null<BaseFilter*> sink);
+    /// Destructor
+    virtual ~ExecutionPlan();
+
+    ExecutionPlan(const ExecutionPlan&) = delete;
+    ExecutionPlan& operator=(const ExecutionPlan&) = delete;
+
+    /*!
+     * @brief Adds a sink to the plan. The first sink sets the reference sampling rate of the plan
+     * @param sink is an additional sink
+     */
+    void add_sink(gsl::not_null<BaseFilter*> sink);
+    /*!
+     * @brief Removes a sink from the plan
+     * @param sink is the sink to remove
+     */
+    void remove_sink(gsl::not_null<const BaseFilter*> sink);
+
+    /*!
+     * @brief Lets the filters share their arrays instead of copying them, applied when the plan is compiled
+     * Filters that are the only readers of an array can compute their outputs in place in it, and filters keep enough
+     * history for the input delays of the filters they feed, so that these can read their output arrays directly.
+     * The output arrays of intermediate filters may then be overwritten during processing.
+     * @param aliasing activates or deactivates the sharing of arrays
+     */
+    void set_buffer_aliasing(bool aliasing);
+    /// Returns true if the filters share their arrays when possible
+    bool get_buffer_aliasing() const;
+
+    /// Sorts the pipeline and checks its consistency, throws if the pipeline can't be processed
+    virtual void compile();
+    /// Returns true if the plan can be processed
+    bool is_compiled() const;
+    /// Marks the plan as out of date, for instance after the pipeline was reconnected, it must be compiled again
+    void invalidate();
+
+    /*!
+     * @brief Processes all the filters of the plan
+     * @param size is the number of samples to process, at the reference sampling rate
+     */
+    virtual void process(gsl::index size);
+    /// As process, but doesn't call process_impl
+    void dryrun(gsl::index size);
+    /*!
+     * @brief Preallocates the buffers of all the filters of the plan, see BaseFilter::set_max_block_size
+     * @param size is the maximum number of samples that will be processed at once, at the reference sampling rate
+     */
+    void set_max_block_size(gsl::index size);
+
+    /// Returns the reference sampling rate (the output sampling rate of the first sink)
+    gsl::index get_sampling_rate() const;
+    /// Returns the number of filters in the plan
+    gsl::index get_nb_nodes() const;
+    /// Returns the filter at a given position of the execution order
+    BaseFilter* get_node(gsl::index index) const;
+    /// Returns the position of a filter in the execution order, or -1
+    gsl::index get_node_index(gsl::not_null<const BaseFilter*> filter) const;
+
+    /// Returns the number of bytes copied by all the filters of the plan to convert their inputs
+    std::int64_t get_converted_bytes() const;
+    /// Resets the number of bytes copied to convert the inputs of all the filters of the plan
+    void reset_converted_bytes();
+
+  protected:
+    /// A filter in the plan
+    struct Node
+    {
+      /// The filter to process
+      BaseFilter* filter;
+      /// The output sampling rate of the filter, used to compute its block size
+      gsl::index sampling_rate;
+      /// Indices of the nodes feeding this node, without duplicates
+      std::vector<gsl::index> dependencies;
+      /// Number of output samples of the block being processed
+      gsl::index block_size{0};
+    };
+
+    /// Returns the block size for a node
+    gsl::index get_node_size(const Node& node, gsl::index size) const
+    {
+      return static_cast<gsl::index>(static_cast<uint64_t>(size) * node.sampling_rate / reference_sampling_rate);
+    }
+
+    /*!
+     * @brief Computes the block size of each node, from the sinks to the sources
+     * A node processes the number of samples its first reader consumes, as when the sinks pull their inputs.
+     * @param size is the number of samples to process, at the reference sampling rate
+     */
+    void update_block_sizes(gsl::index size);
+
+    /// Processes a single node, its dependencies must already be processed and the block sizes updated
+    template<bool must_process>
+    void process_node(const Node& node) const
+    {
+      node.filter->template process_node<must_process>(node.block_size);
+    }
+
+    /// List of sinks
+    std::vector<BaseFilter*> sinks;
+    /// Filters in execution order
+    std::vector<Node> nodes;
+    /// Sampling rate used for the sizes given to process
+    gsl::index reference_sampling_rate{0};
+    /// Is the plan up to date?
+    bool compiled{false};
+    /// Can the filters share their arrays?
+    bool buffer_aliasing{false};
+    /// Maximum size of the blocks to process, 0 if unknown
+    gsl::index max_block_size{0};
+#if ATK_ALLOCATION_TRIPWIRE == 1
+    /// Has a block been processed since set_max_block_size?
+    bool warmed_up{false};
+#endif
+
+  private:
+    template<bool must_process>
+    void process_nodes(gsl::index size);
+    /// Raises the output delays and marks the arrays that only have one reader, if the arrays can be shared
+    void share_arrays(const std::unordered_map<const BaseFilter*, gsl::index>& indices);
+    /// Removes the additional history the plan required from its filters
+    void restore_output_delays();
+
+    /// Filters whose output delay was raised by share_arrays
+    std::vector<BaseFilter*> raised_filters;
+  };
+}
+
+#endif
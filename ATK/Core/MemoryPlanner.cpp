@@ -0,0 +1,214 @@
+/**
+ * \file MemoryPlanner.cpp
+ */
+
+#include "MemoryPlanner.h"
+#include <ATK/Core/ParallelExecutionPlan.h>
+#include <ATK/Core/Utilities.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+namespace ATK
+{
+  namespace
+  {
+    gsl::index align(gsl::index size)
+    {
+      return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+  }
+
+  MemoryPlanner::MemoryPlanner(const ExecutionPlan& plan)
+  :execution_plan(plan)
+  {
+  }
+
+  MemoryPlanner::~MemoryPlanner()
+  {
+    release();
+  }
+
+  void MemoryPlanner::plan(gsl::index max_size)
+  {
+    if(!execution_plan.is_compiled())
+    {
+      throw RuntimeError("The execution plan must be compiled before planning its memory");
+    }
+    if(dynamic_cast<const ParallelExecutionPlan*>(&execution_plan) != nullptr)
+    {
+      throw RuntimeError("Buffer lifetimes can't be computed for parallel execution plans");
+    }
+    release();
+
+    auto nb_nodes = execution_plan.get_nb_nodes();
+    std::unordered_map<const BaseFilter*, gsl::index> indices;
+    for(gsl::index i = 0; i < nb_nodes; ++i)
+    {
+      indices[execution_plan.get_node(i)] = i;
+    }
+    // Last node reading each output port
+    std::vector<std::vector<gsl::index>> last_uses(nb_nodes);
+    for(gsl::index i = 0; i < nb_nodes; ++i)
+    {
+      auto filter = execution_plan.get_node(i);
+      last_uses[i].assign(filter->get_nb_output_ports(), -1);
+    }
+    for(gsl::index i = 0; i < nb_nodes; ++i)
+    {
+      for(const auto& connection: execution_plan.get_node(i)->connections)
+      {
+        if(connection.second != nullptr)
+        {
+          auto& last_use = last_uses[indices[connection.second]][connection.first];
+          last_use = std::max(last_use, i);
+        }
+      }
+    }
+
+    unplanned_size = 0;
+    // Buffer used by each output port, several ports share a buffer when they are computed in place
+    std::vector<std::vector<gsl::index>> output_buffers(nb_nodes);
+    std::vector<gsl::index> input_buffers;
+    for(gsl::index i = 0; i < nb_nodes; ++i)
+    {
+      auto filter = execution_plan.get_node(i);
+      // Blocks carry the fractional samples over when the sampling rates don't divide the size, so round up
+      auto reference_rate = static_cast<uint64_t>(execution_plan.get_sampling_rate());
+      auto size = static_cast<gsl::index>((static_cast<uint64_t>(max_size) * filter->get_output_sampling_rate() + reference_rate - 1) / reference_rate);
+      size = std::max(size, filter->get_max_block_size());
+      auto input_size = filter->get_max_input_size(size);
+
+      input_buffers.assign(filter->get_nb_input_ports(), -1);
+      for(gsl::index port = 0; port < filter->get_nb_input_ports(); ++port)
+      {
+        auto bytes = filter->get_input_buffer_size(port, input_size);
+        if(bytes == 0)
+        {
+          continue;
+        }
+        input_buffers[port] = static_cast<gsl::index>(buffers.size());
+        unplanned_size += bytes;
+        // Only used while the filter is processed, unless the history is kept
+        auto first_use = filter->get_input_delay() > 0 ? 0 : i;
+        auto last_use = filter->get_input_delay() > 0 ? nb_nodes : i;
+        buffers.push_back(Buffer{filter, port, false, align(bytes), first_use, last_use, 0});
+      }
+      output_buffers[i].assign(filter->get_nb_output_ports(), -1);
+      for(gsl::index port = 0; port < filter->get_nb_output_ports(); ++port)
+      {
+        // Sinks outputs may be used after the processing
+        auto last_use = last_uses[i][port] == -1 ? nb_nodes : last_uses[i][port];
+        auto input_port = filter->get_aliased_input(port);
+        if(input_port >= 0)
+        {
+          // Computed in place, the buffer of the input must live as long as the output
+          auto owner = input_buffers[input_port];
+          if(owner == -1)
+          {
+            const auto& connection = filter->connections[input_port];
+            owner = output_buffers[indices[connection.second]][connection.first];
+          }
+          if(owner != -1)
+          {
+            buffers[owner].last_use = std::max(buffers[owner].last_use, last_use);
+          }
+          output_buffers[i][port] = owner;
+          continue;
+        }
+        auto bytes = filter->get_output_buffer_size(port, size);
+        if(bytes == 0)
+        {
+          continue;
+        }
+        unplanned_size += bytes;
+        output_buffers[i][port] = static_cast<gsl::index>(buffers.size());
+        auto first_use = filter->get_output_delay() > 0 ? 0 : i;
+        if(filter->get_output_delay() > 0)
+        {
+          last_use = nb_nodes;
+        }
+        buffers.push_back(Buffer{filter, port, true, align(bytes), first_use, last_use, 0});
+      }
+    }
+
+    // Greedy placement, biggest buffers first, at the lowest offset not used by a live buffer
+    std::vector<Buffer*> order;
+    for(auto& buffer: buffers)
+    {
+      order.push_back(&buffer);
+    }
+    std::stable_sort(order.begin(), order.end(), [](const Buffer* lhs, const Buffer* rhs){return lhs->size > rhs->size;});
+
+    gsl::index arena_size = 0;
+    std::vector<const Buffer*> placed;
+    std::vector<const Buffer*> conflicts;
+    for(auto buffer: order)
+    {
+      conflicts.clear();
+      for(auto other: placed)
+      {
+        if(other->first_use <= buffer->last_use && buffer->first_use <= other->last_use)
+        {
+          conflicts.push_back(other);
+        }
+      }
+      std::sort(conflicts.begin(), conflicts.end(), [](const Buffer* lhs, const Buffer* rhs){return lhs->offset < rhs->offset;});
+      gsl::index offset = 0;
+      for(auto other: conflicts)
+      {
+        if(offset + buffer->size <= other->offset)
+        {
+          break;
+        }
+        offset = std::max(offset, other->offset + other->size);
+      }
+      buffer->offset = offset;
+      arena_size = std::max(arena_size, offset + buffer->size);
+      placed.push_back(buffer);
+    }
+
+    arena.assign(static_cast<std::size_t>(arena_size), 0);
+    for(const auto& buffer: buffers)
+    {
+      if(buffer.output)
+      {
+        buffer.filter->set_output_buffer(buffer.port, arena.data() + buffer.offset, buffer.size);
+      }
+      else
+      {
+        buffer.filter->set_input_buffer(buffer.port, arena.data() + buffer.offset, buffer.size);
+      }
+    }
+  }
+
+  void MemoryPlanner::release()
+  {
+    for(const auto& buffer: buffers)
+    {
+      if(buffer.output)
+      {
+        buffer.filter->set_output_buffer(buffer.port, nullptr, 0);
+      }
+      else
+      {
+        buffer.filter->set_input_buffer(buffer.port, nullptr, 0);
+      }
+    }
+    buffers.clear();
+    arena.clear();
+    arena.shrink_to_fit();
+    unplanned_size = 0;
+  }
+
+  gsl::index MemoryPlanner::get_unplanned_size() const
+  {
+    return unplanned_size;
+  }
+
+  gsl::index MemoryPlanner::get_planned_size() const
+  {
+    return static_cast<gsl::index>(arena.size());
+  }
+}
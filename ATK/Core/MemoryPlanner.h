@@ -0,0 +1,72 @@
+/**
+ * \file MemoryPlanner.h
+ */
+
+#ifndef ATK_CORE_MEMORYPLANNER_H
+#define ATK_CORE_MEMORYPLANNER_H
+
+#include <ATK/Core/AlignedAllocator.h>
+#include <ATK/Core/ExecutionPlan.h>
+#include <ATK/Core/TypedBaseFilter.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace ATK
+{
+  /// Assigns the port buffers of all the filters of an execution plan to slices of a single arena
+  /*!
+   * Buffers are only live between the filter that writes them and the last filter that reads them, so buffers with
+   * non overlapping lifetimes can share the same memory. Buffers with a delay keep samples from one block to the next
+   * and are never shared. Outputs computed in place use the buffer of their input, which then lives as long as them.
+   * Lifetimes are computed from the sequential order of the plan, so parallel plans are not supported.
+   * The filters must outlive the planner, and the plan must be compiled again and planned again if the pipeline changes.
+   */
+  class ATK_CORE_EXPORT MemoryPlanner
+  {
+  public:
+    /*!
+     * @brief Constructor
+     * @param plan is a compiled execution plan
+     */
+    explicit MemoryPlanner(const ExecutionPlan& plan);
+    /// Destructor, gives back their own buffers to the filters
+    ~MemoryPlanner();
+
+    MemoryPlanner(const MemoryPlanner&) = delete;
+    MemoryPlanner& operator=(const MemoryPlanner&) = delete;
+
+    /*!
+     * @brief Computes the buffer lifetimes and assigns the arena slices to the filters
+     * @param max_size is the maximum size of the blocks that will be processed, at the plan reference sampling rate
+     */
+    void plan(gsl::index max_size);
+    /// Gives back their own buffers to the filters
+    void release();
+
+    /// Returns the number of bytes the buffers use when each filter owns its buffers
+    gsl::index get_unplanned_size() const;
+    /// Returns the number of bytes of the shared arena
+    gsl::index get_planned_size() const;
+
+  private:
+    /// A buffer to place in the arena
+    struct Buffer
+    {
+      BaseFilter* filter;
+      gsl::index port;
+      bool output;
+      gsl::index size;
+      gsl::index first_use;
+      gsl::index last_use;
+      gsl::index offset;
+    };
+
+    const ExecutionPlan& execution_plan;
+    std::vector<Buffer> buffers;
+    std::vector<std::uint8_t, AlignedAllocator<std::uint8_t, ALIGNMENT>> arena;
+    gsl::index unplanned_size{0};
+  };
+}
+
+#endif
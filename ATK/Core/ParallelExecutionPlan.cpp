@@ -0,0 +1,321 @@
+/**
+ * \file ParallelExecutionPlan.cpp
+ */
+
+#include "ParallelExecutionPlan.h"
+#include <ATK/Core/Utilities.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ATK
+{
+  namespace
+  {
+    /// Chase-Lev work stealing deque. Each node is pushed at most once per block, so the storage never wraps around.
+    class WorkQueue
+    {
+    public:
+      void resize(gsl::index size)
+      {
+        buffer = std::make_unique<std::atomic<gsl::index>[]>(static_cast<std::size_t>(std::max<gsl::index>(size, 1)));
+        clear();
+      }
+
+      /// Must only be called when no thread is using the queue
+      void clear()
+      {
+        top.store(0, std::memory_order_relaxed);
+        bottom.store(0, std::memory_order_relaxed);
+      }
+
+      /// Called by the owner of the queue only
+      void push(gsl::index node)
+      {
+        auto b = bottom.load(std::memory_order_relaxed);
+        buffer[b].store(node, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_release);
+      }
+
+      /// Called by the owner of the queue only
+      bool pop(gsl::index& node)
+      {
+        auto b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t = top.load(std::memory_order_relaxed);
+        if(t > b)
+        {
+          bottom.store(b + 1, std::memory_order_relaxed);
+          return false;
+        }
+        node = buffer[b].load(std::memory_order_relaxed);
+        if(t == b)
+        {
+          // Last element, race against the thieves
+          bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+          bottom.store(b + 1, std::memory_order_relaxed);
+          return won;
+        }
+        return true;
+      }
+
+      /// Can be called by any thread
+      bool steal(gsl::index& node)
+      {
+        auto t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto b = bottom.load(std::memory_order_acquire);
+        if(t >= b)
+        {
+          return false;
+        }
+        node = buffer[t].load(std::memory_order_relaxed);
+        return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+      }
+
+    private:
+      alignas(64) std::atomic<gsl::index> top{0};
+      alignas(64) std::atomic<gsl::index> bottom{0};
+      std::unique_ptr<std::atomic<gsl::index>[]> buffer;
+    };
+  }
+
+  class ParallelExecutionPlan::Scheduler
+  {
+  public:
+    Scheduler(ParallelExecutionPlan& plan, gsl::index nb_threads)
+    :plan(plan), queues(static_cast<std::size_t>(nb_threads))
+    {
+      for(gsl::index i = 1; i < nb_threads; ++i)
+      {
+        threads.emplace_back([this, i](){worker(i);});
+      }
+    }
+
+    ~Scheduler()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+      }
+      condition.notify_all();
+      for(auto& thread: threads)
+      {
+        thread.join();
+      }
+    }
+
+    void compile()
+    {
+      auto nb_nodes = plan.get_nb_nodes();
+      dependents.assign(static_cast<std::size_t>(nb_nodes), {});
+      nb_dependencies.assign(static_cast<std::size_t>(nb_nodes), 0);
+      roots.clear();
+      for(gsl::index i = 0; i < nb_nodes; ++i)
+      {
+        const auto& dependencies = plan.nodes[i].dependencies;
+        nb_dependencies[i] = static_cast<gsl::index>(dependencies.size());
+        for(auto dependency: dependencies)
+        {
+          dependents[dependency].push_back(i);
+        }
+        if(dependencies.empty())
+        {
+          roots.push_back(i);
+        }
+      }
+      pending = std::make_unique<std::atomic<gsl::index>[]>(static_cast<std::size_t>(std::max<gsl::index>(nb_nodes, 1)));
+      for(auto& queue: queues)
+      {
+        queue.resize(nb_nodes);
+      }
+    }
+
+    /// Processes the nodes with the block sizes of the plan
+    void process()
+    {
+      auto nb_nodes = plan.get_nb_nodes();
+      for(gsl::index i = 0; i < nb_nodes; ++i)
+      {
+        pending[i].store(nb_dependencies[i], std::memory_order_relaxed);
+      }
+      for(auto& queue: queues)
+      {
+        queue.clear();
+      }
+      // Only the owner may push in a queue, but the workers are all idle here
+      for(std::size_t i = 0; i < roots.size(); ++i)
+      {
+        queues[i % queues.size()].push(roots[i]);
+      }
+      remaining_nodes.store(nb_nodes, std::memory_order_relaxed);
+      error = nullptr;
+      active_workers.store(static_cast<gsl::index>(threads.size()), std::memory_order_relaxed);
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        epoch.fetch_add(1, std::memory_order_release);
+      }
+      condition.notify_all();
+
+      run_block(0);
+      // End of block barrier
+      while(active_workers.load(std::memory_order_acquire) != 0)
+      {
+        std::this_thread::yield();
+      }
+      // All the counters and queues are reset by the next block, the workers are idle again
+      if(error)
+      {
+        std::rethrow_exception(std::exchange(error, nullptr));
+      }
+    }
+
+    gsl::index get_nb_threads() const
+    {
+      return static_cast<gsl::index>(queues.size());
+    }
+
+  private:
+    void worker(gsl::index id)
+    {
+      std::uint64_t seen_epoch = 0;
+      while(true)
+      {
+        // Spin for a while, as blocks usually come in quick succession, then sleep
+        for(int i = 0; i < spin_count && epoch.load(std::memory_order_acquire) == seen_epoch; ++i)
+        {
+          std::this_thread::yield();
+        }
+        if(epoch.load(std::memory_order_acquire) == seen_epoch)
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          condition.wait(lock, [&](){return stop || epoch.load(std::memory_order_acquire) != seen_epoch;});
+        }
+        if(stop)
+        {
+          return;
+        }
+        seen_epoch = epoch.load(std::memory_order_acquire);
+        run_block(id);
+        active_workers.fetch_sub(1, std::memory_order_release);
+      }
+    }
+
+    void run_block(gsl::index id)
+    {
+      auto& queue = queues[id];
+      auto nb_queues = static_cast<gsl::index>(queues.size());
+      while(remaining_nodes.load(std::memory_order_acquire) > 0)
+      {
+        gsl::index node = 0;
+        bool found = queue.pop(node);
+        for(gsl::index i = 1; !found && i < nb_queues; ++i)
+        {
+          found = queues[(id + i) % nb_queues].steal(node);
+        }
+        if(!found)
+        {
+          std::this_thread::yield();
+          continue;
+        }
+        const auto& current = plan.nodes[node];
+        try
+        {
+          plan.process_node<true>(current);
+        }
+        catch(...)
+        {
+          abort(std::current_exception());
+          return;
+        }
+        for(auto dependent: dependents[node])
+        {
+          if(pending[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+          {
+            queue.push(dependent);
+          }
+        }
+        remaining_nodes.fetch_sub(1, std::memory_order_acq_rel);
+      }
+    }
+
+    /// Keeps the first exception of the block and makes all the threads leave it
+    void abort(std::exception_ptr exception)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(!error)
+        {
+          error = std::move(exception);
+        }
+      }
+      // The nodes being processed by other threads may still decrement the counter below 0
+      remaining_nodes.store(0, std::memory_order_release);
+    }
+
+    static constexpr int spin_count = 1000;
+
+    ParallelExecutionPlan& plan;
+    std::vector<WorkQueue> queues;
+    std::vector<std::thread> threads;
+
+    std::vector<std::vector<gsl::index>> dependents;
+    std::vector<gsl::index> nb_dependencies;
+    std::vector<gsl::index> roots;
+    std::unique_ptr<std::atomic<gsl::index>[]> pending;
+
+    std::atomic<gsl::index> remaining_nodes{0};
+    std::atomic<gsl::index> active_workers{0};
+    std::atomic<std::uint64_t> epoch{0};
+    /// First exception thrown by a node of the current block, rethrown by the calling thread
+    std::exception_ptr error;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::atomic<bool> stop{false};
+  };
+
+  ParallelExecutionPlan::ParallelExecutionPlan(gsl::index nb_threads)
+  {
+    if(nb_threads <= 0)
+    {
+      nb_threads = std::max<gsl::index>(std::thread::hardware_concurrency(), 1);
+    }
+    scheduler = std::make_unique<Scheduler>(*this, nb_threads);
+  }
+
+  ParallelExecutionPlan::~ParallelExecutionPlan() = default;
+
+  void ParallelExecutionPlan::compile()
+  {
+    Parent::compile();
+    scheduler->compile();
+  }
+
+  void ParallelExecutionPlan::process(gsl::index size)
+  {
+    if(!compiled)
+    {
+      throw RuntimeError("The execution plan must be compiled before processing");
+    }
+    if(size == 0)
+    {
+      return;
+    }
+    update_block_sizes(size);
+    scheduler->process();
+  }
+
+  gsl::index ParallelExecutionPlan::get_nb_threads() const
+  {
+    return scheduler->get_nb_threads();
+  }
+}
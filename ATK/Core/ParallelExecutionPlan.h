@@ -0,0 +1,50 @@
+/**
+ * \file ParallelExecutionPlan.h
+ */
+
+#ifndef ATK_CORE_PARALLELEXECUTIONPLAN_H
+#define ATK_CORE_PARALLELEXECUTIONPLAN_H
+
+#include <ATK/Core/ExecutionPlan.h>
+
+#include <memory>
+
+namespace ATK
+{
+  /// Execution plan that processes independent branches of the pipeline concurrently
+  /*!
+   * A persistent pool of threads is created with the plan. For each block, nodes become ready when all their inputs
+   * are processed, ready nodes are pushed on lock-free per-thread queues and idle threads steal from the others.
+   * The calling thread takes part in the processing and returns when the whole block is processed.
+   * Only std::thread is used, so this doesn't depend on a thread pool library.
+   * If a filter throws, the block is abandoned and the first exception is rethrown by process once all the threads are
+   * idle, the plan can then process the next blocks.
+   */
+  class ATK_CORE_EXPORT ParallelExecutionPlan final : public ExecutionPlan
+  {
+  protected:
+    /// Simplify parent calls
+    using Parent = ExecutionPlan;
+
+  public:
+    /*!
+     * @brief Constructor
+     * @param nb_threads is the total number of threads used for processing, including the calling thread (0 for the number of hardware threads)
+     */
+    explicit ParallelExecutionPlan(gsl::index nb_threads = 0);
+    /// Destructor, stops the worker threads
+    ~ParallelExecutionPlan() override;
+
+    void compile() override;
+    void process(gsl::index size) override;
+
+    /// Returns the number of threads used for processing, including the calling thread
+    gsl::index get_nb_threads() const;
+
+  private:
+    class Scheduler;
+    std::unique_ptr<Scheduler> scheduler;
+  };
+}
+
+#endif
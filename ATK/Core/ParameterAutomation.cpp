@@ -0,0 +1,369 @@
+/**
+ * \file ParameterAutomation.cpp
+ */
+
+#include "ParameterAutomation.h"
+#include "BaseFilter.h"
+#include "ExecutionPlan.h"
+#include "Utilities.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace ATK
+{
+  /// A parameter whose value is computed on the worker thread
+  class ParameterAutomation::DeferredParameter
+  {
+  public:
+    DeferredParameter(Setter compute, std::function<void()> commit)
+    :compute(std::move(compute)), commit(std::move(commit))
+    {
+    }
+
+    /// Requests a new value, from the control thread
+    void request(double value)
+    {
+      requested_value.store(value, std::memory_order_relaxed);
+      requested_version.fetch_add(1, std::memory_order_release);
+    }
+
+    /// Returns true if a computation is needed, from the worker thread
+    bool is_pending() const
+    {
+      return status.load(std::memory_order_acquire) == Idle && requested_version.load(std::memory_order_acquire) != computed_version;
+    }
+
+    /// Computes the last requested value, from the worker thread
+    void try_compute()
+    {
+      if(!is_pending())
+      {
+        return;
+      }
+      // A newer request between these loads is computed again later
+      computed_version = requested_version.load(std::memory_order_acquire);
+      compute(requested_value.load(std::memory_order_relaxed));
+      status.store(Ready, std::memory_order_release);
+    }
+
+    /// Commits the computed value, from the processing thread. Returns true if a value was committed
+    bool try_commit()
+    {
+      if(status.load(std::memory_order_acquire) != Ready)
+      {
+        return false;
+      }
+      commit();
+      status.store(Idle, std::memory_order_release);
+      return true;
+    }
+
+  private:
+    enum Status
+    {
+      /// Nothing computed, compute can be called
+      Idle,
+      /// A value is computed and waits for its commit
+      Ready
+    };
+
+    Setter compute;
+    std::function<void()> commit;
+    std::atomic<double> requested_value{0};
+    std::atomic<std::uint64_t> requested_version{0};
+    /// Only accessed by the worker thread
+    std::uint64_t computed_version{0};
+    std::atomic<Status> status{Idle};
+  };
+
+  /// A parameter applied by the processing thread
+  class ParameterAutomation::Parameter
+  {
+  public:
+    Parameter(Setter setter, double value, Smoothing smoothing, gsl::index smoothing_size)
+    :setter(std::move(setter)), value(value, smoothing, smoothing_size)
+    {
+    }
+
+    explicit Parameter(DeferredParameter* deferred)
+    :deferred(deferred)
+    {
+    }
+
+    /// Calls the setter with the current value
+    void update()
+    {
+      setter(value.get_value());
+    }
+
+    Setter setter;
+    SmoothedParameter<double> value;
+    /// The computation of a deferred parameter, owned by the worker
+    DeferredParameter* deferred{nullptr};
+  };
+
+  /// Background thread computing the deferred parameters
+  class ParameterAutomation::Worker
+  {
+  public:
+    Worker()
+    :thread([this](){run();})
+    {
+    }
+
+    ~Worker()
+    {
+      stop.store(true, std::memory_order_release);
+      condition.notify_one();
+      thread.join();
+    }
+
+    /// Adds a deferred parameter, not from the processing thread
+    DeferredParameter* add(std::unique_ptr<DeferredParameter> parameter)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      parameters.push_back(std::move(parameter));
+      return parameters.back().get();
+    }
+
+    /// Wakes up the thread, called without locking so that the processing thread never blocks
+    void notify()
+    {
+      condition.notify_one();
+    }
+
+  private:
+    void run()
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      while(!stop.load(std::memory_order_acquire))
+      {
+        for(auto& parameter: parameters)
+        {
+          parameter->try_compute();
+        }
+        // A notification may be missed as the lock is not taken by notify(), hence the timeout
+        condition.wait_for(lock, std::chrono::milliseconds(1), [this](){return stop.load(std::memory_order_acquire) || has_pending();});
+      }
+    }
+
+    bool has_pending() const
+    {
+      return std::any_of(parameters.begin(), parameters.end(), [](const auto& parameter){return parameter->is_pending();});
+    }
+
+    std::vector<std::unique_ptr<DeferredParameter>> parameters;
+    std::atomic<bool> stop{false};
+    /// Protects the list of parameters, held by the thread while it computes
+    std::mutex mutex;
+    std::condition_variable condition;
+    /// Started last, once the other members are initialized
+    std::thread thread;
+  };
+
+  ParameterAutomation::ParameterAutomation(gsl::index queue_size)
+  :queue(queue_size)
+  {
+    pending_events.reserve(queue.get_capacity());
+  }
+
+  ParameterAutomation::~ParameterAutomation()
+  {
+    // The thread must be stopped before the parameters are destroyed
+    worker.reset();
+  }
+
+  gsl::index ParameterAutomation::add_parameter(Setter setter, double value, Smoothing smoothing, gsl::index smoothing_size)
+  {
+    parameters.push_back(std::make_unique<Parameter>(std::move(setter), value, smoothing, smoothing_size));
+    parameters.back()->update();
+    return static_cast<gsl::index>(parameters.size()) - 1;
+  }
+
+  gsl::index ParameterAutomation::add_deferred_parameter(Setter compute, std::function<void()> commit)
+  {
+    if(!worker)
+    {
+      worker = std::make_unique<Worker>();
+    }
+    parameters.push_back(std::make_unique<Parameter>(worker->add(std::make_unique<DeferredParameter>(std::move(compute), std::move(commit)))));
+    return static_cast<gsl::index>(parameters.size()) - 1;
+  }
+
+  gsl::index ParameterAutomation::get_nb_parameters() const
+  {
+    return static_cast<gsl::index>(parameters.size());
+  }
+
+  void ParameterAutomation::set_control_period(gsl::index control_period)
+  {
+    if(control_period <= 0)
+    {
+      throw RuntimeError("Control period must be strictly positive");
+    }
+    this->control_period = control_period;
+    control_position = 0;
+  }
+
+  gsl::index ParameterAutomation::get_control_period() const
+  {
+    return control_period;
+  }
+
+  bool ParameterAutomation::set_parameter(gsl::index parameter, double value, gsl::index timestamp)
+  {
+    if(parameter < 0 || parameter >= static_cast<gsl::index>(parameters.size()))
+    {
+      throw RuntimeError("Parameter does not exist");
+    }
+    auto* deferred = parameters[parameter]->deferred;
+    if(deferred)
+    {
+      deferred->request(value);
+      worker->notify();
+      return true;
+    }
+    return queue.push(Event{parameter, value, std::max<gsl::index>(timestamp, 0)});
+  }
+
+  void ParameterAutomation::process(BaseFilter& sink, gsl::index size)
+  {
+    process_parts([&sink](gsl::index part_size){sink.process(part_size);}, size);
+  }
+
+  void ParameterAutomation::process(ExecutionPlan& plan, gsl::index size)
+  {
+    process_parts([&plan](gsl::index part_size){plan.process(part_size);}, size);
+  }
+
+  template<typename Processor>
+  void ParameterAutomation::process_parts(Processor&& processor, gsl::index size)
+  {
+    commit_deferred_parameters();
+    receive_events();
+
+    gsl::index position = 0;
+    apply_events(position);
+    while(position < size)
+    {
+      // The block is split at the next change or the next update of the ramps
+      auto next_position = size;
+      if(!pending_events.empty())
+      {
+        next_position = std::min(next_position, pending_events.front().timestamp);
+      }
+      auto update = next_control_update();
+      if(update > 0)
+      {
+        next_position = std::min(next_position, position + update);
+      }
+
+      processor(next_position - position);
+      advance_parameters(next_position - position);
+      position = next_position;
+      apply_events(position);
+    }
+
+    for(auto& event: pending_events)
+    {
+      event.timestamp -= size;
+    }
+  }
+
+  void ParameterAutomation::receive_events()
+  {
+    Event event;
+    while(pending_events.size() < pending_events.capacity() && queue.pop(event))
+    {
+      // Changes are usually sent in order, the insertion keeps the order of changes with the same timestamp
+      auto it = std::upper_bound(pending_events.begin(), pending_events.end(), event, [](const Event& lhs, const Event& rhs){return lhs.timestamp < rhs.timestamp;});
+      pending_events.insert(it, event);
+    }
+  }
+
+  void ParameterAutomation::apply_events(gsl::index timestamp)
+  {
+    auto end = std::find_if(pending_events.begin(), pending_events.end(), [timestamp](const Event& event){return event.timestamp > timestamp;});
+    if(end == pending_events.begin())
+    {
+      return;
+    }
+    for(auto it = pending_events.begin(); it != end; ++it)
+    {
+      auto& parameter = *parameters[it->parameter];
+      parameter.value.set_target(it->value);
+      if(!parameter.value.is_smoothing())
+      {
+        parameter.update();
+      }
+    }
+    pending_events.erase(pending_events.begin(), end);
+  }
+
+  void ParameterAutomation::advance_parameters(gsl::index nb_samples)
+  {
+    control_position += nb_samples;
+    bool control_update = control_position >= control_period;
+    bool smoothing = false;
+    for(auto& parameter: parameters)
+    {
+      if(!parameter->value.is_smoothing())
+      {
+        continue;
+      }
+      parameter->value.advance(nb_samples);
+      // The final value of a ramp is always set
+      if(control_update || !parameter->value.is_smoothing())
+      {
+        parameter->update();
+      }
+      smoothing |= parameter->value.is_smoothing();
+    }
+    if(control_update || !smoothing)
+    {
+      control_position = 0;
+    }
+  }
+
+  gsl::index ParameterAutomation::next_control_update() const
+  {
+    gsl::index update = 0;
+    for(const auto& parameter: parameters)
+    {
+      if(parameter->value.is_smoothing())
+      {
+        // Ramps also end exactly on their last sample
+        auto remaining = std::min(control_period - control_position, parameter->value.get_remaining_samples());
+        update = update == 0 ? remaining : std::min(update, remaining);
+      }
+    }
+    return update;
+  }
+
+  void ParameterAutomation::commit_deferred_parameters()
+  {
+    if(!worker)
+    {
+      return;
+    }
+    bool committed = false;
+    for(auto& parameter: parameters)
+    {
+      if(parameter->deferred)
+      {
+        committed |= parameter->deferred->try_commit();
+      }
+    }
+    if(committed)
+    {
+      // Requests received during the computation can be computed now
+      worker->notify();
+    }
+  }
+}
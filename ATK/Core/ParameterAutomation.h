@@ -0,0 +1,173 @@
+/**
+ * \file ParameterAutomation.h
+ */
+
+#ifndef ATK_CORE_PARAMETERAUTOMATION_H
+#define ATK_CORE_PARAMETERAUTOMATION_H
+
+#include <ATK/Core/SmoothedParameter.h>
+#include <ATK/Core/SPSCQueue.h>
+
+#include <gsl/gsl>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace ATK
+{
+  class BaseFilter;
+  class ExecutionPlan;
+
+  /// Thread safe automation of the parameters of a pipeline
+  /*!
+   * A control thread (GUI, host automation) sends timestamped parameter changes through a lock-free queue. The
+   * processing thread applies them when it processes the pipeline, so that the filters are only modified from this
+   * thread. Blocks are split at the timestamps of the changes, and smoothed parameters are updated every control period
+   * while they ramp towards their target.
+   * The filters only read their parameters once per block, so a ramp is applied as a staircase with a step every control
+   * period, not interpolated inside the block. A control period of 1 gives a true per sample ramp, at the cost of
+   * processing the pipeline one sample at a time while a parameter ramps.
+   * Expensive parameters (coefficients designs for instance) can be deferred: their computation happens on a worker
+   * thread, and only the commit of the result is done by the processing thread at the beginning of a block.
+   * Parameters must all be added before processing or sending changes.
+   */
+  class ATK_CORE_EXPORT ParameterAutomation
+  {
+  public:
+    /// Function updating a parameter of a filter
+    using Setter = std::function<void(double)>;
+
+    /*!
+     * @brief Constructor
+     * @param queue_size is the maximum number of changes pending between two blocks
+     */
+    explicit ParameterAutomation(gsl::index queue_size = 1024);
+    /// Destructor, stops the worker thread
+    ~ParameterAutomation();
+
+    ParameterAutomation(const ParameterAutomation&) = delete;
+    ParameterAutomation& operator=(const ParameterAutomation&) = delete;
+
+    /*!
+     * @brief Adds a parameter updated on the processing thread
+     * @param setter is called with the new value of the parameter
+     * @param value is the initial value of the parameter, set immediately
+     * @param smoothing is the ramp followed when the parameter changes
+     * @param smoothing_size is the number of samples of the ramp
+     * @return the index of the parameter
+     */
+    gsl::index add_parameter(Setter setter, double value, Smoothing smoothing = Smoothing::None, gsl::index smoothing_size = 0);
+
+    /*!
+     * @brief Adds a parameter updated by a filter method on the processing thread
+     * @param filter is the filter to update
+     * @param method is the setter of the filter
+     * @param value is the initial value of the parameter, set immediately
+     * @param smoothing is the ramp followed when the parameter changes
+     * @param smoothing_size is the number of samples of the ramp
+     * @return the index of the parameter
+     */
+    template<typename Filter, typename Value>
+    gsl::index add_parameter(Filter& filter, void (Filter::*method)(Value), double value, Smoothing smoothing = Smoothing::None, gsl::index smoothing_size = 0)
+    {
+      return add_parameter([&filter, method](double value){(filter.*method)(static_cast<Value>(value));}, value, smoothing, smoothing_size);
+    }
+
+    /*!
+     * @brief Adds a parameter computed on the worker thread
+     * compute is never called while commit is, so it can prepare its result in a buffer that commit swaps in.
+     * @param compute is called on the worker thread with the new value of the parameter
+     * @param commit is called on the processing thread at the beginning of the block following the computation
+     * @return the index of the parameter
+     */
+    gsl::index add_deferred_parameter(Setter compute, std::function<void()> commit);
+
+    /*!
+     * @brief Adds a parameter whose coefficients are designed on the worker thread
+     * The filter designs the coefficients in staging buffers with the stage method, and swaps them in with its
+     * commit_staged_coefficients method, as the Chebyshev and Remez coefficients do.
+     * @param filter is the filter to update
+     * @param stage is the method designing the coefficients of a new value
+     * @return the index of the parameter
+     */
+    template<typename Filter, typename Class, typename Value>
+    gsl::index add_deferred_parameter(Filter& filter, void (Class::*stage)(Value))
+    {
+      return add_deferred_parameter([&filter, stage](double value){(filter.*stage)(static_cast<Value>(value));}, [&filter](){filter.commit_staged_coefficients();});
+    }
+
+    /// Returns the number of parameters
+    gsl::index get_nb_parameters() const;
+
+    /*!
+     * @brief Changes the number of samples between two updates of a ramping parameter
+     * The value is held between two updates, a smaller period gives a smoother ramp but smaller blocks.
+     * @param control_period is the update period in samples, 1 for per sample updates
+     */
+    void set_control_period(gsl::index control_period);
+    /// Returns the number of samples between two updates of a ramping parameter
+    gsl::index get_control_period() const;
+
+    /*!
+     * @brief Changes a parameter, from the control thread. Never blocks nor allocates
+     * Deferred parameters ignore the timestamp and are updated as soon as they are computed.
+     * @param parameter is the index of the parameter
+     * @param value is the new value
+     * @param timestamp is the position of the change in samples, relative to the beginning of the next processed block
+     * @return false if the change was dropped because the queue is full
+     */
+    bool set_parameter(gsl::index parameter, double value, gsl::index timestamp = 0);
+
+    /*!
+     * @brief Processes a sink, applying the pending changes
+     * @param sink is the last filter of the pipeline
+     * @param size is the number of samples to process
+     */
+    void process(BaseFilter& sink, gsl::index size);
+    /*!
+     * @brief Processes a plan, applying the pending changes
+     * @param plan is a compiled plan
+     * @param size is the number of samples to process, at the plan reference sampling rate
+     */
+    void process(ExecutionPlan& plan, gsl::index size);
+
+  private:
+    /// A change of a parameter sent by the control thread
+    struct Event
+    {
+      gsl::index parameter{0};
+      double value{0};
+      gsl::index timestamp{0};
+    };
+    class Parameter;
+    class DeferredParameter;
+    class Worker;
+
+    /// Applies the changes and calls processor on each part of the block
+    template<typename Processor>
+    void process_parts(Processor&& processor, gsl::index size);
+    /// Moves the changes from the queue to the pending events, sorted by timestamp
+    void receive_events();
+    /// Applies the pending events at this timestamp
+    void apply_events(gsl::index timestamp);
+    /// Advances the ramping parameters and calls their setters
+    void advance_parameters(gsl::index nb_samples);
+    /// Returns the number of samples before the next update of the ramping parameters, 0 if none is ramping
+    gsl::index next_control_update() const;
+    /// Commits the deferred parameters whose computation is finished
+    void commit_deferred_parameters();
+
+    std::vector<std::unique_ptr<Parameter>> parameters;
+    SPSCQueue<Event> queue;
+    /// Changes received from the queue, not applied yet
+    std::vector<Event> pending_events;
+    gsl::index control_period{16};
+    /// Samples since the last update of the ramping parameters
+    gsl::index control_position{0};
+    /// Owns the deferred parameters and computes them, started with the first deferred parameter
+    std::unique_ptr<Worker> worker;
+  };
+}
+
+#endif
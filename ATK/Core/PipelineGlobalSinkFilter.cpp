@@ -5,10 +5,6 @@
 #include "PipelineGlobalSinkFilter.h"
 #include <ATK/Core/Utilities.h>
 
-#if ATK_USE_THREADPOOL == 1
-#include <tbb/task_group.h>
-#endif
-
 #include <algorithm>
 
 namespace ATK
@@ -23,6 +19,10 @@ namespace ATK
     if(std::find(filters.begin(), filters.end(), filter) == filters.end())
     {
       filters.push_back(filter);
+      if(plan)
+      {
+        plan->add_sink(filter);
+      }
     }
     else
     {
@@ -36,6 +36,10 @@ namespace ATK
     if(it != filters.end())
     {
       filters.erase(it);
+      if(plan)
+      {
+        plan->remove_sink(filter);
+      }
     }
     else
     {
@@ -58,14 +62,27 @@ namespace ATK
     throw RuntimeError("This function must not be called on pipelines");
   }
 
-  void PipelineGlobalSinkFilter::set_parallel(bool parallel)
+  void PipelineGlobalSinkFilter::set_parallel(bool parallel, gsl::index nb_threads)
   {
     activate_parallel = parallel;
+    plan.reset();
+    if(parallel)
+    {
+      plan = std::make_unique<ParallelExecutionPlan>(nb_threads);
+      for(auto filter: filters)
+      {
+        plan->add_sink(filter);
+      }
+    }
   }
 
   void PipelineGlobalSinkFilter::prepare_process(gsl::index size)
   {
-    // Nothing to do
+    // Compiling may throw and allocate, so it is done here and not in process_impl
+    if(plan && !filters.empty() && !plan->is_compiled())
+    {
+      plan->compile();
+    }
   }
 
   void PipelineGlobalSinkFilter::prepare_outputs(gsl::index size )
@@ -73,6 +90,15 @@ namespace ATK
     // Nothing to do
   }
 
+  void PipelineGlobalSinkFilter::full_setup()
+  {
+    if(plan)
+    {
+      plan->invalidate();
+    }
+    Parent::full_setup();
+  }
+
   void PipelineGlobalSinkFilter::dryrun(gsl::index size)
   {
     for(auto filter: filters)
@@ -87,25 +113,15 @@ namespace ATK
 
   void PipelineGlobalSinkFilter::process_impl(gsl::index size ) const
   {
-    for(auto filter: filters)
+    if(activate_parallel && !filters.empty())
     {
-      filter->reset();
+      plan->process(uint64_t(size) * plan->get_sampling_rate() / input_sampling_rate);
+      return;
     }
-#if ATK_USE_THREADPOOL == 1
-    if (activate_parallel)
+    for(auto filter: filters)
     {
-      tbb::task_group g;
-      for(auto filter: filters)
-      {
-        g.run([=] {
-          filter->process_conditionnally<true>(
-              uint64_t(size) * (*it)->get_output_sampling_rate() / input_sampling_rate);
-        });
-      }
-      g.wait();
-      return;
+      filter->reset();
     }
-#endif
     for(auto filter: filters)
     {
       filter->process_conditionnally<true>(uint64_t(size) * filter->get_output_sampling_rate() / input_sampling_rate);
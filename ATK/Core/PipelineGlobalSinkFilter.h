@@ -6,7 +6,9 @@
 #define ATK_CORE_PIPELINEGLOBALSINKFILTER_H
 
 #include <ATK/Core/BaseFilter.h>
+#include <ATK/Core/ParallelExecutionPlan.h>
 
+#include <memory>
 #include <vector>
 
 namespace ATK
@@ -40,10 +42,16 @@ namespace ATK
     void set_input_port(gsl::index input_port, BaseFilter& filter, gsl::index output_port) final;
     /*!
      * @brief Indicates if we can process the pipeline in parallel
+     * The pipeline is then processed by a ParallelExecutionPlan that is compiled before the first block is processed.
+     * Adding or removing filters and changing the sampling rates invalidate it, but reconnecting filters of the pipeline
+     * can't be detected, so this must be called again if the pipeline is modified afterwards.
+     * @param parallel activates or deactivates parallel processing
+     * @param nb_threads is the number of threads to use, 0 for the number of hardware threads
      */
-    void set_parallel(bool parallel);
+    void set_parallel(bool parallel, gsl::index nb_threads = 0);
 
     void dryrun(gsl::index size);
+    void full_setup() final;
 
   protected:
     void process_impl(gsl::index size) const final;
@@ -54,6 +62,8 @@ namespace ATK
     std::vector<gsl::not_null<BaseFilter*>> filters;
     /// Are we in parallel mode?
     bool activate_parallel = false;
+    /// Execution plan used in parallel mode, compiled when a block is prepared
+    std::unique_ptr<ParallelExecutionPlan> plan;
   };
 }
 
@@ -0,0 +1,103 @@
+/**
+ * \file SPSCQueue.h
+ */
+
+#ifndef ATK_CORE_SPSCQUEUE_H
+#define ATK_CORE_SPSCQUEUE_H
+
+#include <ATK/Core/Utilities.h>
+
+#include <gsl/gsl>
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace ATK
+{
+  /// Lock-free bounded queue between one producer thread and one consumer thread
+  /*!
+   * The storage is allocated by the constructor, pushing and popping never allocate nor block.
+   */
+  template<typename Element>
+  class SPSCQueue
+  {
+  public:
+    /*!
+     * @brief Constructor
+     * @param capacity is the maximum number of elements in the queue, rounded up to a power of 2
+     */
+    explicit SPSCQueue(gsl::index capacity)
+    {
+      if(capacity <= 0)
+      {
+        throw RuntimeError("Queue capacity must be strictly positive");
+      }
+      std::size_t size = 1;
+      while(size < static_cast<std::size_t>(capacity))
+      {
+        size *= 2;
+      }
+      elements.resize(size);
+      mask = size - 1;
+    }
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    /// Returns the maximum number of elements in the queue
+    gsl::index get_capacity() const
+    {
+      return static_cast<gsl::index>(elements.size());
+    }
+
+    /*!
+     * @brief Adds an element at the end of the queue, from the producer thread
+     * @param element is the element to add
+     * @return false if the queue is full
+     */
+    bool push(const Element& element)
+    {
+      auto current_tail = tail.load(std::memory_order_relaxed);
+      if(current_tail - head.load(std::memory_order_acquire) == elements.size())
+      {
+        return false;
+      }
+      elements[current_tail & mask] = element;
+      tail.store(current_tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    /*!
+     * @brief Removes the first element of the queue, from the consumer thread
+     * @param element receives the removed element
+     * @return false if the queue is empty
+     */
+    bool pop(Element& element)
+    {
+      auto current_head = head.load(std::memory_order_relaxed);
+      if(current_head == tail.load(std::memory_order_acquire))
+      {
+        return false;
+      }
+      element = elements[current_head & mask];
+      head.store(current_head + 1, std::memory_order_release);
+      return true;
+    }
+
+    /// Returns true if the queue is empty, only reliable from the consumer thread
+    bool empty() const
+    {
+      return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire);
+    }
+
+  private:
+    std::vector<Element> elements;
+    std::size_t mask{0};
+    /// Positions of the next element to pop and to push, on different cache lines to avoid false sharing
+    alignas(64) std::atomic<std::size_t> head{0};
+    alignas(64) std::atomic<std::size_t> tail{0};
+  };
+}
+
+#endif
@@ -0,0 +1,124 @@
+/**
+ * \file SmoothedParameter.cpp
+ */
+
+#include "SmoothedParameter.h"
+#include "Utilities.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ATK
+{
+  template<typename DataType_>
+  SmoothedParameter<DataType_>::SmoothedParameter(DataType value, Smoothing smoothing, gsl::index smoothing_size)
+  :value(value), target(value), smoothing(smoothing), smoothing_size(0)
+  {
+    set_smoothing(smoothing, smoothing_size);
+  }
+
+  template<typename DataType_>
+  void SmoothedParameter<DataType_>::set_smoothing(Smoothing smoothing, gsl::index smoothing_size)
+  {
+    if(smoothing_size < 0)
+    {
+      throw RuntimeError("Smoothing size must be positive");
+    }
+    this->smoothing = smoothing;
+    this->smoothing_size = smoothing_size;
+    set_value(target);
+  }
+
+  template<typename DataType_>
+  Smoothing SmoothedParameter<DataType_>::get_smoothing() const
+  {
+    return smoothing;
+  }
+
+  template<typename DataType_>
+  gsl::index SmoothedParameter<DataType_>::get_smoothing_size() const
+  {
+    return smoothing_size;
+  }
+
+  template<typename DataType_>
+  void SmoothedParameter<DataType_>::set_target(DataType target)
+  {
+    this->target = target;
+    if(smoothing == Smoothing::None || smoothing_size == 0)
+    {
+      set_value(target);
+      return;
+    }
+    start = value;
+    current_smoothing = smoothing;
+    if(current_smoothing == Smoothing::Exponential && !(start * target > 0))
+    {
+      current_smoothing = Smoothing::Linear;
+    }
+    remaining_samples = smoothing_size;
+  }
+
+  template<typename DataType_>
+  DataType_ SmoothedParameter<DataType_>::get_target() const
+  {
+    return target;
+  }
+
+  template<typename DataType_>
+  void SmoothedParameter<DataType_>::set_value(DataType value)
+  {
+    this->value = value;
+    target = value;
+    remaining_samples = 0;
+  }
+
+  template<typename DataType_>
+  DataType_ SmoothedParameter<DataType_>::get_value() const
+  {
+    return value;
+  }
+
+  template<typename DataType_>
+  bool SmoothedParameter<DataType_>::is_smoothing() const
+  {
+    return remaining_samples > 0;
+  }
+
+  template<typename DataType_>
+  gsl::index SmoothedParameter<DataType_>::get_remaining_samples() const
+  {
+    return remaining_samples;
+  }
+
+  template<typename DataType_>
+  DataType_ SmoothedParameter<DataType_>::advance(gsl::index nb_samples)
+  {
+    if(remaining_samples == 0)
+    {
+      return value;
+    }
+    remaining_samples = std::max<gsl::index>(remaining_samples - nb_samples, 0);
+    if(remaining_samples == 0)
+    {
+      value = target;
+      return value;
+    }
+    // The value is computed from the start of the ramp so that errors don't accumulate
+    auto position = static_cast<DataType>(smoothing_size - remaining_samples) / smoothing_size;
+    if(current_smoothing == Smoothing::Exponential)
+    {
+      value = start * std::pow(target / start, position);
+    }
+    else
+    {
+      value = start + (target - start) * position;
+    }
+    return value;
+  }
+
+#if ATK_ENABLE_INSTANTIATION
+  template class SmoothedParameter<float>;
+#endif
+  template class SmoothedParameter<double>;
+}
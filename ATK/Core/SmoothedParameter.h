@@ -0,0 +1,81 @@
+/**
+ * \file SmoothedParameter.h
+ */
+
+#ifndef ATK_CORE_SMOOTHEDPARAMETER_H
+#define ATK_CORE_SMOOTHEDPARAMETER_H
+
+#include <ATK/config.h>
+#include <ATK/Core/config.h>
+
+#include <gsl/gsl>
+
+namespace ATK
+{
+  /// Ramp followed by a smoothed parameter when its target changes
+  enum class Smoothing
+  {
+    /// The target is used immediately
+    None,
+    /// Constant step per sample
+    Linear,
+    /// Constant ratio per sample, for frequencies or gains. Falls back to linear if the values don't have the same sign
+    Exponential
+  };
+
+  /// Parameter that moves towards its target value in a fixed number of samples
+  template<typename DataType_>
+  class ATK_CORE_EXPORT SmoothedParameter
+  {
+  public:
+    using DataType = DataType_;
+
+    /*!
+     * @brief Constructor
+     * @param value is the initial value of the parameter
+     * @param smoothing is the ramp followed when the target changes
+     * @param smoothing_size is the number of samples to reach the target
+     */
+    explicit SmoothedParameter(DataType value = 0, Smoothing smoothing = Smoothing::None, gsl::index smoothing_size = 0);
+
+    /// Changes the ramp and its length, the current ramp is finished immediately
+    void set_smoothing(Smoothing smoothing, gsl::index smoothing_size);
+    /// Returns the ramp followed when the target changes
+    Smoothing get_smoothing() const;
+    /// Returns the number of samples to reach the target
+    gsl::index get_smoothing_size() const;
+
+    /// Sets a new target, reached after the smoothing size
+    void set_target(DataType target);
+    /// Returns the target value
+    DataType get_target() const;
+    /// Sets the value and the target immediately
+    void set_value(DataType value);
+    /// Returns the current value
+    DataType get_value() const;
+
+    /// Returns true if the value has not reached its target yet
+    bool is_smoothing() const;
+    /// Returns the number of samples before the target is reached
+    gsl::index get_remaining_samples() const;
+
+    /*!
+     * @brief Advances the ramp
+     * @param nb_samples is the number of elapsed samples
+     * @return the new value
+     */
+    DataType advance(gsl::index nb_samples = 1);
+
+  private:
+    DataType value;
+    DataType target;
+    /// Value at the beginning of the current ramp
+    DataType start{0};
+    Smoothing smoothing;
+    Smoothing current_smoothing{Smoothing::None};
+    gsl::index smoothing_size;
+    gsl::index remaining_samples{0};
+  };
+}
+
+#endif
@@ -5,11 +5,10 @@
 #ifndef ATK_CORE_TYPEDBASEFILTER_H
 #define ATK_CORE_TYPEDBASEFILTER_H
 
+#include <ATK/Core/AlignedAllocator.h>
 #include <ATK/Core/BaseFilter.h>
 #include <ATK/Core/TypeTraits.h>
 
-#include <boost/align/aligned_allocator.hpp>
-
 #include <gsl/gsl>
 
 #include <memory>
@@ -52,11 +51,11 @@ namespace ATK
     /// To be used by inherited APIs
     using DataTypeOutput = DataType__;
     /// To be used for filters that require aligned data
-    using AlignedVector = std::vector<DataTypeInput, boost::alignment::aligned_allocator<DataTypeInput, ALIGNMENT> >;
+    using AlignedVector = std::vector<DataTypeInput, AlignedAllocator<DataTypeInput, ALIGNMENT> >;
     /// To be used for filters that require aligned data for output data
-    using AlignedOutVector = std::vector<DataTypeOutput, boost::alignment::aligned_allocator<DataTypeOutput, ALIGNMENT> >;
+    using AlignedOutVector = std::vector<DataTypeOutput, AlignedAllocator<DataTypeOutput, ALIGNMENT> >;
     /// To be used for filters that required aligned data for parameters (like EQ)
-    using AlignedScalarVector = std::vector<typename TypeTraits<DataType>::Scalar, boost::alignment::aligned_allocator<typename TypeTraits<DataType>::Scalar, ALIGNMENT> >;
+    using AlignedScalarVector = std::vector<typename TypeTraits<DataType>::Scalar, AlignedAllocator<typename TypeTraits<DataType>::Scalar, ALIGNMENT> >;
 
     /// Base constructor for filters with actual data
     TypedBaseFilter(gsl::index nb_input_ports, gsl::index nb_output_ports);
@@ -96,6 +95,16 @@ namespace ATK
 
     /// Used to convert other filter outputs to DataType*
     void convert_inputs(gsl::index size);
+    /// Allocates the buffers of all the ports for blocks up to size samples
+    void preallocate(gsl::index size) override;
+
+    gsl::index get_aliased_input(gsl::index output_port) const override;
+    bool can_use_input_array(gsl::index port) const override;
+
+    gsl::index get_input_buffer_size(gsl::index port, gsl::index size) const override;
+    gsl::index get_output_buffer_size(gsl::index port, gsl::index size) const override;
+    void set_input_buffer(gsl::index port, void* buffer, gsl::index bytes) override;
+    void set_output_buffer(gsl::index port, void* buffer, gsl::index bytes) override;
 
     /// Input arrays with the input delay, owned here
     std::vector<AlignedVector> converted_inputs_delay;
@@ -117,10 +126,25 @@ namespace ATK
     /// Current output delay
     std::vector<gsl::index> out_delays;
 
+    /// External input arrays with the input delay and their capacity, not owned
+    std::vector<std::pair<DataTypeInput*, gsl::index>> external_inputs;
+    /// External output arrays with the output delay and their capacity, not owned
+    std::vector<std::pair<DataTypeOutput*, gsl::index>> external_outputs;
+
     /// A vector containing the default values for the input arrays
     AlignedVector default_input;
     /// A vector containing the default values for the output arrays
     AlignedOutVector default_output;
+    /// Output ports that were computed in place during the last block
+    boost::dynamic_bitset<> aliased_outputs;
+
+  private:
+    /// Returns true if an input port directly uses the output array of the connected filter
+    bool is_direct_input(gsl::index port) const;
+    /// Grows the buffer of an input port, keeping its history
+    void allocate_input(gsl::index port, gsl::index size);
+    /// Grows the buffer of an output port, keeping its history
+    void allocate_output(gsl::index port, gsl::index size);
   };
 }
 
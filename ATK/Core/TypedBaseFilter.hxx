@@ -8,6 +8,7 @@
 #include <boost/mp11/algorithm.hpp>
 #include <boost/mp11/list.hpp>
 
+#include <algorithm>
 #include <complex>
 #include <cstdint>
 #include <type_traits>
@@ -104,7 +105,7 @@ namespace Utilities
 
   template<typename DataType_, typename DataType__>
   TypedBaseFilter<DataType_, DataType__>::TypedBaseFilter(gsl::index nb_input_ports, gsl::index nb_output_ports)
-  :Parent(nb_input_ports, nb_output_ports), converted_inputs_delay(nb_input_ports), converted_inputs(nb_input_ports, nullptr), converted_inputs_size(nb_input_ports, 0), converted_in_delays(nb_input_ports, 0), direct_filters(nb_input_ports, nullptr), outputs_delay(nb_output_ports), outputs(nb_output_ports, nullptr), outputs_size(nb_output_ports, 0), out_delays(nb_output_ports, 0), default_input(nb_input_ports, TypeTraits<DataType_>::Zero()), default_output(nb_output_ports, TypeTraits<DataType__>::Zero())
+  :Parent(nb_input_ports, nb_output_ports), converted_inputs_delay(nb_input_ports), converted_inputs(nb_input_ports, nullptr), converted_inputs_size(nb_input_ports, 0), converted_in_delays(nb_input_ports, 0), direct_filters(nb_input_ports, nullptr), outputs_delay(nb_output_ports), outputs(nb_output_ports, nullptr), outputs_size(nb_output_ports, 0), out_delays(nb_output_ports, 0), external_inputs(nb_input_ports, std::make_pair(nullptr, 0)), external_outputs(nb_output_ports, std::make_pair(nullptr, 0)), default_input(nb_input_ports, TypeTraits<DataType_>::Zero()), default_output(nb_output_ports, TypeTraits<DataType__>::Zero()), aliased_outputs(nb_output_ports)
   {
   }
 
@@ -121,6 +122,7 @@ namespace Utilities
     converted_inputs_size.assign(nb_ports, 0);
     converted_in_delays.assign(nb_ports, 0);
     direct_filters.assign(nb_ports, nullptr);
+    external_inputs.assign(nb_ports, std::make_pair(nullptr, 0));
     default_input.assign(nb_ports, TypeTraits<DataTypeInput>::Zero());
   }
 
@@ -136,7 +138,10 @@ namespace Utilities
     outputs.assign(nb_ports, nullptr);
     outputs_size.assign(nb_ports, 0);
     out_delays.assign(nb_ports, 0);
+    external_outputs.assign(nb_ports, std::make_pair(nullptr, 0));
     default_output.assign(nb_ports, TypeTraits<DataTypeOutput>::Zero());
+    aliased_outputs.clear();
+    aliased_outputs.resize(nb_ports);
   }
 
   template<typename DataType_, typename DataType__>
@@ -170,103 +175,326 @@ namespace Utilities
   }
 
   template<typename DataType_, typename DataType__>
-  void TypedBaseFilter<DataType_, DataType__>::convert_inputs(gsl::index size)
+  bool TypedBaseFilter<DataType_, DataType__>::is_direct_input(gsl::index port) const
   {
-    for(gsl::index i = 0; i < nb_input_ports; ++i)
+    // if the input delay is smaller than the preceding filter output delay, we may have overlap
+    // if the types are identical and if the type is not -1 (an unknown type)
+    return (input_delay <= connections[port].second->get_output_delay()) && (direct_filters[port] != nullptr);
+  }
+
+  template<typename DataType_, typename DataType__>
+  bool TypedBaseFilter<DataType_, DataType__>::can_use_input_array(gsl::index port) const
+  {
+    return direct_filters[port] != nullptr;
+  }
+
+  template<typename DataType_, typename DataType__>
+  gsl::index TypedBaseFilter<DataType_, DataType__>::get_aliased_input(gsl::index output_port) const
+  {
+    if constexpr(std::is_same<DataType_, DataType__>::value)
     {
-      // if the input delay is smaller than the preceding filter output delay, we may have overlap
-      // if the types are identical and if the type is not -1 (an unknown type)
-      // if we have overlap, don't copy anything at all
-      if((input_delay <= connections[i].second->get_output_delay()) && (direct_filters[i] != nullptr))
+      auto port = this->get_in_place_input(output_port);
+      // Without delays, the input and the output can share the same history-free buffer
+      if(port < 0 || input_delay != 0 || this->get_output_delay() != 0 || external_outputs[output_port].first != nullptr || connections[port].second == nullptr)
       {
-        converted_inputs[i] = direct_filters[i]->get_output_array(connections[i].first);
-        converted_inputs_size[i] = size;
-        converted_in_delays[i] = input_delay;
-        continue;
+        return -1;
+      }
+      // The output array of the connected filter can only be overwritten if nobody else reads it, the filter included
+      if(is_direct_input(port) && (!this->is_exclusive_input(port) || connections[port].second->get_output_delay() != 0))
+      {
+        return -1;
+      }
+      return port;
+    }
+    else
+    {
+      return -1;
+    }
+  }
+
+  template<typename DataType_, typename DataType__>
+  void TypedBaseFilter<DataType_, DataType__>::allocate_input(gsl::index port, gsl::index size)
+  {
+    auto input_size = converted_inputs_size[port];
+    auto in_delay = converted_in_delays[port];
+    if(external_inputs[port].first != nullptr)
+    {
+      if(external_inputs[port].second < input_delay + size)
+      {
+        throw RuntimeError("External input buffer is too small for this block size");
       }
-      auto input_size = converted_inputs_size[i];
-      auto in_delay = converted_in_delays[i];
-      if(input_size < size || in_delay < input_delay)
+      auto buffer = external_inputs[port].first;
+      if(input_size == 0)
       {
-        // TODO Properly align the beginning of the data, not depending on input delay
-        AlignedVector temp(input_delay + size, TypeTraits<DataTypeInput>::Zero());
-        if(input_size == 0)
+        for(gsl::index j = 0; j < input_delay; ++j)
         {
-          for(unsigned int j = 0; j < input_delay; ++j)
-          {
-            temp[j] = default_input[i];
-          }
+          buffer[j] = default_input[port];
         }
-        else
+      }
+      else
+      {
+        // The history is moved towards the beginning of the same buffer
+        const auto input_ptr = converted_inputs[port];
+        for(gsl::index j = 0; j < in_delay; ++j)
+        {
+          buffer[j] = input_ptr[last_input_size + j - in_delay];
+        }
+      }
+      converted_inputs[port] = buffer + input_delay;
+      converted_inputs_size[port] = external_inputs[port].second - input_delay;
+    }
+    else
+    {
+      // Allocate for the largest block so that smaller blocks don't trigger a new allocation
+      if(output_sampling_rate != 0)
+      {
+        size = std::max(size, get_max_input_size(max_block_size));
+      }
+      // TODO Properly align the beginning of the data, not depending on input delay
+      AlignedVector temp(input_delay + size, TypeTraits<DataTypeInput>::Zero());
+      if(input_size == 0)
+      {
+        for(unsigned int j = 0; j < input_delay; ++j)
+        {
+          temp[j] = default_input[port];
+        }
+      }
+      else
+      {
+        const auto input_ptr = converted_inputs[port];
+        for(gsl::index j = 0; j < in_delay; ++j)
+        {
+          temp[j] = input_ptr[last_input_size + j - in_delay];
+        }
+      }
+
+      converted_inputs_delay[port] = std::move(temp);
+      converted_inputs[port] = converted_inputs_delay[port].data() + input_delay;
+      converted_inputs_size[port] = size;
+    }
+    converted_in_delays[port] = input_delay;
+  }
+
+  template<typename DataType_, typename DataType__>
+  void TypedBaseFilter<DataType_, DataType__>::allocate_output(gsl::index port, gsl::index size)
+  {
+    auto output_size = outputs_size[port];
+    auto out_delay = out_delays[port];
+    // The history kept for the readers of the output array may be longer than output_delay
+    auto history_size = this->get_output_delay();
+    if(external_outputs[port].first != nullptr)
+    {
+      if(external_outputs[port].second < history_size + size)
+      {
+        throw RuntimeError("External output buffer is too small for this block size");
+      }
+      auto buffer = external_outputs[port].first;
+      if(output_size == 0)
+      {
+        for(gsl::index j = 0; j < history_size; ++j)
+        {
+          buffer[j] = default_output[port];
+        }
+      }
+      else
+      {
+        // The history is moved towards the beginning of the same buffer
+        const auto output_ptr = outputs[port];
+        for(gsl::index j = 0; j < out_delay; ++j)
+        {
+          buffer[j] = output_ptr[last_size + j - out_delay];
+        }
+      }
+      outputs[port] = buffer + history_size;
+      outputs_size[port] = external_outputs[port].second - history_size;
+    }
+    else
+    {
+      // Allocate for the largest block so that smaller blocks don't trigger a new allocation
+      size = std::max(size, max_block_size);
+      // TODO Properly align the beginning of the data, not depending on output delay
+      AlignedOutVector temp(history_size + size, TypeTraits<DataTypeOutput>::Zero());
+      if(output_size == 0)
+      {
+        for(gsl::index j = 0; j < history_size; ++j)
+        {
+          temp[j] = default_output[port];
+        }
+      }
+      else
+      {
+        const auto output_ptr = outputs[port];
+        for(gsl::index j = 0; j < static_cast<int>(out_delay); ++j)
         {
-          const auto input_ptr = converted_inputs[i];
-          for(gsl::index j = 0; j < in_delay; ++j)
-          {
-            temp[j] = input_ptr[last_size + j - in_delay];
-          }
+          temp[j] = output_ptr[last_size + j - out_delay];
         }
+      }
+
+      outputs_delay[port] = std::move(temp);
+      outputs[port] = outputs_delay[port].data() + history_size;
+      outputs_size[port] = size;
+    }
+    out_delays[port] = history_size;
+  }
 
-        converted_inputs_delay[i] = std::move(temp);
-        converted_inputs[i] = converted_inputs_delay[i].data() + input_delay;
+  template<typename DataType_, typename DataType__>
+  void TypedBaseFilter<DataType_, DataType__>::convert_inputs(gsl::index size)
+  {
+    for(gsl::index i = 0; i < nb_input_ports; ++i)
+    {
+      // if we have overlap, don't copy anything at all
+      if(is_direct_input(i))
+      {
+        converted_inputs[i] = direct_filters[i]->get_output_array(connections[i].first);
         converted_inputs_size[i] = size;
         converted_in_delays[i] = input_delay;
+        continue;
+      }
+      if(converted_inputs_size[i] < size || converted_in_delays[i] < input_delay)
+      {
+        allocate_input(i, size);
       }
       else
       {
-        auto my_last_size = static_cast<int64_t>(last_size) * input_sampling_rate / output_sampling_rate;
         const auto input_ptr = converted_inputs[i];
         for(gsl::index j = 0; j < input_delay; ++j)
         {
-          input_ptr[j - input_delay] = input_ptr[my_last_size + j - input_delay];
+          input_ptr[j - input_delay] = input_ptr[last_input_size + j - input_delay];
         }
       }
       Utilities::convert_array<Utilities::ConversionTypes, DataTypeInput>(connections[i].second, connections[i].first, converted_inputs[i], size, connections[i].second->get_type());
+      converted_bytes += size * static_cast<gsl::index>(sizeof(DataTypeInput));
     }
   }
 
   template<typename DataType_, typename DataType__>
   void TypedBaseFilter<DataType_, DataType__>::prepare_outputs(gsl::index size)
   {
+    auto history_size = this->get_output_delay();
     for(gsl::index i = 0; i < nb_output_ports; ++i)
     {
-      auto output_size = outputs_size[i];
-      auto out_delay = out_delays[i];
-      if(output_size < size || out_delay < output_delay)
+      if constexpr(std::is_same<DataType_, DataType__>::value)
       {
-        // TODO Properly align the beginning of the data, not depending on output delay
-        AlignedOutVector temp(output_delay + size, TypeTraits<DataTypeOutput>::Zero());
-        if(output_size == 0)
-        {
-          for(gsl::index j = 0; j < output_delay; ++j)
-          {
-            temp[j] = default_output[i];
-          }
-        }
-        else
+        auto input_port = get_aliased_input(i);
+        if(input_port >= 0)
         {
-          const auto output_ptr = outputs[i];
-          for(gsl::index j = 0; j < static_cast<int>(out_delay); ++j)
-          {
-            temp[j] = output_ptr[last_size + j - out_delay];
-          }
+          // The output is computed in place in the input array
+          outputs[i] = converted_inputs[input_port];
+          outputs_size[i] = converted_inputs_size[input_port];
+          out_delays[i] = 0;
+          aliased_outputs[i] = true;
+          continue;
         }
-
-        outputs_delay[i] = std::move(temp);
-        outputs[i] = outputs_delay[i].data() + output_delay;
-        outputs_size[i] = size;
-        out_delays[i] = output_delay;
+      }
+      if(aliased_outputs[i])
+      {
+        // The output needs its own buffer again
+        aliased_outputs[i] = false;
+        outputs_size[i] = 0;
+      }
+      if(outputs_size[i] < size || out_delays[i] < history_size)
+      {
+        allocate_output(i, size);
       }
       else
       {
         const auto output_ptr = outputs[i];
-        for(gsl::index j = 0; j < static_cast<int>(output_delay); ++j)
+        for(gsl::index j = 0; j < static_cast<int>(history_size); ++j)
         {
-          output_ptr[j - output_delay] = output_ptr[last_size + j - output_delay];
+          output_ptr[j - history_size] = output_ptr[last_size + j - history_size];
         }
       }
     }
   }
 
+  template<typename DataType_, typename DataType__>
+  void TypedBaseFilter<DataType_, DataType__>::preallocate(gsl::index size)
+  {
+    Parent::preallocate(size);
+    auto input_size = get_max_input_size(size);
+    bool needed = false;
+    for(gsl::index i = 0; i < nb_input_ports; ++i)
+    {
+      if(connections[i].second != nullptr && !is_direct_input(i))
+      {
+        needed |= converted_inputs_size[i] < input_size || converted_in_delays[i] < input_delay;
+      }
+    }
+    for(gsl::index i = 0; i < nb_output_ports; ++i)
+    {
+      if(get_aliased_input(i) < 0)
+      {
+        needed |= outputs_size[i] < size || out_delays[i] < this->get_output_delay();
+      }
+    }
+    if(!needed)
+    {
+      return;
+    }
+    // All the buffers are moved so that the history is just before the beginning of the next block
+    for(gsl::index i = 0; i < nb_input_ports; ++i)
+    {
+      if(connections[i].second != nullptr && !is_direct_input(i))
+      {
+        allocate_input(i, input_size);
+      }
+    }
+    for(gsl::index i = 0; i < nb_output_ports; ++i)
+    {
+      if(get_aliased_input(i) < 0)
+      {
+        allocate_output(i, size);
+      }
+    }
+    // and there is nothing to shift before the next block
+    last_size = 0;
+    last_input_size = 0;
+  }
+
+  template<typename DataType_, typename DataType__>
+  gsl::index TypedBaseFilter<DataType_, DataType__>::get_input_buffer_size(gsl::index port, gsl::index size) const
+  {
+    if(connections[port].second == nullptr)
+    {
+      return 0;
+    }
+    if((input_delay <= connections[port].second->get_output_delay()) && (direct_filters[port] != nullptr))
+    {
+      return 0;
+    }
+    return (input_delay + size) * static_cast<gsl::index>(sizeof(DataTypeInput));
+  }
+
+  template<typename DataType_, typename DataType__>
+  gsl::index TypedBaseFilter<DataType_, DataType__>::get_output_buffer_size(gsl::index port, gsl::index size) const
+  {
+    if(get_aliased_input(port) >= 0)
+    {
+      return 0;
+    }
+    return (this->get_output_delay() + size) * static_cast<gsl::index>(sizeof(DataTypeOutput));
+  }
+
+  template<typename DataType_, typename DataType__>
+  void TypedBaseFilter<DataType_, DataType__>::set_input_buffer(gsl::index port, void* buffer, gsl::index bytes)
+  {
+    external_inputs[port] = std::make_pair(static_cast<DataTypeInput*>(buffer), bytes / static_cast<gsl::index>(sizeof(DataTypeInput)));
+    converted_inputs_delay[port] = AlignedVector();
+    converted_inputs[port] = nullptr;
+    converted_inputs_size[port] = 0;
+    converted_in_delays[port] = 0;
+  }
+
+  template<typename DataType_, typename DataType__>
+  void TypedBaseFilter<DataType_, DataType__>::set_output_buffer(gsl::index port, void* buffer, gsl::index bytes)
+  {
+    external_outputs[port] = std::make_pair(static_cast<DataTypeOutput*>(buffer), bytes / static_cast<gsl::index>(sizeof(DataTypeOutput)));
+    outputs_delay[port] = AlignedOutVector();
+    outputs[port] = nullptr;
+    outputs_size[port] = 0;
+    out_delays[port] = 0;
+  }
+
   template<typename DataType_, typename DataType__>
   void TypedBaseFilter<DataType_, DataType__>::full_setup()
   {
@@ -281,8 +509,13 @@ namespace Utilities
     outputs.assign(nb_output_ports, nullptr);
     outputs_size.assign(nb_output_ports, 0);
     out_delays.assign(nb_output_ports, 0);
+    aliased_outputs.reset();
 
     Parent::full_setup();
+    if(max_block_size > 0)
+    {
+      preallocate(max_block_size);
+    }
   }
   
   template<typename DataType_, typename DataType__>
@@ -5,6 +5,7 @@
 #ifndef ATK_DELAY_FEEDBACKDELAYNETWORKFILTER_H
 #define ATK_DELAY_FEEDBACKDELAYNETWORKFILTER_H
 
+#include <ATK/Core/TypeTraits.h>
 #include <ATK/Core/TypedBaseFilter.h>
 #include <ATK/Delay/config.h>
 
@@ -14,18 +15,25 @@
 namespace ATK
 {
   /// A FDN class with custom mixture matrix
+  /*!
+   * The network is processed by blocks as long as the shortest delay, so that the delay lines are read and written with
+   * contiguous accesses and the mixture is applied on whole blocks. Each line can have a fractional delay modulated by a
+   * sine and a one pole damping filter.
+   */
   template<typename Mixture>
   class ATK_DELAY_EXPORT FeedbackDelayNetworkFilter final : public TypedBaseFilter<typename Mixture::DataType>
   {
     class HFDN_Impl;
   protected:
     using DataType = typename Mixture::DataType;
+    using Scalar = typename TypeTraits<DataType>::Scalar;
     using Parent = TypedBaseFilter<DataType>;
     using Parent::converted_inputs;
     using Parent::outputs;
     using Parent::nb_input_ports;
     using Parent::nb_output_ports;
     using Parent::output_delay;
+    using Parent::input_sampling_rate;
 
     static constexpr auto nb_channels = Mixture::nb_channels;
 
@@ -40,9 +48,29 @@ namespace ATK
 
     /// Set the initial delay from a channel
     void set_delay(unsigned int channel, gsl::index delay);
-    /// Gets the initial delay from a channel
+    /// Gets the initial delay from a channel, rounded down
     gsl::index get_delay(unsigned int channel) const;
 
+    /// Set the delay from a channel, linearly interpolated if it is not an integer
+    void set_fractional_delay(unsigned int channel, Scalar delay);
+    /// Gets the delay from a channel
+    Scalar get_fractional_delay(unsigned int channel) const;
+
+    /// Sets the depth of the sine modulation of the delay of a channel, in samples
+    void set_modulation_depth(unsigned int channel, Scalar depth);
+    /// Gets the depth of the modulation of the delay of a channel
+    Scalar get_modulation_depth(unsigned int channel) const;
+
+    /// Sets the frequency of the sine modulation of the delay of a channel, in Hz
+    void set_modulation_frequency(unsigned int channel, Scalar frequency);
+    /// Gets the frequency of the modulation of the delay of a channel
+    Scalar get_modulation_frequency(unsigned int channel) const;
+
+    /// Sets the pole of the damping filter of a channel (between 0 and 1, 0 disables damping)
+    void set_damping(unsigned int channel, Scalar damping);
+    /// Gets the pole of the damping filter of a channel
+    Scalar get_damping(unsigned int channel) const;
+
     /// Sets the input gain of a channel (between -1 and 1)
     void set_ingain(unsigned int channel, DataType ingain);
     /// Gets the input gain of a channel
@@ -60,12 +88,21 @@ namespace ATK
 
     void full_setup() final;
   protected:
+    void setup() final;
+    void preallocate(gsl::index size) final;
     void process_impl(gsl::index size) const final;
 
   private:
+    /// Checks that a modulated delay stays in the delay line
+    void check_delay(Scalar delay, Scalar depth) const;
+    /// Returns the number of samples that can be processed without reading samples of the same block
+    gsl::index get_max_network_block_size() const;
+
     // internal state
     std::unique_ptr<HFDN_Impl> impl;
-    std::array<gsl::index, nb_channels> delay;
+    std::array<Scalar, nb_channels> delay;
+    std::array<Scalar, nb_channels> modulation_depth;
+    std::array<Scalar, nb_channels> modulation_frequency;
     /// Max delay for the delay line
     gsl::index max_delay{0};
   };
@@ -8,8 +8,11 @@
 #include <ATK/Delay/FeedbackDelayNetworkFilter.h>
 #include <ATK/Core/Utilities.h>
 
-#include <Eigen/Dense>
+#include <boost/align/aligned_allocator.hpp>
+#include <boost/math/constants/constants.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <complex>
 
 namespace ATK
@@ -18,19 +21,59 @@ namespace ATK
   class FeedbackDelayNetworkFilter<Mixture>::HFDN_Impl: public Mixture::MixtureImpl
   {
   public:
-    using Vector =  typename Mixture::MixtureImpl::Vector;
-    using Matrix =  typename Mixture::MixtureImpl::Matrix;
+    using AlignedVector = std::vector<DataType, boost::alignment::aligned_allocator<DataType, 32>>;
 
-    std::vector<Vector, boost::alignment::aligned_allocator<Vector, 32>> delay_line;
-    std::vector<Vector, boost::alignment::aligned_allocator<Vector, 32>> processed_input;
-    int64_t index{0};
-    Vector ingain = Vector::Zero();
-    Vector outgain = Vector::Zero();
-    Vector feedback = Vector::Zero();
+    /// The delay lines, one after the other
+    AlignedVector lines;
+    /// The delayed samples of a block, one channel after the other
+    AlignedVector block;
+    /// Number of samples of each channel in block
+    gsl::index block_stride{0};
+    gsl::index index{0};
+    std::array<DataType, nb_channels> ingain;
+    std::array<DataType, nb_channels> outgain;
+    std::array<DataType, nb_channels> feedback;
+    std::array<Scalar, nb_channels> damping;
+    std::array<DataType, nb_channels> damping_state;
+    /// Quadrature oscillators modulating the delays
+    std::array<Scalar, nb_channels> sine;
+    std::array<Scalar, nb_channels> cosine;
+    std::array<Scalar, nb_channels> rotation_sine;
+    std::array<Scalar, nb_channels> rotation_cosine;
 
     explicit HFDN_Impl(gsl::index max_delay)
-      :processed_input(max_delay, Vector::Zero())
+      :lines(nb_channels * max_delay, TypeTraits<DataType>::Zero())
     {
+      ingain.fill(TypeTraits<DataType>::Zero());
+      outgain.fill(TypeTraits<DataType>::Zero());
+      feedback.fill(TypeTraits<DataType>::Zero());
+      damping.fill(0);
+      rotation_sine.fill(0);
+      rotation_cosine.fill(1);
+      reset();
+    }
+
+    void reset()
+    {
+      std::fill(lines.begin(), lines.end(), TypeTraits<DataType>::Zero());
+      damping_state.fill(TypeTraits<DataType>::Zero());
+      index = 0;
+      // The phases of the modulations are spread so that the lines are not modulated together
+      for(gsl::index channel = 0; channel < nb_channels; ++channel)
+      {
+        auto phase = 2 * boost::math::constants::pi<Scalar>() * channel / nb_channels;
+        sine[channel] = std::sin(phase);
+        cosine[channel] = std::cos(phase);
+      }
+    }
+
+    void resize_block(gsl::index size)
+    {
+      if(block_stride < size)
+      {
+        block_stride = size;
+        block.assign(nb_channels * size, TypeTraits<DataType>::Zero());
+      }
     }
   };
 
@@ -38,7 +81,9 @@ namespace ATK
   FeedbackDelayNetworkFilter<Mixture>::FeedbackDelayNetworkFilter(gsl::index max_delay)
     :Parent(1, 2), impl(std::make_unique<HFDN_Impl>(max_delay)), max_delay(max_delay)
   {
-    delay.fill(max_delay - 1);
+    delay.fill(static_cast<Scalar>(max_delay - 1));
+    modulation_depth.fill(0);
+    modulation_frequency.fill(0);
   }
 
   template<typename Mixture>
@@ -47,36 +92,103 @@ namespace ATK
   }
 
   template<typename Mixture>
-  void FeedbackDelayNetworkFilter<Mixture>::set_delay(unsigned int channel, gsl::index delay)
+  void FeedbackDelayNetworkFilter<Mixture>::check_delay(Scalar delay, Scalar depth) const
   {
-    if (delay == 0)
+    if (delay - depth < 1)
     {
-      throw ATK::RuntimeError("Delay must be strictly positive");
+      throw ATK::RuntimeError("Delay must be strictly positive, and one sample longer than the modulation depth");
     }
-    if (delay >= max_delay)
+    if (delay + depth + 1 > max_delay)
     {
       throw ATK::RuntimeError("Delay must be less than delay line size");
     }
+  }
 
-    this->delay[channel] = delay;
+  template<typename Mixture>
+  void FeedbackDelayNetworkFilter<Mixture>::set_delay(unsigned int channel, gsl::index delay)
+  {
+    set_fractional_delay(channel, static_cast<Scalar>(delay));
   }
 
   template<typename Mixture>
   gsl::index FeedbackDelayNetworkFilter<Mixture>::get_delay(unsigned int channel) const
+  {
+    return static_cast<gsl::index>(delay[channel]);
+  }
+
+  template<typename Mixture>
+  void FeedbackDelayNetworkFilter<Mixture>::set_fractional_delay(unsigned int channel, Scalar delay)
+  {
+    check_delay(delay, modulation_depth[channel]);
+    this->delay[channel] = delay;
+  }
+
+  template<typename Mixture>
+  auto FeedbackDelayNetworkFilter<Mixture>::get_fractional_delay(unsigned int channel) const -> Scalar
   {
     return delay[channel];
   }
 
+  template<typename Mixture>
+  void FeedbackDelayNetworkFilter<Mixture>::set_modulation_depth(unsigned int channel, Scalar depth)
+  {
+    if (depth < 0)
+    {
+      throw ATK::RuntimeError("Modulation depth must be positive");
+    }
+    check_delay(delay[channel], depth);
+    modulation_depth[channel] = depth;
+  }
+
+  template<typename Mixture>
+  auto FeedbackDelayNetworkFilter<Mixture>::get_modulation_depth(unsigned int channel) const -> Scalar
+  {
+    return modulation_depth[channel];
+  }
+
+  template<typename Mixture>
+  void FeedbackDelayNetworkFilter<Mixture>::set_modulation_frequency(unsigned int channel, Scalar frequency)
+  {
+    if (frequency < 0)
+    {
+      throw ATK::RuntimeError("Modulation frequency must be positive");
+    }
+    modulation_frequency[channel] = frequency;
+    setup();
+  }
+
+  template<typename Mixture>
+  auto FeedbackDelayNetworkFilter<Mixture>::get_modulation_frequency(unsigned int channel) const -> Scalar
+  {
+    return modulation_frequency[channel];
+  }
+
+  template<typename Mixture>
+  void FeedbackDelayNetworkFilter<Mixture>::set_damping(unsigned int channel, Scalar damping)
+  {
+    if (damping < 0 || damping >= 1)
+    {
+      throw ATK::RuntimeError("Damping must be between 0 and 1");
+    }
+    impl->damping[channel] = damping;
+  }
+
+  template<typename Mixture>
+  auto FeedbackDelayNetworkFilter<Mixture>::get_damping(unsigned int channel) const -> Scalar
+  {
+    return impl->damping[channel];
+  }
+
   template<typename Mixture>
   void FeedbackDelayNetworkFilter<Mixture>::set_ingain(unsigned int channel, DataType ingain)
   {
-    impl->ingain(channel) = ingain;
+    impl->ingain[channel] = ingain;
   }
 
   template<typename Mixture>
   typename FeedbackDelayNetworkFilter<Mixture>::DataType FeedbackDelayNetworkFilter<Mixture>::get_ingain(unsigned int channel) const
   {
-    return impl->ingain(channel);
+    return impl->ingain[channel];
   }
 
   template<typename Mixture>
@@ -86,32 +198,64 @@ namespace ATK
     {
       throw ATK::RuntimeError("Feedback must be between " + std::to_string(-Mixture::gain_factor) + " and " + std::to_string(Mixture::gain_factor) + " to avoid divergence");
     }
-    impl->feedback(channel) = feedback * static_cast<DataType>(Mixture::gain_factor);
+    impl->feedback[channel] = feedback * static_cast<DataType>(Mixture::gain_factor);
   }
 
   template<typename Mixture>
   typename FeedbackDelayNetworkFilter<Mixture>::DataType FeedbackDelayNetworkFilter<Mixture>::get_feedback(unsigned int channel) const
   {
-    return impl->feedback(channel) / static_cast<DataType>(Mixture::gain_factor);
+    return impl->feedback[channel] / static_cast<DataType>(Mixture::gain_factor);
   }
 
   template<typename Mixture>
   void FeedbackDelayNetworkFilter<Mixture>::set_outgain(unsigned int channel, DataType outgain)
   {
-    impl->outgain(channel) = outgain;
+    impl->outgain[channel] = outgain;
   }
 
   template<typename Mixture>
   typename FeedbackDelayNetworkFilter<Mixture>::DataType FeedbackDelayNetworkFilter<Mixture>::get_outgain(unsigned int channel) const
   {
-    return impl->outgain(channel);
+    return impl->outgain[channel];
   }
 
   template<typename Mixture>
   void FeedbackDelayNetworkFilter<Mixture>::full_setup()
   {
     // reset the delay line
-    impl->processed_input.assign(max_delay, HFDN_Impl::Vector::Zero());
+    impl->reset();
+    Parent::full_setup();
+  }
+
+  template<typename Mixture>
+  void FeedbackDelayNetworkFilter<Mixture>::setup()
+  {
+    Parent::setup();
+    for(gsl::index channel = 0; channel < nb_channels; ++channel)
+    {
+      auto increment = input_sampling_rate == 0 ? 0 : 2 * boost::math::constants::pi<Scalar>() * modulation_frequency[channel] / input_sampling_rate;
+      impl->rotation_sine[channel] = std::sin(increment);
+      impl->rotation_cosine[channel] = std::cos(increment);
+    }
+  }
+
+  template<typename Mixture>
+  void FeedbackDelayNetworkFilter<Mixture>::preallocate(gsl::index size)
+  {
+    Parent::preallocate(size);
+    impl->resize_block(std::min(size, get_max_network_block_size()));
+  }
+
+  template<typename Mixture>
+  gsl::index FeedbackDelayNetworkFilter<Mixture>::get_max_network_block_size() const
+  {
+    // A block can't read samples that are written by the same block
+    gsl::index size = max_delay;
+    for(gsl::index channel = 0; channel < nb_channels; ++channel)
+    {
+      size = std::min(size, static_cast<gsl::index>(delay[channel] - modulation_depth[channel]));
+    }
+    return size;
   }
 
   template<typename Mixture>
@@ -120,29 +264,115 @@ namespace ATK
     const DataType* ATK_RESTRICT input = converted_inputs[0];
     DataType* ATK_RESTRICT output = outputs[0];
 
-    impl->delay_line.resize(size);
+    auto max_block_size = get_max_network_block_size();
+    impl->resize_block(std::min(size, max_block_size));
+    auto stride = impl->block_stride;
+    auto scale = impl->get_scale();
 
-    for (gsl::index i = 0; i < size; ++i)
+    for(gsl::index processed = 0; processed < size; )
     {
-      for (gsl::index channel = 0; channel < nb_channels; ++channel)
+      auto block_size = std::min(size - processed, max_block_size);
+      auto index = impl->index;
+      // Number of samples before the write index wraps
+      auto first_size = std::min(block_size, max_delay - index);
+
+      for(gsl::index channel = 0; channel < nb_channels; ++channel)
       {
-        auto j = impl->index - static_cast<int64_t>(delay[channel]);
-        if (j < 0)
+        const DataType* ATK_RESTRICT line = impl->lines.data() + channel * max_delay;
+        DataType* ATK_RESTRICT delayed = impl->block.data() + channel * stride;
+
+        if(modulation_depth[channel] == 0 && delay[channel] == std::floor(delay[channel]))
+        {
+          auto start = index - static_cast<gsl::index>(delay[channel]);
+          if(start < 0)
+          {
+            start += max_delay;
+          }
+          auto read_size = std::min(block_size, max_delay - start);
+          std::copy(line + start, line + start + read_size, delayed);
+          std::copy(line, line + block_size - read_size, delayed + read_size);
+        }
+        else
         {
-          j += max_delay;
+          auto depth = modulation_depth[channel];
+          auto sine = impl->sine[channel];
+          auto cosine = impl->cosine[channel];
+          auto rotation_sine = impl->rotation_sine[channel];
+          auto rotation_cosine = impl->rotation_cosine[channel];
+          for(gsl::index i = 0; i < block_size; ++i)
+          {
+            auto current_delay = delay[channel] + depth * sine;
+            auto integer_delay = static_cast<gsl::index>(current_delay);
+            auto fraction = current_delay - integer_delay;
+            auto j = index + i - integer_delay;
+            if(j < 0)
+            {
+              j += max_delay;
+            }
+            auto k = j == 0 ? max_delay - 1 : j - 1;
+            delayed[i] = line[j] + fraction * (line[k] - line[j]);
+
+            auto new_sine = sine * rotation_cosine + cosine * rotation_sine;
+            cosine = cosine * rotation_cosine - sine * rotation_sine;
+            sine = new_sine;
+          }
+          // Keeps the oscillator on the unit circle
+          auto norm = 1 / std::sqrt(sine * sine + cosine * cosine);
+          impl->sine[channel] = sine * norm;
+          impl->cosine[channel] = cosine * norm;
         }
 
-        impl->delay_line[i](channel) = impl->processed_input[j](channel);
+        auto damping = impl->damping[channel];
+        if(damping != 0)
+        {
+          auto state = impl->damping_state[channel];
+          for(gsl::index i = 0; i < block_size; ++i)
+          {
+            state = (1 - damping) * delayed[i] + damping * state;
+            delayed[i] = state;
+          }
+          impl->damping_state[channel] = state;
+        }
       }
-      impl->processed_input[impl->index] = (impl->ingain * input[i]).array() + impl->mix(impl->delay_line[i]).array() * impl->feedback.array();
 
-      output[i] = impl->outgain.dot(impl->delay_line[i]);
+      for(gsl::index i = 0; i < block_size; ++i)
+      {
+        output[processed + i] = TypeTraits<DataType>::Zero();
+      }
+      for(gsl::index channel = 0; channel < nb_channels; ++channel)
+      {
+        const DataType* ATK_RESTRICT delayed = impl->block.data() + channel * stride;
+        auto outgain = impl->outgain[channel];
+        for(gsl::index i = 0; i < block_size; ++i)
+        {
+          output[processed + i] += outgain * delayed[i];
+        }
+      }
+
+      impl->mix(impl->block.data(), stride, block_size);
+
+      for(gsl::index channel = 0; channel < nb_channels; ++channel)
+      {
+        DataType* ATK_RESTRICT line = impl->lines.data() + channel * max_delay;
+        const DataType* ATK_RESTRICT mixed = impl->block.data() + channel * stride;
+        auto ingain = impl->ingain[channel];
+        auto feedback = impl->feedback[channel] * scale;
+        for(gsl::index i = 0; i < first_size; ++i)
+        {
+          line[index + i] = ingain * input[processed + i] + feedback * mixed[i];
+        }
+        for(gsl::index i = first_size; i < block_size; ++i)
+        {
+          line[index + i - max_delay] = ingain * input[processed + i] + feedback * mixed[i];
+        }
+      }
 
-      ++impl->index;
-      if(impl->index == max_delay)
+      impl->index = index + block_size;
+      if(impl->index >= max_delay)
       {
-        impl->index = 0;
+        impl->index -= max_delay;
       }
+      processed += block_size;
     }
   }
 }
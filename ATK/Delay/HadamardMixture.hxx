@@ -6,9 +6,8 @@
 #include <ATK/Delay/FeedbackDelayNetworkFilter.hxx>
 
 #include <ATK/Core/TypeTraits.h>
-#include <ATK/Utility/fmath.h>
 
-#include <Eigen/Dense>
+#include <cmath>
 
 namespace ATK
 {
@@ -16,42 +15,41 @@ namespace ATK
   class HadamardMixture<DataType_, order>::MixtureImpl
   {
   public:
-    using Vector = Eigen::Matrix<DataType, nb_channels, 1>;
-    using Matrix = Eigen::Matrix<DataType, nb_channels, nb_channels>;
+    using Scalar = typename TypeTraits<DataType_>::Scalar;
 
-    Vector mix(const Vector& x) const
+    /*!
+     * @brief Mixes a block of samples in place with a fast Walsh-Hadamard transform, without the normalization
+     * @param lines is the block, one channel after the other
+     * @param stride is the number of samples between two channels
+     * @param size is the number of samples to mix
+     */
+    static void mix(DataType_* ATK_RESTRICT lines, gsl::index stride, gsl::index size)
     {
-      return transition * x;
+      // Iterative form of the recursive matrix [[H, H], [-H, H]], the largest butterflies first
+      for(gsl::index half = nb_channels / 2; half > 0; half /= 2)
+      {
+        for(gsl::index first = 0; first < nb_channels; first += 2 * half)
+        {
+          for(gsl::index channel = first; channel < first + half; ++channel)
+          {
+            DataType_* ATK_RESTRICT top = lines + channel * stride;
+            DataType_* ATK_RESTRICT bottom = top + half * stride;
+            for(gsl::index i = 0; i < size; ++i)
+            {
+              auto a = top[i];
+              auto b = bottom[i];
+              top[i] = a + b;
+              bottom[i] = b - a;
+            }
+          }
+        }
+      }
     }
 
-  protected:
-    const Matrix transition = create();
-    
-    static Matrix create()
-    {
-      return (DataType_(1 / fmath::pow(2, order / 2.)) * recursive_create<order>()).template cast<DataType_>();
-    }
-    
-    template<unsigned int recursive_order>
-    static Eigen::Matrix<typename TypeTraits<DataType_>::Scalar, (1U<<recursive_order), (1U<<recursive_order)> recursive_create()
+    /// Normalization of the mixture, applied with the feedback
+    static Scalar get_scale()
     {
-      if constexpr(recursive_order == 0)
-      {
-        return Eigen::Matrix<typename TypeTraits<DataType_>::Scalar, 1U, 1U>::Constant(1);
-      }
-      else
-      {
-        constexpr auto big_size = (1U << recursive_order);
-        constexpr auto small_size = (1U << (recursive_order - 1));
-        Eigen::Matrix<typename TypeTraits<DataType_>::Scalar, big_size, big_size> cur_transition;
-        
-        auto M_1 = recursive_create<recursive_order - 1>();
-        cur_transition.block(0, 0, small_size, small_size) = M_1;
-        cur_transition.block(0, small_size, small_size, small_size) = M_1;
-        cur_transition.block(small_size, 0, small_size, small_size) = -M_1;
-        cur_transition.block(small_size, small_size, small_size, small_size) = M_1;
-        return cur_transition;
-      }
+      return static_cast<Scalar>(1 / std::pow(2., order / 2.));
     }
   };
 }
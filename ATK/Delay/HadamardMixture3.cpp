@@ -0,0 +1,19 @@
+/**
+ * \file HadamardMixture3.cpp
+ */
+
+#include "HadamardMixture.hxx"
+
+#include <complex>
+
+namespace ATK
+{
+  template class FeedbackDelayNetworkFilter<HadamardMixture<double, 4>>;
+  template class FeedbackDelayNetworkFilter<HadamardMixture<double, 5>>;
+  template class FeedbackDelayNetworkFilter<HadamardMixture<double, 6>>;
+#if ATK_ENABLE_INSTANTIATION
+  template class FeedbackDelayNetworkFilter<HadamardMixture<float, 4>>;
+  template class FeedbackDelayNetworkFilter<HadamardMixture<float, 5>>;
+  template class FeedbackDelayNetworkFilter<HadamardMixture<float, 6>>;
+#endif
+}
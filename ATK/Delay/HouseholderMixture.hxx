@@ -5,7 +5,9 @@
 #include "HouseholderMixture.h"
 #include <ATK/Delay/FeedbackDelayNetworkFilter.hxx>
 
-#include <Eigen/Dense>
+#include <ATK/Core/TypeTraits.h>
+
+#include <algorithm>
 
 namespace ATK
 {
@@ -13,20 +15,47 @@ namespace ATK
   class HouseholderMixture<DataType_, nb_channels>::MixtureImpl
   {
   public:
-    using Vector = Eigen::Matrix<DataType, nb_channels, 1>;
-    using Matrix = Eigen::Matrix<DataType, nb_channels, nb_channels>;
+    using Scalar = typename TypeTraits<DataType_>::Scalar;
 
-    Vector mix(const Vector& x) const
+    /*!
+     * @brief Mixes a block of samples in place with the rank one update x - 2/N sum(x)
+     * @param lines is the block, one channel after the other
+     * @param stride is the number of samples between two channels
+     * @param size is the number of samples to mix
+     */
+    static void mix(DataType_* ATK_RESTRICT lines, gsl::index stride, gsl::index size)
     {
-      return transition * x;
+      constexpr gsl::index chunk_size = 64;
+      const auto factor = static_cast<Scalar>(2) / nb_channels;
+      // The sums are computed by chunks so that they stay in the cache
+      for(gsl::index start = 0; start < size; start += chunk_size)
+      {
+        auto current_size = std::min(chunk_size, size - start);
+        DataType_ sum[chunk_size];
+        std::fill(sum, sum + current_size, TypeTraits<DataType_>::Zero());
+        for(gsl::index channel = 0; channel < nb_channels; ++channel)
+        {
+          const DataType_* ATK_RESTRICT line = lines + channel * stride + start;
+          for(gsl::index i = 0; i < current_size; ++i)
+          {
+            sum[i] += line[i];
+          }
+        }
+        for(gsl::index channel = 0; channel < nb_channels; ++channel)
+        {
+          DataType_* ATK_RESTRICT line = lines + channel * stride + start;
+          for(gsl::index i = 0; i < current_size; ++i)
+          {
+            line[i] -= factor * sum[i];
+          }
+        }
+      }
     }
 
-  protected:
-    const Matrix transition = create();
-    
-    static Matrix create()
+    /// Normalization of the mixture, applied with the feedback
+    static Scalar get_scale()
     {
-      return Matrix::Identity().array() - (DataType(2) / DataType(nb_channels));
+      return 1;
     }
   };
 }
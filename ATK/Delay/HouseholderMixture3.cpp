@@ -0,0 +1,19 @@
+/**
+ * \file HouseholderMixture3.cpp
+ */
+
+#include "HouseholderMixture.hxx"
+
+#include <complex>
+
+namespace ATK
+{
+  template class FeedbackDelayNetworkFilter<HouseholderMixture<double, 16>>;
+  template class FeedbackDelayNetworkFilter<HouseholderMixture<double, 32>>;
+  template class FeedbackDelayNetworkFilter<HouseholderMixture<double, 64>>;
+#if ATK_ENABLE_INSTANTIATION
+  template class FeedbackDelayNetworkFilter<HouseholderMixture<float, 16>>;
+  template class FeedbackDelayNetworkFilter<HouseholderMixture<float, 32>>;
+  template class FeedbackDelayNetworkFilter<HouseholderMixture<float, 64>>;
+#endif
+}
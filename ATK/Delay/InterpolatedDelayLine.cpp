@@ -0,0 +1,354 @@
+/**
+ * \file InterpolatedDelayLine.cpp
+ */
+
+#include "InterpolatedDelayLine.h"
+
+#include <boost/math/constants/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ATK
+{
+  namespace
+  {
+    /// Largest number of interpolated samples, also the number of mirrored samples
+    constexpr gsl::index MAX_TAPS = 16;
+    /// Smallest number of samples written before they are read
+    constexpr gsl::index MIN_CHUNK_SIZE = 1024;
+    /// Number of fractions of a sample in the windowed sinc table
+    constexpr gsl::index SINC_PHASES = 256;
+
+    gsl::index next_power_of_2(gsl::index value)
+    {
+      gsl::index power = 1;
+      while(power < value)
+      {
+        power *= 2;
+      }
+      return power;
+    }
+
+    /// Windowed sinc, the number of points is known at compile time so that the convolution is vectorized
+    template<gsl::index nb_taps, typename DataType>
+    void interpolate_sinc(const DataType* ATK_RESTRICT history, const DataType* ATK_RESTRICT table, gsl::index mask, gsl::index reference, const DataType* ATK_RESTRICT delay, DataType* ATK_RESTRICT output, gsl::index size, DataType min_delay, DataType max_delay)
+    {
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        auto current_delay = std::min(std::max(delay[i], min_delay), max_delay);
+        auto integer_delay = static_cast<gsl::index>(current_delay);
+        auto phase = (current_delay - integer_delay) * SINC_PHASES;
+        auto integer_phase = std::min(static_cast<gsl::index>(phase), SINC_PHASES - 1);
+        auto fraction = phase - integer_phase;
+        const DataType* ATK_RESTRICT coefficients = table + integer_phase * nb_taps;
+        const DataType* ATK_RESTRICT points = history + ((reference + i - integer_delay - nb_taps / 2) & mask);
+        DataType products[nb_taps];
+        for(gsl::index tap = 0; tap < nb_taps; ++tap)
+        {
+          products[tap] = (coefficients[tap] + fraction * (coefficients[tap + nb_taps] - coefficients[tap])) * points[tap];
+        }
+        // Pairwise sum, the products of a sample are summed in the same vector
+        for(gsl::index width = nb_taps / 2; width > 0; width /= 2)
+        {
+          for(gsl::index tap = 0; tap < width; ++tap)
+          {
+            products[tap] += products[tap + width];
+          }
+        }
+        output[i] = products[0];
+      }
+    }
+  }
+
+  template<typename DataType_>
+  InterpolatedDelayLine<DataType_>::InterpolatedDelayLine(gsl::index max_delay)
+  :max_delay(max_delay), capacity(next_power_of_2(max_delay + MAX_TAPS + MIN_CHUNK_SIZE)), mask(capacity - 1), chunk_size(capacity - max_delay - MAX_TAPS), buffer(capacity + MAX_TAPS, 0)
+  {
+  }
+
+  template<typename DataType_>
+  void InterpolatedDelayLine<DataType_>::set_interpolation(DelayInterpolation interpolation)
+  {
+    this->interpolation = interpolation;
+    last_output = 0;
+    switch(interpolation)
+    {
+    case DelayInterpolation::Linear:
+    case DelayInterpolation::Allpass:
+    case DelayInterpolation::Thiran:
+      nb_taps = 2;
+      break;
+    case DelayInterpolation::Lagrange:
+      nb_taps = 4;
+      break;
+    case DelayInterpolation::Sinc8:
+      nb_taps = 8;
+      compute_sinc_table();
+      break;
+    case DelayInterpolation::Sinc16:
+      nb_taps = 16;
+      compute_sinc_table();
+      break;
+    }
+  }
+
+  template<typename DataType_>
+  DelayInterpolation InterpolatedDelayLine<DataType_>::get_interpolation() const
+  {
+    return interpolation;
+  }
+
+  template<typename DataType_>
+  DataType_ InterpolatedDelayLine<DataType_>::get_min_delay() const
+  {
+    switch(interpolation)
+    {
+    case DelayInterpolation::Linear:
+    case DelayInterpolation::Allpass:
+      return 0;
+    case DelayInterpolation::Thiran:
+      return static_cast<DataType>(.5);
+    default:
+      // Half of the points are after the delayed sample
+      return static_cast<DataType>(nb_taps / 2 - 1);
+    }
+  }
+
+  template<typename DataType_>
+  gsl::index InterpolatedDelayLine<DataType_>::get_max_delay() const
+  {
+    return max_delay;
+  }
+
+  template<typename DataType_>
+  void InterpolatedDelayLine<DataType_>::reset()
+  {
+    std::fill(buffer.begin(), buffer.end(), 0);
+    position = 0;
+    last_output = 0;
+  }
+
+  template<typename DataType_>
+  void InterpolatedDelayLine<DataType_>::compute_sinc_table()
+  {
+    sinc_table.resize((SINC_PHASES + 1) * nb_taps);
+    auto pi = boost::math::constants::pi<double>();
+    for(gsl::index phase = 0; phase <= SINC_PHASES; ++phase)
+    {
+      auto fraction = static_cast<double>(phase) / SINC_PHASES;
+      double sum = 0;
+      std::vector<double> coefficients(nb_taps);
+      for(gsl::index tap = 0; tap < nb_taps; ++tap)
+      {
+        // Distance between the point and the delayed sample, the oldest point comes first
+        auto x = tap - nb_taps / 2 + fraction;
+        auto sinc = x == 0 ? 1 : std::sin(pi * x) / (pi * x);
+        auto u = (x + nb_taps / 2.) / nb_taps;
+        auto window = .35875 - .48829 * std::cos(2 * pi * u) + .14128 * std::cos(4 * pi * u) - .01168 * std::cos(6 * pi * u);
+        coefficients[tap] = sinc * window;
+        sum += coefficients[tap];
+      }
+      // Unity gain for all the fractions
+      for(gsl::index tap = 0; tap < nb_taps; ++tap)
+      {
+        sinc_table[phase * nb_taps + tap] = static_cast<DataType>(coefficients[tap] / sum);
+      }
+    }
+  }
+
+  template<typename DataType_>
+  void InterpolatedDelayLine<DataType_>::process(const DataType* input, const DataType* delay, DataType* output, gsl::index size)
+  {
+    auto min_delay = get_min_delay();
+    while(size > 0)
+    {
+      auto current_size = std::min(size, chunk_size);
+      auto first_size = std::min(current_size, capacity - position);
+      std::copy(input, input + first_size, buffer.data() + position);
+      std::copy(input + first_size, input + current_size, buffer.data());
+      std::copy(buffer.data(), buffer.data() + MAX_TAPS, buffer.data() + capacity);
+
+      interpolate(position, delay, output, current_size, min_delay);
+
+      position = (position + current_size) & mask;
+      input += current_size;
+      delay += current_size;
+      output += current_size;
+      size -= current_size;
+    }
+  }
+
+  template<typename DataType_>
+  DataType_ InterpolatedDelayLine<DataType_>::read(DataType delay)
+  {
+    DataType output;
+    interpolate(position, &delay, &output, 1, get_min_delay() + 1);
+    return output;
+  }
+
+  template<typename DataType_>
+  void InterpolatedDelayLine<DataType_>::process_comb(const DataType* input, const DataType* delay, DataType* output, gsl::index size, gsl::index feedback_delay, DataType feedback, DataType blend, DataType feedforward)
+  {
+    switch(interpolation)
+    {
+    case DelayInterpolation::Linear:
+      process_comb<DelayInterpolation::Linear>(input, delay, output, size, feedback_delay, feedback, blend, feedforward);
+      break;
+    case DelayInterpolation::Lagrange:
+      process_comb<DelayInterpolation::Lagrange>(input, delay, output, size, feedback_delay, feedback, blend, feedforward);
+      break;
+    case DelayInterpolation::Allpass:
+      process_comb<DelayInterpolation::Allpass>(input, delay, output, size, feedback_delay, feedback, blend, feedforward);
+      break;
+    case DelayInterpolation::Thiran:
+      process_comb<DelayInterpolation::Thiran>(input, delay, output, size, feedback_delay, feedback, blend, feedforward);
+      break;
+    case DelayInterpolation::Sinc8:
+      process_comb<DelayInterpolation::Sinc8>(input, delay, output, size, feedback_delay, feedback, blend, feedforward);
+      break;
+    case DelayInterpolation::Sinc16:
+      process_comb<DelayInterpolation::Sinc16>(input, delay, output, size, feedback_delay, feedback, blend, feedforward);
+      break;
+    }
+  }
+
+  template<typename DataType_>
+  template<DelayInterpolation Interpolation>
+  void InterpolatedDelayLine<DataType_>::process_comb(const DataType* ATK_RESTRICT input, const DataType* ATK_RESTRICT delay, DataType* ATK_RESTRICT output, gsl::index size, gsl::index feedback_delay, DataType feedback, DataType blend, DataType feedforward)
+  {
+    // Same as read() for each sample, the written sample can be read by the next one
+    auto min_delay = get_min_delay() + 1;
+    for(gsl::index i = 0; i < size; ++i)
+    {
+      DataType delayed;
+      interpolate<Interpolation>(position, delay + i, &delayed, 1, min_delay);
+      auto processed = input[i] + feedback * get(feedback_delay);
+      push(processed);
+      output[i] = blend * processed + feedforward * delayed;
+    }
+  }
+
+  template<typename DataType_>
+  DataType_ InterpolatedDelayLine<DataType_>::get(gsl::index delay) const
+  {
+    return buffer[(position - delay) & mask];
+  }
+
+  template<typename DataType_>
+  void InterpolatedDelayLine<DataType_>::push(DataType value)
+  {
+    buffer[position] = value;
+    if(position < MAX_TAPS)
+    {
+      buffer[capacity + position] = value;
+    }
+    position = (position + 1) & mask;
+  }
+
+  template<typename DataType_>
+  void InterpolatedDelayLine<DataType_>::interpolate(gsl::index reference, const DataType* delay, DataType* output, gsl::index size, DataType min_delay)
+  {
+    switch(interpolation)
+    {
+    case DelayInterpolation::Linear:
+      interpolate<DelayInterpolation::Linear>(reference, delay, output, size, min_delay);
+      break;
+    case DelayInterpolation::Lagrange:
+      interpolate<DelayInterpolation::Lagrange>(reference, delay, output, size, min_delay);
+      break;
+    case DelayInterpolation::Allpass:
+      interpolate<DelayInterpolation::Allpass>(reference, delay, output, size, min_delay);
+      break;
+    case DelayInterpolation::Thiran:
+      interpolate<DelayInterpolation::Thiran>(reference, delay, output, size, min_delay);
+      break;
+    case DelayInterpolation::Sinc8:
+      interpolate<DelayInterpolation::Sinc8>(reference, delay, output, size, min_delay);
+      break;
+    case DelayInterpolation::Sinc16:
+      interpolate<DelayInterpolation::Sinc16>(reference, delay, output, size, min_delay);
+      break;
+    }
+  }
+
+  template<typename DataType_>
+  template<DelayInterpolation Interpolation>
+  void InterpolatedDelayLine<DataType_>::interpolate(gsl::index reference, const DataType* ATK_RESTRICT delay, DataType* ATK_RESTRICT output, gsl::index size, DataType min_delay)
+  {
+    const DataType* ATK_RESTRICT history = buffer.data();
+    const auto max_delay = static_cast<DataType>(this->max_delay - 1);
+    const auto mask = this->mask;
+
+    if constexpr(Interpolation == DelayInterpolation::Linear)
+    {
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        auto current_delay = std::min(std::max(delay[i], min_delay), max_delay);
+        auto integer_delay = static_cast<gsl::index>(current_delay);
+        auto fraction = current_delay - integer_delay;
+        auto index = (reference + i - integer_delay - 1) & mask;
+        output[i] = history[index + 1] * (1 - fraction) + history[index] * fraction;
+      }
+    }
+    else if constexpr(Interpolation == DelayInterpolation::Lagrange)
+    {
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        auto current_delay = std::min(std::max(delay[i], min_delay), max_delay);
+        auto integer_delay = static_cast<gsl::index>(current_delay);
+        // Delay relative to the most recent point
+        auto d = current_delay - integer_delay + 1;
+        auto index = (reference + i - integer_delay - 2) & mask;
+        auto dm1 = d - 1;
+        auto dm2 = d - 2;
+        auto dm3 = d - 3;
+        output[i] = history[index + 3] * (-dm1 * dm2 * dm3 / 6) + history[index + 2] * (d * dm2 * dm3 / 2)
+          + history[index + 1] * (-d * dm1 * dm3 / 2) + history[index] * (d * dm1 * dm2 / 6);
+      }
+    }
+    else if constexpr(Interpolation == DelayInterpolation::Allpass)
+    {
+      auto last_output = this->last_output;
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        auto current_delay = std::min(std::max(delay[i], min_delay), max_delay);
+        auto integer_delay = static_cast<gsl::index>(current_delay);
+        auto fraction = current_delay - integer_delay;
+        auto index = (reference + i - integer_delay - 1) & mask;
+        last_output = (history[index + 1] - last_output) * (1 - fraction) + history[index];
+        output[i] = last_output;
+      }
+      this->last_output = last_output;
+    }
+    else if constexpr(Interpolation == DelayInterpolation::Thiran)
+    {
+      // Recursive, the fractional delay is kept between 0.5 and 1.5 so that the pole stays far from the unit circle
+      auto last_output = this->last_output;
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        auto current_delay = std::min(std::max(delay[i], min_delay), max_delay);
+        auto integer_delay = static_cast<gsl::index>(current_delay - static_cast<DataType>(.5));
+        auto d = current_delay - integer_delay;
+        auto eta = (1 - d) / (1 + d);
+        auto index = (reference + i - integer_delay - 1) & mask;
+        last_output = eta * (history[index + 1] - last_output) + history[index];
+        output[i] = last_output;
+      }
+      this->last_output = last_output;
+    }
+    else if constexpr(Interpolation == DelayInterpolation::Sinc8)
+    {
+      interpolate_sinc<8>(history, sinc_table.data(), mask, reference, delay, output, size, min_delay, max_delay);
+    }
+    else if constexpr(Interpolation == DelayInterpolation::Sinc16)
+    {
+      interpolate_sinc<16>(history, sinc_table.data(), mask, reference, delay, output, size, min_delay, max_delay);
+    }
+  }
+
+  template class InterpolatedDelayLine<double>;
+#if ATK_ENABLE_INSTANTIATION
+  template class InterpolatedDelayLine<float>;
+#endif
+}
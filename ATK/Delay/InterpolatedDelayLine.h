@@ -0,0 +1,129 @@
+/**
+ * \file InterpolatedDelayLine.h
+ */
+
+#ifndef ATK_DELAY_INTERPOLATEDDELAYLINE_H
+#define ATK_DELAY_INTERPOLATEDDELAYLINE_H
+
+#include <ATK/Core/TypedBaseFilter.h>
+#include <ATK/Delay/config.h>
+
+#include <boost/align/aligned_allocator.hpp>
+
+#include <vector>
+
+namespace ATK
+{
+  /// Interpolation of the fractional delays
+  enum class DelayInterpolation
+  {
+    /// Two points, minimum delay of 0
+    Linear,
+    /// Cubic Lagrange on four points, minimum delay of 1
+    Lagrange,
+    /// First order allpass with the coefficient 1 - fraction, cheaper but less accurate than Thiran, minimum delay of 0
+    Allpass,
+    /// First order Thiran allpass, minimum delay of 0.5, only for slowly varying delays
+    Thiran,
+    /// Blackman-Harris windowed sinc on 8 points, minimum delay of 3
+    Sinc8,
+    /// Blackman-Harris windowed sinc on 16 points, minimum delay of 7
+    Sinc16
+  };
+
+  /// Circular buffer of a variable delay line, with a selectable interpolation
+  /*!
+   * The history is never moved, the buffer is indexed modulo a power of 2 and its first samples are mirrored after its
+   * end so that the points of an interpolation are always contiguous.
+   */
+  template<typename DataType_>
+  class ATK_DELAY_EXPORT InterpolatedDelayLine final
+  {
+  public:
+    using DataType = DataType_;
+
+    /*!
+     * @brief Constructor
+     * @param max_delay is the exclusive upper bound of the delays
+     */
+    explicit InterpolatedDelayLine(gsl::index max_delay);
+
+    /// Changes the interpolation, resets the state of the allpass interpolation
+    void set_interpolation(DelayInterpolation interpolation);
+    /// Returns the interpolation
+    DelayInterpolation get_interpolation() const;
+
+    /// Smallest delay that doesn't read samples after the delayed one, depends on the interpolation
+    DataType get_min_delay() const;
+    /// Returns the exclusive upper bound of the delays
+    gsl::index get_max_delay() const;
+
+    /// Clears the history
+    void reset();
+
+    /*!
+     * @brief Delays a block of samples
+     * @param input is the block, written in the line before it is read
+     * @param delay is the delay of each output sample, clamped between get_min_delay() and the max delay
+     * @param output is the delayed block, can't be input
+     * @param size is the size of the block
+     */
+    void process(const DataType* input, const DataType* delay, DataType* output, gsl::index size);
+
+    /*!
+     * @brief Runs a universal comb on a block, one sample after the other
+     * Each sample reads the line as read() does, then writes its input plus feedback times the sample written
+     * feedback_delay samples before. The interpolation is selected once for the whole block.
+     * @param input is the block added to the feedback
+     * @param delay is the read delay of each sample
+     * @param output is blend times the written samples plus feedforward times the read samples, can't be input
+     * @param size is the size of the block
+     * @param feedback_delay is the delay of the feedback, between 1 and the max delay
+     * @param feedback is the gain of the feedback
+     * @param blend is the gain of the written samples
+     * @param feedforward is the gain of the read samples
+     */
+    void process_comb(const DataType* input, const DataType* delay, DataType* output, gsl::index size, gsl::index feedback_delay, DataType feedback, DataType blend, DataType feedforward);
+
+    /// Returns the history delayed relative to the next written sample, clamped between get_min_delay() + 1 and the max delay
+    DataType read(DataType delay);
+    /// Returns the sample written delay samples before the next one
+    DataType get(gsl::index delay) const;
+    /// Writes the next sample
+    void push(DataType value);
+
+  private:
+    /// Interpolates size samples, the first one being at reference
+    void interpolate(gsl::index reference, const DataType* delay, DataType* output, gsl::index size, DataType min_delay);
+    /// Same, for a given interpolation
+    template<DelayInterpolation Interpolation>
+    void interpolate(gsl::index reference, const DataType* delay, DataType* output, gsl::index size, DataType min_delay);
+    /// Runs the universal comb for a given interpolation
+    template<DelayInterpolation Interpolation>
+    void process_comb(const DataType* input, const DataType* delay, DataType* output, gsl::index size, gsl::index feedback_delay, DataType feedback, DataType blend, DataType feedforward);
+    /// Fills the polyphase table of the windowed sinc
+    void compute_sinc_table();
+
+    using AlignedVector = std::vector<DataType, boost::alignment::aligned_allocator<DataType, 32>>;
+
+    DelayInterpolation interpolation{DelayInterpolation::Linear};
+    gsl::index max_delay;
+    /// Number of interpolated samples
+    gsl::index nb_taps{2};
+    /// Power of 2 holding the longest delay and a chunk of samples processed at once
+    gsl::index capacity;
+    gsl::index mask;
+    /// Maximum number of samples written before they are read
+    gsl::index chunk_size;
+    /// Circular buffer, followed by a copy of its first samples
+    AlignedVector buffer;
+    /// Position of the next written sample in the buffer
+    gsl::index position{0};
+    /// Last output of the allpass interpolation
+    DataType last_output{0};
+    /// Coefficients of the windowed sinc for each fraction of a sample, one phase after the other
+    AlignedVector sinc_table;
+  };
+}
+
+#endif
@@ -0,0 +1,268 @@
+/**
+ * \file MultiTapDelayFilter.cpp
+ */
+
+#include "MultiTapDelayFilter.h"
+#include <ATK/Core/Utilities.h>
+
+#include <boost/align/aligned_allocator.hpp>
+#include <boost/math/constants/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ATK
+{
+  namespace
+  {
+    /// Smallest number of samples written before they are read
+    constexpr gsl::index MIN_CHUNK_SIZE = 1024;
+  }
+
+  template<typename DataType>
+  class MultiTapDelayFilter<DataType>::MTDF_Impl
+  {
+  public:
+    /// A tap ready to be processed, it is panned between two adjacent outputs
+    struct SortedTap
+    {
+      gsl::index integer_delay;
+      DataType fraction;
+      gsl::index first_output;
+      DataType first_gain;
+      DataType second_gain;
+    };
+
+    /// Power of 2 holding the longest delay and a chunk of samples processed at once
+    gsl::index capacity;
+    gsl::index mask;
+    gsl::index chunk_size;
+    /// Circular buffer, preceded by a copy of its last sample so that the interpolations never wrap
+    std::vector<DataType, boost::alignment::aligned_allocator<DataType, 32>> history;
+    /// Position of the next written sample in the buffer
+    gsl::index position{0};
+    std::vector<SortedTap> sorted_taps;
+
+    explicit MTDF_Impl(gsl::index max_delay)
+      :capacity(1)
+    {
+      while(capacity < max_delay + MIN_CHUNK_SIZE)
+      {
+        capacity *= 2;
+      }
+      mask = capacity - 1;
+      chunk_size = capacity - max_delay;
+      history.assign(capacity + 1, 0);
+    }
+
+    /// Writes a chunk of samples, the sample at position p is stored at p + 1
+    void write(const DataType* ATK_RESTRICT input, gsl::index size)
+    {
+      auto first_size = std::min(size, capacity - position);
+      std::copy(input, input + first_size, history.data() + position + 1);
+      std::copy(input + first_size, input + size, history.data() + 1);
+      history[0] = history[capacity];
+    }
+
+    /// Accumulates a delayed chunk on an output
+    static void accumulate(const DataType* ATK_RESTRICT delayed, DataType* ATK_RESTRICT output, gsl::index size, DataType gain, DataType fraction)
+    {
+      if(fraction == 0)
+      {
+        for(gsl::index i = 0; i < size; ++i)
+        {
+          output[i] += gain * delayed[i];
+        }
+      }
+      else
+      {
+        // delayed[i - 1] is the older sample
+        auto current_gain = gain * (1 - fraction);
+        auto previous_gain = gain * fraction;
+        for(gsl::index i = 0; i < size; ++i)
+        {
+          output[i] += current_gain * delayed[i] + previous_gain * delayed[i - 1];
+        }
+      }
+    }
+  };
+
+  template<typename DataType_>
+  MultiTapDelayFilter<DataType_>::MultiTapDelayFilter(gsl::index max_delay, gsl::index nb_outputs)
+    :Parent(1, nb_outputs), impl(std::make_unique<MTDF_Impl>(max_delay)), max_delay(max_delay)
+  {
+  }
+
+  template<typename DataType_>
+  MultiTapDelayFilter<DataType_>::~MultiTapDelayFilter()
+  {
+  }
+
+  template<typename DataType_>
+  void MultiTapDelayFilter<DataType_>::check_tap(DataType_ delay, DataType_ pan) const
+  {
+    if(delay < 0)
+    {
+      throw ATK::RuntimeError("Delay must be positive");
+    }
+    if(delay > max_delay - 1)
+    {
+      throw ATK::RuntimeError("Delay must be less than delay line size");
+    }
+    if(std::abs(pan) > 1)
+    {
+      throw ATK::RuntimeError("Pan must be between -1 and 1");
+    }
+  }
+
+  template<typename DataType_>
+  auto MultiTapDelayFilter<DataType_>::get_tap(gsl::index tap) const -> const Tap&
+  {
+    if(tap < 0 || tap >= static_cast<gsl::index>(taps.size()))
+    {
+      throw ATK::RuntimeError("Tap does not exist");
+    }
+    return taps[tap];
+  }
+
+  template<typename DataType_>
+  gsl::index MultiTapDelayFilter<DataType_>::add_tap(DataType_ delay, DataType_ gain, DataType_ pan)
+  {
+    check_tap(delay, pan);
+    taps.push_back(Tap{delay, gain, pan});
+    update_order();
+    return static_cast<gsl::index>(taps.size()) - 1;
+  }
+
+  template<typename DataType_>
+  void MultiTapDelayFilter<DataType_>::set_tap(gsl::index tap, DataType_ delay, DataType_ gain, DataType_ pan)
+  {
+    get_tap(tap);
+    check_tap(delay, pan);
+    taps[tap] = Tap{delay, gain, pan};
+    update_order();
+  }
+
+  template<typename DataType_>
+  void MultiTapDelayFilter<DataType_>::remove_tap(gsl::index tap)
+  {
+    get_tap(tap);
+    taps.erase(taps.begin() + tap);
+    update_order();
+  }
+
+  template<typename DataType_>
+  void MultiTapDelayFilter<DataType_>::clear_taps()
+  {
+    taps.clear();
+    update_order();
+  }
+
+  template<typename DataType_>
+  gsl::index MultiTapDelayFilter<DataType_>::get_nb_taps() const
+  {
+    return static_cast<gsl::index>(taps.size());
+  }
+
+  template<typename DataType_>
+  DataType_ MultiTapDelayFilter<DataType_>::get_tap_delay(gsl::index tap) const
+  {
+    return get_tap(tap).delay;
+  }
+
+  template<typename DataType_>
+  DataType_ MultiTapDelayFilter<DataType_>::get_tap_gain(gsl::index tap) const
+  {
+    return get_tap(tap).gain;
+  }
+
+  template<typename DataType_>
+  DataType_ MultiTapDelayFilter<DataType_>::get_tap_pan(gsl::index tap) const
+  {
+    return get_tap(tap).pan;
+  }
+
+  template<typename DataType_>
+  void MultiTapDelayFilter<DataType_>::update_order()
+  {
+    auto& sorted_taps = impl->sorted_taps;
+    sorted_taps.clear();
+    for(const auto& tap: taps)
+    {
+      typename MTDF_Impl::SortedTap sorted_tap;
+      sorted_tap.integer_delay = static_cast<gsl::index>(tap.delay);
+      sorted_tap.fraction = tap.delay - sorted_tap.integer_delay;
+      if(nb_output_ports == 1)
+      {
+        sorted_tap.first_output = 0;
+        sorted_tap.first_gain = tap.gain;
+        sorted_tap.second_gain = 0;
+      }
+      else
+      {
+        auto position = (tap.pan + 1) / 2 * (nb_output_ports - 1);
+        sorted_tap.first_output = std::min(static_cast<gsl::index>(position), nb_output_ports - 2);
+        auto angle = (position - sorted_tap.first_output) * boost::math::constants::half_pi<DataType>();
+        sorted_tap.first_gain = tap.gain * std::cos(angle);
+        sorted_tap.second_gain = tap.gain * std::sin(angle);
+      }
+      sorted_taps.push_back(sorted_tap);
+    }
+    // The oldest samples are read first
+    std::sort(sorted_taps.begin(), sorted_taps.end(), [](const auto& lhs, const auto& rhs){return lhs.integer_delay > rhs.integer_delay;});
+  }
+
+  template<typename DataType_>
+  void MultiTapDelayFilter<DataType_>::full_setup()
+  {
+    // reset the delay line
+    std::fill(impl->history.begin(), impl->history.end(), 0);
+    impl->position = 0;
+    Parent::full_setup();
+  }
+
+  template<typename DataType_>
+  void MultiTapDelayFilter<DataType_>::process_impl(gsl::index size) const
+  {
+    const DataType* ATK_RESTRICT input = converted_inputs[0];
+    for(gsl::index channel = 0; channel < nb_output_ports; ++channel)
+    {
+      std::fill(outputs[channel], outputs[channel] + size, 0);
+    }
+
+    for(gsl::index processed = 0; processed < size; )
+    {
+      auto chunk_size = std::min(size - processed, impl->chunk_size);
+      impl->write(input + processed, chunk_size);
+
+      for(const auto& tap: impl->sorted_taps)
+      {
+        // The delayed samples are contiguous until the end of the circular buffer
+        auto start = (impl->position - tap.integer_delay) & impl->mask;
+        auto first_size = std::min(chunk_size, impl->capacity - start);
+        const DataType* ATK_RESTRICT first_delayed = impl->history.data() + start + 1;
+        const DataType* ATK_RESTRICT second_delayed = impl->history.data() + 1;
+
+        for(gsl::index output = tap.first_output; output < std::min(tap.first_output + 2, nb_output_ports); ++output)
+        {
+          auto gain = output == tap.first_output ? tap.first_gain : tap.second_gain;
+          if(gain == 0)
+          {
+            continue;
+          }
+          DataType* ATK_RESTRICT output_data = outputs[output] + processed;
+          MTDF_Impl::accumulate(first_delayed, output_data, first_size, gain, tap.fraction);
+          MTDF_Impl::accumulate(second_delayed, output_data + first_size, chunk_size - first_size, gain, tap.fraction);
+        }
+      }
+
+      impl->position = (impl->position + chunk_size) & impl->mask;
+      processed += chunk_size;
+    }
+  }
+
+  template class MultiTapDelayFilter<double>;
+#if ATK_ENABLE_INSTANTIATION
+  template class MultiTapDelayFilter<float>;
+#endif
+}
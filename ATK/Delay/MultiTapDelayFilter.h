@@ -0,0 +1,94 @@
+/**
+ * \file MultiTapDelayFilter.h
+ */
+
+#ifndef ATK_DELAY_MULTITAPDELAYFILTER_H
+#define ATK_DELAY_MULTITAPDELAYFILTER_H
+
+#include <ATK/Core/TypedBaseFilter.h>
+#include <ATK/Delay/config.h>
+
+#include <vector>
+
+namespace ATK
+{
+  /// Delay with any number of taps read from a single delay line, for multitap echoes and early reflections
+  /*!
+   * Each tap has a delay, possibly fractional and linearly interpolated, a gain and a pan over the outputs. The taps are
+   * read in decreasing delay order, each one with contiguous accesses for a whole block.
+   */
+  template<typename DataType_>
+  class ATK_DELAY_EXPORT MultiTapDelayFilter final : public TypedBaseFilter<DataType_>
+  {
+    class MTDF_Impl;
+  protected:
+    /// Simplify parent calls
+    using Parent = TypedBaseFilter<DataType_>;
+    using typename Parent::DataType;
+    using Parent::converted_inputs;
+    using Parent::outputs;
+    using Parent::nb_input_ports;
+    using Parent::nb_output_ports;
+
+  public:
+    /*!
+     * @brief construct the filter with a maximum delay line size
+     * @param max_delay is the maximum delay allowed
+     * @param nb_outputs is the number of outputs the taps are panned on
+     */
+    explicit MultiTapDelayFilter(gsl::index max_delay, gsl::index nb_outputs = 2);
+    /// Destructor
+    ~MultiTapDelayFilter() override;
+
+    /*!
+     * @brief Adds a tap
+     * @param delay is the delay of the tap, between 0 and max_delay - 1
+     * @param gain is the gain of the tap
+     * @param pan is the position of the tap between the first (-1) and the last (1) output, with a constant power law
+     * @return the index of the tap
+     */
+    gsl::index add_tap(DataType_ delay, DataType_ gain, DataType_ pan = 0);
+    /// Changes a tap
+    void set_tap(gsl::index tap, DataType_ delay, DataType_ gain, DataType_ pan = 0);
+    /// Removes a tap, the following taps are shifted
+    void remove_tap(gsl::index tap);
+    /// Removes all the taps
+    void clear_taps();
+    /// Returns the number of taps
+    gsl::index get_nb_taps() const;
+
+    /// Gets the delay of a tap
+    DataType_ get_tap_delay(gsl::index tap) const;
+    /// Gets the gain of a tap
+    DataType_ get_tap_gain(gsl::index tap) const;
+    /// Gets the pan of a tap
+    DataType_ get_tap_pan(gsl::index tap) const;
+
+    void full_setup() final;
+  protected:
+    void process_impl(gsl::index size) const final;
+
+  private:
+    /// Checks the parameters of a tap
+    void check_tap(DataType_ delay, DataType_ pan) const;
+    /// Sorts the taps by delay and computes their gains on each output
+    void update_order();
+
+    struct Tap
+    {
+      DataType delay;
+      DataType gain;
+      DataType pan;
+    };
+
+    /// Returns a tap, throws if it doesn't exist
+    const Tap& get_tap(gsl::index tap) const;
+
+    std::unique_ptr<MTDF_Impl> impl;
+    std::vector<Tap> taps;
+    /// Max delay for the delay line
+    gsl::index max_delay{0};
+  };
+}
+
+#endif
@@ -5,10 +5,7 @@
 #include "UniversalVariableDelayLineFilter.h"
 #include <ATK/Core/Utilities.h>
 
-#include <cassert>
 #include <cmath>
-#include <cstdint>
-#include <cstring>
 
 namespace ATK
 {
@@ -16,33 +13,13 @@ namespace ATK
   class UniversalVariableDelayLineFilter<DataType>::UVDLF_Impl
   {
   public:
-    /// Delay line contains the last size elements + max_delay of the last delay line
-    std::vector<DataType> delay_line;
-    std::vector<DataType> processed_input;
-
-    /// Integer portion of the delay for the last processed chunk
-    std::vector<gsl::index> integer_delay;
-    /// Fractional portion of the delay for the last processed chunk, used for the interpolation
-    std::vector<DataType> fractional_delay;
-    DataType last_delay{0};
+    /// Circular buffer with the last max_delay processed samples
+    InterpolatedDelayLine<DataType> processed_input;
 
     explicit UVDLF_Impl(gsl::index max_delay)
-      :processed_input(max_delay, 0)
+      :processed_input(max_delay)
     {
-    }
-
-    void update_delay_line(gsl::index max_delay, gsl::index size)
-    {
-      auto array_size = processed_input.size();
-      // Update delay line
-      ATK_VECTORIZE for (gsl::index i = 0; i < max_delay; ++i)
-      {
-        processed_input[i] = processed_input[array_size + i - max_delay];
-      }
-      delay_line.resize(size);
-      processed_input.resize(size + max_delay);
-      integer_delay.resize(size);
-      fractional_delay.resize(size);
+      processed_input.set_interpolation(DelayInterpolation::Allpass);
     }
   };
 
@@ -110,42 +87,35 @@ namespace ATK
     return feedforward;
   }
 
+  template<typename DataType_>
+  void UniversalVariableDelayLineFilter<DataType_>::set_interpolation(DelayInterpolation interpolation)
+  {
+    impl->processed_input.set_interpolation(interpolation);
+  }
+
+  template<typename DataType_>
+  DelayInterpolation UniversalVariableDelayLineFilter<DataType_>::get_interpolation() const
+  {
+    return impl->processed_input.get_interpolation();
+  }
+
   template<typename DataType_>
   void UniversalVariableDelayLineFilter<DataType_>::full_setup()
   {
     // reset the delay line
-    impl->processed_input.assign(max_delay, 0);
-    impl->last_delay = 0;
+    impl->processed_input.reset();
+    Parent::full_setup();
   }
 
   template<typename DataType_>
   void UniversalVariableDelayLineFilter<DataType_>::process_impl(gsl::index size) const
   {
-    impl->update_delay_line(max_delay, size);
     const DataType* ATK_RESTRICT input1 = converted_inputs[0]; // samples
     const DataType* ATK_RESTRICT input2 = converted_inputs[1]; // delay
     DataType* ATK_RESTRICT output = outputs[0];
 
-    DataType* ATK_RESTRICT delay_line = impl->delay_line.data();
-    DataType* ATK_RESTRICT processed_input = impl->processed_input.data();
-    gsl::index* ATK_RESTRICT integer_delay = impl->integer_delay.data();
-    DataType* ATK_RESTRICT fractional_delay = impl->fractional_delay.data();
-
-    // Update the delay line
-    ATK_VECTORIZE for(gsl::index i = 0; i < size; ++i)
-    {
-      auto rounded = static_cast<gsl::index>(input2[i]);
-      integer_delay[i] = rounded >= max_delay ? 0 : rounded;
-      fractional_delay[i] = input2[i] - integer_delay[i];
-    }
-
-    ATK_VECTORIZE for(gsl::index i = 0; i < size; ++i)
-    {
-      delay_line[i] = (processed_input[i + max_delay - integer_delay[i]] - impl->last_delay) * (1 - fractional_delay[i]) + processed_input[i + max_delay - integer_delay[i] - 1];
-      processed_input[max_delay + i] = input1[i] + feedback * processed_input[max_delay + i - central_delay]; // FB only uses the central delay and is not varying
-      output[i] = blend * processed_input[max_delay + i] + feedforward * delay_line[i];
-      impl->last_delay = delay_line[i]; // the reason why the test is not that simple!
-    }
+    // FB only uses the central delay and is not varying
+    impl->processed_input.process_comb(input1, input2, output, size, central_delay, feedback, blend, feedforward);
   }
   
   template class UniversalVariableDelayLineFilter<double>;
@@ -6,6 +6,7 @@
 #define ATK_DELAY_UNIVERSALVARIABLEDELAYFILTER_H
 
 #include <ATK/Core/TypedBaseFilter.h>
+#include <ATK/Delay/InterpolatedDelayLine.h>
 #include <ATK/Delay/config.h>
 
 #include <vector>
@@ -56,6 +57,11 @@ namespace ATK
     /// Gets feedforward amount
     DataType_ get_feedforward() const;
 
+    /// Changes the interpolation of the fractional delays, DelayInterpolation::Allpass by default
+    void set_interpolation(DelayInterpolation interpolation);
+    /// Returns the interpolation of the fractional delays
+    DelayInterpolation get_interpolation() const;
+
     void full_setup() final;
   protected:
     void process_impl(gsl::index size) const final;
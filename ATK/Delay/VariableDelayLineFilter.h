@@ -6,6 +6,7 @@
 #define ATK_DELAY_VARIABLEDELAYFILTER_H
 
 #include <ATK/Core/TypedBaseFilter.h>
+#include <ATK/Delay/InterpolatedDelayLine.h>
 #include <ATK/Delay/config.h>
 
 #include <vector>
@@ -36,6 +37,11 @@ namespace ATK
     /// Destructor
     ~VariableDelayLineFilter() override;
 
+    /// Changes the interpolation of the fractional delays, linear by default
+    void set_interpolation(DelayInterpolation interpolation);
+    /// Returns the interpolation of the fractional delays
+    DelayInterpolation get_interpolation() const;
+
     void full_setup() final;
   protected:
     void process_impl(gsl::index size) const final;
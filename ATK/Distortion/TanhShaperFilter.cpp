@@ -41,8 +41,13 @@ namespace ATK
       DataType* ATK_RESTRICT output = outputs[channel];
       for(gsl::index i = 0; i < size; ++i)
       {
-        auto exp = fmath::exp(2 * coeff * input[i]);
-        output[i] = (exp - 1) / (coeff * (exp + 1));
+        output[i] = coeff * input[i];
+      }
+      fmath::tanh(output, output, size);
+      auto inverse_coeff = 1 / coeff;
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        output[i] *= inverse_coeff;
       }
     }
   }
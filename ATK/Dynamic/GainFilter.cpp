@@ -5,16 +5,36 @@
 #include "GainFilter.h"
 #include <ATK/Core/Utilities.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 
 namespace ATK
 {
   template<typename DataType_>
   ParentGainFilter<DataType_>::ParentGainFilter(gsl::index nb_channels, size_t LUTsize, size_t LUTprecision)
-  :Parent(nb_channels, nb_channels), LUTsize(LUTsize), LUTprecision(LUTprecision), gainLUT(LUTsize, 0)
+  :Parent(nb_channels, nb_channels), LUTsize(LUTsize), LUTprecision(LUTprecision)
   {
+    if (this->LUTsize < 2 || this->LUTprecision <= 0)
+    {
+      throw ATK::RuntimeError("LUT must have at least 2 elements and a strictly positive precision");
+    }
+    // Octaves from 2^-40 (-120dB) to the largest value, each one with the same power of 2 of elements
+    constexpr int min_exponent = -40;
+    auto max_exponent = std::max(min_exponent + 1, static_cast<int>(std::ceil(std::log2(static_cast<double>(this->LUTsize) / this->LUTprecision))));
+    auto nb_octaves = max_exponent - min_exponent;
+    auto elements_per_octave = std::floor(std::log2(static_cast<double>(this->LUTsize - 1) / nb_octaves));
+    auto octave_bits = std::clamp(static_cast<int>(elements_per_octave), 0, mantissa_size);
+    LUT_shift = mantissa_size - octave_bits;
+    this->LUTsize = (static_cast<gsl::index>(nb_octaves) << octave_bits) + 1;
+    auto min_value = static_cast<DataType_>(std::ldexp(1., min_exponent));
+    std::memcpy(&LUT_min_bits, &min_value, sizeof(LUT_min_bits));
+    for (auto& LUT: gainLUTs)
+    {
+      LUT.assign(this->LUTsize, 0);
+    }
   }
   
   template<typename DataType_>
@@ -6,11 +6,17 @@
 #define ATK_DYNAMIC_GAINFILTER_H
 
 #include <ATK/Core/TypedBaseFilter.h>
+#include <ATK/Dynamic/LUTWorker.h>
 #include <ATK/Dynamic/config.h>
 
+#include <array>
 #include <cassert>
 #include <atomic>
-#include <future>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 namespace ATK
@@ -18,6 +24,11 @@ namespace ATK
   /// Gain generic filter. Based on a LUT table, compute the gain.
   /*!
    * Be aware that the threshold is taken as a power measure contrary to the gain (there is a factor 2 in the dB computation)
+   *
+   * The table is indexed by the binary representation of the power relative to the threshold: the exponent selects an
+   * octave and the highest bits of the mantissa a uniform step inside it, so that each octave (3dB) gets the same number
+   * of elements. It goes from 2^-40 (-120dB) up to the power of 2 above LUTsize / LUTprecision, the values outside of
+   * this range use the gain of the closest bound. The first element holds the gain of a null power.
    */
   template<typename DataType_>
   class ATK_DYNAMIC_EXPORT ParentGainFilter : public TypedBaseFilter<DataType_>
@@ -31,8 +42,8 @@ namespace ATK
     /*!
     * @brief Constructor
     * @param nb_channels is the number of input and output channels
-    * @param LUTsize is the total LUT size used by the filter
-    * @param LUTprecision is the number of elements used to compute values < 1
+    * @param LUTsize is the largest number of elements of the LUT, each octave keeps at least one
+    * @param LUTprecision sets the largest value of the LUT, LUTsize / LUTprecision
     */
     ParentGainFilter(gsl::index nb_channels = 1, size_t LUTsize = 128*1024, size_t LUTprecision = 64);
     /// Destructor
@@ -57,9 +68,19 @@ namespace ATK
 
     virtual void start_recomputeLUT() = 0;
 
+    /// Integer with the size of DataType_, to read its representation
+    using LUTBits = std::conditional_t<sizeof(DataType_) == sizeof(std::int32_t), std::int32_t, std::int64_t>;
+    static constexpr int mantissa_size = std::numeric_limits<DataType_>::digits - 1;
+
+    /// Number of elements of the LUT, a power of 2 per octave and the upper bound
     gsl::index LUTsize{0};
     gsl::index LUTprecision{0};
-    std::vector<DataType_> gainLUT;
+    /// Representation of the value of the first element
+    LUTBits LUT_min_bits{0};
+    /// Number of low bits of the mantissa between two elements
+    int LUT_shift{0};
+    /// The LUT read by the processing and the one that is rebuilt
+    std::array<std::vector<DataType_>, 2> gainLUTs;
   };
 
   template<class ParentFilter>
@@ -75,8 +96,11 @@ namespace ATK
     using Parent::nb_output_ports;
     using Parent::computeGain;
     using Parent::LUTsize;
-    using Parent::LUTprecision;
-    using Parent::gainLUT;
+    using Parent::LUT_min_bits;
+    using Parent::LUT_shift;
+    using Parent::gainLUTs;
+    using typename Parent::LUTBits;
+    using Parent::mantissa_size;
 
     GainFilter(gsl::index nb_channels = 1, gsl::index LUTsize = 128 * 1024, gsl::index LUTprecision = 64)
     :ParentFilter(nb_channels, LUTsize, LUTprecision)
@@ -86,111 +110,178 @@ namespace ATK
 
     ~GainFilter() override
     {
-      //Future has to be deleted in child destructor as it uses computeGain
-      wait_for_LUT_completion();
+      // The rebuild has to be stopped in the child destructor as it uses computeGain
+      LUTWorker::get_instance().cancel(this);
     }
 
+    /// Waits until the LUT matches the last parameters
     void wait_for_LUT_completion()
     {
-      if (recomputeFuture.valid())
+      LUTWorker::get_instance().wait(this);
+    }
+
+    /*!
+     * @brief Computes the gains of buffers of powers outside of a pipeline, for the filters that embed a gain computer
+     * @param powers are the buffers of powers, relative to the threshold like the input ports
+     * @param gains are the buffers that receive the gains
+     * @param nb_buffers is the number of buffers
+     * @param size is the size of each buffer
+     */
+    void compute_gains(const DataType* const * powers, DataType* const * gains, gsl::index nb_buffers, gsl::index size) const
+    {
+      // Once the processing has started with a LUT, it is read with the previous parameters until the rebuilt one is published
+      int index = published_LUT.load();
+      if (!LUT_live)
+      {
+        if (built_LUT[index].load() != requested_LUT.load())
+        {
+          process_impl_direct(powers, gains, nb_buffers, size);
+          return;
+        }
+        LUT_live = true;
+      }
+      while (true)
       {
-        recomputeFuture.wait();
+        used_LUT.store(index);
+        // If the LUT was swapped before it was marked as used, the rebuild may already be writing in it
+        int current = published_LUT.load();
+        if (current == index)
+        {
+          break;
+        }
+        index = current;
       }
+      process_impl_LUT(powers, gains, nb_buffers, size, gainLUTs[index].data());
+      used_LUT.store(-1, std::memory_order_release);
     }
 
   protected:
-    /// Future used to track the thread recomputing the LUT
-    std::future<void> recomputeFuture;
-    /// Is the thread recomputing the LUT running (which way of computing the gain shall we use?)
-    std::atomic<bool> isRunning{false};
-    /// Indicates to start recomputing the LUT from the start, used when asked to change LUT parameters when the LUT is recomputed
-    std::atomic<bool> resetRequest{false};
+    /// Index of the LUT read by the processing, the other one is rebuilt
+    std::atomic<int> published_LUT{0};
+    /// Index of the LUT read by the current compute_gains call, -1 between the calls
+    mutable std::atomic<int> used_LUT{-1};
+    /// Number of rebuilds requested so far
+    std::atomic<std::int64_t> requested_LUT{0};
+    /// Request that each LUT was built for
+    std::array<std::atomic<std::int64_t>, 2> built_LUT{{{-1}, {-1}}};
+    /// Has the processing read a LUT? Until one matches the parameters, the gain is computed directly
+    mutable bool LUT_live{false};
 
     void process_impl(gsl::index size) const final
     {
       assert(nb_input_ports == nb_output_ports);
 
-      if (isRunning)
-      {
-        process_impl_direct(size);
-      }
-      else
-      {
-        process_impl_LUT(size);
-      }
+      compute_gains(converted_inputs.data(), outputs.data(), nb_output_ports, size);
     }
 
     /// Computes the gain based on the LUT
-    void process_impl_LUT(gsl::index size) const
+    void process_impl_LUT(const DataType* const * powers, DataType* const * gains, gsl::index nb_buffers, gsl::index size, const DataType* ATK_RESTRICT LUT) const
     {
-      for (gsl::index channel = 0; channel < nb_output_ports; ++channel)
+      const auto last_offset = static_cast<LUTBits>(LUTsize - 1) << LUT_shift;
+      const auto last_step = static_cast<LUTBits>(LUTsize - 2);
+      // Copied so that they are not read again after each in place write
+      const auto threshold = this->threshold;
+      const auto min_bits = LUT_min_bits;
+      const auto shift = LUT_shift;
+      DataType one = 1;
+      LUTBits one_bits;
+      std::memcpy(&one_bits, &one, sizeof(one_bits));
+      // Only integer operations and gathers, the negative values go to the first element
+      auto gain = [=](DataType power)
+      {
+        DataType value = power * threshold;
+        LUTBits offset;
+        std::memcpy(&offset, &value, sizeof(offset));
+        offset -= min_bits;
+        offset = offset > 0 ? offset : 0;
+        offset = offset < last_offset ? offset : last_offset;
+        auto step = offset >> shift;
+        step = step < last_step ? step : last_step;
+        // The remaining bits of the mantissa, as the mantissa of a number in [1, 2]
+        LUTBits fraction_bits = one_bits + ((offset - (step << shift)) << (mantissa_size - shift));
+        DataType fraction;
+        std::memcpy(&fraction, &fraction_bits, sizeof(fraction));
+        fraction -= 1;
+        return LUT[step] + fraction * (LUT[step + 1] - LUT[step]);
+      };
+      for (gsl::index buffer = 0; buffer < nb_buffers; ++buffer)
       {
-        const auto* ATK_RESTRICT input = converted_inputs[channel];
-        auto* ATK_RESTRICT output = outputs[channel];
-        for (gsl::index i = 0; i < size; ++i)
+        if (powers[buffer] == gains[buffer])
         {
-          auto value = input[i] * threshold * LUTprecision;
-          auto step = std::lround(std::ceil(value));
-          if (step >= LUTsize - 1)
+          // Computed in place
+          DataType* output = gains[buffer];
+          for (gsl::index i = 0; i < size; ++i)
           {
-            step = static_cast<int>(LUTsize) - 1;
-            output[i] = gainLUT[step];
+            output[i] = gain(output[i]);
           }
-          else
+        }
+        else
+        {
+          const DataType* ATK_RESTRICT input = powers[buffer];
+          DataType* ATK_RESTRICT output = gains[buffer];
+          for (gsl::index i = 0; i < size; ++i)
           {
-            output[i] = (1 - (value - step)) * gainLUT[step] + (value - step) * gainLUT[step + 1];
+            output[i] = gain(input[i]);
           }
         }
       }
     }
 
     /// Computes the gain directly
-    void process_impl_direct(gsl::index size) const
+    void process_impl_direct(const DataType* const * powers, DataType* const * gains, gsl::index nb_buffers, gsl::index size) const
     {
-      for (gsl::index channel = 0; channel < nb_output_ports; ++channel)
+      for (gsl::index buffer = 0; buffer < nb_buffers; ++buffer)
       {
-        const auto* ATK_RESTRICT input = converted_inputs[channel];
-        auto* ATK_RESTRICT output = outputs[channel];
-        for (gsl::index i = 0; i < size; ++i)
+        if (powers[buffer] == gains[buffer])
         {
-          output[i] = computeGain(*(input++) * threshold);
+          // Computed in place
+          DataType* output = gains[buffer];
+          for (gsl::index i = 0; i < size; ++i)
+          {
+            output[i] = computeGain(output[i] * threshold);
+          }
+        }
+        else
+        {
+          const auto* ATK_RESTRICT input = powers[buffer];
+          auto* ATK_RESTRICT output = gains[buffer];
+          for (gsl::index i = 0; i < size; ++i)
+          {
+            output[i] = computeGain(*(input++) * threshold);
+          }
         }
       }
     }
 
-    /// Asks to recompute the LUT
+    /// Rebuilds the LUT that is not read and publishes it, on the worker thread
     void recomputeLUT()
     {
-      auto gainLUT_ptr = gainLUT.data();
-
-      for (gsl::index i = 0; i < LUTsize; i += 16)
+      auto request = requested_LUT.load();
+      int index = 1 - published_LUT.load();
+      // The processing may still read this LUT if it started before the last swap
+      while (used_LUT.load() == index)
       {
-        if (resetRequest)
-        {
-          i = 0;
-          resetRequest = false;
-          gainLUT_ptr = gainLUT.data();
-        }
-        for (gsl::index j = 0; j < 16; ++j)
-        {
-          *(gainLUT_ptr++) = computeGain(static_cast<DataType>(i + j) / LUTprecision);
-        }
+        std::this_thread::yield();
+      }
+      auto& LUT = gainLUTs[index];
+      for (gsl::index i = 0; i < LUTsize; ++i)
+      {
+        auto bits = LUT_min_bits + (static_cast<LUTBits>(i) << LUT_shift);
+        DataType value;
+        std::memcpy(&value, &bits, sizeof(value));
+        LUT[i] = computeGain(value);
       }
-      isRunning = false;
+      // Silence goes to the first element, as with the linear table
+      LUT[0] = computeGain(0);
+      built_LUT[index].store(request);
+      published_LUT.store(index);
     }
 
-    /// Actually recomputes the LUT
+    /// Asks the worker to rebuild the LUT with the current parameters
     void start_recomputeLUT() final
     {
-      if (isRunning)
-      {
-        resetRequest = true; // Tell the thread to start over
-      }
-      else
-      {
-        isRunning = true; // starting a new thread
-        recomputeFuture = std::async(&GainFilter<ParentFilter>::recomputeLUT, this);
-      }
+      ++requested_LUT;
+      LUTWorker::get_instance().submit(this, [this](){recomputeLUT();});
     }
 
   };
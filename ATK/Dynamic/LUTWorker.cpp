@@ -0,0 +1,85 @@
+/**
+ * \file LUTWorker.cpp
+ */
+
+#include "LUTWorker.h"
+
+#include <algorithm>
+
+namespace ATK
+{
+  LUTWorker& LUTWorker::get_instance()
+  {
+    // Constructed by the first filter, so destroyed after the static filters
+    static LUTWorker worker;
+    return worker;
+  }
+
+  LUTWorker::LUTWorker()
+  :thread([this](){run();})
+  {
+  }
+
+  LUTWorker::~LUTWorker()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    condition.notify_one();
+    thread.join();
+  }
+
+  void LUTWorker::submit(const void* owner, std::function<void()> task)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      // A running rebuild may have read the parameters already, so only the queued ones are merged
+      if(std::any_of(tasks.begin(), tasks.end(), [owner](const auto& task){return task.first == owner;}))
+      {
+        return;
+      }
+      tasks.emplace_back(owner, std::move(task));
+    }
+    condition.notify_one();
+  }
+
+  void LUTWorker::wait(const void* owner)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this, owner](){return !is_busy(owner);});
+  }
+
+  void LUTWorker::cancel(const void* owner)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    tasks.erase(std::remove_if(tasks.begin(), tasks.end(), [owner](const auto& task){return task.first == owner;}), tasks.end());
+    finished.wait(lock, [this, owner](){return running != owner;});
+  }
+
+  bool LUTWorker::is_busy(const void* owner) const
+  {
+    return running == owner || std::any_of(tasks.begin(), tasks.end(), [owner](const auto& task){return task.first == owner;});
+  }
+
+  void LUTWorker::run()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true)
+    {
+      condition.wait(lock, [this](){return stop || !tasks.empty();});
+      if(stop)
+      {
+        return;
+      }
+      auto task = std::move(tasks.front());
+      tasks.pop_front();
+      running = task.first;
+      lock.unlock();
+      task.second();
+      lock.lock();
+      running = nullptr;
+      finished.notify_all();
+    }
+  }
+}
@@ -0,0 +1,63 @@
+/**
+ * \file LUTWorker.h
+ */
+
+#ifndef ATK_DYNAMIC_LUTWORKER_H
+#define ATK_DYNAMIC_LUTWORKER_H
+
+#include <ATK/Dynamic/config.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace ATK
+{
+  /// Background thread shared by the gain filters to rebuild their tables one after the other
+  class ATK_DYNAMIC_EXPORT LUTWorker final
+  {
+  public:
+    /// Returns the worker, started by the first call
+    static LUTWorker& get_instance();
+
+    ~LUTWorker();
+
+    LUTWorker(const LUTWorker&) = delete;
+    LUTWorker& operator=(const LUTWorker&) = delete;
+
+    /*!
+     * @brief Queues a rebuild
+     * @param owner identifies the table, a rebuild already queued for it is not queued again
+     * @param task is the rebuild, it must read the parameters when it starts
+     */
+    void submit(const void* owner, std::function<void()> task);
+    /// Waits until the owner has no queued or running rebuild
+    void wait(const void* owner);
+    /// Drops the queued rebuild of the owner and waits for the running one, to be called before the owner is destroyed
+    void cancel(const void* owner);
+
+  private:
+    LUTWorker();
+
+    void run();
+    /// Returns true if the owner has a queued or running rebuild, with the mutex locked
+    bool is_busy(const void* owner) const;
+
+    std::deque<std::pair<const void*, std::function<void()>>> tasks;
+    /// Owner of the running rebuild
+    const void* running{nullptr};
+    bool stop{false};
+    std::mutex mutex;
+    /// Wakes the thread
+    std::condition_variable condition;
+    /// Wakes the callers of wait and cancel
+    std::condition_variable finished;
+    /// Started last, once the other members are initialized
+    std::thread thread;
+  };
+}
+
+#endif
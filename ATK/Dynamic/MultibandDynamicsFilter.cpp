@@ -0,0 +1,491 @@
+/**
+ * \file MultibandDynamicsFilter.cpp
+ */
+
+#include "MultibandDynamicsFilter.h"
+#include <ATK/Core/Utilities.h>
+#include <ATK/Dynamic/GainCompressorFilter.h>
+#include <ATK/Dynamic/GainExpanderFilter.h>
+#include <ATK/Dynamic/GainLimiterFilter.h>
+
+#include <boost/math/constants/constants.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+namespace ATK
+{
+  namespace
+  {
+    /// One sample of a 4th order filter (Transposed Direct Form II)
+    template<typename BatchType>
+    BatchType fourth_order(const std::array<double, 9>& coefficients, BatchType* ATK_RESTRICT state, const BatchType& x)
+    {
+      BatchType y = state[0];
+      y.multiply_add(coefficients[0], x);
+      for(gsl::index j = 0; j < 3; ++j)
+      {
+        state[j] = state[j + 1];
+        state[j].multiply_add(coefficients[j + 1], x);
+        state[j].multiply_add(coefficients[j + 5], y);
+      }
+      state[3] = BatchType(0.);
+      state[3].multiply_add(coefficients[4], x);
+      state[3].multiply_add(coefficients[8], y);
+      return y;
+    }
+
+    /// One sample of a 2nd order allpass filter (Transposed Direct Form II)
+    template<typename BatchType>
+    BatchType allpass(const std::array<double, 2>& coefficients, BatchType* ATK_RESTRICT state, const BatchType& x)
+    {
+      BatchType y = state[0];
+      y.multiply_add(coefficients[1], x);
+      state[0] = state[1];
+      state[0].multiply_add(coefficients[0], x);
+      state[0].multiply_add(-coefficients[0], y);
+      state[1] = x;
+      state[1].multiply_add(-coefficients[1], y);
+      return y;
+    }
+  }
+
+  template<class GainParent>
+  MultibandDynamicsFilter<GainParent>::MultibandDynamicsFilter(gsl::index nb_channels, gsl::index nb_bands, bool sidechain)
+  :Parent(sidechain ? 2 * nb_channels : nb_channels, nb_channels), nb_bands(nb_bands), sidechain(sidechain)
+  {
+    if(nb_bands < min_bands || nb_bands > max_bands)
+    {
+      throw ATK::RuntimeError("Number of bands must be between 2 and 8");
+    }
+    // Crossovers spread logarithmically between 100Hz and 10kHz
+    for(gsl::index index = 0; index < nb_bands - 1; ++index)
+    {
+      crossovers.push_back(nb_bands == 2 ? 1000. : 100. * std::pow(100., static_cast<double>(index) / (nb_bands - 2)));
+      low_passes.emplace_back();
+      high_passes.emplace_back();
+    }
+    low_coefficients.resize(nb_bands - 1);
+    high_coefficients.resize(nb_bands - 1);
+    allpass_coefficients.resize(nb_bands - 1);
+    for(gsl::index band = 0; band < nb_bands; ++band)
+    {
+      gain_computers.push_back(std::make_unique<GainComputer>());
+    }
+    memories.assign(nb_bands, 0);
+    attacks.assign(nb_bands, 0);
+    releases.assign(nb_bands, 0);
+  }
+
+  template<class GainParent>
+  gsl::index MultibandDynamicsFilter<GainParent>::get_nb_bands() const
+  {
+    return nb_bands;
+  }
+
+  template<class GainParent>
+  bool MultibandDynamicsFilter<GainParent>::has_sidechain() const
+  {
+    return sidechain;
+  }
+
+  template<class GainParent>
+  void MultibandDynamicsFilter<GainParent>::set_crossover(gsl::index index, double frequency)
+  {
+    if(index < 0 || index >= nb_bands - 1)
+    {
+      throw ATK::RuntimeError("Crossover does not exist");
+    }
+    if(frequency <= 0)
+    {
+      throw ATK::RuntimeError("Crossover frequency must be strictly positive");
+    }
+    crossovers[index] = frequency;
+    setup();
+  }
+
+  template<class GainParent>
+  double MultibandDynamicsFilter<GainParent>::get_crossover(gsl::index index) const
+  {
+    if(index < 0 || index >= nb_bands - 1)
+    {
+      throw ATK::RuntimeError("Crossover does not exist");
+    }
+    return crossovers[index];
+  }
+
+  template<class GainParent>
+  void MultibandDynamicsFilter<GainParent>::check_band(gsl::index band) const
+  {
+    if(band < 0 || band >= nb_bands)
+    {
+      throw ATK::RuntimeError("Band does not exist");
+    }
+  }
+
+  template<class GainParent>
+  auto MultibandDynamicsFilter<GainParent>::get_gain_computer(gsl::index band) -> GainComputer&
+  {
+    check_band(band);
+    return *gain_computers[band];
+  }
+
+  template<class GainParent>
+  auto MultibandDynamicsFilter<GainParent>::get_gain_computer(gsl::index band) const -> const GainComputer&
+  {
+    check_band(band);
+    return *gain_computers[band];
+  }
+
+  template<class GainParent>
+  void MultibandDynamicsFilter<GainParent>::set_memory(gsl::index band, DataType memory_factor)
+  {
+    check_band(band);
+    if(memory_factor < 0 || memory_factor >= 1)
+    {
+      throw ATK::RuntimeError("Memory factor must be a positive value less than 1 (so that it doesn't diverge)");
+    }
+    memories[band] = memory_factor;
+  }
+
+  template<class GainParent>
+  auto MultibandDynamicsFilter<GainParent>::get_memory(gsl::index band) const -> DataType
+  {
+    check_band(band);
+    return memories[band];
+  }
+
+  template<class GainParent>
+  void MultibandDynamicsFilter<GainParent>::set_attack(gsl::index band, DataType attack)
+  {
+    check_band(band);
+    if(attack < 0 || attack > 1)
+    {
+      throw ATK::RuntimeError("Attack factor must be between 0 and 1");
+    }
+    attacks[band] = attack;
+  }
+
+  template<class GainParent>
+  auto MultibandDynamicsFilter<GainParent>::get_attack(gsl::index band) const -> DataType
+  {
+    check_band(band);
+    return attacks[band];
+  }
+
+  template<class GainParent>
+  void MultibandDynamicsFilter<GainParent>::set_release(gsl::index band, DataType release)
+  {
+    check_band(band);
+    if(release < 0 || release > 1)
+    {
+      throw ATK::RuntimeError("Release factor must be between 0 and 1");
+    }
+    releases[band] = release;
+  }
+
+  template<class GainParent>
+  auto MultibandDynamicsFilter<GainParent>::get_release(gsl::index band) const -> DataType
+  {
+    check_band(band);
+    return releases[band];
+  }
+
+  template<class GainParent>
+  void MultibandDynamicsFilter<GainParent>::set_lookahead(gsl::index lookahead)
+  {
+    if(lookahead < 0)
+    {
+      throw ATK::RuntimeError("Lookahead must be positive");
+    }
+    this->lookahead = lookahead;
+    this->set_latency(lookahead);
+    setup();
+  }
+
+  template<class GainParent>
+  gsl::index MultibandDynamicsFilter<GainParent>::get_lookahead() const
+  {
+    return lookahead;
+  }
+
+  template<class GainParent>
+  gsl::index MultibandDynamicsFilter<GainParent>::get_nb_groups() const
+  {
+    return (nb_output_ports + nb_lanes - 1) / nb_lanes;
+  }
+
+  template<class GainParent>
+  void MultibandDynamicsFilter<GainParent>::setup()
+  {
+    Parent::setup();
+
+    if(input_sampling_rate > 0)
+    {
+      for(gsl::index index = 0; index < nb_bands - 1; ++index)
+      {
+        auto& low_pass = low_passes[index];
+        auto& high_pass = high_passes[index];
+        low_pass.set_input_sampling_rate(input_sampling_rate);
+        low_pass.set_output_sampling_rate(input_sampling_rate);
+        low_pass.set_cut_frequency(crossovers[index]);
+        high_pass.set_input_sampling_rate(input_sampling_rate);
+        high_pass.set_output_sampling_rate(input_sampling_rate);
+        high_pass.set_cut_frequency(crossovers[index]);
+        // The IIR filters store the coefficients from the oldest sample
+        for(gsl::index j = 0; j < 5; ++j)
+        {
+          low_coefficients[index][j] = low_pass.get_coefficients_in()[4 - j];
+          high_coefficients[index][j] = high_pass.get_coefficients_in()[4 - j];
+        }
+        for(gsl::index j = 0; j < 4; ++j)
+        {
+          low_coefficients[index][j + 5] = low_pass.get_coefficients_out()[3 - j];
+          high_coefficients[index][j + 5] = high_pass.get_coefficients_out()[3 - j];
+        }
+
+        // The sum of the Linkwitz-Riley filters is (s^4 + wc^4) / (s^2 + sqrt(2) wc s + wc^2)^2, the allpass
+        // (s^2 - sqrt(2) wc s + wc^2) / (s^2 + sqrt(2) wc s + wc^2), with the same bilinear transform
+        auto wc = 2 * boost::math::constants::pi<double>() * crossovers[index];
+        auto k = wc / std::tan(wc / 2 / input_sampling_rate);
+        auto a0 = k * k + std::sqrt(2.) * wc * k + wc * wc;
+        auto a1 = 2 * (wc * wc - k * k);
+        auto a2 = k * k - std::sqrt(2.) * wc * k + wc * wc;
+        allpass_coefficients[index] = {{a1 / a0, a2 / a0}};
+      }
+    }
+
+    // The states are kept when only the coefficients change
+    auto nb_groups = get_nb_groups();
+    auto crossover_size = static_cast<std::size_t>(nb_groups * (nb_bands - 1) * 8);
+    if(crossover_state.size() != crossover_size)
+    {
+      crossover_state.assign(crossover_size, BatchType(0.));
+    }
+    auto sidechain_size = sidechain ? crossover_size : 0;
+    if(sidechain_state.size() != sidechain_size)
+    {
+      sidechain_state.assign(sidechain_size, BatchType(0.));
+    }
+    auto band_size = static_cast<std::size_t>(nb_groups * (2 * (nb_bands - 1) + 2 * nb_bands));
+    if(band_state.size() != band_size)
+    {
+      band_state.assign(band_size, BatchType(0.));
+    }
+    auto delay_size = static_cast<std::size_t>(nb_groups * nb_bands * lookahead);
+    if(delay_line.size() != delay_size)
+    {
+      delay_line.assign(delay_size, BatchType(0.));
+      delay_position = 0;
+    }
+  }
+
+  template<class GainParent>
+  void MultibandDynamicsFilter<GainParent>::full_setup()
+  {
+    crossover_state.clear();
+    sidechain_state.clear();
+    band_state.clear();
+    delay_line.clear();
+    Parent::full_setup();
+  }
+
+  template<class GainParent>
+  void MultibandDynamicsFilter<GainParent>::preallocate(gsl::index size)
+  {
+    Parent::preallocate(size);
+    resize_buffers(size);
+  }
+
+  template<class GainParent>
+  void MultibandDynamicsFilter<GainParent>::resize_buffers(gsl::index size) const
+  {
+    if(interleaved.size() < static_cast<std::size_t>(size))
+    {
+      interleaved.resize(size);
+    }
+    if(signal_bands.size() < static_cast<std::size_t>(nb_bands * size))
+    {
+      signal_bands.resize(nb_bands * size);
+    }
+    if(sidechain && sidechain_bands.size() < static_cast<std::size_t>(nb_bands * size))
+    {
+      sidechain_bands.resize(nb_bands * size);
+    }
+    if(powers.size() < static_cast<std::size_t>(nb_bands * size * nb_lanes))
+    {
+      powers.resize(nb_bands * size * nb_lanes);
+      gains.resize(nb_bands * size * nb_lanes);
+    }
+  }
+
+  template<class GainParent>
+  void MultibandDynamicsFilter<GainParent>::process_impl(gsl::index size) const
+  {
+    assert(input_sampling_rate == output_sampling_rate);
+    assert(crossover_state.size() == static_cast<std::size_t>(get_nb_groups() * (nb_bands - 1) * 8));
+
+    resize_buffers(size);
+    for(gsl::index group = 0; group < get_nb_groups(); ++group)
+    {
+      process_group(group, size);
+    }
+    if(lookahead > 0)
+    {
+      delay_position = (delay_position + size) % lookahead;
+    }
+  }
+
+  template<class GainParent>
+  void MultibandDynamicsFilter<GainParent>::process_group(gsl::index group, gsl::index size) const
+  {
+    auto first_channel = group * nb_lanes;
+    auto nb_channels = std::min(nb_lanes, nb_output_ports - first_channel);
+    auto crossover_offset = group * (nb_bands - 1) * 8;
+    auto* ATK_RESTRICT state = band_state.data() + group * (2 * (nb_bands - 1) + 2 * nb_bands);
+
+    interleave(first_channel, nb_channels, size);
+    split(signal_bands.data(), crossover_state.data() + crossover_offset, size);
+    if(sidechain)
+    {
+      interleave(nb_output_ports + first_channel, nb_channels, size);
+      split(sidechain_bands.data(), sidechain_state.data() + crossover_offset, size);
+      detect(sidechain_bands.data(), state + 2 * (nb_bands - 1), size);
+    }
+    else
+    {
+      detect(signal_bands.data(), state + 2 * (nb_bands - 1), size);
+    }
+
+    // The channels stay interleaved, each gain computer processes all the lanes of its band at once
+    for(gsl::index band = 0; band < nb_bands; ++band)
+    {
+      const DataType* power = powers.data() + band * size * nb_lanes;
+      DataType* gain = gains.data() + band * size * nb_lanes;
+      gain_computers[band]->compute_gains(&power, &gain, 1, size * nb_lanes);
+    }
+
+    recombine(signal_bands.data(), state, delay_line.data() + group * nb_bands * lookahead, size);
+
+    for(gsl::index lane = 0; lane < nb_channels; ++lane)
+    {
+      DataType* ATK_RESTRICT channel_output = outputs[first_channel + lane];
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        channel_output[i] = static_cast<DataType>(interleaved[i][lane]);
+      }
+    }
+  }
+
+  template<class GainParent>
+  void MultibandDynamicsFilter<GainParent>::interleave(gsl::index first_port, gsl::index nb_channels, gsl::index size) const
+  {
+    BatchType* ATK_RESTRICT buffer = interleaved.data();
+    for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+    {
+      if(lane < nb_channels)
+      {
+        const DataType* ATK_RESTRICT channel_input = converted_inputs[first_port + lane];
+        for(gsl::index i = 0; i < size; ++i)
+        {
+          buffer[i][lane] = static_cast<double>(channel_input[i]);
+        }
+      }
+      else
+      {
+        for(gsl::index i = 0; i < size; ++i)
+        {
+          buffer[i][lane] = 0;
+        }
+      }
+    }
+  }
+
+  template<class GainParent>
+  void MultibandDynamicsFilter<GainParent>::split(BatchType* ATK_RESTRICT bands, BatchType* ATK_RESTRICT state, gsl::index size) const
+  {
+    const BatchType* ATK_RESTRICT buffer = interleaved.data();
+    for(gsl::index i = 0; i < size; ++i)
+    {
+      BatchType rest = buffer[i];
+      for(gsl::index index = 0; index < nb_bands - 1; ++index)
+      {
+        bands[index * size + i] = fourth_order(low_coefficients[index], state + 8 * index, rest);
+        rest = fourth_order(high_coefficients[index], state + 8 * index + 4, rest);
+      }
+      bands[(nb_bands - 1) * size + i] = rest;
+    }
+  }
+
+  template<class GainParent>
+  void MultibandDynamicsFilter<GainParent>::detect(const BatchType* ATK_RESTRICT bands, BatchType* ATK_RESTRICT state, gsl::index size) const
+  {
+    for(gsl::index band = 0; band < nb_bands; ++band)
+    {
+      const BatchType* ATK_RESTRICT input = bands + band * size;
+      DataType* ATK_RESTRICT output = powers.data() + band * size * nb_lanes;
+      double memory = memories[band];
+      double attack = attacks[band];
+      double release = releases[band];
+      BatchType power = state[2 * band];
+      BatchType envelope = state[2 * band + 1];
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+        {
+          power[lane] = (1 - memory) * input[i][lane] * input[i][lane] + memory * power[lane];
+          auto factor = envelope[lane] > power[lane] ? release : attack;
+          envelope[lane] = (1 - factor) * power[lane] + factor * envelope[lane];
+          output[i * nb_lanes + lane] = static_cast<DataType>(envelope[lane]);
+        }
+      }
+      state[2 * band] = power;
+      state[2 * band + 1] = envelope;
+    }
+  }
+
+  template<class GainParent>
+  void MultibandDynamicsFilter<GainParent>::recombine(BatchType* ATK_RESTRICT bands, BatchType* ATK_RESTRICT state, BatchType* ATK_RESTRICT delay_line, gsl::index size) const
+  {
+    BatchType* ATK_RESTRICT buffer = interleaved.data();
+    auto position = delay_position;
+    for(gsl::index i = 0; i < size; ++i)
+    {
+      BatchType sum(0.);
+      for(gsl::index band = 0; band < nb_bands; ++band)
+      {
+        BatchType value = bands[band * size + i];
+        if(lookahead > 0)
+        {
+          std::swap(value, delay_line[band * lookahead + position]);
+        }
+        // The lower bands have not been through this crossover
+        if(band > 0 && band < nb_bands - 1)
+        {
+          sum = allpass(allpass_coefficients[band], state + 2 * band, sum);
+        }
+        const DataType* ATK_RESTRICT gain = gains.data() + (band * size + i) * nb_lanes;
+        for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+        {
+          sum[lane] += gain[lane] * value[lane];
+        }
+      }
+      buffer[i] = sum;
+      if(lookahead > 0)
+      {
+        position = (position + 1) % lookahead;
+      }
+    }
+  }
+
+#if ATK_ENABLE_INSTANTIATION
+  template class MultibandDynamicsFilter<GainCompressorFilter<float>>;
+  template class MultibandDynamicsFilter<GainExpanderFilter<float>>;
+  template class MultibandDynamicsFilter<GainLimiterFilter<float>>;
+#endif
+  template class MultibandDynamicsFilter<GainCompressorFilter<double>>;
+  template class MultibandDynamicsFilter<GainExpanderFilter<double>>;
+  template class MultibandDynamicsFilter<GainLimiterFilter<double>>;
+}
@@ -0,0 +1,175 @@
+/**
+ * \file MultibandDynamicsFilter.h
+ */
+
+#ifndef ATK_DYNAMIC_MULTIBANDDYNAMICSFILTER_H
+#define ATK_DYNAMIC_MULTIBANDDYNAMICSFILTER_H
+
+#include <ATK/Core/TypedBaseFilter.h>
+#include <ATK/Dynamic/GainFilter.h>
+#include <ATK/Dynamic/config.h>
+#include <ATK/EQ/IIRFilter.h>
+#include <ATK/EQ/LinkwitzRileyFilter.h>
+#include <ATK/Utility/Batch.h>
+
+#include <boost/align/aligned_allocator.hpp>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace ATK
+{
+  /// Multiband dynamics processor, each band with its own detector, ballistics and gain computer
+  /*!
+   * The signal is split by a cascade of 4th order Linkwitz-Riley crossovers, the first band is the lowest one. Each band
+   * then goes through the same chain as PowerFilter, AttackReleaseFilter, GainFilter<GainParent> and ApplyGainFilter.
+   * The bands are summed from the lowest one, each partial sum going through the allpass response of the next crossover
+   * (the sum of its low and high pass filters), so that the output is an allpass version of the input when no gain is
+   * applied.
+   *
+   * The first nb_channels input ports are the signals. With a sidechain, the next nb_channels ports are split by the
+   * same crossovers and drive the detectors instead. The signal bands can be delayed (lookahead) so that the gains
+   * anticipate them, the delay is the latency of the filter.
+   *
+   * Channels are interleaved in the lanes of a Batch and all the bands are split, detected and summed together. The
+   * crossovers and the ballistics run in double precision, as the low crossovers are too close to the unit circle.
+   */
+  template<class GainParent>
+  class ATK_DYNAMIC_EXPORT MultibandDynamicsFilter final : public TypedBaseFilter<typename GainParent::DataType>
+  {
+  protected:
+    /// Simplify parent calls
+    using Parent = TypedBaseFilter<typename GainParent::DataType>;
+    using typename Parent::DataType;
+    using typename Parent::AlignedScalarVector;
+    using Parent::converted_inputs;
+    using Parent::outputs;
+    using Parent::input_sampling_rate;
+    using Parent::output_sampling_rate;
+    using Parent::nb_input_ports;
+    using Parent::nb_output_ports;
+
+    static constexpr gsl::index nb_lanes = native_batch_size<double>();
+    using BatchType = Batch<double, nb_lanes>;
+    using AlignedBatchVector = std::vector<BatchType, boost::alignment::aligned_allocator<BatchType, alignof(BatchType)> >;
+
+  public:
+    /// The gain computer of a band
+    using GainComputer = GainFilter<GainParent>;
+
+    /// Smallest number of bands
+    static constexpr gsl::index min_bands = 2;
+    /// Largest number of bands
+    static constexpr gsl::index max_bands = 8;
+
+    /*!
+     * @brief Constructor
+     * @param nb_channels is the number of output channels
+     * @param nb_bands is the number of bands, between 2 and 8
+     * @param sidechain adds nb_channels input ports for the detection
+     */
+    MultibandDynamicsFilter(gsl::index nb_channels = 1, gsl::index nb_bands = 2, bool sidechain = false);
+    /// Destructor
+    ~MultibandDynamicsFilter() override = default;
+
+    /// Returns the number of bands
+    gsl::index get_nb_bands() const;
+    /// Does the detection use the sidechain ports?
+    bool has_sidechain() const;
+
+    /// Sets the frequency between band index and band index + 1, the frequencies should be increasing
+    void set_crossover(gsl::index index, double frequency);
+    /// Returns the frequency between band index and band index + 1
+    double get_crossover(gsl::index index) const;
+
+    /// Returns the gain computer of a band, to set its threshold, ratio...
+    GainComputer& get_gain_computer(gsl::index band);
+    /// Returns the gain computer of a band
+    const GainComputer& get_gain_computer(gsl::index band) const;
+
+    /// Sets the memory of the AR1 computing the power of a band (must be between 0 and 1)
+    void set_memory(gsl::index band, DataType memory_factor);
+    /// Returns the memory of a band
+    DataType get_memory(gsl::index band) const;
+    /// Sets the attack factor of the power of a band (between 0 and 1)
+    void set_attack(gsl::index band, DataType attack);
+    /// Returns the attack factor of a band
+    DataType get_attack(gsl::index band) const;
+    /// Sets the release factor of the power of a band (between 0 and 1)
+    void set_release(gsl::index band, DataType release);
+    /// Returns the release factor of a band
+    DataType get_release(gsl::index band) const;
+
+    /// Sets the delay of the signal compared to the detection, in samples
+    void set_lookahead(gsl::index lookahead);
+    /// Returns the delay of the signal compared to the detection
+    gsl::index get_lookahead() const;
+
+  protected:
+    void setup() final;
+    void full_setup() final;
+    void preallocate(gsl::index size) final;
+    void process_impl(gsl::index size) const final;
+
+  private:
+    /// Number of groups of nb_lanes channels
+    gsl::index get_nb_groups() const;
+    /// Checks a band index
+    void check_band(gsl::index band) const;
+    /// Makes room for the interleaved bands of a block
+    void resize_buffers(gsl::index size) const;
+
+    /// Processes the channels of one group
+    void process_group(gsl::index group, gsl::index size) const;
+    /// Interleaves up to nb_lanes ports, unused lanes are set to 0
+    void interleave(gsl::index first_port, gsl::index nb_channels, gsl::index size) const;
+    /// Splits the interleaved ports in bands, band major
+    void split(BatchType* ATK_RESTRICT bands, BatchType* ATK_RESTRICT state, gsl::index size) const;
+    /// Computes the smoothed powers of the bands, as the input of the gain computers
+    void detect(const BatchType* ATK_RESTRICT bands, BatchType* ATK_RESTRICT state, gsl::index size) const;
+    /// Applies the gains and sums the bands in the interleaved buffer
+    void recombine(BatchType* ATK_RESTRICT bands, BatchType* ATK_RESTRICT state, BatchType* ATK_RESTRICT delay_line, gsl::index size) const;
+
+    gsl::index nb_bands;
+    bool sidechain;
+    gsl::index lookahead{0};
+
+    std::vector<double> crossovers;
+    /// Linkwitz-Riley filters of each crossover, used for their coefficients
+    std::vector<IIRFilter<LinkwitzRiley4LowPassCoefficients<double> > > low_passes;
+    std::vector<IIRFilter<LinkwitzRiley4HighPassCoefficients<double> > > high_passes;
+    /// b0..b4 then a1..a4 (added) of each filter
+    std::vector<std::array<double, 9> > low_coefficients;
+    std::vector<std::array<double, 9> > high_coefficients;
+    /// a1 and a2 of the allpass response of each crossover, b0 is a2, b1 is a1 and b2 is 1
+    std::vector<std::array<double, 2> > allpass_coefficients;
+
+    std::vector<std::unique_ptr<GainComputer> > gain_computers;
+    std::vector<DataType> memories;
+    std::vector<DataType> attacks;
+    std::vector<DataType> releases;
+
+    /// For each group, 4 states for each low and high pass filter of each crossover
+    mutable AlignedBatchVector crossover_state;
+    /// Same for the sidechain crossovers
+    mutable AlignedBatchVector sidechain_state;
+    /// For each group, 2 states for the allpass of each crossover, then the power and the smoothed power of each band
+    mutable AlignedBatchVector band_state;
+    /// For each group, the delayed signal of each band
+    mutable AlignedBatchVector delay_line;
+    /// Position of the next sample in the delay lines
+    mutable gsl::index delay_position{0};
+
+    /// The interleaved channels of a block, inputs then outputs
+    mutable AlignedBatchVector interleaved;
+    /// The bands of the signal and of the sidechain
+    mutable AlignedBatchVector signal_bands;
+    mutable AlignedBatchVector sidechain_bands;
+    /// Smoothed powers then gains of each band, with the channels interleaved
+    mutable AlignedScalarVector powers;
+    mutable AlignedScalarVector gains;
+  };
+}
+
+#endif
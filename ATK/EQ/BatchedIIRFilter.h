@@ -0,0 +1,185 @@
+/**
+ * \file BatchedIIRFilter.h
+ */
+
+#ifndef ATK_EQ_BATCHEDIIRFILTER_H
+#define ATK_EQ_BATCHEDIIRFILTER_H
+
+#include <ATK/config.h>
+#include <ATK/Core/TypeTraits.h>
+#include <ATK/EQ/config.h>
+#include <ATK/Utility/Batch.h>
+
+#include <boost/align/aligned_allocator.hpp>
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace ATK
+{
+  /// IIR filter template class (Direct Form I) processing several channels at once
+  /*!
+   * Channels are interleaved in the lanes of a Batch, so that each step of the recursion advances up to nb_lanes channels
+   * with vector instructions. Use it instead of IIRFilter for filters with many channels.
+   */
+  template<class Coefficients, gsl::index nb_lanes = native_batch_size<typename Coefficients::DataType>()>
+  class BatchedIIRFilter final : public Coefficients
+  {
+  protected:
+    /// Simplify parent calls
+    using Parent = Coefficients;
+    using typename Parent::DataType;
+    using typename Parent::AlignedScalarVector;
+    using Parent::converted_inputs;
+    using Parent::outputs;
+    using Parent::coefficients_in;
+    using Parent::coefficients_out;
+    using Parent::input_sampling_rate;
+    using Parent::output_sampling_rate;
+    using Parent::nb_input_ports;
+    using Parent::nb_output_ports;
+
+    using Parent::in_order;
+    using Parent::out_order;
+    using Parent::input_delay;
+    using Parent::output_delay;
+    using Parent::setup;
+
+    using BatchType = Batch<DataType, nb_lanes>;
+    using AlignedBatchVector = std::vector<BatchType, boost::alignment::aligned_allocator<BatchType, alignof(BatchType)> >;
+
+  public:
+    /*!
+     * @brief Constructor
+     * @param nb_channels is the number of input and output channels
+     */
+    explicit BatchedIIRFilter(gsl::index nb_channels = 1)
+      :Parent(nb_channels)
+    {
+    }
+
+    /// Move constructor
+    BatchedIIRFilter(BatchedIIRFilter&& other)
+    :Parent(std::move(other))
+    {
+    }
+
+    void setup() final
+    {
+      Parent::setup();
+      input_delay = in_order;
+      output_delay = out_order;
+    }
+
+    void process_impl(gsl::index size) const final
+    {
+      assert(input_sampling_rate == output_sampling_rate);
+      assert(nb_input_ports == nb_output_ports);
+      assert(coefficients_in.data());
+      assert(out_order == 0 || coefficients_out.data() != nullptr);
+
+      resize_batches(size);
+      const auto* ATK_RESTRICT coefficients_in_ptr = coefficients_in.data();
+      const auto* ATK_RESTRICT coefficients_out_ptr = coefficients_out.data();
+      BatchType* ATK_RESTRICT input = batched_input.data();
+      BatchType* ATK_RESTRICT output = batched_output.data();
+
+      for(gsl::index first_channel = 0; first_channel < nb_input_ports; first_channel += nb_lanes)
+      {
+        auto nb_channels = std::min(nb_lanes, nb_input_ports - first_channel);
+
+        // Interleave the channels, with their history, unused lanes are set to 0
+        for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+        {
+          if(lane < nb_channels)
+          {
+            const DataType* ATK_RESTRICT channel_input = converted_inputs[first_channel + lane] - static_cast<int64_t>(in_order);
+            const DataType* ATK_RESTRICT channel_output = outputs[first_channel + lane] - static_cast<int64_t>(out_order);
+            for(gsl::index i = 0; i < in_order + size; ++i)
+            {
+              input[i][lane] = channel_input[i];
+            }
+            for(gsl::index i = 0; i < out_order; ++i)
+            {
+              output[i][lane] = channel_output[i];
+            }
+          }
+          else
+          {
+            for(gsl::index i = 0; i < in_order + size; ++i)
+            {
+              input[i][lane] = TypeTraits<DataType>::Zero();
+            }
+            for(gsl::index i = 0; i < out_order; ++i)
+            {
+              output[i][lane] = TypeTraits<DataType>::Zero();
+            }
+          }
+        }
+
+        for(gsl::index i = 0; i < size; ++i)
+        {
+          BatchType value(TypeTraits<DataType>::Zero());
+          for(gsl::index j = 0; j < in_order + 1; ++j)
+          {
+            value.multiply_add(coefficients_in_ptr[j], input[i + j]);
+          }
+          for(gsl::index j = 0; j < out_order; ++j)
+          {
+            value.multiply_add(coefficients_out_ptr[j], output[i + j]);
+          }
+          output[out_order + i] = value;
+        }
+
+        for(gsl::index lane = 0; lane < nb_channels; ++lane)
+        {
+          DataType* ATK_RESTRICT channel_output = outputs[first_channel + lane];
+          for(gsl::index i = 0; i < size; ++i)
+          {
+            channel_output[i] = output[out_order + i][lane];
+          }
+        }
+      }
+    }
+
+    /// Returns the vector of internal coefficients for the MA section
+    const AlignedScalarVector& get_coefficients_in() const
+    {
+      return coefficients_in;
+    }
+
+    /// Returns the vector of internal coefficients for the AR section, without degree 0 implicitely set to -1
+    const AlignedScalarVector& get_coefficients_out() const
+    {
+      return coefficients_out;
+    }
+
+  protected:
+    void preallocate(gsl::index size) final
+    {
+      Parent::preallocate(size);
+      resize_batches(size);
+    }
+
+  private:
+    /// Makes room for the interleaved channels of a block and of their history
+    void resize_batches(gsl::index size) const
+    {
+      if(batched_input.size() < static_cast<std::size_t>(in_order + size))
+      {
+        batched_input.resize(in_order + size);
+      }
+      if(batched_output.size() < static_cast<std::size_t>(out_order + size))
+      {
+        batched_output.resize(out_order + size);
+      }
+    }
+
+    mutable AlignedBatchVector batched_input;
+    mutable AlignedBatchVector batched_output;
+  };
+}
+
+#endif
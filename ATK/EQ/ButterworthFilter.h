@@ -36,6 +36,10 @@ namespace ATK
     AlignedScalarVector coefficients_in;
     /// Coefficients of the AR part of the IIR filter
     AlignedScalarVector coefficients_out;
+    /// Coefficients of the second order sections (b0, b1, b2, a1, a2 for each section), always in double precision
+    std::vector<double> coefficients_sections;
+    /// Also compute the second order sections during the setup
+    bool emit_sections{false};
     
   public:
     /*!
@@ -80,6 +84,10 @@ namespace ATK
     AlignedScalarVector coefficients_in;
     /// Coefficients of the AR part of the IIR filter
     AlignedScalarVector coefficients_out;
+    /// Coefficients of the second order sections (b0, b1, b2, a1, a2 for each section), always in double precision
+    std::vector<double> coefficients_sections;
+    /// Also compute the second order sections during the setup
+    bool emit_sections{false};
     
   public:
     /*!
@@ -124,6 +132,10 @@ namespace ATK
     AlignedScalarVector coefficients_in;
     /// Coefficients of the AR part of the IIR filter
     AlignedScalarVector coefficients_out;
+    /// Coefficients of the second order sections (b0, b1, b2, a1, a2 for each section), always in double precision
+    std::vector<double> coefficients_sections;
+    /// Also compute the second order sections during the setup
+    bool emit_sections{false};
     
   public:
     /*!
@@ -170,6 +182,10 @@ namespace ATK
     AlignedScalarVector coefficients_in;
     /// Coefficients of the AR part of the IIR filter
     AlignedScalarVector coefficients_out;
+    /// Coefficients of the second order sections (b0, b1, b2, a1, a2 for each section), always in double precision
+    std::vector<double> coefficients_sections;
+    /// Also compute the second order sections during the setup
+    bool emit_sections{false};
     
   public:
     /*!
@@ -22,34 +22,34 @@ namespace ButterworthUtilities
     }
   }
   
-  template<typename DataType, typename Container>
-  void create_default_coeffs(size_t order, DataType Wn, Container& coefficients_in, Container& coefficients_out)
+  template<typename DataType, typename Container, typename SectionsContainer = Container>
+  void create_default_coeffs(size_t order, DataType Wn, Container& coefficients_in, Container& coefficients_out, SectionsContainer* coefficients_sections = nullptr)
   {
     EQUtilities::ZPK<DataType> zpk;
 
     int fs = 2;
     create_butterworth_analog_coefficients(static_cast<int>(order), zpk);
-    EQUtilities::populate_lp_coeffs(Wn, fs, order, zpk, coefficients_in, coefficients_out);
+    EQUtilities::populate_lp_coeffs(Wn, fs, order, zpk, coefficients_in, coefficients_out, coefficients_sections);
   }
 
-  template<typename DataType, typename Container>
-  void create_bp_coeffs(size_t order, DataType wc1, DataType wc2, Container& coefficients_in, Container& coefficients_out)
+  template<typename DataType, typename Container, typename SectionsContainer = Container>
+  void create_bp_coeffs(size_t order, DataType wc1, DataType wc2, Container& coefficients_in, Container& coefficients_out, SectionsContainer* coefficients_sections = nullptr)
   {
     EQUtilities::ZPK<DataType> zpk;
 
     int fs = 2;
     create_butterworth_analog_coefficients(static_cast<int>(order/2), zpk);
-    EQUtilities::populate_bp_coeffs(wc1, wc2, fs, order, zpk, coefficients_in, coefficients_out);
+    EQUtilities::populate_bp_coeffs(wc1, wc2, fs, order, zpk, coefficients_in, coefficients_out, coefficients_sections);
   }
   
-  template<typename DataType, typename Container>
-  void create_bs_coeffs(size_t order, DataType wc1, DataType wc2, Container& coefficients_in, Container& coefficients_out)
+  template<typename DataType, typename Container, typename SectionsContainer = Container>
+  void create_bs_coeffs(size_t order, DataType wc1, DataType wc2, Container& coefficients_in, Container& coefficients_out, SectionsContainer* coefficients_sections = nullptr)
   {
     EQUtilities::ZPK<DataType> zpk;
 
     int fs = 2;
     create_butterworth_analog_coefficients(static_cast<int>(order/2), zpk);
-    EQUtilities::populate_bs_coeffs(wc1, wc2, fs, order, zpk, coefficients_in, coefficients_out);
+    EQUtilities::populate_bs_coeffs(wc1, wc2, fs, order, zpk, coefficients_in, coefficients_out, coefficients_sections);
   }
 }
 
@@ -102,7 +102,7 @@ namespace ATK
     coefficients_in.assign(in_order+1, 0);
     coefficients_out.assign(out_order, 0);
     
-    ButterworthUtilities::create_default_coeffs(in_order, 2 * cut_frequency / input_sampling_rate, coefficients_in, coefficients_out);
+    ButterworthUtilities::create_default_coeffs(in_order, 2 * cut_frequency / input_sampling_rate, coefficients_in, coefficients_out, emit_sections ? &coefficients_sections : nullptr);
   }
 
   template <typename DataType>
@@ -152,12 +152,16 @@ namespace ATK
     coefficients_in.assign(in_order+1, 0);
     coefficients_out.assign(out_order, 0);
     
-    ButterworthUtilities::create_default_coeffs(in_order, (input_sampling_rate - 2 * cut_frequency) / input_sampling_rate, coefficients_in, coefficients_out);
+    ButterworthUtilities::create_default_coeffs(in_order, (input_sampling_rate - 2 * cut_frequency) / input_sampling_rate, coefficients_in, coefficients_out, emit_sections ? &coefficients_sections : nullptr);
     for(gsl::index i = in_order - 1; i >= 0; i -= 2)
     {
       coefficients_in[i] = - coefficients_in[i];
       coefficients_out[i] = - coefficients_out[i];
     }
+    if(emit_sections)
+    {
+      EQUtilities::sos_lp2hp(coefficients_sections);
+    }
   }
 
   template <typename DataType>
@@ -213,7 +217,7 @@ namespace ATK
     coefficients_in.assign(in_order+1, 0);
     coefficients_out.assign(out_order, 0);
     
-    ButterworthUtilities::create_bp_coeffs(in_order, 2 * cut_frequencies.first / input_sampling_rate, 2 * cut_frequencies.second / input_sampling_rate, coefficients_in, coefficients_out);
+    ButterworthUtilities::create_bp_coeffs(in_order, 2 * cut_frequencies.first / input_sampling_rate, 2 * cut_frequencies.second / input_sampling_rate, coefficients_in, coefficients_out, emit_sections ? &coefficients_sections : nullptr);
   }
 
   template <typename DataType>
@@ -269,6 +273,6 @@ namespace ATK
     coefficients_in.assign(in_order+1, 0);
     coefficients_out.assign(out_order, 0);
     
-    ButterworthUtilities::create_bs_coeffs(in_order, 2 * cut_frequencies.first / input_sampling_rate, 2 * cut_frequencies.second / input_sampling_rate, coefficients_in, coefficients_out);
+    ButterworthUtilities::create_bs_coeffs(in_order, 2 * cut_frequencies.first / input_sampling_rate, 2 * cut_frequencies.second / input_sampling_rate, coefficients_in, coefficients_out, emit_sections ? &coefficients_sections : nullptr);
   }
 }
@@ -47,34 +47,34 @@ namespace Chebyshev1Utilities
     }
   }
   
-  template<typename DataType, typename Container>
-  void create_default_chebyshev1_coeffs(size_t order, DataType ripple, DataType Wn, Container& coefficients_in, Container& coefficients_out)
+  template<typename DataType, typename Container, typename SectionsContainer = Container>
+  void create_default_chebyshev1_coeffs(size_t order, DataType ripple, DataType Wn, Container& coefficients_in, Container& coefficients_out, SectionsContainer* coefficients_sections = nullptr)
   {
     EQUtilities::ZPK<DataType> zpk;
 
     int fs = 2;
     create_chebyshev1_analog_coefficients(static_cast<int>(order), ripple, zpk);
-    EQUtilities::populate_lp_coeffs(Wn, fs, order, zpk, coefficients_in, coefficients_out);
+    EQUtilities::populate_lp_coeffs(Wn, fs, order, zpk, coefficients_in, coefficients_out, coefficients_sections);
   }
   
-  template<typename DataType, typename Container>
-  void create_bp_chebyshev1_coeffs(size_t order, DataType ripple, DataType wc1, DataType wc2, Container& coefficients_in, Container& coefficients_out)
+  template<typename DataType, typename Container, typename SectionsContainer = Container>
+  void create_bp_chebyshev1_coeffs(size_t order, DataType ripple, DataType wc1, DataType wc2, Container& coefficients_in, Container& coefficients_out, SectionsContainer* coefficients_sections = nullptr)
   {
     EQUtilities::ZPK<DataType> zpk;
 
     int fs = 2;
     create_chebyshev1_analog_coefficients(static_cast<int>(order/2), ripple, zpk);
-    EQUtilities::populate_bp_coeffs(wc1, wc2, fs, order, zpk, coefficients_in, coefficients_out);
+    EQUtilities::populate_bp_coeffs(wc1, wc2, fs, order, zpk, coefficients_in, coefficients_out, coefficients_sections);
   }
   
-  template<typename DataType, typename Container>
-  void create_bs_chebyshev1_coeffs(size_t order, DataType ripple, DataType wc1, DataType wc2, Container& coefficients_in, Container& coefficients_out)
+  template<typename DataType, typename Container, typename SectionsContainer = Container>
+  void create_bs_chebyshev1_coeffs(size_t order, DataType ripple, DataType wc1, DataType wc2, Container& coefficients_in, Container& coefficients_out, SectionsContainer* coefficients_sections = nullptr)
   {
     EQUtilities::ZPK<DataType> zpk;
 
     int fs = 2;
     create_chebyshev1_analog_coefficients(static_cast<int>(order/2), ripple, zpk);
-    EQUtilities::populate_bs_coeffs(wc1, wc2, fs, order, zpk, coefficients_in, coefficients_out);
+    EQUtilities::populate_bs_coeffs(wc1, wc2, fs, order, zpk, coefficients_in, coefficients_out, coefficients_sections);
   }
 }
 
@@ -90,6 +90,7 @@ namespace ATK
   void Chebyshev1LowPassCoefficients<DataType_>::set_ripple(CoeffDataType ripple)
   {
     this->ripple = ripple;
+    this->sync_staged_parameters();
     setup();
   }
   
@@ -107,6 +108,7 @@ namespace ATK
       throw std::out_of_range("Frequency can't be negative");
     }
     this->cut_frequency = cut_frequency;
+    this->sync_staged_parameters();
     setup();
   }
   
@@ -137,10 +139,20 @@ namespace ATK
   void Chebyshev1LowPassCoefficients<DataType>::setup()
   {
     Parent::setup();
+    if(this->staged_design.is_committing())
+    {
+      return;
+    }
+    compute_coefficients(cut_frequency, ripple, coefficients_in, coefficients_out, coefficients_sections);
+  }
+
+  template <typename DataType>
+  void Chebyshev1LowPassCoefficients<DataType>::compute_coefficients(CoeffDataType cut_frequency, CoeffDataType ripple, AlignedScalarVector& coefficients_in, AlignedScalarVector& coefficients_out, std::vector<double>& coefficients_sections) const
+  {
     coefficients_in.assign(in_order+1, 0);
     coefficients_out.assign(out_order, 0);
     
-    Chebyshev1Utilities::create_default_chebyshev1_coeffs(in_order, ripple, 2 * cut_frequency / input_sampling_rate, coefficients_in, coefficients_out);
+    Chebyshev1Utilities::create_default_chebyshev1_coeffs(in_order, ripple, 2 * cut_frequency / input_sampling_rate, coefficients_in, coefficients_out, emit_sections ? &coefficients_sections : nullptr);
   }
   
   template <typename DataType>
@@ -157,6 +169,7 @@ namespace ATK
       throw std::out_of_range("Frequency can't be negative");
     }
     this->cut_frequency = cut_frequency;
+    this->sync_staged_parameters();
     setup();
   }
   
@@ -170,6 +183,7 @@ namespace ATK
   void Chebyshev1HighPassCoefficients<DataType_>::set_ripple(CoeffDataType ripple)
   {
     this->ripple = ripple;
+    this->sync_staged_parameters();
     setup();
   }
   
@@ -200,15 +214,29 @@ namespace ATK
   void Chebyshev1HighPassCoefficients<DataType>::setup()
   {
     Parent::setup();
+    if(this->staged_design.is_committing())
+    {
+      return;
+    }
+    compute_coefficients(cut_frequency, ripple, coefficients_in, coefficients_out, coefficients_sections);
+  }
+
+  template <typename DataType>
+  void Chebyshev1HighPassCoefficients<DataType>::compute_coefficients(CoeffDataType cut_frequency, CoeffDataType ripple, AlignedScalarVector& coefficients_in, AlignedScalarVector& coefficients_out, std::vector<double>& coefficients_sections) const
+  {
     coefficients_in.assign(in_order+1, 0);
     coefficients_out.assign(out_order, 0);
     
-    Chebyshev1Utilities::create_default_chebyshev1_coeffs(in_order, ripple, (input_sampling_rate - 2 * cut_frequency) / input_sampling_rate, coefficients_in, coefficients_out);
+    Chebyshev1Utilities::create_default_chebyshev1_coeffs(in_order, ripple, (input_sampling_rate - 2 * cut_frequency) / input_sampling_rate, coefficients_in, coefficients_out, emit_sections ? &coefficients_sections : nullptr);
     for(gsl::index i = in_order - 1; i >= 0; i -= 2)
     {
       coefficients_in[i] = - coefficients_in[i];
       coefficients_out[i] = - coefficients_out[i];
     }
+    if(emit_sections)
+    {
+      EQUtilities::sos_lp2hp(coefficients_sections);
+    }
   }
   
   template <typename DataType>
@@ -225,6 +253,7 @@ namespace ATK
       throw std::out_of_range("Frequencies can't be negative");
     }
     this->cut_frequencies = cut_frequencies;
+    this->sync_staged_parameters();
     setup();
   }
   
@@ -244,6 +273,7 @@ namespace ATK
   void Chebyshev1BandPassCoefficients<DataType_>::set_ripple(CoeffDataType ripple)
   {
     this->ripple = ripple;
+    this->sync_staged_parameters();
     setup();
   }
   
@@ -274,10 +304,20 @@ namespace ATK
   void Chebyshev1BandPassCoefficients<DataType>::setup()
   {
     Parent::setup();
+    if(this->staged_design.is_committing())
+    {
+      return;
+    }
+    compute_coefficients(cut_frequencies, ripple, coefficients_in, coefficients_out, coefficients_sections);
+  }
+
+  template <typename DataType>
+  void Chebyshev1BandPassCoefficients<DataType>::compute_coefficients(std::pair<CoeffDataType, CoeffDataType> cut_frequencies, CoeffDataType ripple, AlignedScalarVector& coefficients_in, AlignedScalarVector& coefficients_out, std::vector<double>& coefficients_sections) const
+  {
     coefficients_in.assign(in_order+1, 0);
     coefficients_out.assign(out_order, 0);
     
-    Chebyshev1Utilities::create_bp_chebyshev1_coeffs(in_order, ripple, 2 * cut_frequencies.first / input_sampling_rate, 2 * cut_frequencies.second / input_sampling_rate, coefficients_in, coefficients_out);
+    Chebyshev1Utilities::create_bp_chebyshev1_coeffs(in_order, ripple, 2 * cut_frequencies.first / input_sampling_rate, 2 * cut_frequencies.second / input_sampling_rate, coefficients_in, coefficients_out, emit_sections ? &coefficients_sections : nullptr);
   }
   
   template <typename DataType>
@@ -294,6 +334,7 @@ namespace ATK
       throw std::out_of_range("Frequencies can't be negative");
     }
     this->cut_frequencies = cut_frequencies;
+    this->sync_staged_parameters();
     setup();
   }
   
@@ -313,6 +354,7 @@ namespace ATK
   void Chebyshev1BandStopCoefficients<DataType_>::set_ripple(CoeffDataType ripple)
   {
     this->ripple = ripple;
+    this->sync_staged_parameters();
     setup();
   }
   
@@ -343,9 +385,19 @@ namespace ATK
   void Chebyshev1BandStopCoefficients<DataType>::setup()
   {
     Parent::setup();
+    if(this->staged_design.is_committing())
+    {
+      return;
+    }
+    compute_coefficients(cut_frequencies, ripple, coefficients_in, coefficients_out, coefficients_sections);
+  }
+
+  template <typename DataType>
+  void Chebyshev1BandStopCoefficients<DataType>::compute_coefficients(std::pair<CoeffDataType, CoeffDataType> cut_frequencies, CoeffDataType ripple, AlignedScalarVector& coefficients_in, AlignedScalarVector& coefficients_out, std::vector<double>& coefficients_sections) const
+  {
     coefficients_in.assign(in_order+1, 0);
     coefficients_out.assign(out_order, 0);
     
-    Chebyshev1Utilities::create_bs_chebyshev1_coeffs(in_order, ripple, 2 * cut_frequencies.first / input_sampling_rate, 2 * cut_frequencies.second / input_sampling_rate, coefficients_in, coefficients_out);
+    Chebyshev1Utilities::create_bs_chebyshev1_coeffs(in_order, ripple, 2 * cut_frequencies.first / input_sampling_rate, 2 * cut_frequencies.second / input_sampling_rate, coefficients_in, coefficients_out, emit_sections ? &coefficients_sections : nullptr);
   }
 }
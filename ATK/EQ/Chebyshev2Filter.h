@@ -7,12 +7,13 @@
 
 #include <ATK/Core/TypedBaseFilter.h>
 #include <ATK/EQ/EQInterface.h>
+#include <ATK/EQ/StagedDesign.h>
 
 namespace ATK
 {
   /// @brief Chebyshev 2 coeffs for a low pass filter
   template<typename DataType_>
-  class Chebyshev2LowPassCoefficients: public TypedBaseFilter<DataType_>, public OrderInterface, public SingleCutFrequencyInterface<typename TypeTraits<DataType_>::Scalar>, public RippleInterface<typename TypeTraits<DataType_>::Scalar>
+  class Chebyshev2LowPassCoefficients: public TypedBaseFilter<DataType_>, public OrderInterface, public SingleCutFrequencyInterface<typename TypeTraits<DataType_>::Scalar>, public RippleInterface<typename TypeTraits<DataType_>::Scalar>, public StagedSingleCutRippleDesign<Chebyshev2LowPassCoefficients<DataType_>, DataType_>
   {
   public:
     /// Simplify parent calls
@@ -38,7 +39,16 @@ namespace ATK
     AlignedScalarVector coefficients_in;
     /// Coefficients of the AR part of the IIR filter
     AlignedScalarVector coefficients_out;
-    
+    /// Coefficients of the second order sections (b0, b1, b2, a1, a2 for each section), always in double precision
+    std::vector<double> coefficients_sections;
+    /// Also compute the second order sections during the setup
+    bool emit_sections{false};
+    /// Designs the coefficients of a cut frequency and a ripple in the given buffers
+    void compute_coefficients(CoeffDataType cut_frequency, CoeffDataType ripple, AlignedScalarVector& coefficients_in, AlignedScalarVector& coefficients_out, std::vector<double>& coefficients_sections) const;
+
+    /// The staging designs with compute_coefficients and swaps the coefficients in
+    friend class StagedCutRippleDesign<Chebyshev2LowPassCoefficients<DataType_>, DataType_, CoeffDataType>;
+
   public:
     /*!
      * @brief Constructor
@@ -62,7 +72,7 @@ namespace ATK
   
   /// @brief Chebyshev 2 coeffs for a high pass filter
   template<typename DataType_>
-  class Chebyshev2HighPassCoefficients: public TypedBaseFilter<DataType_>, public OrderInterface, public SingleCutFrequencyInterface<typename TypeTraits<DataType_>::Scalar>, public RippleInterface<typename TypeTraits<DataType_>::Scalar>
+  class Chebyshev2HighPassCoefficients: public TypedBaseFilter<DataType_>, public OrderInterface, public SingleCutFrequencyInterface<typename TypeTraits<DataType_>::Scalar>, public RippleInterface<typename TypeTraits<DataType_>::Scalar>, public StagedSingleCutRippleDesign<Chebyshev2HighPassCoefficients<DataType_>, DataType_>
   {
   public:
     /// Simplify parent calls
@@ -88,7 +98,16 @@ namespace ATK
     AlignedScalarVector coefficients_in;
     /// Coefficients of the AR part of the IIR filter
     AlignedScalarVector coefficients_out;
-    
+    /// Coefficients of the second order sections (b0, b1, b2, a1, a2 for each section), always in double precision
+    std::vector<double> coefficients_sections;
+    /// Also compute the second order sections during the setup
+    bool emit_sections{false};
+    /// Designs the coefficients of a cut frequency and a ripple in the given buffers
+    void compute_coefficients(CoeffDataType cut_frequency, CoeffDataType ripple, AlignedScalarVector& coefficients_in, AlignedScalarVector& coefficients_out, std::vector<double>& coefficients_sections) const;
+
+    /// The staging designs with compute_coefficients and swaps the coefficients in
+    friend class StagedCutRippleDesign<Chebyshev2HighPassCoefficients<DataType_>, DataType_, CoeffDataType>;
+
   public:
     /*!
      * @brief Constructor
@@ -112,7 +131,7 @@ namespace ATK
   
   /// @brief Chebyshev 2 coeffs for a band pass filter
   template<typename DataType_>
-  class Chebyshev2BandPassCoefficients: public TypedBaseFilter<DataType_>, public OrderInterface, public RippleInterface<typename TypeTraits<DataType_>::Scalar>, public DualCutFrequencyInterface<typename TypeTraits<DataType_>::Scalar>
+  class Chebyshev2BandPassCoefficients: public TypedBaseFilter<DataType_>, public OrderInterface, public RippleInterface<typename TypeTraits<DataType_>::Scalar>, public DualCutFrequencyInterface<typename TypeTraits<DataType_>::Scalar>, public StagedDualCutRippleDesign<Chebyshev2BandPassCoefficients<DataType_>, DataType_>
   {
   public:
     /// Simplify parent calls
@@ -138,7 +157,16 @@ namespace ATK
     AlignedScalarVector coefficients_in;
     /// Coefficients of the AR part of the IIR filter
     AlignedScalarVector coefficients_out;
-    
+    /// Coefficients of the second order sections (b0, b1, b2, a1, a2 for each section), always in double precision
+    std::vector<double> coefficients_sections;
+    /// Also compute the second order sections during the setup
+    bool emit_sections{false};
+    /// Designs the coefficients of a bandwidth and a ripple in the given buffers
+    void compute_coefficients(std::pair<CoeffDataType, CoeffDataType> cut_frequencies, CoeffDataType ripple, AlignedScalarVector& coefficients_in, AlignedScalarVector& coefficients_out, std::vector<double>& coefficients_sections) const;
+
+    /// The staging designs with compute_coefficients and swaps the coefficients in
+    friend class StagedCutRippleDesign<Chebyshev2BandPassCoefficients<DataType_>, DataType_, std::pair<CoeffDataType, CoeffDataType> >;
+
   public:
     /*!
      * @brief Constructor
@@ -164,7 +192,7 @@ namespace ATK
   
   /// @brief Chebyshev 2 coeffs for a band stop filter
   template<typename DataType_>
-  class Chebyshev2BandStopCoefficients: public TypedBaseFilter<DataType_>, public OrderInterface, public RippleInterface<typename TypeTraits<DataType_>::Scalar>, public DualCutFrequencyInterface<typename TypeTraits<DataType_>::Scalar>
+  class Chebyshev2BandStopCoefficients: public TypedBaseFilter<DataType_>, public OrderInterface, public RippleInterface<typename TypeTraits<DataType_>::Scalar>, public DualCutFrequencyInterface<typename TypeTraits<DataType_>::Scalar>, public StagedDualCutRippleDesign<Chebyshev2BandStopCoefficients<DataType_>, DataType_>
   {
   public:
     /// Simplify parent calls
@@ -190,7 +218,16 @@ namespace ATK
     AlignedScalarVector coefficients_in;
     /// Coefficients of the AR part of the IIR filter
     AlignedScalarVector coefficients_out;
-    
+    /// Coefficients of the second order sections (b0, b1, b2, a1, a2 for each section), always in double precision
+    std::vector<double> coefficients_sections;
+    /// Also compute the second order sections during the setup
+    bool emit_sections{false};
+    /// Designs the coefficients of a bandwidth and a ripple in the given buffers
+    void compute_coefficients(std::pair<CoeffDataType, CoeffDataType> cut_frequencies, CoeffDataType ripple, AlignedScalarVector& coefficients_in, AlignedScalarVector& coefficients_out, std::vector<double>& coefficients_sections) const;
+
+    /// The staging designs with compute_coefficients and swaps the coefficients in
+    friend class StagedCutRippleDesign<Chebyshev2BandStopCoefficients<DataType_>, DataType_, std::pair<CoeffDataType, CoeffDataType> >;
+
   public:
     /*!
      * @brief Constructor
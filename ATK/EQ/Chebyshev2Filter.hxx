@@ -46,34 +46,34 @@ namespace Chebyshev2Utilities
     zpk.k = f.real();
   }
   
-  template<typename DataType, typename Container>
-  void create_default_chebyshev2_coeffs(size_t order, DataType ripple, DataType Wn, Container& coefficients_in, Container& coefficients_out)
+  template<typename DataType, typename Container, typename SectionsContainer = Container>
+  void create_default_chebyshev2_coeffs(size_t order, DataType ripple, DataType Wn, Container& coefficients_in, Container& coefficients_out, SectionsContainer* coefficients_sections = nullptr)
   {
     EQUtilities::ZPK<DataType> zpk;
 
     int fs = 2;
     create_chebyshev2_analog_coefficients(static_cast<int>(order), ripple, zpk);
-    EQUtilities::populate_lp_coeffs(Wn, fs, order, zpk, coefficients_in, coefficients_out);
+    EQUtilities::populate_lp_coeffs(Wn, fs, order, zpk, coefficients_in, coefficients_out, coefficients_sections);
   }
   
-  template<typename DataType, typename Container>
-  void create_bp_chebyshev2_coeffs(size_t order, DataType ripple, DataType wc1, DataType wc2, Container& coefficients_in, Container& coefficients_out)
+  template<typename DataType, typename Container, typename SectionsContainer = Container>
+  void create_bp_chebyshev2_coeffs(size_t order, DataType ripple, DataType wc1, DataType wc2, Container& coefficients_in, Container& coefficients_out, SectionsContainer* coefficients_sections = nullptr)
   {
     EQUtilities::ZPK<DataType> zpk;
 
     int fs = 2;
     create_chebyshev2_analog_coefficients(static_cast<int>(order/2), ripple, zpk);
-    EQUtilities::populate_bp_coeffs(wc1, wc2, fs, order, zpk, coefficients_in, coefficients_out);
+    EQUtilities::populate_bp_coeffs(wc1, wc2, fs, order, zpk, coefficients_in, coefficients_out, coefficients_sections);
   }
   
-  template<typename DataType, typename Container>
-  void create_bs_chebyshev2_coeffs(size_t order, DataType ripple, DataType wc1, DataType wc2, Container& coefficients_in, Container& coefficients_out)
+  template<typename DataType, typename Container, typename SectionsContainer = Container>
+  void create_bs_chebyshev2_coeffs(size_t order, DataType ripple, DataType wc1, DataType wc2, Container& coefficients_in, Container& coefficients_out, SectionsContainer* coefficients_sections = nullptr)
   {
     EQUtilities::ZPK<DataType> zpk;
 
     int fs = 2;
     create_chebyshev2_analog_coefficients(static_cast<int>(order/2), ripple, zpk);
-    EQUtilities::populate_bs_coeffs(wc1, wc2, fs, order, zpk, coefficients_in, coefficients_out);
+    EQUtilities::populate_bs_coeffs(wc1, wc2, fs, order, zpk, coefficients_in, coefficients_out, coefficients_sections);
   }
 }
 
@@ -89,6 +89,7 @@ namespace ATK
   void Chebyshev2LowPassCoefficients<DataType_>::set_ripple(CoeffDataType ripple)
   {
     this->ripple = ripple;
+    this->sync_staged_parameters();
     setup();
   }
   
@@ -106,6 +107,7 @@ namespace ATK
       throw std::out_of_range("Frequency can't be negative");
     }
     this->cut_frequency = cut_frequency;
+    this->sync_staged_parameters();
     setup();
   }
   
@@ -136,10 +138,20 @@ namespace ATK
   void Chebyshev2LowPassCoefficients<DataType>::setup()
   {
     Parent::setup();
+    if(this->staged_design.is_committing())
+    {
+      return;
+    }
+    compute_coefficients(cut_frequency, ripple, coefficients_in, coefficients_out, coefficients_sections);
+  }
+
+  template <typename DataType>
+  void Chebyshev2LowPassCoefficients<DataType>::compute_coefficients(CoeffDataType cut_frequency, CoeffDataType ripple, AlignedScalarVector& coefficients_in, AlignedScalarVector& coefficients_out, std::vector<double>& coefficients_sections) const
+  {
     coefficients_in.assign(in_order+1, 0);
     coefficients_out.assign(out_order, 0);
     
-    Chebyshev2Utilities::create_default_chebyshev2_coeffs(in_order, ripple, 2 * cut_frequency / input_sampling_rate, coefficients_in, coefficients_out);
+    Chebyshev2Utilities::create_default_chebyshev2_coeffs(in_order, ripple, 2 * cut_frequency / input_sampling_rate, coefficients_in, coefficients_out, emit_sections ? &coefficients_sections : nullptr);
   }
   
   template <typename DataType>
@@ -156,6 +168,7 @@ namespace ATK
       throw std::out_of_range("Frequency can't be negative");
     }
     this->cut_frequency = cut_frequency;
+    this->sync_staged_parameters();
     setup();
   }
   
@@ -169,6 +182,7 @@ namespace ATK
   void Chebyshev2HighPassCoefficients<DataType_>::set_ripple(CoeffDataType ripple)
   {
     this->ripple = ripple;
+    this->sync_staged_parameters();
     setup();
   }
   
@@ -199,15 +213,29 @@ namespace ATK
   void Chebyshev2HighPassCoefficients<DataType>::setup()
   {
     Parent::setup();
+    if(this->staged_design.is_committing())
+    {
+      return;
+    }
+    compute_coefficients(cut_frequency, ripple, coefficients_in, coefficients_out, coefficients_sections);
+  }
+
+  template <typename DataType>
+  void Chebyshev2HighPassCoefficients<DataType>::compute_coefficients(CoeffDataType cut_frequency, CoeffDataType ripple, AlignedScalarVector& coefficients_in, AlignedScalarVector& coefficients_out, std::vector<double>& coefficients_sections) const
+  {
     coefficients_in.assign(in_order+1, 0);
     coefficients_out.assign(out_order, 0);
     
-    Chebyshev2Utilities::create_default_chebyshev2_coeffs(in_order, ripple, (input_sampling_rate - 2 * cut_frequency) / input_sampling_rate, coefficients_in, coefficients_out);
+    Chebyshev2Utilities::create_default_chebyshev2_coeffs(in_order, ripple, (input_sampling_rate - 2 * cut_frequency) / input_sampling_rate, coefficients_in, coefficients_out, emit_sections ? &coefficients_sections : nullptr);
     for(gsl::index i = in_order - 1; i >= 0; i -= 2)
     {
       coefficients_in[i] = - coefficients_in[i];
       coefficients_out[i] = - coefficients_out[i];
     }
+    if(emit_sections)
+    {
+      EQUtilities::sos_lp2hp(coefficients_sections);
+    }
   }
   
   template <typename DataType>
@@ -224,6 +252,7 @@ namespace ATK
       throw std::out_of_range("Frequencies can't be negative");
     }
     this->cut_frequencies = cut_frequencies;
+    this->sync_staged_parameters();
     setup();
   }
   
@@ -243,6 +272,7 @@ namespace ATK
   void Chebyshev2BandPassCoefficients<DataType_>::set_ripple(CoeffDataType ripple)
   {
     this->ripple = ripple;
+    this->sync_staged_parameters();
     setup();
   }
   
@@ -273,10 +303,20 @@ namespace ATK
   void Chebyshev2BandPassCoefficients<DataType>::setup()
   {
     Parent::setup();
+    if(this->staged_design.is_committing())
+    {
+      return;
+    }
+    compute_coefficients(cut_frequencies, ripple, coefficients_in, coefficients_out, coefficients_sections);
+  }
+
+  template <typename DataType>
+  void Chebyshev2BandPassCoefficients<DataType>::compute_coefficients(std::pair<CoeffDataType, CoeffDataType> cut_frequencies, CoeffDataType ripple, AlignedScalarVector& coefficients_in, AlignedScalarVector& coefficients_out, std::vector<double>& coefficients_sections) const
+  {
     coefficients_in.assign(in_order+1, 0);
     coefficients_out.assign(out_order, 0);
     
-    Chebyshev2Utilities::create_bp_chebyshev2_coeffs(in_order, ripple, 2 * cut_frequencies.first / input_sampling_rate, 2 * cut_frequencies.second / input_sampling_rate, coefficients_in, coefficients_out);
+    Chebyshev2Utilities::create_bp_chebyshev2_coeffs(in_order, ripple, 2 * cut_frequencies.first / input_sampling_rate, 2 * cut_frequencies.second / input_sampling_rate, coefficients_in, coefficients_out, emit_sections ? &coefficients_sections : nullptr);
   }
   
   template <typename DataType>
@@ -293,6 +333,7 @@ namespace ATK
       throw std::out_of_range("Frequencies can't be negative");
     }
     this->cut_frequencies = cut_frequencies;
+    this->sync_staged_parameters();
     setup();
   }
   
@@ -312,6 +353,7 @@ namespace ATK
   void Chebyshev2BandStopCoefficients<DataType_>::set_ripple(CoeffDataType ripple)
   {
     this->ripple = ripple;
+    this->sync_staged_parameters();
     setup();
   }
   
@@ -342,9 +384,19 @@ namespace ATK
   void Chebyshev2BandStopCoefficients<DataType>::setup()
   {
     Parent::setup();
+    if(this->staged_design.is_committing())
+    {
+      return;
+    }
+    compute_coefficients(cut_frequencies, ripple, coefficients_in, coefficients_out, coefficients_sections);
+  }
+
+  template <typename DataType>
+  void Chebyshev2BandStopCoefficients<DataType>::compute_coefficients(std::pair<CoeffDataType, CoeffDataType> cut_frequencies, CoeffDataType ripple, AlignedScalarVector& coefficients_in, AlignedScalarVector& coefficients_out, std::vector<double>& coefficients_sections) const
+  {
     coefficients_in.assign(in_order+1, 0);
     coefficients_out.assign(out_order, 0);
     
-    Chebyshev2Utilities::create_bs_chebyshev2_coeffs(in_order, ripple, 2 * cut_frequencies.first / input_sampling_rate, 2 * cut_frequencies.second / input_sampling_rate, coefficients_in, coefficients_out);
+    Chebyshev2Utilities::create_bs_chebyshev2_coeffs(in_order, ripple, 2 * cut_frequencies.first / input_sampling_rate, 2 * cut_frequencies.second / input_sampling_rate, coefficients_in, coefficients_out, emit_sections ? &coefficients_sections : nullptr);
   }
 }
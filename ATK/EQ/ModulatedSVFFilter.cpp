@@ -0,0 +1,300 @@
+/**
+ * \file ModulatedSVFFilter.cpp
+ */
+
+#include "ModulatedSVFFilter.h"
+
+#include <ATK/Core/TypeTraits.h>
+#include <ATK/Core/Utilities.h>
+
+#include <boost/math/constants/constants.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+namespace ATK
+{
+  namespace
+  {
+    /// Highest cut frequency of the table, relative to the sampling rate, tan diverges at the Nyquist frequency
+    constexpr double MAX_RELATIVE_FREQUENCY = .49;
+  }
+
+  template<typename DataType_>
+  ModulatedSVFFilter<DataType_>::ModulatedSVFFilter(gsl::index nb_channels)
+  :Parent(nb_channels + 1, nb_channels)
+  {
+  }
+
+  template<typename DataType_>
+  void ModulatedSVFFilter<DataType_>::set_mode(Mode mode)
+  {
+    this->mode = mode;
+    setup();
+  }
+
+  template<typename DataType_>
+  auto ModulatedSVFFilter<DataType_>::get_mode() const -> Mode
+  {
+    return mode;
+  }
+
+  template<typename DataType_>
+  void ModulatedSVFFilter<DataType_>::set_Q(DataType_ Q)
+  {
+    if(Q <= 0)
+    {
+      throw std::out_of_range("Q must be strictly positive");
+    }
+    this->Q = Q;
+    setup();
+  }
+
+  template<typename DataType_>
+  DataType_ ModulatedSVFFilter<DataType_>::get_Q() const
+  {
+    return Q;
+  }
+
+  template<typename DataType_>
+  void ModulatedSVFFilter<DataType_>::set_control_period(gsl::index control_period)
+  {
+    if(control_period <= 0)
+    {
+      throw RuntimeError("Control period must be strictly positive");
+    }
+    this->control_period = control_period;
+    control_countdown = 0;
+  }
+
+  template<typename DataType_>
+  gsl::index ModulatedSVFFilter<DataType_>::get_control_period() const
+  {
+    return control_period;
+  }
+
+  template<typename DataType_>
+  void ModulatedSVFFilter<DataType_>::set_table_size(gsl::index table_size)
+  {
+    if(table_size <= 0)
+    {
+      throw RuntimeError("Table size must be strictly positive");
+    }
+    this->table_size = table_size;
+    setup();
+  }
+
+  template<typename DataType_>
+  gsl::index ModulatedSVFFilter<DataType_>::get_table_size() const
+  {
+    return table_size;
+  }
+
+  template<typename DataType_>
+  void ModulatedSVFFilter<DataType_>::full_setup()
+  {
+    state.assign(2 * ((nb_output_ports + nb_lanes - 1) / nb_lanes), BatchType(TypeTraits<DataType>::Zero()));
+    control_countdown = 0;
+    Parent::full_setup();
+  }
+
+  template<typename DataType_>
+  void ModulatedSVFFilter<DataType_>::setup()
+  {
+    Parent::setup();
+    auto k = 1 / Q;
+    switch(mode)
+    {
+    case Mode::LowPass:
+      m0 = 0;
+      m1 = 0;
+      m2 = 1;
+      break;
+    case Mode::BandPass:
+      m0 = 0;
+      m1 = 1;
+      m2 = 0;
+      break;
+    case Mode::HighPass:
+      m0 = 1;
+      m1 = -k;
+      m2 = -1;
+      break;
+    case Mode::Notch:
+      m0 = 1;
+      m1 = -k;
+      m2 = 0;
+      break;
+    case Mode::Peak:
+      m0 = 1;
+      m1 = -k;
+      m2 = 2;
+      break;
+    }
+
+    if(input_sampling_rate == 0)
+    {
+      return;
+    }
+    // The divisions and the tan are only computed here, for the table points
+    table.resize(3 * (table_size + 1));
+    for(gsl::index i = 0; i <= table_size; ++i)
+    {
+      auto g = std::tan(boost::math::constants::pi<double>() * MAX_RELATIVE_FREQUENCY * i / table_size);
+      auto a1 = 1 / (1 + g * (g + k));
+      table[3 * i] = static_cast<DataType>(a1);
+      table[3 * i + 1] = static_cast<DataType>(g * a1);
+      table[3 * i + 2] = static_cast<DataType>(g * g * a1);
+    }
+    table_scale = static_cast<DataType>(table_size / (MAX_RELATIVE_FREQUENCY * input_sampling_rate));
+  }
+
+  template<typename DataType_>
+  void ModulatedSVFFilter<DataType_>::preallocate(gsl::index size)
+  {
+    Parent::preallocate(size);
+    resize_buffers(size);
+  }
+
+  template<typename DataType_>
+  void ModulatedSVFFilter<DataType_>::resize_buffers(gsl::index size) const
+  {
+    if(coefficients.size() < static_cast<std::size_t>(3 * size))
+    {
+      coefficients.resize(3 * size);
+    }
+    if(batched_signal.size() < static_cast<std::size_t>(size))
+    {
+      batched_signal.resize(size);
+    }
+  }
+
+  template<typename DataType_>
+  void ModulatedSVFFilter<DataType_>::compute_coefficients(gsl::index size) const
+  {
+    const DataType* ATK_RESTRICT cut_frequencies = converted_inputs[0];
+    const DataType* ATK_RESTRICT entries = table.data();
+    DataType* ATK_RESTRICT a1 = coefficients.data();
+    DataType* ATK_RESTRICT a2 = a1 + size;
+    DataType* ATK_RESTRICT a3 = a2 + size;
+    auto max_position = static_cast<DataType>(table_size);
+
+    // Each coefficient is linearly interpolated between two points of the table
+    auto interpolate = [=](DataType cut_frequency, DataType& a1, DataType& a2, DataType& a3)
+    {
+      auto position = std::min(std::max(cut_frequency * table_scale, DataType(0)), max_position);
+      auto index = std::min(static_cast<gsl::index>(position), table_size - 1);
+      auto fraction = position - index;
+      const DataType* ATK_RESTRICT entry = entries + 3 * index;
+      a1 = entry[0] + fraction * (entry[3] - entry[0]);
+      a2 = entry[1] + fraction * (entry[4] - entry[1]);
+      a3 = entry[2] + fraction * (entry[5] - entry[2]);
+    };
+
+    if(control_period == 1)
+    {
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        interpolate(cut_frequencies[i], a1[i], a2[i], a3[i]);
+      }
+      return;
+    }
+
+    // The coefficients of the previous block are held until the end of their control period
+    gsl::index i = 0;
+    while(i < size)
+    {
+      if(control_countdown == 0)
+      {
+        interpolate(cut_frequencies[i], held_coefficients[0], held_coefficients[1], held_coefficients[2]);
+        control_countdown = control_period;
+      }
+      auto end = std::min(i + control_countdown, size);
+      for(gsl::index j = i; j < end; ++j)
+      {
+        a1[j] = held_coefficients[0];
+        a2[j] = held_coefficients[1];
+        a3[j] = held_coefficients[2];
+      }
+      control_countdown -= end - i;
+      i = end;
+    }
+  }
+
+  template<typename DataType_>
+  void ModulatedSVFFilter<DataType_>::process_impl(gsl::index size) const
+  {
+    assert(input_sampling_rate == output_sampling_rate);
+    assert(nb_input_ports == nb_output_ports + 1);
+
+    resize_buffers(size);
+    compute_coefficients(size);
+
+    const DataType* ATK_RESTRICT a1 = coefficients.data();
+    const DataType* ATK_RESTRICT a2 = a1 + size;
+    const DataType* ATK_RESTRICT a3 = a2 + size;
+    BatchType* ATK_RESTRICT signal = batched_signal.data();
+
+    for(gsl::index first_channel = 0; first_channel < nb_output_ports; first_channel += nb_lanes)
+    {
+      auto nb_channels = std::min(nb_lanes, nb_output_ports - first_channel);
+
+      // Interleave the channels, unused lanes are set to 0
+      for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+      {
+        if(lane < nb_channels)
+        {
+          const DataType* ATK_RESTRICT input = converted_inputs[first_channel + lane + 1];
+          for(gsl::index i = 0; i < size; ++i)
+          {
+            signal[i][lane] = input[i];
+          }
+        }
+        else
+        {
+          for(gsl::index i = 0; i < size; ++i)
+          {
+            signal[i][lane] = TypeTraits<DataType>::Zero();
+          }
+        }
+      }
+
+      // The states are kept in local variables so that they stay in registers
+      auto iceq1 = state[2 * (first_channel / nb_lanes)];
+      auto iceq2 = state[2 * (first_channel / nb_lanes) + 1];
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        auto v0 = signal[i];
+        BatchType result;
+        for(gsl::index lane = 0; lane < nb_lanes; ++lane)
+        {
+          auto v3 = v0[lane] - iceq2[lane];
+          auto v1 = a1[i] * iceq1[lane] + a2[i] * v3;
+          auto v2 = iceq2[lane] + a2[i] * iceq1[lane] + a3[i] * v3;
+          iceq1[lane] = 2 * v1 - iceq1[lane];
+          iceq2[lane] = 2 * v2 - iceq2[lane];
+          result[lane] = m0 * v0[lane] + m1 * v1 + m2 * v2;
+        }
+        signal[i] = result;
+      }
+      state[2 * (first_channel / nb_lanes)] = iceq1;
+      state[2 * (first_channel / nb_lanes) + 1] = iceq2;
+
+      for(gsl::index lane = 0; lane < nb_channels; ++lane)
+      {
+        DataType* ATK_RESTRICT output = outputs[first_channel + lane];
+        for(gsl::index i = 0; i < size; ++i)
+        {
+          output[i] = signal[i][lane];
+        }
+      }
+    }
+  }
+
+#if ATK_ENABLE_INSTANTIATION
+  template class ModulatedSVFFilter<float>;
+#endif
+  template class ModulatedSVFFilter<double>;
+}
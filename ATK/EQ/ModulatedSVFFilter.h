@@ -0,0 +1,127 @@
+/**
+ * \file ModulatedSVFFilter.h
+ */
+
+#ifndef ATK_EQ_MODULATEDSVFFILTER_H
+#define ATK_EQ_MODULATEDSVFFILTER_H
+
+#include <ATK/config.h>
+#include <ATK/Core/TypedBaseFilter.h>
+#include <ATK/EQ/config.h>
+#include <ATK/Utility/Batch.h>
+
+#include <boost/align/aligned_allocator.hpp>
+
+#include <vector>
+
+namespace ATK
+{
+  /// Second order SVF with a cut frequency modulated at audio or control rate
+  /*!
+   * The first input port is the cut frequency in Hz, the other ports are the channels, processed together in the lanes of
+   * a Batch. The coefficients are interpolated in a table computed for the Q factor, so that modulating the cut frequency
+   * costs neither a tan nor a division per sample.
+   */
+  template<typename DataType_>
+  class ATK_EQ_EXPORT ModulatedSVFFilter final : public TypedBaseFilter<DataType_>
+  {
+  protected:
+    /// Simplify parent calls
+    using Parent = TypedBaseFilter<DataType_>;
+    using typename Parent::DataType;
+    using typename Parent::AlignedScalarVector;
+    using Parent::converted_inputs;
+    using Parent::outputs;
+    using Parent::nb_input_ports;
+    using Parent::nb_output_ports;
+    using Parent::input_sampling_rate;
+    using Parent::output_sampling_rate;
+
+    static constexpr gsl::index nb_lanes = native_batch_size<DataType>();
+    using BatchType = Batch<DataType, nb_lanes>;
+    using AlignedBatchVector = std::vector<BatchType, boost::alignment::aligned_allocator<BatchType, alignof(BatchType)> >;
+
+  public:
+    /// Response of the filter
+    enum class Mode
+    {
+      LowPass,
+      BandPass,
+      HighPass,
+      Notch,
+      Peak
+    };
+
+    /*!
+     * @brief Constructor
+     * @param nb_channels is the number of filtered channels, the number of input ports is one more
+     */
+    explicit ModulatedSVFFilter(gsl::index nb_channels = 1);
+    /// Destructor
+    ~ModulatedSVFFilter() override = default;
+
+    /// Changes the response of the filter
+    void set_mode(Mode mode);
+    /// Returns the response of the filter
+    Mode get_mode() const;
+
+    /// Sets the Q factor, must be strictly positive
+    void set_Q(DataType_ Q);
+    /// Returns the Q factor
+    DataType_ get_Q() const;
+
+    /*!
+     * @brief Sets the number of samples between two reads of the cut frequency
+     * @param control_period is 1 for an audio rate modulation, the coefficients are held in between otherwise
+     */
+    void set_control_period(gsl::index control_period);
+    /// Returns the number of samples between two reads of the cut frequency
+    gsl::index get_control_period() const;
+
+    /*!
+     * @brief Sets the number of intervals of the coefficients table
+     * @param table_size is the number of linearly interpolated intervals between 0 and the maximum cut frequency
+     */
+    void set_table_size(gsl::index table_size);
+    /// Returns the number of intervals of the coefficients table
+    gsl::index get_table_size() const;
+
+    void full_setup() final;
+
+  protected:
+    void setup() final;
+    void preallocate(gsl::index size) final;
+    void process_impl(gsl::index size) const final;
+
+  private:
+    /// Fills the per sample coefficients of the block
+    void compute_coefficients(gsl::index size) const;
+    /// Makes room for the coefficients and the interleaved channels of a block
+    void resize_buffers(gsl::index size) const;
+
+    Mode mode{Mode::LowPass};
+    DataType Q{1};
+    gsl::index control_period{1};
+    gsl::index table_size{4096};
+
+    /// Interleaved a1, a2, a3 for table_size + 1 cut frequencies
+    AlignedScalarVector table;
+    /// Converts a cut frequency to a position in the table
+    DataType table_scale{0};
+    DataType m0{0};
+    DataType m1{0};
+    DataType m2{1};
+
+    /// Coefficients of the block, a1 then a2 then a3
+    mutable AlignedScalarVector coefficients;
+    /// Coefficients held until the next read of the cut frequency
+    mutable DataType held_coefficients[3]{0, 0, 0};
+    /// Samples before the next read of the cut frequency
+    mutable gsl::index control_countdown{0};
+    mutable AlignedBatchVector batched_signal;
+    /// The two integrator states of each group of channels
+    mutable AlignedBatchVector state;
+  };
+}
+
+#endif
@@ -313,7 +313,7 @@ namespace ATK
 
   template<class DataType>
   RemezBasedCoefficients<DataType>::RemezBasedCoefficients(RemezBasedCoefficients&& other)
-    :Parent(std::move(other)), target(std::move(other.target)), in_order(std::move(other.in_order)), coefficients_in(std::move(other.coefficients_in))
+    :Parent(std::move(other)), target(std::move(other.target)), in_order(std::move(other.in_order)), coefficients_in(std::move(other.coefficients_in)), staged_design(std::move(other.staged_design))
   {
   }
 
@@ -345,7 +345,23 @@ namespace ATK
   void RemezBasedCoefficients<DataType>::setup()
   {
     Parent::setup();
+    if(staged_design.is_committing())
+    {
+      return;
+    }
     
+    check_template(target);
+    
+    if (in_order > 0)
+    {
+      RemezBuilder<CoeffDataType> builder(in_order, target);
+      coefficients_in = builder.build();
+    }
+  }
+
+  template<class DataType>
+  void RemezBasedCoefficients<DataType>::check_template(std::vector<std::pair<std::pair<CoeffDataType, CoeffDataType>, std::pair<CoeffDataType, CoeffDataType> > >& target)
+  {
     std::sort(target.begin(), target.end());
     for(gsl::index i = 0; i + 1 < target.size(); ++i)
     {
@@ -355,12 +371,32 @@ namespace ATK
         throw ATK::RuntimeError("Bad template");
       }
     }
-    
-    if (in_order > 0)
+  }
+
+  template<class DataType>
+  void RemezBasedCoefficients<DataType>::stage_template(const std::vector<std::pair<std::pair<CoeffDataType, CoeffDataType>, std::pair<CoeffDataType, CoeffDataType> > >& target)
+  {
+    staged_design.parameters = target;
+    check_template(staged_design.parameters);
+    staged_design.stage(in_order, [this](const auto& staged_target, AlignedScalarVector& coefficients_in)
     {
-      RemezBuilder<CoeffDataType> builder(in_order, target);
-      coefficients_in = builder.build();
+      if (in_order > 0)
+      {
+        RemezBuilder<CoeffDataType> builder(in_order, staged_target);
+        coefficients_in = builder.build();
+      }
+    });
+  }
+
+  template<class DataType>
+  void RemezBasedCoefficients<DataType>::commit_staged_coefficients()
+  {
+    if(!staged_design.is_staged())
+    {
+      return;
     }
+    target = staged_design.parameters;
+    staged_design.commit(in_order, [this](){setup();}, coefficients_in);
   }
   
   template class ATK_EQ_EXPORT RemezBasedCoefficients<double>;
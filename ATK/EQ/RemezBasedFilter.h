@@ -7,6 +7,7 @@
 #define ATK_EQ_REMEZBASEDFILTER_H
 
 #include <ATK/Core/TypedBaseFilter.h>
+#include <ATK/EQ/StagedDesign.h>
 
 namespace ATK
 {
@@ -33,7 +34,14 @@ namespace ATK
     void setup() override;
     /// Final coefficients
     AlignedScalarVector coefficients_in;
-    
+
+  private:
+    /// Sorts and checks a template
+    static void check_template(std::vector<std::pair<std::pair<CoeffDataType, CoeffDataType>, std::pair<CoeffDataType, CoeffDataType> > >& target);
+
+    /// Template and coefficients computed by stage_template, swapped in by commit_staged_coefficients
+    StagedDesign<std::vector<std::pair<std::pair<CoeffDataType, CoeffDataType>, std::pair<CoeffDataType, CoeffDataType> > >, AlignedScalarVector> staged_design;
+
   public:
     /// Constructor of a FIR filter using Remeze/Parks&McClellan algorithm to match a given template
     explicit RemezBasedCoefficients(gsl::index nb_channels = 1);
@@ -48,6 +56,15 @@ namespace ATK
     
     /// Order of the FIR filter
     void set_order(gsl::index order);
+
+    /// Computes the coefficients of a new template in the staging buffer, without changing the filter
+    void stage_template(const std::vector<std::pair<std::pair<CoeffDataType, CoeffDataType>, std::pair<CoeffDataType, CoeffDataType> > >& target);
+    /*!
+     * @brief Swaps the staged coefficients in, cheap enough for the processing thread
+     * stage_template can be called from another thread, as long as the order doesn't change before the commit. If it
+     * changed, the coefficients are computed again here.
+     */
+    void commit_staged_coefficients();
   };
 }
 
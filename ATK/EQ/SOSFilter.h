@@ -0,0 +1,266 @@
+/**
+ * \file SOSFilter.h
+ */
+
+#ifndef ATK_EQ_SOSFILTER_H
+#define ATK_EQ_SOSFILTER_H
+
+#include <ATK/config.h>
+#include <ATK/Core/TypeTraits.h>
+#include <ATK/EQ/config.h>
+#include <ATK/Utility/Batch.h>
+
+#include <boost/align/aligned_allocator.hpp>
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <cassert>
+#include <complex>
+#include <type_traits>
+#include <vector>
+
+namespace ATK
+{
+  /// IIR filter template class processing a cascade of second order sections (Transposed Direct Form II)
+  /*!
+   * The coefficients class must be able to emit second order sections (Butterworth, Chebyshev 1 and 2, Bessel). High
+   * order filters are then stable even with low cut frequencies. Sections are processed in double precision, as the
+   * poles of low cut frequencies are too close to the unit circle for single precision coefficients and states.
+   * Channels are interleaved in the lanes of a Batch, so that each section advances up to nb_lanes channels at once.
+   */
+  template<class Coefficients, gsl::index nb_lanes = native_batch_size<double>()>
+  class SOSFilter final : public Coefficients
+  {
+  protected:
+    /// Simplify parent calls
+    using Parent = Coefficients;
+    using typename Parent::DataType;
+    using Parent::converted_inputs;
+    using Parent::outputs;
+    using Parent::coefficients_sections;
+    using Parent::emit_sections;
+    using Parent::input_sampling_rate;
+    using Parent::output_sampling_rate;
+    using Parent::nb_input_ports;
+    using Parent::nb_output_ports;
+
+    using Parent::input_delay;
+    using Parent::output_delay;
+    using Parent::setup;
+
+    /// Type used to process the sections, double or std::complex<double>
+    using SectionDataType = std::conditional_t<std::is_same<DataType, typename TypeTraits<DataType>::Scalar>::value, double, std::complex<double> >;
+    using BatchType = Batch<SectionDataType, nb_lanes>;
+    using AlignedBatchVector = std::vector<BatchType, boost::alignment::aligned_allocator<BatchType, alignof(BatchType)> >;
+
+  public:
+    /*!
+     * @brief Constructor
+     * @param nb_channels is the number of input and output channels
+     */
+    explicit SOSFilter(gsl::index nb_channels = 1)
+      :Parent(nb_channels)
+    {
+      emit_sections = true;
+    }
+
+    /// Move constructor
+    SOSFilter(SOSFilter&& other)
+    :Parent(std::move(other)), state(std::move(other.state))
+    {
+    }
+
+    void setup() final
+    {
+      Parent::setup();
+      input_delay = 0;
+      output_delay = 0;
+
+      // The state is kept when only the coefficients change
+      auto state_size = static_cast<std::size_t>(2 * get_nb_sections() * nb_input_ports);
+      if(state.size() != state_size)
+      {
+        state.assign(state_size, SectionDataType(0));
+      }
+    }
+
+    void full_setup() final
+    {
+      state.clear();
+      Parent::full_setup();
+    }
+
+    void process_impl(gsl::index size) const final
+    {
+      assert(input_sampling_rate == output_sampling_rate);
+      assert(nb_input_ports == nb_output_ports);
+      assert(state.size() == static_cast<std::size_t>(2 * get_nb_sections() * nb_input_ports));
+
+      resize_batches(size);
+      for(gsl::index first_channel = 0; first_channel < nb_input_ports; first_channel += nb_lanes)
+      {
+        process_channels<nb_lanes>(first_channel, std::min(nb_lanes, nb_input_ports - first_channel), size);
+      }
+    }
+
+    /// Returns the coefficients of the second order sections (b0, b1, b2, a1, a2 for each section)
+    const std::vector<double>& get_coefficients_sections() const
+    {
+      return coefficients_sections;
+    }
+
+    /// Returns the number of second order sections
+    gsl::index get_nb_sections() const
+    {
+      return static_cast<gsl::index>(coefficients_sections.size() / 5);
+    }
+
+  protected:
+    void preallocate(gsl::index size) final
+    {
+      Parent::preallocate(size);
+      resize_batches(size);
+    }
+
+  private:
+    /// Processes nb_channels channels with the smallest batch that can hold them
+    template<gsl::index lanes>
+    void process_channels(gsl::index first_channel, gsl::index nb_channels, gsl::index size) const
+    {
+      if constexpr (lanes > 1)
+      {
+        if(nb_channels <= lanes / 2)
+        {
+          process_channels<lanes / 2>(first_channel, nb_channels, size);
+          return;
+        }
+      }
+      using LaneBatchType = Batch<SectionDataType, lanes>;
+      static_assert(alignof(LaneBatchType) <= alignof(BatchType), "Batched buffer is not aligned enough");
+      auto* ATK_RESTRICT buffer = reinterpret_cast<LaneBatchType*>(batched_buffer.data());
+
+      // Interleave the channels, unused lanes are set to 0
+      for(gsl::index lane = 0; lane < lanes; ++lane)
+      {
+        if(lane < nb_channels)
+        {
+          const DataType* ATK_RESTRICT channel_input = converted_inputs[first_channel + lane];
+          for(gsl::index i = 0; i < size; ++i)
+          {
+            buffer[i][lane] = static_cast<SectionDataType>(channel_input[i]);
+          }
+        }
+        else
+        {
+          for(gsl::index i = 0; i < size; ++i)
+          {
+            buffer[i][lane] = SectionDataType(0);
+          }
+        }
+      }
+
+      // Sections are fused by groups of up to 4 so that their recursions can overlap
+      auto nb_sections = get_nb_sections();
+      for(gsl::index section = 0; section < nb_sections; section += 4)
+      {
+        switch(std::min<gsl::index>(4, nb_sections - section))
+        {
+          case 1:
+            process_sections<LaneBatchType, 1>(buffer, first_channel, nb_channels, section, size);
+            break;
+          case 2:
+            process_sections<LaneBatchType, 2>(buffer, first_channel, nb_channels, section, size);
+            break;
+          case 3:
+            process_sections<LaneBatchType, 3>(buffer, first_channel, nb_channels, section, size);
+            break;
+          default:
+            process_sections<LaneBatchType, 4>(buffer, first_channel, nb_channels, section, size);
+        }
+      }
+
+      for(gsl::index lane = 0; lane < nb_channels; ++lane)
+      {
+        DataType* ATK_RESTRICT channel_output = outputs[first_channel + lane];
+        for(gsl::index i = 0; i < size; ++i)
+        {
+          channel_output[i] = static_cast<DataType>(buffer[i][lane]);
+        }
+      }
+    }
+
+    /// Processes in place nb_fused consecutive sections for a batch of channels
+    template<typename LaneBatchType, gsl::index nb_fused>
+    void process_sections(LaneBatchType* ATK_RESTRICT buffer, gsl::index first_channel, gsl::index nb_channels, gsl::index first_section, gsl::index size) const
+    {
+      auto nb_sections = get_nb_sections();
+      const auto* ATK_RESTRICT coefficients_ptr = coefficients_sections.data() + 5 * first_section;
+      SectionDataType* ATK_RESTRICT state_ptr = state.data();
+
+      double b0[nb_fused];
+      double b1[nb_fused];
+      double b2[nb_fused];
+      double a1[nb_fused];
+      double a2[nb_fused];
+      LaneBatchType s1[nb_fused];
+      LaneBatchType s2[nb_fused];
+      for(gsl::index j = 0; j < nb_fused; ++j)
+      {
+        b0[j] = coefficients_ptr[5 * j];
+        b1[j] = coefficients_ptr[5 * j + 1];
+        b2[j] = coefficients_ptr[5 * j + 2];
+        a1[j] = -coefficients_ptr[5 * j + 3];
+        a2[j] = -coefficients_ptr[5 * j + 4];
+        for(gsl::index lane = 0; lane < LaneBatchType::size; ++lane)
+        {
+          auto index = 2 * ((first_channel + lane) * nb_sections + first_section + j);
+          s1[j][lane] = lane < nb_channels ? state_ptr[index] : SectionDataType(0);
+          s2[j][lane] = lane < nb_channels ? state_ptr[index + 1] : SectionDataType(0);
+        }
+      }
+
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        LaneBatchType x = buffer[i];
+        for(gsl::index j = 0; j < nb_fused; ++j)
+        {
+          LaneBatchType y = s1[j];
+          y.multiply_add(b0[j], x);
+          s1[j] = s2[j];
+          s1[j].multiply_add(b1[j], x);
+          s1[j].multiply_add(a1[j], y);
+          s2[j] = LaneBatchType(SectionDataType(0));
+          s2[j].multiply_add(b2[j], x);
+          s2[j].multiply_add(a2[j], y);
+          x = y;
+        }
+        buffer[i] = x;
+      }
+
+      for(gsl::index j = 0; j < nb_fused; ++j)
+      {
+        for(gsl::index lane = 0; lane < nb_channels; ++lane)
+        {
+          auto index = 2 * ((first_channel + lane) * nb_sections + first_section + j);
+          state_ptr[index] = s1[j][lane];
+          state_ptr[index + 1] = s2[j][lane];
+        }
+      }
+    }
+
+    /// Makes room for the interleaved channels of a block
+    void resize_batches(gsl::index size) const
+    {
+      if(batched_buffer.size() < static_cast<std::size_t>(size))
+      {
+        batched_buffer.resize(size);
+      }
+    }
+
+    /// Two state values per section for each channel
+    mutable std::vector<SectionDataType> state;
+    mutable AlignedBatchVector batched_buffer;
+  };
+}
+
+#endif
@@ -0,0 +1,211 @@
+/**
+ * \file StagedDesign.h
+ */
+
+#ifndef ATK_EQ_STAGEDDESIGN_H
+#define ATK_EQ_STAGEDDESIGN_H
+
+#include <ATK/Core/TypeTraits.h>
+#include <ATK/Core/TypedBaseFilter.h>
+
+#include <gsl/gsl>
+
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ATK
+{
+  /// Coefficients designed in staging buffers, then swapped in a coefficients filter by the processing thread
+  /*!
+   * Parameters are the parameters of a design, Buffers the types of the coefficients arrays of the filter. The design
+   * can run on another thread, as long as the other parameters of the filter don't change before the commit.
+   */
+  template<typename Parameters, typename... Buffers>
+  class StagedDesign
+  {
+  public:
+    /// Parameters of the next design, the setters of the filter keep them in sync with its own parameters
+    Parameters parameters{};
+
+    /// Designs the coefficients of the staged parameters for an order, with design(parameters, buffers...)
+    template<typename Design>
+    void stage(gsl::index order, const Design& design)
+    {
+      std::apply([&](auto&... staged_buffers){design(parameters, staged_buffers...);}, buffers);
+      staged_order = order;
+      staged = true;
+    }
+
+    /// Is there a design waiting for its commit?
+    bool is_staged() const
+    {
+      return staged;
+    }
+
+    /// Is the filter set up by a commit? Its coefficients must not be designed again then
+    bool is_committing() const
+    {
+      return committing;
+    }
+
+    /*!
+     * @brief Swaps the staged coefficients with the ones of the filter and sets it up
+     * If the order changed since the design, setup designs the coefficients again instead.
+     * @param order is the current order of the filter
+     * @param setup sets up the filter
+     * @param filter_buffers are the coefficients of the filter, in the same order as Buffers
+     */
+    template<typename Setup>
+    void commit(gsl::index order, const Setup& setup, Buffers&... filter_buffers)
+    {
+      staged = false;
+      if(order != staged_order)
+      {
+        setup();
+        return;
+      }
+      std::apply([&](auto&... staged_buffers){(filter_buffers.swap(staged_buffers), ...);}, buffers);
+      // Only the filters built on these coefficients update their own state
+      committing = true;
+      try
+      {
+        setup();
+      }
+      catch(...)
+      {
+        committing = false;
+        throw;
+      }
+      committing = false;
+    }
+
+  private:
+    std::tuple<Buffers...> buffers;
+    gsl::index staged_order{0};
+    bool staged{false};
+    bool committing{false};
+  };
+
+  /// Staging of the designs of the coefficients filters with a ripple and one or two cut frequencies
+  /*!
+   * Coefficients provides compute_coefficients(cut, ripple, coefficients_in, coefficients_out, coefficients_sections),
+   * calls sync_staged_parameters from its setters and skips the design in setup while staged_design.is_committing().
+   */
+  template<class Coefficients, typename DataType, typename Cut>
+  class StagedCutRippleDesign
+  {
+  public:
+    using CoeffDataType = typename TypeTraits<DataType>::Scalar;
+    using AlignedScalarVector = typename TypedBaseFilter<DataType>::AlignedScalarVector;
+
+    /// Designs the coefficients of a new ripple in the staging buffers, without changing the filter
+    void stage_ripple(CoeffDataType ripple)
+    {
+      staged_design.parameters.second = ripple;
+      stage();
+    }
+
+    /*!
+     * @brief Swaps the staged coefficients in, cheap enough for the processing thread
+     * The stage methods can be called from another thread, as long as the other parameters don't change before the
+     * commit. If the order changed since the design, the coefficients are designed again here.
+     */
+    void commit_staged_coefficients()
+    {
+      if(!staged_design.is_staged())
+      {
+        return;
+      }
+      auto& filter = static_cast<Coefficients&>(*this);
+      get_cut(filter) = staged_design.parameters.first;
+      filter.ripple = staged_design.parameters.second;
+      staged_design.commit(filter.in_order, [&filter](){filter.setup();}, filter.coefficients_in, filter.coefficients_out, filter.coefficients_sections);
+    }
+
+  protected:
+    /// Starts the next designs from the current parameters of the filter
+    void sync_staged_parameters()
+    {
+      auto& filter = static_cast<Coefficients&>(*this);
+      staged_design.parameters = std::make_pair(get_cut(filter), filter.ripple);
+    }
+
+    /// Designs the coefficients of new cut frequencies in the staging buffers
+    void stage_cut(Cut cut)
+    {
+      staged_design.parameters.first = cut;
+      stage();
+    }
+
+    StagedDesign<std::pair<Cut, CoeffDataType>, AlignedScalarVector, AlignedScalarVector, std::vector<double> > staged_design;
+
+  private:
+    static Cut& get_cut(Coefficients& filter)
+    {
+      if constexpr(std::is_same<Cut, CoeffDataType>::value)
+      {
+        return filter.cut_frequency;
+      }
+      else
+      {
+        return filter.cut_frequencies;
+      }
+    }
+
+    void stage()
+    {
+      const auto& filter = static_cast<const Coefficients&>(*this);
+      staged_design.stage(filter.in_order, [&filter](const auto& parameters, auto& coefficients_in, auto& coefficients_out, auto& coefficients_sections)
+      {
+        filter.compute_coefficients(parameters.first, parameters.second, coefficients_in, coefficients_out, coefficients_sections);
+      });
+    }
+  };
+
+  /// Staging of the designs of the coefficients filters with a ripple and a cut frequency
+  template<class Coefficients, typename DataType>
+  class StagedSingleCutRippleDesign: public StagedCutRippleDesign<Coefficients, DataType, typename TypeTraits<DataType>::Scalar>
+  {
+  public:
+    using typename StagedCutRippleDesign<Coefficients, DataType, typename TypeTraits<DataType>::Scalar>::CoeffDataType;
+
+    /// Designs the coefficients of a new cut frequency in the staging buffers, without changing the filter
+    void stage_cut_frequency(CoeffDataType cut_frequency)
+    {
+      if(cut_frequency <= 0)
+      {
+        throw std::out_of_range("Frequency can't be negative");
+      }
+      this->stage_cut(cut_frequency);
+    }
+  };
+
+  /// Staging of the designs of the coefficients filters with a ripple and a bandwidth
+  template<class Coefficients, typename DataType>
+  class StagedDualCutRippleDesign: public StagedCutRippleDesign<Coefficients, DataType, std::pair<typename TypeTraits<DataType>::Scalar, typename TypeTraits<DataType>::Scalar> >
+  {
+  public:
+    using typename StagedCutRippleDesign<Coefficients, DataType, std::pair<typename TypeTraits<DataType>::Scalar, typename TypeTraits<DataType>::Scalar> >::CoeffDataType;
+
+    /// Designs the coefficients of a new bandwidth in the staging buffers, without changing the filter
+    void stage_cut_frequencies(std::pair<CoeffDataType, CoeffDataType> cut_frequencies)
+    {
+      if(cut_frequencies.first <= 0 || cut_frequencies.second <= 0)
+      {
+        throw std::out_of_range("Frequencies can't be negative");
+      }
+      this->stage_cut(cut_frequencies);
+    }
+
+    /// Designs the coefficients of a new bandwidth given as two separate values in the staging buffers
+    void stage_cut_frequencies(CoeffDataType f0, CoeffDataType f1)
+    {
+      stage_cut_frequencies(std::make_pair(f0, f1));
+    }
+  };
+}
+
+#endif
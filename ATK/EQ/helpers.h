@@ -5,7 +5,9 @@
 #ifndef ATK_EQ_HELPERS_H
 #define ATK_EQ_HELPERS_H
 
+#include <algorithm>
 #include <cmath>
+#include <complex>
 #include <vector>
 
 #include <boost/math/tools/polynomial.hpp>
@@ -235,18 +237,173 @@ namespace EQUtilities
     }
   }
 
+  /// Transforms the z, p, k coefficients in second order sections (b0, b1, b2, a1, a2 for each section, a0 being 1)
+  /*!
+   * Poles are paired with their nearest zeros, starting with the poles closest to the unit circle, and the sections are
+   * ordered so that the ones with the poles closest to the unit circle are processed last.
+   * The gain is spread evenly among the sections.
+   */
   template<typename DataType, typename Container>
-  void populate_lp_coeffs(DataType Wn, int fs, size_t order, ZPK<DataType>& zpk, Container& coefficients_in, Container& coefficients_out)
+  void zpk2sos(const ZPK<DataType>& zpk, Container& coefficients_sections)
+  {
+    // Sections are computed with the precision of the container
+    using SectionDataType = typename Container::value_type;
+    using Complex = std::complex<SectionDataType>;
+    // Remaining zeros and poles, complex ones are kept only once
+    std::vector<Complex> zeros;
+    std::vector<Complex> poles;
+    for(const auto& z: zpk.z)
+    {
+      if(z.imag() <= 0)
+      {
+        zeros.push_back(Complex(z));
+      }
+    }
+    for(const auto& p: zpk.p)
+    {
+      if(p.imag() <= 0)
+      {
+        poles.push_back(Complex(p));
+      }
+    }
+
+    auto distance_to_unit_circle = [](const Complex& p)
+    {
+      return std::abs(1 - std::abs(p));
+    };
+    auto take_nearest = [&zeros](const Complex& p, bool only_real)
+    {
+      gsl::index best = -1;
+      for(gsl::index i = 0; i < static_cast<gsl::index>(zeros.size()); ++i)
+      {
+        if(only_real && zeros[i].imag() != 0)
+        {
+          continue;
+        }
+        if(best == -1 || std::abs(zeros[i] - p) < std::abs(zeros[best] - p))
+        {
+          best = i;
+        }
+      }
+      if(best == -1)
+      {
+        // No zero left, equivalent to a zero at the origin
+        return Complex(0);
+      }
+      auto z = zeros[best];
+      zeros.erase(zeros.begin() + best);
+      return z;
+    };
+
+    // Each section is described by its zeros and poles, a second pole of 0 meaning a first order section
+    struct Section
+    {
+      Complex z1;
+      Complex z2;
+      Complex p1;
+      Complex p2;
+    };
+    std::vector<Section> sections;
+
+    // A first order section gets the real pole farthest from the unit circle, if the number of real poles is odd
+    auto nb_real_poles = std::count_if(poles.begin(), poles.end(), [](const Complex& p) {return p.imag() == 0;});
+    if(nb_real_poles % 2 == 1)
+    {
+      auto pole = std::max_element(poles.begin(), poles.end(), [&](const Complex& p1, const Complex& p2)
+      {
+        return (p1.imag() == 0 ? distance_to_unit_circle(p1) : -1) < (p2.imag() == 0 ? distance_to_unit_circle(p2) : -1);
+      });
+      Section section{0, 0, *pole, 0};
+      poles.erase(pole);
+      section.z1 = take_nearest(section.p1, true);
+      sections.push_back(section);
+    }
+
+    std::vector<Section> second_order_sections;
+    while(!poles.empty())
+    {
+      auto pole = std::min_element(poles.begin(), poles.end(), [&](const Complex& p1, const Complex& p2)
+      {
+        return distance_to_unit_circle(p1) < distance_to_unit_circle(p2);
+      });
+      Section section{0, 0, *pole, 0};
+      poles.erase(pole);
+      if(section.p1.imag() == 0)
+      {
+        // Pair with the next real pole closest to the unit circle
+        auto other = std::min_element(poles.begin(), poles.end(), [&](const Complex& p1, const Complex& p2)
+        {
+          return (p1.imag() == 0 ? distance_to_unit_circle(p1) : 2) < (p2.imag() == 0 ? distance_to_unit_circle(p2) : 2);
+        });
+        section.p2 = *other;
+        poles.erase(other);
+      }
+      else
+      {
+        section.p2 = std::conj(section.p1);
+      }
+
+      section.z1 = take_nearest(section.p1, false);
+      if(section.z1.imag() == 0)
+      {
+        section.z2 = take_nearest(section.p2, true);
+      }
+      else
+      {
+        section.z2 = std::conj(section.z1);
+      }
+      second_order_sections.push_back(section);
+    }
+    sections.insert(sections.end(), second_order_sections.rbegin(), second_order_sections.rend());
+
+    if(sections.empty())
+    {
+      // Only a gain
+      sections.push_back(Section{0, 0, 0, 0});
+    }
+
+    auto nb_sections = static_cast<gsl::index>(sections.size());
+    auto gain = std::pow(static_cast<SectionDataType>(std::abs(zpk.k)), SectionDataType(1) / nb_sections);
+    coefficients_sections.assign(5 * nb_sections, 0);
+    for(gsl::index i = 0; i < nb_sections; ++i)
+    {
+      const auto& section = sections[i];
+      auto section_gain = (i == 0 && zpk.k < 0) ? -gain : gain;
+      coefficients_sections[5 * i] = section_gain;
+      coefficients_sections[5 * i + 1] = -section_gain * (section.z1 + section.z2).real();
+      coefficients_sections[5 * i + 2] = section_gain * (section.z1 * section.z2).real();
+      coefficients_sections[5 * i + 3] = -(section.p1 + section.p2).real();
+      coefficients_sections[5 * i + 4] = (section.p1 * section.p2).real();
+    }
+  }
+
+  /// Transforms the sections of H(z) in the sections of H(-z), turning a low pass filter of cut Wn in a high pass filter of cut 1-Wn
+  template<typename Container>
+  void sos_lp2hp(Container& coefficients_sections)
+  {
+    for(gsl::index i = 0; i < static_cast<gsl::index>(coefficients_sections.size()); i += 5)
+    {
+      coefficients_sections[i + 1] = -coefficients_sections[i + 1];
+      coefficients_sections[i + 3] = -coefficients_sections[i + 3];
+    }
+  }
+
+  template<typename DataType, typename Container, typename SectionsContainer = Container>
+  void populate_lp_coeffs(DataType Wn, int fs, size_t order, ZPK<DataType>& zpk, Container& coefficients_in, Container& coefficients_out, SectionsContainer* coefficients_sections = nullptr)
   {
     DataType warped = 2 * fs * std::tan(boost::math::constants::pi<DataType>() *  Wn / fs);
     zpk_lp2lp(warped, zpk);
     zpk_bilinear(fs, zpk);
     
     to_bilinear(zpk, coefficients_in, coefficients_out, order);
+    if(coefficients_sections)
+    {
+      zpk2sos(zpk, *coefficients_sections);
+    }
   }
   
-  template<typename DataType, typename Container>
-  void populate_bp_coeffs(DataType wc1, DataType wc2, int fs, size_t order, ZPK<DataType>& zpk, Container& coefficients_in, Container& coefficients_out)
+  template<typename DataType, typename Container, typename SectionsContainer = Container>
+  void populate_bp_coeffs(DataType wc1, DataType wc2, int fs, size_t order, ZPK<DataType>& zpk, Container& coefficients_in, Container& coefficients_out, SectionsContainer* coefficients_sections = nullptr)
   {
     wc1 = 2 * fs * std::tan(boost::math::constants::pi<DataType>() * wc1 / fs);
     wc2 = 2 * fs * std::tan(boost::math::constants::pi<DataType>() * wc2 / fs);
@@ -255,10 +412,14 @@ namespace EQUtilities
     zpk_bilinear(fs, zpk);
     
     to_bilinear(zpk, coefficients_in, coefficients_out, order);
+    if(coefficients_sections)
+    {
+      zpk2sos(zpk, *coefficients_sections);
+    }
   }
   
-  template<typename DataType, typename Container>
-  void populate_bs_coeffs(DataType wc1, DataType wc2, int fs, size_t order, ZPK<DataType>& zpk, Container& coefficients_in, Container& coefficients_out)
+  template<typename DataType, typename Container, typename SectionsContainer = Container>
+  void populate_bs_coeffs(DataType wc1, DataType wc2, int fs, size_t order, ZPK<DataType>& zpk, Container& coefficients_in, Container& coefficients_out, SectionsContainer* coefficients_sections = nullptr)
   {
     wc1 = 2 * fs * std::tan(boost::math::constants::pi<DataType>() * wc1 / fs);
     wc2 = 2 * fs * std::tan(boost::math::constants::pi<DataType>() * wc2 / fs);
@@ -267,6 +428,10 @@ namespace EQUtilities
     zpk_bilinear(fs, zpk);
     
     to_bilinear(zpk, coefficients_in, coefficients_out, order);
+    if(coefficients_sections)
+    {
+      zpk2sos(zpk, *coefficients_sections);
+    }
   }
 }
 
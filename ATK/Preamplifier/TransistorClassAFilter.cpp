@@ -72,7 +72,7 @@ namespace ATK
         -Ic_Vbe, Ro, -Ic_Vbc + Ro + Rp, (Ic_Vbe + Ic_Vbc),
         -Ib_Vbe, 0, -Ib_Vbc, (Ib_Vbc + Ib_Vbe) + Rg2 + Rg1 + Cg;
 
-      return M.inverse() * y0;
+      return newton_solve<DataType, 4>(M, y0);
     }
 
     void update_state(gsl::index i, const DataType* const * ATK_RESTRICT input, DataType* const * ATK_RESTRICT output)
@@ -82,7 +82,7 @@ namespace ATK
       icoeq = -2 * Co * output[2][i] - icoeq;
     }
 
-    Vector operator()(gsl::index i, const DataType* const * ATK_RESTRICT input, DataType* const * ATK_RESTRICT output, const Vector& y1)
+    void operator()(gsl::index i, const DataType* const * ATK_RESTRICT input, DataType* const * ATK_RESTRICT output, const Vector& y1, Vector& F, Matrix& M)
     {
       std::pair<DataType, DataType> exp_y1 = std::make_pair(fmath::exp((y1(3) - y1(0)) / transistor_function.Vt), fmath::exp((y1(3) - y1(2)) / transistor_function.Vt));
 
@@ -100,18 +100,15 @@ namespace ATK
       auto f3 = Ic + (y1(1) + y1(2)) * Ro + (y1(2) - Vbias) * Rp;
       auto f4 = Ib + icgeq + y1(3) * Rg2 + (y1(3) - Vbias) * Rg1 + (y1(3) - input[0][i]) * Cg;
 
-      Vector F(f1,
+      F << f1,
         f2,
         f3,
-        f4);
+        f4;
 
-      Matrix M;
       M << -(Ib_Vbe + Ic_Vbe) - (Rk + Ck), 0, -(Ib_Vbc + Ic_Vbc), (Ib_Vbe + Ic_Vbe + Ib_Vbc + Ic_Vbc),
         0, Ro + Co, Ro, 0,
         -Ic_Vbe, Ro, -Ic_Vbc + Ro + Rp, (Ic_Vbe + Ic_Vbc),
         -Ib_Vbe, 0, -Ib_Vbc, (Ib_Vbc + Ib_Vbe) + Rg2 + Rg1 + Cg;
-
-      return M.inverse() * F;
     }
 
   };
@@ -137,7 +134,7 @@ namespace ATK
     {
     }
 
-    Vector operator()(const Vector& y1)
+    void operator()(const Vector& y1, Vector& F, Matrix& M)
     {
       std::pair<DataType, DataType> exp_y1 = std::make_pair(fmath::exp((y1(2) - y1(1)) / transistor_function.Vt), fmath::exp((y1(2) - y1(0)) / transistor_function.Vt));
 
@@ -151,16 +148,13 @@ namespace ATK
       auto Ic_Vbc = transistor_function.Lc_Vbc(exp_y1);
 
       auto R = 1 / (1 / Rg1 + 1 / Rg2);
-      Vector F(y1(0) - Vbias + Ic * Rp,
+      F << y1(0) - Vbias + Ic * Rp,
         y1(1) - (Ib + Ic) * Rk,
-        Ib * R + y1(2) - Vbias / Rg1 * R);
+        Ib * R + y1(2) - Vbias / Rg1 * R;
 
-      Matrix M;
       M << 1 - Ic_Vbc * Rp, -Ic_Vbe * Rp, (Ic_Vbe + Ic_Vbc) * Rp,
         (Ib_Vbc + Ic_Vbc) * Rk, 1 + (Ib_Vbc + Ic_Vbc) * Rk, -(Ib_Vbe + Ic_Vbe + Ib_Vbc + Ic_Vbc) * Rk,
         -Ib_Vbc * R, -Ib_Vbe * R, 1 + (Ib_Vbe + Ib_Vbc) * R;
-
-      return M.inverse() * F;
     }
   };
 
@@ -13,6 +13,7 @@
 #include <ATK/Utility/VectorizedNewtonRaphson.h>
 
 #include <cassert>
+#include <sstream>
 
 namespace ATK
 {
@@ -38,11 +39,51 @@ namespace ATK
     using DataType = DataType_;
     using Vector = Eigen::Matrix<DataType, 4, 1>;
     using Matrix = Eigen::Matrix<DataType, 4, 4>;
+    using CurrentVector = Eigen::Matrix<DataType, 2, 1>;
 
+  private:
+    /// Inverse of the linear part of the circuit
+    Matrix linear_inverse;
+    /// Voltages created by the tube currents Ib and Ic
+    Eigen::Matrix<DataType, 4, 2> current_gain;
+
+  public:
     template<typename T>
     CommonCathodeTriode2Function(DataType dt, DataType Rp, DataType Rg, DataType Ro, DataType Rk, DataType Vbias, DataType Co, DataType Ck, TriodeFunction& tube_function, const T& default_output)
       :Rp(1/Rp), Rg(1/Rg), Ro(1/Ro), Rk(1/Rk), Vbias(Vbias), Co(2 / dt * Co), Ck(2 / dt * Ck), Cpg(2 / dt * tube_function.Cpg), ickeq(2 / dt * Ck * default_output[1]), icoeq(-2 / dt * Co * default_output[2]), icpgeq(Cpg * (default_output[3] - default_output[4]) ), tube_function(tube_function)
     {
+      // The tube currents enter the cathode node, Ic leaves the plate node and Ib the grid node
+      Matrix linear;
+      linear << -(this->Rk + this->Ck), 0, 0, 0,
+        0, this->Ro + this->Co, this->Ro, 0,
+        0, this->Ro, this->Rp + this->Ro + this->Cpg, -this->Cpg,
+        0, 0, -this->Cpg, this->Rg + this->Cpg;
+      Eigen::Matrix<DataType, 4, 2> currents;
+      currents << 1, 1,
+        0, 0,
+        0, 1,
+        1, 0;
+      linear_inverse = linear.inverse();
+      current_gain = -linear_inverse * currents;
+    }
+
+    /// Returns K, the matrix between the tube currents and (Vgk, Vpk), row major
+    std::array<double, 4> get_nonlinear_matrix() const
+    {
+      return {{static_cast<double>(current_gain(3, 0) - current_gain(0, 0)), static_cast<double>(current_gain(3, 1) - current_gain(0, 1)),
+        static_cast<double>(current_gain(2, 0) - current_gain(0, 0)), static_cast<double>(current_gain(2, 1) - current_gain(0, 1))}};
+    }
+
+    /// Returns the voltages of the circuit without any tube current
+    Vector linear_solve(gsl::index i, const DataType* const * ATK_RESTRICT input) const
+    {
+      return linear_inverse * Vector(-ickeq, -icoeq, Vbias * Rp + icpgeq, input[0][i] * Rg - icpgeq);
+    }
+
+    /// Returns the voltages created by the tube currents Ib and Ic
+    const Eigen::Matrix<DataType, 4, 2>& get_current_gain() const
+    {
+      return current_gain;
     }
 
     Vector estimate(gsl::index i, const DataType* const * ATK_RESTRICT input, DataType* const * ATK_RESTRICT output)
@@ -68,7 +109,7 @@ namespace ATK
       icpgeq = 2 * Cpg * (output[3][i] - output[4][i]) - icpgeq;
     }
 
-    Vector operator()(gsl::index i, const DataType* const * ATK_RESTRICT input, DataType* const * ATK_RESTRICT output, const Vector& y1)
+    void operator()(gsl::index i, const DataType* const * ATK_RESTRICT input, DataType* const * ATK_RESTRICT output, const Vector& y1, Vector& F, Matrix& M)
     {
       auto Ib = tube_function.Lb(y1(3) - y1(0), y1(2) - y1(0));
       auto Ic = tube_function.Lc(y1(3) - y1(0), y1(2) - y1(0));
@@ -85,18 +126,15 @@ namespace ATK
       auto g1 = (y1(2) - Vbias) * Rp + (Ic + (y1(1) + y1(2)) * Ro) + (y1(2) - y1(3)) * Cpg - icpgeq;
       auto g2 = (y1(3) - input[0][i]) * Rg + Ib + icpgeq - (y1(2) - y1(3)) * Cpg;
       
-      Vector F(f1,
+      F << f1,
            f2,
            g1,
-           g2);
+           g2;
 
-      Matrix M;
       M << -(Ib_Vbe + Ic_Vbe + Ib_Vce + Ic_Vce) - (Rk + Ck), 0, (Ib_Vce + Ic_Vce), (Ib_Vbe + Ic_Vbe),
             0, Ro + Co, Ro, 0,
       -(Ic_Vbe + Ic_Vce), Ro, Rp + Ro + Ic_Vce + Cpg, Ic_Vbe - Cpg,
             -(Ib_Vbe + Ib_Vce), 0, Ib_Vce - Cpg, Ib_Vbe + Rg + Cpg;
-
-      return M.inverse() * F;
     }
 
   };
@@ -122,7 +160,7 @@ namespace ATK
     {
     }
 
-    Vector operator()(const Vector& y1)
+    void operator()(const Vector& y1, Vector& F, Matrix& M)
     {
       auto Ib = tube_function.Lb(y1(1) - y1(2), y1(0) - y1(2));
       auto Ic = tube_function.Lc(y1(1) - y1(2), y1(0) - y1(2));
@@ -133,16 +171,13 @@ namespace ATK
       auto Ic_Vbe = tube_function.Lc_Vbe(y1(1) - y1(2), y1(0) - y1(2));
       auto Ic_Vce = tube_function.Lc_Vce(y1(1) - y1(2), y1(0) - y1(2));
 
-      Vector F(y1(0) - Vbias + Ic * Rp,
+      F << y1(0) - Vbias + Ic * Rp,
         Ib * Rg + y1(1),
-        y1(2) - (Ib + Ic) * Rk);
+        y1(2) - (Ib + Ic) * Rk;
 
-      Matrix M;
       M << 1 + Rp * Ic_Vce, Rp * Ic_Vbe, -Rp * (Ic_Vbe + Ic_Vce),
         Ib_Vce * Rg, 1 + Rg * Ib_Vbe, -Rg * (Ib_Vbe + Ib_Vce),
         -(Ic_Vce + Ib_Vce) * Rk, -(Ic_Vbe + Ib_Vbe) * Rk, 1 + (Ic_Vbe + Ic_Vce + Ib_Vbe + Ib_Vce) * Rk;
-
-      return M.inverse() * F;
     }
   };
 
@@ -155,7 +190,7 @@ namespace ATK
 
   template <typename DataType, typename TriodeFunction>
   Triode2Filter<DataType, TriodeFunction>::Triode2Filter(Triode2Filter&& other)
-  :Parent(std::move(other)), Rp(other.Rp), Rg(other.Rg), Ro(other.Ro), Rk(other.Rk), Vbias(other.Vbias), Co(other.Co), Ck(other.Ck), tube_function(std::move(other.tube_function))
+  :Parent(std::move(other)), TriodeTableSolver<DataType>(std::move(other)), Rp(other.Rp), Rg(other.Rg), Ro(other.Ro), Rk(other.Rk), Vbias(other.Vbias), Co(other.Co), Ck(other.Ck), tube_function(std::move(other.tube_function))
   {
   }
 
@@ -174,6 +209,24 @@ namespace ATK
       Co, Ck, // C
       tube_function, // tube
       default_output));
+    build_table();
+  }
+
+  template<typename DataType,  typename TriodeFunction>
+  void Triode2Filter<DataType, TriodeFunction>::build_table()
+  {
+    std::ostringstream key;
+    key.precision(17);
+    key << "Triode2Filter " << sizeof(DataType) << ' ' << Rp << ' ' << Rg << ' ' << Ro << ' ' << Rk << ' ' << Vbias << ' ' << Co << ' ' << Ck;
+    this->update_table(key.str(), input_sampling_rate, tube_function, [this]()
+    {
+      return VectorizedNewtonRaphson<CommonCathodeTriode2Function, 4, iterations, true>(CommonCathodeTriode2Function(static_cast<DataType>(1. / input_sampling_rate),
+        Rp, Rg, Ro, Rk, //R
+        Vbias, // Vbias
+        Co, Ck, // C
+        tube_function, // tube
+        default_output));
+    }, default_output);
   }
 
   template<typename DataType, typename TriodeFunction>
@@ -207,7 +260,11 @@ namespace ATK
 
     for(gsl::index i = 0; i < size; ++i)
     {
-      optimizer->optimize(i, converted_inputs.data(), outputs.data() + 1);
+      // The samples outside of the table are still solved exactly
+      if(!this->table_solve(optimizer->get_function(), i, converted_inputs.data(), outputs.data() + 1))
+      {
+        optimizer->optimize(i, converted_inputs.data(), outputs.data() + 1);
+      }
       outputs[0][i] = outputs[2][i] + outputs[3][i];
       optimizer->get_function().update_state(i, converted_inputs.data(), outputs.data());
     }
@@ -7,9 +7,12 @@
 #define ATK_PREAMPLIFIER_TRIODE2FILTER_H
 
 #include <ATK/Preamplifier/config.h>
+#include <ATK/Preamplifier/TriodeTableSolver.h>
 #include <ATK/Core/TypedBaseFilter.h>
 
 #include <list>
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace ATK
@@ -26,7 +29,7 @@ namespace ATK
    * Output 4 is Vb
    */
   template<typename DataType_, typename TriodeFunction>
-  class ATK_PREAMPLIFIER_EXPORT Triode2Filter final : public TypedBaseFilter<DataType_>
+  class ATK_PREAMPLIFIER_EXPORT Triode2Filter final : public TypedBaseFilter<DataType_>, public TriodeTableSolver<DataType_>
   {
     class CommonCathodeTriode2Function;
   public:
@@ -55,6 +58,9 @@ namespace ATK
 
     TriodeFunction tube_function;
 
+    /// Loads the table of this circuit from the cache or computes it
+    void build_table() final;
+
   protected:
     /// Constructor, used with a builder static method
     Triode2Filter(DataType Rp, DataType Rg, DataType Ro, DataType Rk, DataType Vbias, DataType Co, DataType Ck, TriodeFunction&& tube_function);
@@ -0,0 +1,172 @@
+/**
+ * \file TriodeTable.cpp
+ */
+
+#include <ATK/Preamplifier/TriodeTable.h>
+#include <ATK/config.h>
+
+#include <cstdint>
+#include <fstream>
+
+namespace ATK
+{
+  namespace
+  {
+    /// Catmull-Rom weights for the 4 nodes around a fraction
+    template<typename DataType>
+    std::array<DataType, 4> cubic_weights(DataType t)
+    {
+      auto t2 = t * t;
+      auto t3 = t2 * t;
+      return {{(-t3 + 2 * t2 - t) / 2, (3 * t3 - 5 * t2 + 2) / 2, (-3 * t3 + 4 * t2 + t) / 2, (t3 - t2) / 2}};
+    }
+  }
+
+  template<typename DataType>
+  TriodeTable<DataType>::TriodeTable(gsl::index size)
+  :size(size)
+  {
+  }
+
+  template<typename DataType>
+  gsl::index TriodeTable<DataType>::get_size() const
+  {
+    return size;
+  }
+
+  template<typename DataType>
+  const std::array<double, 4>& TriodeTable<DataType>::get_bounds() const
+  {
+    return bounds;
+  }
+
+  template<typename DataType>
+  void TriodeTable<DataType>::update_scales()
+  {
+    scale0 = static_cast<DataType>((size - 1) / (bounds[1] - bounds[0]));
+    scale1 = static_cast<DataType>((size - 1) / (bounds[3] - bounds[2]));
+  }
+
+  template<typename DataType>
+  bool TriodeTable<DataType>::save(const std::string& filename, const std::string& key) const
+  {
+    std::ofstream stream(filename, std::ios::binary);
+    if(!stream)
+    {
+      return false;
+    }
+    std::uint64_t key_size = key.size();
+    std::int64_t table_size = size;
+    std::uint64_t data_size = sizeof(DataType);
+    stream.write(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
+    stream.write(key.data(), static_cast<std::streamsize>(key_size));
+    stream.write(reinterpret_cast<const char*>(&table_size), sizeof(table_size));
+    stream.write(reinterpret_cast<const char*>(&data_size), sizeof(data_size));
+    stream.write(reinterpret_cast<const char*>(bounds.data()), sizeof(bounds));
+    stream.write(reinterpret_cast<const char*>(currents.data()), static_cast<std::streamsize>(currents.size() * sizeof(DataType)));
+    return static_cast<bool>(stream);
+  }
+
+  template<typename DataType>
+  bool TriodeTable<DataType>::load(const std::string& filename, const std::string& key)
+  {
+    std::ifstream stream(filename, std::ios::binary);
+    if(!stream)
+    {
+      return false;
+    }
+    std::uint64_t key_size = 0;
+    stream.read(reinterpret_cast<char*>(&key_size), sizeof(key_size));
+    if(!stream || key_size != key.size())
+    {
+      return false;
+    }
+    std::string file_key(key_size, '\0');
+    stream.read(&file_key[0], static_cast<std::streamsize>(key_size));
+    std::int64_t table_size = 0;
+    std::uint64_t data_size = 0;
+    stream.read(reinterpret_cast<char*>(&table_size), sizeof(table_size));
+    stream.read(reinterpret_cast<char*>(&data_size), sizeof(data_size));
+    if(!stream || file_key != key || table_size != size || data_size != sizeof(DataType))
+    {
+      return false;
+    }
+    std::array<double, 4> file_bounds;
+    std::vector<DataType> file_currents(2 * size * size);
+    stream.read(reinterpret_cast<char*>(file_bounds.data()), sizeof(file_bounds));
+    stream.read(reinterpret_cast<char*>(file_currents.data()), static_cast<std::streamsize>(file_currents.size() * sizeof(DataType)));
+    if(!stream)
+    {
+      return false;
+    }
+    bounds = file_bounds;
+    currents = std::move(file_currents);
+    update_scales();
+    return true;
+  }
+
+  template<typename DataType>
+  bool TriodeTable<DataType>::interpolate_linear(DataType p0, DataType p1, DataType& Ib, DataType& Ic) const
+  {
+    auto x = (p0 - static_cast<DataType>(bounds[0])) * scale0;
+    auto y = (p1 - static_cast<DataType>(bounds[2])) * scale1;
+    // Also false for NaN
+    if(!(x >= 0 && x <= size - 1 && y >= 0 && y <= size - 1))
+    {
+      return false;
+    }
+    auto ix = std::min(static_cast<gsl::index>(x), size - 2);
+    auto iy = std::min(static_cast<gsl::index>(y), size - 2);
+    auto fx = x - ix;
+    auto fy = y - iy;
+    const auto* row0 = currents.data() + 2 * (iy * size + ix);
+    const auto* row1 = row0 + 2 * size;
+    Ib = (row0[0] + fx * (row0[2] - row0[0])) * (1 - fy) + (row1[0] + fx * (row1[2] - row1[0])) * fy;
+    Ic = (row0[1] + fx * (row0[3] - row0[1])) * (1 - fy) + (row1[1] + fx * (row1[3] - row1[1])) * fy;
+    return true;
+  }
+
+  template<typename DataType>
+  bool TriodeTable<DataType>::interpolate_cubic(DataType p0, DataType p1, DataType& Ib, DataType& Ic) const
+  {
+    auto x = (p0 - static_cast<DataType>(bounds[0])) * scale0;
+    auto y = (p1 - static_cast<DataType>(bounds[2])) * scale1;
+    if(!(x >= 0 && x <= size - 1 && y >= 0 && y <= size - 1))
+    {
+      return false;
+    }
+    auto ix = std::min(static_cast<gsl::index>(x), size - 2);
+    auto iy = std::min(static_cast<gsl::index>(y), size - 2);
+    auto wx = cubic_weights(x - ix);
+    auto wy = cubic_weights(y - iy);
+    // The borders are repeated
+    std::array<gsl::index, 4> columns;
+    for(gsl::index i = 0; i < 4; ++i)
+    {
+      columns[i] = 2 * std::clamp<gsl::index>(ix + i - 1, 0, size - 1);
+    }
+    DataType sum_b = 0;
+    DataType sum_c = 0;
+    for(gsl::index j = 0; j < 4; ++j)
+    {
+      const auto* row = currents.data() + 2 * size * std::clamp<gsl::index>(iy + j - 1, 0, size - 1);
+      DataType row_b = 0;
+      DataType row_c = 0;
+      for(gsl::index i = 0; i < 4; ++i)
+      {
+        row_b += wx[i] * row[columns[i]];
+        row_c += wx[i] * row[columns[i] + 1];
+      }
+      sum_b += wy[j] * row_b;
+      sum_c += wy[j] * row_c;
+    }
+    Ib = sum_b;
+    Ic = sum_c;
+    return true;
+  }
+
+#if ATK_ENABLE_INSTANTIATION
+  template class TriodeTable<float>;
+#endif
+  template class TriodeTable<double>;
+}
@@ -0,0 +1,186 @@
+/**
+ * \file TriodeTable.h
+ * Precomputed solutions of the nonlinear part of a triode stage, following the DK method
+ * (Yeh, Abel and Smith, Automated physical modeling of nonlinear audio circuits for real-time audio effects)
+ */
+
+#ifndef ATK_PREAMPLIFIER_TRIODETABLE_H
+#define ATK_PREAMPLIFIER_TRIODETABLE_H
+
+#include <ATK/Preamplifier/config.h>
+
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ATK
+{
+  /// How the triode filters solve their nonlinear equations
+  enum class TriodeSolver
+  {
+    /// A Newton-Raphson solver for each sample, the reference
+    NewtonRaphson,
+    /// Bilinear interpolation in a TriodeTable
+    LinearTable,
+    /// Bicubic interpolation in a TriodeTable
+    CubicTable
+  };
+
+  /// Tabulated solution of the nonlinear part of a triode stage
+  /*!
+   * Once the linear part of the circuit is solved, the stage only depends on two voltages v = (Vgk, Vpk) and on the
+   * tube currents i = (Ib, Ic), linked by v = p + K i. p, the prediction of the voltages without any tube current,
+   * is a linear function of the input and of the capacitor states. The table stores the currents that solve this
+   * equation on a regular grid of p.
+   */
+  template<typename DataType_>
+  class ATK_PREAMPLIFIER_EXPORT TriodeTable final
+  {
+  public:
+    using DataType = DataType_;
+
+    /*!
+     * @brief Constructor of an empty table
+     * @param size is the number of nodes of the grid along each dimension
+     */
+    explicit TriodeTable(gsl::index size);
+
+    /// Returns the number of nodes along each dimension
+    gsl::index get_size() const;
+    /// Returns the bounds of the grid, {p0 min, p0 max, p1 min, p1 max}
+    const std::array<double, 4>& get_bounds() const;
+
+    /*!
+     * @brief Solves the nonlinear equation on each node of the grid
+     * @param function is the tube model
+     * @param K is the matrix between the currents and the voltages, row major
+     * @param bounds are the bounds of the grid, {p0 min, p0 max, p1 min, p1 max}
+     */
+    template<typename TriodeFunction>
+    void build(TriodeFunction& function, const std::array<double, 4>& K, const std::array<double, 4>& bounds);
+
+    /*!
+     * @brief Saves the table
+     * @param filename is the file to write
+     * @param key identifies the circuit, it must be the same to load the table
+     * @return true if the file was written
+     */
+    bool save(const std::string& filename, const std::string& key) const;
+    /*!
+     * @brief Loads a table saved with the same key and size
+     * @return true if the table was loaded
+     */
+    bool load(const std::string& filename, const std::string& key);
+
+    /*!
+     * @brief Returns the currents for a prediction with a bilinear interpolation
+     * @return false if the prediction is outside of the grid, the currents are not modified
+     */
+    bool interpolate_linear(DataType p0, DataType p1, DataType& Ib, DataType& Ic) const;
+    /// Same as interpolate_linear with a Catmull-Rom bicubic interpolation
+    bool interpolate_cubic(DataType p0, DataType p1, DataType& Ib, DataType& Ic) const;
+
+    /// Returns a string that changes with the parameters of the tube model, to be used in the keys
+    template<typename TriodeFunction>
+    static std::string fingerprint(TriodeFunction& function);
+
+  private:
+    gsl::index size;
+    std::array<double, 4> bounds{{0, 0, 0, 0}};
+    /// Inverse of the steps of the grid
+    DataType scale0{0};
+    DataType scale1{0};
+    /// Ib and Ic for each node, p1 major
+    std::vector<DataType> currents;
+
+    void update_scales();
+  };
+
+  template<typename DataType>
+  template<typename TriodeFunction>
+  void TriodeTable<DataType>::build(TriodeFunction& function, const std::array<double, 4>& K, const std::array<double, 4>& bounds)
+  {
+    this->bounds = bounds;
+    update_scales();
+    currents.assign(2 * size * size, 0);
+
+    // Each row starts from the solution of the previous one, each node from the previous node
+    std::array<double, 2> row_start{{bounds[0], bounds[2]}};
+    for(gsl::index j = 0; j < size; ++j)
+    {
+      auto p1 = bounds[2] + (bounds[3] - bounds[2]) * j / (size - 1);
+      std::array<double, 2> v = row_start;
+      for(gsl::index k = 0; k < size; ++k)
+      {
+        auto p0 = bounds[0] + (bounds[1] - bounds[0]) * k / (size - 1);
+        double Ib = 0;
+        double Ic = 0;
+        for(int iteration = 0; iteration < 100; ++iteration)
+        {
+          Ib = function.Lb(v[0], v[1]);
+          Ic = function.Lc(v[0], v[1]);
+          double Ib_Vbe = function.Lb_Vbe(v[0], v[1]);
+          double Ib_Vce = function.Lb_Vce(v[0], v[1]);
+          double Ic_Vbe = function.Lc_Vbe(v[0], v[1]);
+          double Ic_Vce = function.Lc_Vce(v[0], v[1]);
+
+          // F(v) = v - p - K i(v), J = I - K di/dv
+          auto F0 = v[0] - p0 - K[0] * Ib - K[1] * Ic;
+          auto F1 = v[1] - p1 - K[2] * Ib - K[3] * Ic;
+          auto J00 = 1 - K[0] * Ib_Vbe - K[1] * Ic_Vbe;
+          auto J01 = -K[0] * Ib_Vce - K[1] * Ic_Vce;
+          auto J10 = -K[2] * Ib_Vbe - K[3] * Ic_Vbe;
+          auto J11 = 1 - K[2] * Ib_Vce - K[3] * Ic_Vce;
+          auto determinant = J00 * J11 - J01 * J10;
+          auto delta0 = (J11 * F0 - J01 * F1) / determinant;
+          auto delta1 = (J00 * F1 - J10 * F0) / determinant;
+          // Large steps overshoot in the exponential parts of the models
+          auto largest = std::max(std::abs(delta0), std::abs(delta1));
+          if(largest > 1)
+          {
+            delta0 /= largest;
+            delta1 /= largest;
+          }
+          v[0] -= delta0;
+          v[1] -= delta1;
+          if(largest < 1e-12 * (1 + std::abs(v[0]) + std::abs(v[1])))
+          {
+            break;
+          }
+        }
+        Ib = function.Lb(v[0], v[1]);
+        Ic = function.Lc(v[0], v[1]);
+        currents[2 * (j * size + k)] = static_cast<DataType>(Ib);
+        currents[2 * (j * size + k) + 1] = static_cast<DataType>(Ic);
+        if(k == 0)
+        {
+          row_start = v;
+        }
+      }
+    }
+  }
+
+  template<typename DataType>
+  template<typename TriodeFunction>
+  std::string TriodeTable<DataType>::fingerprint(TriodeFunction& function)
+  {
+    std::ostringstream stream;
+    stream.precision(17);
+    for(auto Vbe: {-2., -.5, 0., .5})
+    {
+      for(auto Vce: {50., 150., 300.})
+      {
+        stream << function.Lb(Vbe, Vce) << ' ';
+        stream << function.Lc(Vbe, Vce) << ' ';
+      }
+    }
+    return stream.str();
+  }
+}
+
+#endif
@@ -0,0 +1,233 @@
+/**
+ * \file TriodeTableSolver.h
+ */
+
+#ifndef ATK_PREAMPLIFIER_TRIODETABLESOLVER_H
+#define ATK_PREAMPLIFIER_TRIODETABLESOLVER_H
+
+#include <ATK/Preamplifier/TriodeTable.h>
+#include <ATK/Core/Utilities.h>
+#include <ATK/config.h>
+
+#include <boost/math/constants/constants.hpp>
+
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ATK
+{
+  /// Solver selection and table management shared by the triode filters
+  /*!
+   * The filters implement build_table() with update_table(), from the key of their circuit and a factory of
+   * Newton-Raphson solvers of the circuit. The functions of the circuits provide linear_solve, get_current_gain and
+   * get_nonlinear_matrix, their voltages 0, 2 and 3 are the ones of the cathode, of the plate and of the grid.
+   */
+  template<typename DataType_>
+  class TriodeTableSolver
+  {
+  public:
+    /// Destructor
+    virtual ~TriodeTableSolver() = default;
+
+    /*!
+     * @brief Selects how the nonlinear equations are solved, the table is built when the sampling rate is known
+     * The samples outside of the table are solved with the Newton-Raphson solver.
+     */
+    void set_solver(TriodeSolver solver)
+    {
+      this->solver = solver;
+      build_table();
+    }
+
+    /// Returns the current solver
+    TriodeSolver get_solver() const
+    {
+      return solver;
+    }
+
+    /// Sets the number of nodes of the table along each dimension, 256 by default
+    void set_table_size(gsl::index size)
+    {
+      if(size < 4)
+      {
+        throw RuntimeError("The table needs at least 4 nodes along each dimension");
+      }
+      table_size = size;
+      build_table();
+    }
+
+    /// Returns the number of nodes of the table along each dimension
+    gsl::index get_table_size() const
+    {
+      return table_size;
+    }
+
+    /// Sets the largest input amplitude the table is computed for, 10V by default
+    void set_table_input_range(DataType_ range)
+    {
+      if(range <= 0)
+      {
+        throw RuntimeError("The input range must be strictly positive");
+      }
+      table_input_range = range;
+      build_table();
+    }
+
+    /// Returns the largest input amplitude the table is computed for
+    DataType_ get_table_input_range() const
+    {
+      return table_input_range;
+    }
+
+    /// Sets the directory where the tables are saved and looked for, empty (no cache) by default
+    void set_table_cache(const std::string& directory)
+    {
+      table_cache = directory;
+    }
+
+    /// Returns the directory of the cached tables
+    const std::string& get_table_cache() const
+    {
+      return table_cache;
+    }
+
+  protected:
+    TriodeTableSolver() = default;
+    TriodeTableSolver(TriodeTableSolver&& other) = default;
+
+    /// Loads the table from the cache or computes it with update_table
+    virtual void build_table() = 0;
+
+    /*!
+     * @brief Loads the table from the cache or computes it
+     * @param circuit_key identifies the filter, its data type and its components
+     * @param sampling_rate is the sampling rate of the filter, there is no table while it is unknown
+     * @param tube_function is the tube model
+     * @param create_solver returns a Newton-Raphson solver of the circuit starting from default_output
+     * @param default_output is the steady state of the circuit, for each output of the filter
+     */
+    template<typename TriodeFunction, typename CreateSolver, typename Outputs>
+    void update_table(const std::string& circuit_key, gsl::index sampling_rate, TriodeFunction& tube_function, const CreateSolver& create_solver, const Outputs& default_output)
+    {
+      table.reset();
+      if(solver == TriodeSolver::NewtonRaphson || sampling_rate == 0)
+      {
+        return;
+      }
+      table = std::make_unique<TriodeTable<DataType_>>(table_size);
+
+      // Everything the table depends on, the tube parameters are only known through their currents
+      std::ostringstream key;
+      key.precision(17);
+      key << circuit_key << ' ' << sampling_rate << ' ' << table_input_range << ' ' << table_size << ' ' << TriodeTable<DataType_>::fingerprint(tube_function);
+      std::string filename;
+      if(!table_cache.empty())
+      {
+        std::ostringstream name;
+        name << table_cache << "/triode_" << std::hex << std::hash<std::string>()(key.str()) << ".table";
+        filename = name.str();
+        if(table->load(filename, key.str()))
+        {
+          return;
+        }
+      }
+
+      auto calibration = create_solver();
+      auto K = calibration.get_function().get_nonlinear_matrix();
+      table->build(tube_function, K, calibrate_table(calibration, sampling_rate, default_output));
+      if(!filename.empty())
+      {
+        table->save(filename, key.str());
+      }
+    }
+
+    /// Solves the circuit with the tube currents of the table, returns false without a table or outside of it
+    template<typename Function>
+    bool table_solve(const Function& function, gsl::index i, const DataType_* const * ATK_RESTRICT input, DataType_* const * ATK_RESTRICT output) const
+    {
+      if(!table)
+      {
+        return false;
+      }
+      auto y = function.linear_solve(i, input);
+      typename Function::CurrentVector currents;
+      bool cubic = solver == TriodeSolver::CubicTable;
+      if(!(cubic ? table->interpolate_cubic(y(3) - y(0), y(2) - y(0), currents(0), currents(1)) : table->interpolate_linear(y(3) - y(0), y(2) - y(0), currents(0), currents(1))))
+      {
+        return false;
+      }
+      y += function.get_current_gain() * currents;
+      for(gsl::index j = 0; j < 4; ++j)
+      {
+        output[j][i] = y(j);
+      }
+      return true;
+    }
+
+  private:
+    TriodeSolver solver{TriodeSolver::NewtonRaphson};
+    gsl::index table_size{256};
+    DataType_ table_input_range{10};
+    std::string table_cache;
+    /// The solutions of the nonlinear part, built by setup() when a table solver is selected
+    std::unique_ptr<TriodeTable<DataType_>> table;
+
+    /// Returns the bounds of the predictions met when processing a chirp at the largest amplitude
+    template<typename Solver, typename Outputs>
+    std::array<double, 4> calibrate_table(Solver& calibration, gsl::index sampling_rate, const Outputs& default_output) const
+    {
+      // A logarithmic chirp from 20Hz to a quarter of the sampling rate at the largest amplitude
+      auto nb_samples = static_cast<gsl::index>(sampling_rate / 5);
+      auto duration = static_cast<double>(nb_samples) / sampling_rate;
+      auto growth = std::log(sampling_rate / 4 / 20.);
+      std::vector<DataType_> input(nb_samples + 1, 0);
+      for(gsl::index i = 1; i <= nb_samples; ++i)
+      {
+        auto t = static_cast<double>(i) / sampling_rate;
+        input[i] = static_cast<DataType_>(table_input_range * std::sin(2 * boost::math::constants::pi<double>() * 20 * duration / growth * (std::exp(t / duration * growth) - 1)));
+      }
+      std::vector<std::vector<DataType_>> voltages;
+      std::vector<DataType_*> outputs;
+      for(gsl::index j = 0; j < static_cast<gsl::index>(default_output.size()); ++j)
+      {
+        voltages.emplace_back(nb_samples + 1, default_output[j]);
+      }
+      for(auto& voltage: voltages)
+      {
+        outputs.push_back(voltage.data());
+      }
+      const DataType_* inputs[1] = {input.data()};
+
+      std::array<double, 4> bounds{{std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest()}};
+      for(gsl::index i = 1; i <= nb_samples; ++i)
+      {
+        auto y = calibration.get_function().linear_solve(i, inputs);
+        bounds[0] = std::min<double>(bounds[0], y(3) - y(0));
+        bounds[1] = std::max<double>(bounds[1], y(3) - y(0));
+        bounds[2] = std::min<double>(bounds[2], y(2) - y(0));
+        bounds[3] = std::max<double>(bounds[3], y(2) - y(0));
+        calibration.optimize(i, inputs, outputs.data() + 1);
+        calibration.get_function().update_state(i, inputs, outputs.data());
+      }
+      // Some margin for the other signals
+      for(gsl::index j = 0; j < 4; j += 2)
+      {
+        auto margin = std::max(.1, (bounds[j + 1] - bounds[j]) / 10);
+        bounds[j] -= margin;
+        bounds[j + 1] += margin;
+      }
+      return bounds;
+    }
+  };
+}
+
+#endif
@@ -3,9 +3,11 @@
  */
 
 #include "ConvolutionFilter.h"
+#include "helpers.h"
 
 #include <cassert>
 #include <algorithm>
+#include <iterator>
 
 namespace ATK
 {
@@ -37,19 +39,26 @@ namespace ATK
       return;
     }
 
-    auto nb_splits = (impulse.size() + split_size - 1) / split_size;
-    partial_frequency_input.assign(nb_splits - 1, AlignedComplexVector(split_size * 2, 0));
+    // The first chunk is processed directly, the other ones in the frequency domain
+    nb_chunks = (impulse.size() + split_size - 1) / split_size - 1;
+    nb_bins = split_size + 1;
     // Pad with zeros so the convolution is easier created.
-    impulse.resize((partial_frequency_input.size() + 1) * split_size, 0);
+    impulse.resize((nb_chunks + 1) * split_size, 0);
 
     temp_out_buffer.assign(split_size * 2, 0);
+    frequency_delay_line.assign(2 * nb_bins * nb_chunks, 0);
+    frequency_delay_line_position = 0;
+    accumulated_spectrum.assign(2 * nb_bins, 0);
+    result.assign(nb_bins, 0);
+    ifft_result.assign(split_size * 2, 0);
     processor.set_size(split_size * 2);
     
-    // The size is twice as big than the impulse, less
-    partial_frequency_impulse.assign(split_size * 2 * (nb_splits - 1), 0);
-    for(gsl::index i = 1; i < nb_splits; ++i)
+    // Only the first half of the spectra is kept, scaled by the inverse FFT normalization
+    partial_frequency_impulse.assign(2 * nb_bins * nb_chunks, 0);
+    for(gsl::index i = 0; i < nb_chunks; ++i)
     {
-      processor.process_forward(impulse.data() + i * split_size, partial_frequency_impulse.data() + (i - 1) * split_size * 2, split_size);
+      processor.process_forward_real(impulse.data() + (i + 1) * split_size, result.data(), split_size);
+      ConvolutionUtilities::split_spectrum(result.data(), partial_frequency_impulse.data() + i * 2 * nb_bins, nb_bins, static_cast<DataType>(split_size * 2));
     }
 
     input_delay = split_size - 1;
@@ -66,56 +75,42 @@ namespace ATK
       temp_out_buffer[i + split_size] = 0;
     }
     
-    result.assign(2 * split_size, 0);
-    DataType* ATK_RESTRICT result_ptr_orig = reinterpret_cast<DataType*>(result.data());
-    const DataType* ATK_RESTRICT partial_frequency_impulse_ptr_orig = reinterpret_cast<const DataType*>(partial_frequency_impulse.data());
+    std::fill(accumulated_spectrum.begin(), accumulated_spectrum.end(), 0);
+    DataType* ATK_RESTRICT accumulated_spectrum_ptr = accumulated_spectrum.data();
 
-    // offset in the impulse frequencies
-    int64_t offset = 0;
-    for(const auto& buffer: partial_frequency_input)
+    // The newest chunk is convolved with the second chunk of the impulse, and so on, the delay line wrapping around
+    gsl::index chunk = 0;
+    for(gsl::index position = frequency_delay_line_position; position < nb_chunks; ++position, ++chunk)
     {
-      DataType* ATK_RESTRICT result_ptr = result_ptr_orig;
-      const DataType* ATK_RESTRICT buffer_ptr = reinterpret_cast<const DataType*>(buffer.data());
-      const DataType* ATK_RESTRICT partial_frequency_impulse_ptr = partial_frequency_impulse_ptr_orig + offset;
-      // Add the frequency result of this partial FFT
-      for(gsl::index i = 0; i < split_size; ++i)
-      {
-        DataType br1 = *(buffer_ptr++);
-        DataType bi1 = *(buffer_ptr++);
-        DataType pr1 = *(partial_frequency_impulse_ptr++);
-        DataType pi1 = *(partial_frequency_impulse_ptr++);
-        DataType br2 = *(buffer_ptr++);
-        DataType bi2 = *(buffer_ptr++);
-        DataType pr2 = *(partial_frequency_impulse_ptr++);
-        DataType pi2 = *(partial_frequency_impulse_ptr++);
-        *(result_ptr++) += br1*pr1-bi1*pi1;
-        *(result_ptr++) += br1*pi1+pr1*bi1;
-        *(result_ptr++) += br2*pr2-bi2*pi2;
-        *(result_ptr++) += br2*pi2+pr2*bi2;
-      }
-      offset += 4 * split_size;
+      ConvolutionUtilities::multiply_accumulate(frequency_delay_line.data() + position * 2 * nb_bins, partial_frequency_impulse.data() + chunk * 2 * nb_bins, accumulated_spectrum_ptr, nb_bins);
+    }
+    for(gsl::index position = 0; position < frequency_delay_line_position; ++position, ++chunk)
+    {
+      ConvolutionUtilities::multiply_accumulate(frequency_delay_line.data() + position * 2 * nb_bins, partial_frequency_impulse.data() + chunk * 2 * nb_bins, accumulated_spectrum_ptr, nb_bins);
     }
 
-    std::vector<DataType> ifft_result(2*split_size, 0);
-    processor.process_backward(result.data(), ifft_result.data(), 2*split_size);
+    // Only the first half of the spectrum of the real result is needed
+    ConvolutionUtilities::merge_spectrum(accumulated_spectrum_ptr, result.data(), nb_bins);
+
+    processor.process_backward_real(result.data(), ifft_result.data(), 2*split_size);
     for(gsl::index i = 0; i < 2*split_size; ++i)
     {
-      temp_out_buffer[i] += ifft_result[i] * split_size * 2;
+      temp_out_buffer[i] += ifft_result[i];
     }
   }
 
   template<typename DataType_>
   void ConvolutionFilter<DataType_>::process_new_chunk(int64_t position) const
   {
-    if(partial_frequency_input.empty())
+    if(nb_chunks == 0)
     {
       return;
     }
-    partial_frequency_input.pop_back();
-    AlignedComplexVector chunk(2 * split_size);
-    processor.process_forward(converted_inputs[0] + position - split_size, chunk.data(), split_size);
-    
-    partial_frequency_input.push_front(std::move(chunk));
+    // The oldest chunk is replaced by the newest one
+    frequency_delay_line_position = (frequency_delay_line_position == 0 ? nb_chunks : frequency_delay_line_position) - 1;
+    processor.process_forward_real(converted_inputs[0] + position - split_size, result.data(), split_size);
+    ConvolutionUtilities::split_spectrum(result.data(), frequency_delay_line.data() + frequency_delay_line_position * 2 * nb_bins, nb_bins);
+
     compute_convolutions();
   }
 
@@ -164,5 +159,8 @@ namespace ATK
     }while(processed_size != size);
   }
 
+#if ATK_ENABLE_INSTANTIATION
+  template class ConvolutionFilter<float>;
+#endif
   template class ConvolutionFilter<double>;
 }
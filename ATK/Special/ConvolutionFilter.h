@@ -9,7 +9,6 @@
 #include <ATK/Core/TypedBaseFilter.h>
 #include <ATK/Utility/FFT.h>
 
-#include <list>
 #include <vector>
 
 namespace ATK
@@ -37,7 +36,11 @@ namespace ATK
     mutable unsigned int split_position{0};
     /// Size of the individual FFTs that are processed
     unsigned int split_size = 0;
-    
+    /// Number of frequency bins kept for each chunk (the spectra of real signals are symmetric)
+    gsl::index nb_bins{0};
+    /// Number of chunks of the impulse processed in the frequency domain
+    gsl::index nb_chunks{0};
+
     /// FFT object for fast FFT/iFFT
     FFT<DataType> processor;
     
@@ -45,13 +48,19 @@ namespace ATK
     AlignedScalarVector impulse;
     /// This buffer contains the head of the last convolution (easier to have 2 parts)
     mutable AlignedVector temp_out_buffer;
-    /// Called partial convolutions, but actually contains the former temp_in_buffers
-    mutable std::list<AlignedComplexVector> partial_frequency_input;
-    /// Copied so that it's not reallocated each time
+    /// Frequency delay line with the spectra of the last input chunks, the real parts of a chunk followed by its imaginary parts
+    mutable AlignedScalarVector frequency_delay_line;
+    /// Position of the newest chunk in the frequency delay line
+    mutable gsl::index frequency_delay_line_position{0};
+    /// Accumulated spectrum, real parts followed by imaginary parts
+    mutable AlignedScalarVector accumulated_spectrum;
+    /// Spectra of the current chunk and of the convolution result, preallocated
     mutable AlignedComplexVector result;
+    /// Result of the inverse FFT, preallocated as well
+    mutable AlignedScalarVector ifft_result;
 
-    /// The impulse is stored here in a unique vector, split in split_size FFTs, one after the other
-    AlignedComplexVector partial_frequency_impulse;
+    /// The impulse chunks spectra, scaled and split the same way as the frequency delay line, one after the other
+    AlignedScalarVector partial_frequency_impulse;
 
     /// Compute the partial convolutions
     void compute_convolutions() const;
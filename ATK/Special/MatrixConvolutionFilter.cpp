@@ -0,0 +1,267 @@
+/**
+ * \file MatrixConvolutionFilter.cpp
+ */
+
+#include "MatrixConvolutionFilter.h"
+#include "helpers.h"
+
+#include <ATK/Core/Utilities.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace ATK
+{
+  template <typename DataType>
+  MatrixConvolutionFilter<DataType>::MatrixConvolutionFilter(gsl::index nb_input_ports, gsl::index nb_output_ports)
+    :Parent(nb_input_ports, nb_output_ports), impulses(nb_input_ports * nb_output_ports)
+  {
+  }
+
+  template<typename DataType_>
+  gsl::index MatrixConvolutionFilter<DataType_>::get_pair(gsl::index input_port, gsl::index output_port) const
+  {
+    if(input_port < 0 || input_port >= nb_input_ports || output_port < 0 || output_port >= nb_output_ports)
+    {
+      throw RuntimeError("Input or output port does not exist for this filter");
+    }
+    return output_port * nb_input_ports + input_port;
+  }
+
+  template<typename DataType_>
+  void MatrixConvolutionFilter<DataType_>::set_impulse(gsl::index input_port, gsl::index output_port, AlignedScalarVector impulse)
+  {
+    impulses[get_pair(input_port, output_port)] = std::move(impulse);
+    setup();
+  }
+
+  template<typename DataType_>
+  auto MatrixConvolutionFilter<DataType_>::get_impulse(gsl::index input_port, gsl::index output_port) const -> const AlignedScalarVector&
+  {
+    return impulses[get_pair(input_port, output_port)];
+  }
+
+  template<typename DataType_>
+  void MatrixConvolutionFilter<DataType_>::set_split_size(gsl::index split_size)
+  {
+    if(split_size <= 0)
+    {
+      throw RuntimeError("Split size must be strictly positive");
+    }
+    this->split_size = split_size;
+    setup();
+  }
+
+  template<typename DataType_>
+  gsl::index MatrixConvolutionFilter<DataType_>::get_split_size() const
+  {
+    return split_size;
+  }
+
+  template<typename DataType_>
+  void MatrixConvolutionFilter<DataType_>::set_nb_input_ports(gsl::index nb_ports)
+  {
+    if(nb_ports == nb_input_ports)
+    {
+      return;
+    }
+    // The impulses are indexed by the number of ports and are all removed
+    impulses.assign(nb_ports * nb_output_ports, AlignedScalarVector());
+    Parent::set_nb_input_ports(nb_ports);
+    setup();
+  }
+
+  template<typename DataType_>
+  void MatrixConvolutionFilter<DataType_>::set_nb_output_ports(gsl::index nb_ports)
+  {
+    if(nb_ports == nb_output_ports)
+    {
+      return;
+    }
+    impulses.assign(nb_input_ports * nb_ports, AlignedScalarVector());
+    Parent::set_nb_output_ports(nb_ports);
+    setup();
+  }
+
+  template<typename DataType_>
+  void MatrixConvolutionFilter<DataType_>::setup()
+  {
+    if(split_size == 0)
+    {
+      return;
+    }
+
+    // The first chunk of each impulse is processed directly, the other ones in the frequency domain
+    nb_chunks = 0;
+    nb_pair_chunks.assign(impulses.size(), 0);
+    for(std::size_t pair = 0; pair < impulses.size(); ++pair)
+    {
+      if(impulses[pair].empty())
+      {
+        continue;
+      }
+      nb_pair_chunks[pair] = (static_cast<gsl::index>(impulses[pair].size()) + split_size - 1) / split_size - 1;
+      nb_chunks = std::max(nb_chunks, nb_pair_chunks[pair]);
+      // Pad with zeros so the convolution is easier created.
+      impulses[pair].resize((nb_pair_chunks[pair] + 1) * split_size, 0);
+    }
+    nb_bins = split_size + 1;
+
+    temp_out_buffers.assign(nb_output_ports * split_size * 2, 0);
+    frequency_delay_lines.assign(nb_input_ports * 2 * nb_bins * nb_chunks, 0);
+    frequency_delay_line_position = 0;
+    accumulated_spectrum.assign(2 * nb_bins, 0);
+    result.assign(nb_bins, 0);
+    ifft_result.assign(split_size * 2, 0);
+    processor.set_size(split_size * 2);
+
+    // Only the first half of the spectra is kept, scaled by the inverse FFT normalization
+    partial_frequency_impulses.resize(impulses.size());
+    for(std::size_t pair = 0; pair < impulses.size(); ++pair)
+    {
+      partial_frequency_impulses[pair].assign(2 * nb_bins * nb_pair_chunks[pair], 0);
+      for(gsl::index i = 0; i < nb_pair_chunks[pair]; ++i)
+      {
+        processor.process_forward_real(impulses[pair].data() + (i + 1) * split_size, result.data(), split_size);
+        ConvolutionUtilities::split_spectrum(result.data(), partial_frequency_impulses[pair].data() + i * 2 * nb_bins, nb_bins, static_cast<DataType>(split_size * 2));
+      }
+    }
+
+    split_position = 0;
+    input_delay = split_size - 1;
+
+    Parent::setup();
+  }
+
+  template<typename DataType_>
+  void MatrixConvolutionFilter<DataType_>::compute_convolutions(gsl::index output_port) const
+  {
+    DataType* ATK_RESTRICT temp_out_buffer = temp_out_buffers.data() + output_port * split_size * 2;
+    for(gsl::index i = 0; i < split_size; ++i)
+    {
+      temp_out_buffer[i] = temp_out_buffer[i + split_size];
+      temp_out_buffer[i + split_size] = 0;
+    }
+
+    std::fill(accumulated_spectrum.begin(), accumulated_spectrum.end(), 0);
+    DataType* ATK_RESTRICT accumulated_spectrum_ptr = accumulated_spectrum.data();
+
+    bool empty = true;
+    for(gsl::index input_port = 0; input_port < nb_input_ports; ++input_port)
+    {
+      auto pair = get_pair(input_port, output_port);
+      auto nb_convolved_chunks = nb_pair_chunks[pair];
+      if(nb_convolved_chunks == 0)
+      {
+        continue;
+      }
+      empty = false;
+      const DataType* frequency_delay_line = frequency_delay_lines.data() + input_port * 2 * nb_bins * nb_chunks;
+      const DataType* partial_frequency_impulse = partial_frequency_impulses[pair].data();
+
+      // The newest chunk is convolved with the second chunk of the impulse, and so on, the delay line wrapping around
+      gsl::index chunk = 0;
+      for(gsl::index position = frequency_delay_line_position; position < nb_chunks && chunk < nb_convolved_chunks; ++position, ++chunk)
+      {
+        ConvolutionUtilities::multiply_accumulate(frequency_delay_line + position * 2 * nb_bins, partial_frequency_impulse + chunk * 2 * nb_bins, accumulated_spectrum_ptr, nb_bins);
+      }
+      for(gsl::index position = 0; position < frequency_delay_line_position && chunk < nb_convolved_chunks; ++position, ++chunk)
+      {
+        ConvolutionUtilities::multiply_accumulate(frequency_delay_line + position * 2 * nb_bins, partial_frequency_impulse + chunk * 2 * nb_bins, accumulated_spectrum_ptr, nb_bins);
+      }
+    }
+    if(empty)
+    {
+      return;
+    }
+
+    // A single inverse FFT for all the inputs
+    ConvolutionUtilities::merge_spectrum(accumulated_spectrum_ptr, result.data(), nb_bins);
+    processor.process_backward_real(result.data(), ifft_result.data(), 2 * split_size);
+    for(gsl::index i = 0; i < 2 * split_size; ++i)
+    {
+      temp_out_buffer[i] += ifft_result[i];
+    }
+  }
+
+  template<typename DataType_>
+  void MatrixConvolutionFilter<DataType_>::process_new_chunk(gsl::index position) const
+  {
+    if(nb_chunks == 0)
+    {
+      return;
+    }
+    // The oldest chunk of each input is replaced by the newest one
+    frequency_delay_line_position = (frequency_delay_line_position == 0 ? nb_chunks : frequency_delay_line_position) - 1;
+    for(gsl::index input_port = 0; input_port < nb_input_ports; ++input_port)
+    {
+      processor.process_forward_real(converted_inputs[input_port] + position - split_size, result.data(), split_size);
+      ConvolutionUtilities::split_spectrum(result.data(), frequency_delay_lines.data() + (input_port * nb_chunks + frequency_delay_line_position) * 2 * nb_bins, nb_bins);
+    }
+
+    for(gsl::index output_port = 0; output_port < nb_output_ports; ++output_port)
+    {
+      compute_convolutions(output_port);
+    }
+  }
+
+  template<typename DataType_>
+  void MatrixConvolutionFilter<DataType_>::process_impulse_beginning(gsl::index processed_size, gsl::index size_to_process) const
+  {
+    for(gsl::index output_port = 0; output_port < nb_output_ports; ++output_port)
+    {
+      DataType* ATK_RESTRICT output = outputs[output_port] + processed_size;
+      const DataType* ATK_RESTRICT temp_out_buffer = temp_out_buffers.data() + output_port * split_size * 2 + split_position;
+
+      for(gsl::index i = 0; i < size_to_process; ++i)
+      {
+        output[i] = temp_out_buffer[i];
+      }
+
+      for(gsl::index input_port = 0; input_port < nb_input_ports; ++input_port)
+      {
+        const auto& impulse = impulses[get_pair(input_port, output_port)];
+        if(impulse.empty())
+        {
+          continue;
+        }
+        const DataType* ATK_RESTRICT input = converted_inputs[input_port] + processed_size;
+        const DataType* ATK_RESTRICT impulse_ptr = impulse.data();
+        for(gsl::index j = 0; j < split_size; ++j)
+        {
+          for(gsl::index i = 0; i < size_to_process; ++i)
+          {
+            output[i] += impulse_ptr[j] * input[i - j];
+          }
+        }
+      }
+    }
+  }
+
+  template<typename DataType_>
+  void MatrixConvolutionFilter<DataType_>::process_impl(gsl::index size) const
+  {
+    assert(input_sampling_rate == output_sampling_rate);
+    assert(split_size > 0);
+
+    gsl::index processed_size = 0;
+    do
+    {
+      // We can only process split_size elements at a time, but if we already have some elements in the buffer,
+      // we need to take them into account.
+      auto size_to_process = std::min(split_size - split_position, size - processed_size);
+
+      process_impulse_beginning(processed_size, size_to_process);
+
+      split_position += size_to_process;
+      processed_size += size_to_process;
+      if(split_position == split_size)
+      {
+        process_new_chunk(processed_size);
+        split_position = 0;
+      }
+    }while(processed_size != size);
+  }
+
+  template class MatrixConvolutionFilter<double>;
+}
@@ -0,0 +1,121 @@
+/**
+ * \file MatrixConvolutionFilter.h
+ */
+
+#ifndef ATK_SPECIAL_MATRIXCONVOLUTIONFILTER_H
+#define ATK_SPECIAL_MATRIXCONVOLUTIONFILTER_H
+
+#include <ATK/Special/config.h>
+#include <ATK/Core/TypedBaseFilter.h>
+#include <ATK/Utility/FFT.h>
+
+#include <vector>
+
+namespace ATK
+{
+  /// A zero-delay convolution filter between several inputs and several outputs, based on FFT
+  /*!
+   * Each output is the sum of the convolutions of all inputs with the impulse of the pair (true stereo or ambisonic
+   * reverbs). The spectra of the input chunks are computed once and shared by all outputs, and the products are
+   * accumulated in the frequency domain, so that a block only costs one FFT per input and one inverse FFT per output.
+   * Pairs without an impulse are skipped.
+   */
+  template<typename DataType_>
+  class ATK_SPECIAL_EXPORT MatrixConvolutionFilter final : public TypedBaseFilter<DataType_>
+  {
+  public:
+    /// Simplify parent calls
+    using Parent = TypedBaseFilter<DataType_>;
+    using typename Parent::DataType;
+    using typename Parent::AlignedVector;
+    using typename Parent::AlignedScalarVector;
+    using Parent::setup;
+    using Parent::converted_inputs;
+    using Parent::outputs;
+    using Parent::input_delay;
+    using Parent::input_sampling_rate;
+    using Parent::output_sampling_rate;
+    using Parent::nb_input_ports;
+    using Parent::nb_output_ports;
+
+    using AlignedComplexVector = typename TypedBaseFilter<std::complex<DataType_> >::AlignedVector;
+
+    /*!
+     * @brief Build a new convolution filter
+     * @param nb_input_ports is the number of inputs
+     * @param nb_output_ports is the number of outputs
+     */
+    MatrixConvolutionFilter(gsl::index nb_input_ports, gsl::index nb_output_ports);
+
+    /**
+     * @brief Set the impulse between an input and an output
+     * @param input_port is the input convolved with the impulse
+     * @param output_port is the output the convolution is added to
+     * @param impulse is the impulse for the convolution, empty to remove the pair
+     */
+    void set_impulse(gsl::index input_port, gsl::index output_port, AlignedScalarVector impulse);
+    /// Returns the impulse between an input and an output
+    const AlignedScalarVector& get_impulse(gsl::index input_port, gsl::index output_port) const;
+
+    /*!
+     * @brief Set the split size
+     * @param split_size is the size of the individual FFTs
+     */
+    void set_split_size(gsl::index split_size);
+    /// Returns the split size
+    gsl::index get_split_size() const;
+
+    void set_nb_input_ports(gsl::index nb_ports) final;
+    void set_nb_output_ports(gsl::index nb_ports) final;
+
+  protected:
+    void process_impl(gsl::index size) const final;
+
+    void setup() final;
+
+  private:
+    /// Process the first split_size elements of the convolutions
+    void process_impulse_beginning(gsl::index processed_size, gsl::index size_to_process) const;
+    /// Create a new chunk for each input and compute the convolutions
+    void process_new_chunk(gsl::index position) const;
+    /// Compute the partial convolutions of an output
+    void compute_convolutions(gsl::index output_port) const;
+
+    /// Index of the pair in the impulses
+    gsl::index get_pair(gsl::index input_port, gsl::index output_port) const;
+
+    /// Current amount of data in the buffer
+    mutable gsl::index split_position{0};
+    /// Size of the individual FFTs that are processed
+    gsl::index split_size{0};
+    /// Number of frequency bins kept for each chunk (the spectra of real signals are symmetric)
+    gsl::index nb_bins{0};
+    /// Number of chunks processed in the frequency domain for the longest impulse
+    gsl::index nb_chunks{0};
+
+    /// FFT object for fast FFT/iFFT
+    FFT<DataType> processor;
+
+    /// Impulses of each pair, output after output
+    std::vector<AlignedScalarVector> impulses;
+    /// Number of chunks processed in the frequency domain for each pair
+    std::vector<gsl::index> nb_pair_chunks;
+    /// The impulse chunks spectra of each pair, scaled and split the same way as the frequency delay lines
+    std::vector<AlignedScalarVector> partial_frequency_impulses;
+
+    /// For each output, the head of the last convolution
+    mutable AlignedVector temp_out_buffers;
+    /// Frequency delay lines of all inputs, one after the other, the real parts of a chunk followed by its imaginary parts
+    mutable AlignedScalarVector frequency_delay_lines;
+    /// Position of the newest chunk in the frequency delay lines
+    mutable gsl::index frequency_delay_line_position{0};
+    /// Accumulated spectrum of the current output
+    mutable AlignedScalarVector accumulated_spectrum;
+    /// Spectra of the current chunk and of the convolution result, preallocated
+    mutable AlignedComplexVector result;
+    /// Result of the inverse FFT, preallocated as well
+    mutable AlignedScalarVector ifft_result;
+  };
+}
+
+#endif
@@ -0,0 +1,485 @@
+/**
+ * \file PartitionedConvolutionFilter.cpp
+ */
+
+#include "PartitionedConvolutionFilter.h"
+#include "helpers.h"
+
+#include <ATK/Core/Utilities.h>
+#include <ATK/Utility/FFT.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <complex>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+namespace ATK
+{
+  /// A uniformly partitioned part of the impulse, processed with a frequency delay line
+  template<typename DataType_>
+  class PartitionedConvolutionFilter<DataType_>::Stage
+  {
+    using AlignedComplexVector = typename TypedBaseFilter<std::complex<DataType_> >::AlignedVector;
+
+    enum Status {Idle, Pending, Running, Done};
+
+  public:
+    Stage(const AlignedScalarVector& impulse, gsl::index offset, gsl::index partition_size, gsl::index nb_partitions)
+    :offset(offset), partition_size(partition_size), nb_partitions(nb_partitions), nb_bins(partition_size + 1),
+    input(partition_size, 0), block(partition_size, 0), frequency_delay_line(2 * nb_bins * nb_partitions, 0),
+    accumulated_spectrum(2 * nb_bins, 0), spectrum(nb_bins, 0), ifft_result(2 * partition_size, 0),
+    output(2 * partition_size, 0), partial_frequency_impulse(2 * nb_bins * nb_partitions, 0)
+    {
+      processor.set_size(2 * partition_size);
+      // The inverse FFT normalization is folded in the impulse spectra
+      for(gsl::index i = 0; i < nb_partitions; ++i)
+      {
+        auto begin = std::min(static_cast<gsl::index>(impulse.size()), offset + i * partition_size);
+        auto end = std::min(static_cast<gsl::index>(impulse.size()), begin + partition_size);
+        std::fill(std::copy(impulse.begin() + begin, impulse.begin() + end, block.begin()), block.end(), 0);
+        processor.process_forward_real(block.data(), spectrum.data(), partition_size);
+        ConvolutionUtilities::split_spectrum(spectrum.data(), partial_frequency_impulse.data() + i * 2 * nb_bins, nb_bins, static_cast<DataType>(2 * partition_size));
+      }
+    }
+
+    /// Can a block be processed while the next one is filled? True for all stages except the first one
+    bool is_asynchronous() const
+    {
+      return offset >= 2 * partition_size;
+    }
+
+    gsl::index get_partition_size() const
+    {
+      return partition_size;
+    }
+
+    gsl::index get_nb_partitions() const
+    {
+      return nb_partitions;
+    }
+
+    /// Stores new input samples at the given position in the current block
+    void feed(const DataType* ATK_RESTRICT new_input, gsl::index block_position, gsl::index size)
+    {
+      std::copy(new_input, new_input + size, input.data() + block_position);
+    }
+
+    /// Adds the result of the stage for the given position in the current block
+    void add_output(DataType* ATK_RESTRICT new_output, gsl::index block_position, gsl::index size) const
+    {
+      const DataType* ATK_RESTRICT output_ptr = output.data() + block_position;
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        new_output[i] += output_ptr[i];
+      }
+    }
+
+    /// Called by the processing thread when the input block is complete
+    void end_block(std::int64_t block_end)
+    {
+      if(is_asynchronous())
+      {
+        // The previous block result is needed now, the new one only at the end of the next block
+        collect();
+        submit(block_end + partition_size);
+      }
+      else
+      {
+        submit(block_end);
+        collect();
+      }
+    }
+
+    /// Returns the deadline of a pending block, or the maximum value if there is none
+    std::int64_t get_pending_deadline() const
+    {
+      if(status.load(std::memory_order_acquire) != Pending)
+      {
+        return std::numeric_limits<std::int64_t>::max();
+      }
+      return deadline.load(std::memory_order_relaxed);
+    }
+
+    /// Processes the pending block, returns false if there is none or if another thread took it
+    bool try_process()
+    {
+      auto expected = Pending;
+      if(!status.compare_exchange_strong(expected, Running, std::memory_order_acquire, std::memory_order_relaxed))
+      {
+        return false;
+      }
+      process();
+      status.store(Done, std::memory_order_release);
+      return true;
+    }
+
+  private:
+    void submit(std::int64_t new_deadline)
+    {
+      std::swap(input, block);
+      deadline.store(new_deadline, std::memory_order_relaxed);
+      status.store(Pending, std::memory_order_release);
+    }
+
+    /// Overlap-adds the result of the submitted block, processing it if no other thread started it
+    void collect()
+    {
+      DataType* ATK_RESTRICT output_ptr = output.data();
+      if(status.load(std::memory_order_relaxed) == Idle)
+      {
+        // No block was submitted yet
+        for(gsl::index i = 0; i < partition_size; ++i)
+        {
+          output_ptr[i] = output_ptr[partition_size + i];
+          output_ptr[partition_size + i] = 0;
+        }
+        return;
+      }
+      if(!try_process())
+      {
+        while(status.load(std::memory_order_acquire) != Done)
+        {
+          std::this_thread::yield();
+        }
+      }
+
+      const DataType* ATK_RESTRICT ifft_result_ptr = ifft_result.data();
+      for(gsl::index i = 0; i < partition_size; ++i)
+      {
+        output_ptr[i] = output_ptr[partition_size + i] + ifft_result_ptr[i];
+        output_ptr[partition_size + i] = ifft_result_ptr[partition_size + i];
+      }
+      status.store(Idle, std::memory_order_relaxed);
+    }
+
+    /// Convolves the submitted block with all the partitions of the stage
+    void process()
+    {
+      // The oldest block is replaced by the newest one
+      frequency_delay_line_position = (frequency_delay_line_position == 0 ? nb_partitions : frequency_delay_line_position) - 1;
+      processor.process_forward_real(block.data(), spectrum.data(), partition_size);
+      ConvolutionUtilities::split_spectrum(spectrum.data(), frequency_delay_line.data() + frequency_delay_line_position * 2 * nb_bins, nb_bins);
+
+      std::fill(accumulated_spectrum.begin(), accumulated_spectrum.end(), 0);
+      gsl::index partition = 0;
+      for(gsl::index position = frequency_delay_line_position; position < nb_partitions; ++position, ++partition)
+      {
+        ConvolutionUtilities::multiply_accumulate(frequency_delay_line.data() + position * 2 * nb_bins, partial_frequency_impulse.data() + partition * 2 * nb_bins, accumulated_spectrum.data(), nb_bins);
+      }
+      for(gsl::index position = 0; position < frequency_delay_line_position; ++position, ++partition)
+      {
+        ConvolutionUtilities::multiply_accumulate(frequency_delay_line.data() + position * 2 * nb_bins, partial_frequency_impulse.data() + partition * 2 * nb_bins, accumulated_spectrum.data(), nb_bins);
+      }
+
+      ConvolutionUtilities::merge_spectrum(accumulated_spectrum.data(), spectrum.data(), nb_bins);
+      processor.process_backward_real(spectrum.data(), ifft_result.data(), 2 * partition_size);
+    }
+
+    /// Position of the stage in the impulse
+    const gsl::index offset;
+    const gsl::index partition_size;
+    const gsl::index nb_partitions;
+    const gsl::index nb_bins;
+
+    /// Input block being filled by the processing thread
+    AlignedScalarVector input;
+    /// Input block being convolved
+    AlignedScalarVector block;
+    /// Spectra of the last input blocks, the real parts of a block followed by its imaginary parts
+    AlignedScalarVector frequency_delay_line;
+    /// Position of the newest block in the frequency delay line
+    gsl::index frequency_delay_line_position{0};
+    AlignedScalarVector accumulated_spectrum;
+    AlignedComplexVector spectrum;
+    AlignedScalarVector ifft_result;
+    /// Output of the current block followed by the tail of the last result
+    AlignedScalarVector output;
+    /// The impulse partitions spectra, scaled and split the same way as the frequency delay line
+    AlignedScalarVector partial_frequency_impulse;
+    FFT<DataType> processor;
+
+    std::atomic<Status> status{Idle};
+    /// Position at which the result of the pending block is needed
+    std::atomic<std::int64_t> deadline{0};
+  };
+
+  /// Background thread processing the pending blocks of the asynchronous stages, earliest deadline first
+  template<typename DataType_>
+  class PartitionedConvolutionFilter<DataType_>::Worker
+  {
+  public:
+    explicit Worker(std::vector<Stage*> stages)
+    :stages(std::move(stages)), thread([this](){run();})
+    {
+    }
+
+    ~Worker()
+    {
+      stop.store(true, std::memory_order_release);
+      condition.notify_one();
+      thread.join();
+    }
+
+    /// Wakes up the thread, called without locking so that the processing thread never blocks
+    void notify()
+    {
+      condition.notify_one();
+    }
+
+  private:
+    void run()
+    {
+      while(!stop.load(std::memory_order_acquire))
+      {
+        auto* stage = next_stage();
+        if(stage)
+        {
+          stage->try_process();
+          continue;
+        }
+        // A notification may be missed as the lock is not taken by notify(), hence the timeout
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait_for(lock, std::chrono::milliseconds(1), [this](){return stop.load(std::memory_order_acquire) || next_stage() != nullptr;});
+      }
+    }
+
+    /// Returns the stage with the earliest pending deadline
+    Stage* next_stage() const
+    {
+      Stage* next = nullptr;
+      auto next_deadline = std::numeric_limits<std::int64_t>::max();
+      for(auto* stage: stages)
+      {
+        auto deadline = stage->get_pending_deadline();
+        if(deadline < next_deadline)
+        {
+          next = stage;
+          next_deadline = deadline;
+        }
+      }
+      return next;
+    }
+
+    std::vector<Stage*> stages;
+    std::atomic<bool> stop{false};
+    std::mutex mutex;
+    std::condition_variable condition;
+    /// Started last, once the other members are initialized
+    std::thread thread;
+  };
+
+  template <typename DataType>
+  PartitionedConvolutionFilter<DataType>::PartitionedConvolutionFilter()
+    :Parent(1, 1)
+  {
+  }
+
+  template <typename DataType>
+  PartitionedConvolutionFilter<DataType>::~PartitionedConvolutionFilter()
+  {
+    // The thread must be stopped before the stages are destroyed
+    worker.reset();
+  }
+
+  template<typename DataType_>
+  void PartitionedConvolutionFilter<DataType_>::set_impulse(AlignedScalarVector impulse)
+  {
+    this->impulse = std::move(impulse);
+    setup();
+  }
+
+  template<typename DataType_>
+  void PartitionedConvolutionFilter<DataType_>::set_head_size(gsl::index head_size)
+  {
+    if(head_size <= 0)
+    {
+      throw RuntimeError("Head size must be strictly positive");
+    }
+    this->head_size = head_size;
+    setup();
+  }
+
+  template<typename DataType_>
+  gsl::index PartitionedConvolutionFilter<DataType_>::get_head_size() const
+  {
+    return head_size;
+  }
+
+  template<typename DataType_>
+  void PartitionedConvolutionFilter<DataType_>::set_max_partition_size(gsl::index max_partition_size)
+  {
+    this->max_partition_size = max_partition_size;
+    setup();
+  }
+
+  template<typename DataType_>
+  gsl::index PartitionedConvolutionFilter<DataType_>::get_max_partition_size() const
+  {
+    return max_partition_size;
+  }
+
+  template<typename DataType_>
+  void PartitionedConvolutionFilter<DataType_>::set_background_processing(bool background_processing)
+  {
+    this->background_processing = background_processing;
+    setup();
+  }
+
+  template<typename DataType_>
+  bool PartitionedConvolutionFilter<DataType_>::get_background_processing() const
+  {
+    return background_processing;
+  }
+
+  template<typename DataType_>
+  gsl::index PartitionedConvolutionFilter<DataType_>::get_nb_stages() const
+  {
+    return static_cast<gsl::index>(stages.size());
+  }
+
+  template<typename DataType_>
+  gsl::index PartitionedConvolutionFilter<DataType_>::get_partition_size(gsl::index stage) const
+  {
+    return stages.at(stage)->get_partition_size();
+  }
+
+  template<typename DataType_>
+  gsl::index PartitionedConvolutionFilter<DataType_>::get_nb_partitions(gsl::index stage) const
+  {
+    return stages.at(stage)->get_nb_partitions();
+  }
+
+  template<typename DataType_>
+  void PartitionedConvolutionFilter<DataType_>::setup()
+  {
+    worker.reset();
+    stages.clear();
+    position = 0;
+    if(impulse.size() == 0 || head_size == 0)
+    {
+      return;
+    }
+
+    // A stage must start at least two partitions after its beginning to be processed in the background, so each stage
+    // covers the impulse until the next one can start, the first stage with 3 partitions, the next ones with 2.
+    auto impulse_size = static_cast<gsl::index>(impulse.size());
+    auto offset = head_size;
+    auto partition_size = head_size;
+    while(offset < impulse_size)
+    {
+      auto nb_partitions = (impulse_size - offset + partition_size - 1) / partition_size;
+      if(partition_size < max_partition_size)
+      {
+        nb_partitions = std::min(nb_partitions, (4 * partition_size - offset) / partition_size);
+      }
+      stages.push_back(std::make_unique<Stage>(impulse, offset, partition_size, nb_partitions));
+      offset += nb_partitions * partition_size;
+      if(partition_size < max_partition_size)
+      {
+        partition_size *= 2;
+      }
+    }
+
+    input_delay = head_size - 1;
+
+    if(background_processing)
+    {
+      std::vector<Stage*> asynchronous_stages;
+      for(auto& stage: stages)
+      {
+        if(stage->is_asynchronous())
+        {
+          asynchronous_stages.push_back(stage.get());
+        }
+      }
+      if(!asynchronous_stages.empty())
+      {
+        worker = std::make_unique<Worker>(std::move(asynchronous_stages));
+      }
+    }
+
+    Parent::setup();
+  }
+
+  template<typename DataType_>
+  void PartitionedConvolutionFilter<DataType_>::process_impulse_beginning(gsl::index processed_size, gsl::index size_to_process) const
+  {
+    const DataType* ATK_RESTRICT input = converted_inputs[0] + processed_size;
+    const DataType* ATK_RESTRICT impulse_ptr = impulse.data();
+    DataType* ATK_RESTRICT output = outputs[0] + processed_size;
+
+    for(gsl::index i = 0; i < size_to_process; ++i)
+    {
+      output[i] = 0;
+    }
+
+    auto nb_taps = std::min(head_size, static_cast<gsl::index>(impulse.size()));
+    for(gsl::index j = 0; j < nb_taps; ++j)
+    {
+      for(gsl::index i = 0; i < size_to_process; ++i)
+      {
+        output[i] += impulse_ptr[j] * input[i - j];
+      }
+    }
+  }
+
+  template<typename DataType_>
+  void PartitionedConvolutionFilter<DataType_>::process_stages(gsl::index processed_size, gsl::index size_to_process) const
+  {
+    const DataType* ATK_RESTRICT input = converted_inputs[0] + processed_size;
+    DataType* ATK_RESTRICT output = outputs[0] + processed_size;
+
+    for(auto& stage: stages)
+    {
+      auto block_position = static_cast<gsl::index>(position % stage->get_partition_size());
+      stage->feed(input, block_position, size_to_process);
+      stage->add_output(output, block_position, size_to_process);
+    }
+
+    auto block_end = position + size_to_process;
+    if(block_end % head_size != 0)
+    {
+      return;
+    }
+    bool submitted = false;
+    for(auto& stage: stages)
+    {
+      if(block_end % stage->get_partition_size() == 0)
+      {
+        stage->end_block(block_end);
+        submitted |= stage->is_asynchronous();
+      }
+    }
+    if(submitted && worker)
+    {
+      worker->notify();
+    }
+  }
+
+  template<typename DataType_>
+  void PartitionedConvolutionFilter<DataType_>::process_impl(gsl::index size) const
+  {
+    assert(input_sampling_rate == output_sampling_rate);
+    assert(head_size > 0);
+
+    gsl::index processed_size = 0;
+    do
+    {
+      // Blocks never cross the end of the smallest partition, as the stages results are updated there
+      auto size_to_process = std::min(head_size - static_cast<gsl::index>(position % head_size), size - processed_size);
+
+      process_impulse_beginning(processed_size, size_to_process);
+      process_stages(processed_size, size_to_process);
+
+      processed_size += size_to_process;
+      position += size_to_process;
+    }while(processed_size != size);
+  }
+
+  template class PartitionedConvolutionFilter<double>;
+}
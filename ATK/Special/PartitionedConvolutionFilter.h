@@ -0,0 +1,119 @@
+/**
+ * \file PartitionedConvolutionFilter.h
+ */
+
+#ifndef ATK_SPECIAL_PARTITIONEDCONVOLUTIONFILTER_H
+#define ATK_SPECIAL_PARTITIONEDCONVOLUTIONFILTER_H
+
+#include <ATK/Special/config.h>
+#include <ATK/Core/TypedBaseFilter.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ATK
+{
+  /// A zero-delay convolution filter for long impulses, with a non uniform partition of the impulse
+  /*!
+   * The head of the impulse is convolved directly. The rest of the impulse is split in stages of uniform partitions,
+   * each stage processed in the frequency domain with its own frequency delay line. The partition size starts at the
+   * head size and doubles from one stage to the next, up to the maximum partition size, so that the cost per sample
+   * stays low for long impulses without adding latency.
+   *
+   * The result of a block of a stage is only needed one block after the input block is complete, except for the first
+   * stage. These stages can be processed by a background thread, which picks the pending block with the earliest
+   * deadline. The processing thread then only convolves the head and the first stage, and processes itself a pending
+   * block whose deadline is reached.
+   */
+  template<typename DataType_>
+  class ATK_SPECIAL_EXPORT PartitionedConvolutionFilter final : public TypedBaseFilter<DataType_>
+  {
+  public:
+    /// Simplify parent calls
+    using Parent = TypedBaseFilter<DataType_>;
+    using typename Parent::DataType;
+    using typename Parent::AlignedVector;
+    using typename Parent::AlignedScalarVector;
+    using Parent::setup;
+    using Parent::converted_inputs;
+    using Parent::outputs;
+    using Parent::input_delay;
+    using Parent::input_sampling_rate;
+    using Parent::output_sampling_rate;
+
+    /// Build a new convolution filter
+    PartitionedConvolutionFilter();
+    /// Destructor, stops the background thread
+    ~PartitionedConvolutionFilter() override;
+
+    /**
+     * @brief Set the impulse for the convolution
+     * @param impulse is the impulse for the convolution
+     */
+    void set_impulse(AlignedScalarVector impulse);
+
+    /*!
+     * @brief Set the size of the head of the impulse, convolved directly, which is also the smallest partition size
+     * @param head_size is the size of the head, a power of 2 is advised
+     */
+    void set_head_size(gsl::index head_size);
+    /// Returns the size of the head of the impulse
+    gsl::index get_head_size() const;
+
+    /*!
+     * @brief Set the maximum partition size
+     * @param max_partition_size is rounded up to the head size times a power of 2
+     */
+    void set_max_partition_size(gsl::index max_partition_size);
+    /// Returns the maximum partition size
+    gsl::index get_max_partition_size() const;
+
+    /*!
+     * @brief Processes the large partitions on a background thread
+     * @param background_processing is true to start a background thread
+     */
+    void set_background_processing(bool background_processing);
+    /// Are the large partitions processed on a background thread?
+    bool get_background_processing() const;
+
+    /// Returns the number of stages of uniform partitions
+    gsl::index get_nb_stages() const;
+    /// Returns the partition size of a stage
+    gsl::index get_partition_size(gsl::index stage) const;
+    /// Returns the number of partitions of a stage
+    gsl::index get_nb_partitions(gsl::index stage) const;
+
+  protected:
+    void process_impl(gsl::index size) const final;
+
+    void setup() final;
+
+  private:
+    class Stage;
+    class Worker;
+
+    /// Process the head of the impulse directly
+    void process_impulse_beginning(gsl::index processed_size, gsl::index size_to_process) const;
+    /// Feed the stages with the input and add their output
+    void process_stages(gsl::index processed_size, gsl::index size_to_process) const;
+
+    /// Impulse convolved with the input signal
+    AlignedScalarVector impulse;
+    /// Size of the head of the impulse
+    gsl::index head_size{64};
+    /// Maximum size of the partitions
+    gsl::index max_partition_size{8192};
+    /// Are the large partitions processed in the background?
+    bool background_processing{false};
+
+    /// Number of samples processed since the last setup, all stages blocks are aligned on this position
+    mutable std::int64_t position{0};
+    /// The stages of uniform partitions, with growing sizes
+    std::vector<std::unique_ptr<Stage>> stages;
+    /// The background thread
+    std::unique_ptr<Worker> worker;
+  };
+}
+
+#endif
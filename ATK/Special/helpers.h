@@ -0,0 +1,54 @@
+/**
+ * \file helpers.h
+ */
+
+#ifndef ATK_SPECIAL_HELPERS_H
+#define ATK_SPECIAL_HELPERS_H
+
+#include <ATK/config.h>
+
+#include <gsl/gsl>
+
+#include <complex>
+
+/// Namespace with the spectrum operations shared by the frequency domain convolutions
+namespace ConvolutionUtilities
+{
+  /// Stores the nb_bins first bins of a spectrum as real parts followed by imaginary parts, multiplied by factor
+  template<typename DataType>
+  void split_spectrum(const std::complex<DataType>* ATK_RESTRICT spectrum, DataType* ATK_RESTRICT split, gsl::index nb_bins, DataType factor = 1)
+  {
+    for(gsl::index i = 0; i < nb_bins; ++i)
+    {
+      split[i] = spectrum[i].real() * factor;
+      split[nb_bins + i] = spectrum[i].imag() * factor;
+    }
+  }
+
+  /// Rebuilds the nb_bins first bins of a spectrum from their split real and imaginary parts
+  template<typename DataType>
+  void merge_spectrum(const DataType* ATK_RESTRICT split, std::complex<DataType>* ATK_RESTRICT spectrum, gsl::index nb_bins)
+  {
+    for(gsl::index i = 0; i < nb_bins; ++i)
+    {
+      spectrum[i] = std::complex<DataType>(split[i], split[nb_bins + i]);
+    }
+  }
+
+  /// Accumulates the product of two split spectra
+  template<typename DataType>
+  void multiply_accumulate(const DataType* ATK_RESTRICT input, const DataType* ATK_RESTRICT impulse, DataType* ATK_RESTRICT accumulator, gsl::index nb_bins)
+  {
+    const DataType* ATK_RESTRICT input_imag = input + nb_bins;
+    const DataType* ATK_RESTRICT impulse_imag = impulse + nb_bins;
+    DataType* ATK_RESTRICT accumulator_imag = accumulator + nb_bins;
+
+    ATK_VECTORIZE for(gsl::index i = 0; i < nb_bins; ++i)
+    {
+      accumulator[i] += input[i] * impulse[i] - input_imag[i] * impulse_imag[i];
+      accumulator_imag[i] += input[i] * impulse_imag[i] + input_imag[i] * impulse[i];
+    }
+  }
+}
+
+#endif
@@ -17,6 +17,13 @@ namespace ATK
   {
   }
   
+  template<typename DataType_>
+  gsl::index ApplyGainFilter<DataType_>::get_in_place_input(gsl::index output_port) const
+  {
+    // The signal is multiplied in place, the gain is only read
+    return 2 * output_port;
+  }
+
   template<typename DataType_>
   void ApplyGainFilter<DataType_>::process_impl(gsl::index size) const
   {
@@ -24,12 +31,24 @@ namespace ATK
 
     for(gsl::index channel = 0; channel < nb_output_ports; ++channel)
     {
-      const DataType* ATK_RESTRICT input1 = converted_inputs[2 * channel];
       const DataType* ATK_RESTRICT input2 = converted_inputs[2 * channel + 1];
-      DataType* ATK_RESTRICT output = outputs[channel];
-      for(gsl::index i = 0; i < size; ++i)
+      if(converted_inputs[2 * channel] == outputs[channel])
+      {
+        // Computed in place
+        DataType* output = outputs[channel];
+        for(gsl::index i = 0; i < size; ++i)
+        {
+          output[i] = output[i] * input2[i];
+        }
+      }
+      else
       {
-        output[i] = input1[i] * input2[i];
+        const DataType* ATK_RESTRICT input1 = converted_inputs[2 * channel];
+        DataType* ATK_RESTRICT output = outputs[channel];
+        for(gsl::index i = 0; i < size; ++i)
+        {
+          output[i] = input1[i] * input2[i];
+        }
       }
     }
   }
@@ -0,0 +1,129 @@
+/**
+ * \file FusedFilter.h
+ */
+
+#ifndef ATK_TOOLS_FUSEDFILTER_H
+#define ATK_TOOLS_FUSEDFILTER_H
+
+#include <ATK/Core/TypedBaseFilter.h>
+#include <ATK/Tools/config.h>
+
+#include <cassert>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+namespace ATK
+{
+  /// Applies a chain of stateless per sample operators in a single pass over the block
+  /**
+   * Each operator replaces a filter of the chain (see FusedOperators), so a chain of n pointwise filters reads and
+   * writes the block once instead of n times.
+   * Each channel has one input port for the signal followed by the side input ports of the operators, in order.
+   */
+  template<typename DataType_, typename... Operators>
+  class FusedFilter final : public TypedBaseFilter<DataType_>
+  {
+  protected:
+    /// Simplify parent calls
+    using Parent = TypedBaseFilter<DataType_>;
+    using typename Parent::DataType;
+    using Parent::converted_inputs;
+    using Parent::outputs;
+    using Parent::nb_input_ports;
+    using Parent::nb_output_ports;
+    using Parent::input_sampling_rate;
+
+  public:
+    /// Number of side input ports per channel
+    static constexpr gsl::index nb_side_inputs = (Operators::nb_side_inputs + ... + 0);
+    /// Number of input ports per channel
+    static constexpr gsl::index nb_channel_inputs = nb_side_inputs + 1;
+
+    static_assert(sizeof...(Operators) > 0, "A fused filter needs at least one operator");
+
+    /*!
+     * @brief Constructor
+     * @param nb_channels is the number of output channels
+     */
+    explicit FusedFilter(gsl::index nb_channels = 1)
+    :Parent(nb_channel_inputs * nb_channels, nb_channels)
+    {
+    }
+    /*!
+     * @brief Constructor
+     * @param nb_channels is the number of output channels
+     * @param operators are the operators of the chain
+     */
+    FusedFilter(gsl::index nb_channels, Operators... operators)
+    :Parent(nb_channel_inputs * nb_channels, nb_channels), operators(std::move(operators)...)
+    {
+    }
+    /// Destructor
+    ~FusedFilter() override = default;
+
+    /// Returns an operator of the chain, to update its parameters
+    template<std::size_t index>
+    auto& get_operator()
+    {
+      return std::get<index>(operators);
+    }
+
+    /// Returns an operator of the chain
+    template<std::size_t index>
+    const auto& get_operator() const
+    {
+      return std::get<index>(operators);
+    }
+
+  protected:
+    void setup() final
+    {
+      Parent::setup();
+      std::apply([this](auto&... op){(op.setup(input_sampling_rate), ...);}, operators);
+    }
+
+    void process_impl(gsl::index size) const final
+    {
+      assert(nb_input_ports == nb_channel_inputs * nb_output_ports);
+
+      for(gsl::index channel = 0; channel < nb_output_ports; ++channel)
+      {
+        const DataType* const* inputs = converted_inputs.data() + channel * nb_channel_inputs;
+        DataType* output = outputs[channel];
+        for(gsl::index i = 0; i < size; ++i)
+        {
+          auto input = inputs[0][i];
+          output[i] = apply<0, 1>(input, input, inputs, i);
+        }
+      }
+    }
+
+    gsl::index get_in_place_input(gsl::index output_port) const final
+    {
+      // The signal is read once before the output is written, side inputs are only read
+      return nb_channel_inputs * output_port;
+    }
+
+  private:
+    /// Applies the operators from index to the end of the chain, side_input being their first side input port
+    template<std::size_t index, gsl::index side_input>
+    DataType apply(DataType value, DataType input, const DataType* const* inputs, gsl::index i) const
+    {
+      if constexpr(index == sizeof...(Operators))
+      {
+        return value;
+      }
+      else
+      {
+        const auto& op = std::get<index>(operators);
+        using Operator = std::tuple_element_t<index, std::tuple<Operators...> >;
+        return apply<index + 1, side_input + Operator::nb_side_inputs>(op(value, input, inputs + side_input, i), input, inputs, i);
+      }
+    }
+
+    std::tuple<Operators...> operators;
+  };
+}
+
+#endif
@@ -0,0 +1,222 @@
+/**
+ * \file FusedOperators.h
+ */
+
+#ifndef ATK_TOOLS_FUSEDOPERATORS_H
+#define ATK_TOOLS_FUSEDOPERATORS_H
+
+#include <ATK/Utility/fmath.h>
+
+#include <boost/math/constants/constants.hpp>
+#include <gsl/gsl>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace ATK
+{
+  /// Per sample operators that can be chained in a FusedFilter
+  /**
+   * An operator computes one sample from the current value of the chain, the input of the chain (the dry signal) and
+   * its side inputs, and must not keep any state from one sample to the next one.
+   */
+  namespace FusedOperators
+  {
+    /// Multiplies the signal by a volume, as VolumeFilter
+    template<typename DataType>
+    class Volume
+    {
+    public:
+      /// Number of additional input ports per channel
+      static constexpr gsl::index nb_side_inputs = 0;
+
+      /// Changes the volume
+      void set_volume(DataType volume)
+      {
+        this->volume = volume;
+      }
+      /// Gets the volume
+      DataType get_volume() const
+      {
+        return volume;
+      }
+
+      /// Updates the parameters depending on the sampling rate
+      void setup(gsl::index sampling_rate)
+      {
+      }
+
+      /// Computes a sample
+      DataType operator()(DataType value, DataType dry, const DataType* const* side_inputs, gsl::index i) const
+      {
+        return volume * value;
+      }
+    private:
+      DataType volume{1};
+    };
+
+    /// Multiplies the signal by a volume and adds an offset, as OffsetVolumeFilter
+    template<typename DataType>
+    class OffsetVolume
+    {
+    public:
+      /// Number of additional input ports per channel
+      static constexpr gsl::index nb_side_inputs = 0;
+
+      /// Changes the volume
+      void set_volume(DataType volume)
+      {
+        this->volume = volume;
+      }
+      /// Gets the volume
+      DataType get_volume() const
+      {
+        return volume;
+      }
+      /// Changes the offset
+      void set_offset(DataType offset)
+      {
+        this->offset = offset;
+      }
+      /// Gets the offset
+      DataType get_offset() const
+      {
+        return offset;
+      }
+
+      /// Updates the parameters depending on the sampling rate
+      void setup(gsl::index sampling_rate)
+      {
+      }
+
+      /// Computes a sample
+      DataType operator()(DataType value, DataType dry, const DataType* const* side_inputs, gsl::index i) const
+      {
+        return offset + volume * value;
+      }
+    private:
+      DataType volume{1};
+      DataType offset{0};
+    };
+
+    /// Warps an analog frequency to a numeric one, as TanFilter
+    template<typename DataType>
+    class Tan
+    {
+    public:
+      /// Number of additional input ports per channel
+      static constexpr gsl::index nb_side_inputs = 0;
+
+      /// Updates the parameters depending on the sampling rate
+      void setup(gsl::index sampling_rate)
+      {
+        coeff = boost::math::constants::pi<DataType>() / sampling_rate;
+      }
+
+      /// Computes a sample
+      DataType operator()(DataType value, DataType dry, const DataType* const* side_inputs, gsl::index i) const
+      {
+        return std::tan(value * coeff);
+      }
+    private:
+      DataType coeff{1};
+    };
+
+    /// Hyperbolic tangent shaper, as TanhShaperFilter
+    template<typename DataType>
+    class TanhShaper
+    {
+    public:
+      /// Number of additional input ports per channel
+      static constexpr gsl::index nb_side_inputs = 0;
+
+      /// Changes the shaper coefficient, must be strictly positive
+      void set_coefficient(DataType coeff)
+      {
+        if(coeff <= 0)
+        {
+          throw std::out_of_range("Coefficient must be strictly positive.");
+        }
+        this->coeff = coeff;
+      }
+      /// Gets the shaper coefficient
+      DataType get_coefficient() const
+      {
+        return coeff;
+      }
+
+      /// Updates the parameters depending on the sampling rate
+      void setup(gsl::index sampling_rate)
+      {
+      }
+
+      /// Computes a sample
+      DataType operator()(DataType value, DataType dry, const DataType* const* side_inputs, gsl::index i) const
+      {
+        auto exp = fmath::exp(2 * coeff * value);
+        return (exp - 1) / (coeff * (exp + 1));
+      }
+    private:
+      DataType coeff{1};
+    };
+
+    /// Mixes the signal with the input of the chain, as a DryWetFilter fed with the signal and then the chain input
+    template<typename DataType>
+    class DryWet
+    {
+    public:
+      /// Number of additional input ports per channel
+      static constexpr gsl::index nb_side_inputs = 0;
+
+      /// Changes the proportion of the signal, the rest is the input of the chain
+      void set_dry(DataType dry)
+      {
+        if(dry < 0 || dry > 1)
+        {
+          throw std::out_of_range("Dry/wet factor must be a value between 0 and 1");
+        }
+        this->dry = dry;
+      }
+      /// Gets the proportion of the signal
+      DataType get_dry() const
+      {
+        return dry;
+      }
+
+      /// Updates the parameters depending on the sampling rate
+      void setup(gsl::index sampling_rate)
+      {
+      }
+
+      /// Computes a sample
+      DataType operator()(DataType value, DataType input, const DataType* const* side_inputs, gsl::index i) const
+      {
+        return value * dry + input * (1 - dry);
+      }
+    private:
+      DataType dry{1};
+    };
+
+    /// Multiplies the signal by a gain read on a side input, as ApplyGainFilter
+    template<typename DataType>
+    class ApplyGain
+    {
+    public:
+      /// Number of additional input ports per channel
+      static constexpr gsl::index nb_side_inputs = 1;
+
+      /// Updates the parameters depending on the sampling rate
+      void setup(gsl::index sampling_rate)
+      {
+      }
+
+      /// Computes a sample
+      DataType operator()(DataType value, DataType dry, const DataType* const* side_inputs, gsl::index i) const
+      {
+        return value * side_inputs[0][i];
+      }
+    };
+  }
+}
+
+#endif
@@ -0,0 +1,453 @@
+/**
+ * \file HalfbandCascade.cpp
+ * The allpass design is the one of Valenzuela and Constantinides, as implemented in http://ldesoras.free.fr/prod.html#src_hiir
+ */
+
+#include "HalfbandCascade.h"
+#include <ATK/Core/Utilities.h>
+
+#include <boost/math/constants/constants.hpp>
+#include <boost/math/special_functions/bessel.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+namespace ATK
+{
+  namespace
+  {
+    /// Number of samples at the low rate processed at once
+    constexpr gsl::index CHUNK_SIZE = 256;
+    /// End of the preserved band, relative to the low sampling rate
+    constexpr double PASSBAND = 0.45;
+    /// Rejection of the images, in dB
+    constexpr double ATTENUATION = 100;
+
+    /// Width of the transition band of a stage, relative to its high sampling rate
+    double transition_width(gsl::index stage)
+    {
+      auto passband = PASSBAND / (gsl::index(1) << (stage + 1));
+      return .5 - 2 * passband;
+    }
+
+    /// Kaiser windowed half-band, returns the coefficients of the even taps up to the center
+    std::vector<double> design_fir(double width)
+    {
+      auto length = static_cast<gsl::index>(std::ceil((ATTENUATION - 8) / (2.285 * 2 * boost::math::constants::pi<double>() * width))) + 1;
+      // The length is 4 * half_length - 1 so that the center tap is odd and the others are symmetric
+      auto half_length = (length + 4) / 4;
+      auto center = 2 * half_length - 1;
+      auto beta = 0.1102 * (ATTENUATION - 8.7);
+
+      std::vector<double> coefficients(half_length);
+      double sum = 0;
+      for(gsl::index j = 0; j < half_length; ++j)
+      {
+        auto offset = static_cast<double>(2 * j - center);
+        auto window = boost::math::cyl_bessel_i(0, beta * std::sqrt(1 - offset * offset / (center * center))) / boost::math::cyl_bessel_i(0, beta);
+        coefficients[j] = std::sin(boost::math::constants::half_pi<double>() * offset) / (boost::math::constants::pi<double>() * offset) * window;
+        sum += 2 * coefficients[j];
+      }
+      // Each polyphase branch has a gain of 0.5
+      for(auto& coefficient: coefficients)
+      {
+        coefficient *= .5 / sum;
+      }
+      return coefficients;
+    }
+
+    double accumulate_numerator(double q, gsl::index order, gsl::index c)
+    {
+      double sum = 0;
+      double term = 0;
+      gsl::index i = 0;
+      do
+      {
+        term = std::pow(q, static_cast<double>(i * (i + 1))) * std::sin((2 * i + 1) * c * boost::math::constants::pi<double>() / order) * (i % 2 ? -1 : 1);
+        sum += term;
+        ++i;
+      } while(std::abs(term) > 1e-100);
+      return sum;
+    }
+
+    double accumulate_denominator(double q, gsl::index order, gsl::index c)
+    {
+      double sum = 0;
+      double term = 0;
+      gsl::index i = 1;
+      do
+      {
+        term = std::pow(q, static_cast<double>(i * i)) * std::cos(2 * i * c * boost::math::constants::pi<double>() / order) * (i % 2 ? -1 : 1);
+        sum += term;
+        ++i;
+      } while(std::abs(term) > 1e-100);
+      return sum;
+    }
+
+    /// Allpass half-band, returns the coefficients alternating between the two paths
+    std::vector<double> design_iir(double width)
+    {
+      auto k = std::tan((1 - width) * boost::math::constants::pi<double>() / 4);
+      k *= k;
+      auto kksqrt = std::pow(1 - k * k, .25);
+      auto e = .5 * (1 - kksqrt) / (1 + kksqrt);
+      auto e4 = e * e * e * e;
+      auto q = e * (1 + e4 * (2 + e4 * (15 + 150 * e4)));
+
+      auto attenuation = std::pow(10., -ATTENUATION / 10);
+      auto a = attenuation / (1 - attenuation);
+      auto order = static_cast<gsl::index>(std::ceil(std::log(a * a / 16) / std::log(q)));
+      order = std::max<gsl::index>(order | 1, 3);
+
+      std::vector<double> coefficients((order - 1) / 2);
+      for(gsl::index i = 0; i < static_cast<gsl::index>(coefficients.size()); ++i)
+      {
+        auto numerator = accumulate_numerator(q, order, i + 1) * std::pow(q, .25);
+        auto denominator = accumulate_denominator(q, order, i + 1) + .5;
+        auto ww = numerator / denominator;
+        auto wwsq = ww * ww;
+        auto x = std::sqrt((1 - wwsq * k) * (1 - wwsq / k)) / (1 + wwsq);
+        coefficients[i] = (1 - x) / (1 + x);
+      }
+      return coefficients;
+    }
+
+    /// Largest number of allpass sections of a stage
+    constexpr gsl::index MAX_ALLPASS_COEFFICIENTS = 16;
+
+    /// Two paths of first order allpass sections a + z^-1 / (1 + a z^-1) at the low rate
+    /*!
+     * The number of sections is known at compile time so that their states stay in registers, and the recursions of
+     * the sections overlap from one sample to the next.
+     */
+    template<gsl::index nb_coefficients, bool upsample, typename DataType>
+    void process_allpass(const DataType* ATK_RESTRICT coefficients, DataType* ATK_RESTRICT state, const DataType* ATK_RESTRICT input, DataType* ATK_RESTRICT output, gsl::index size)
+    {
+      DataType last_input[nb_coefficients];
+      DataType last_output[nb_coefficients];
+      for(gsl::index section = 0; section < nb_coefficients; ++section)
+      {
+        last_input[section] = state[section];
+        last_output[section] = state[nb_coefficients + section];
+      }
+
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        // The outputs of a decimating stage are aligned on the odd input samples
+        DataType paths[2] = {upsample ? input[i] : input[2 * i + 1], upsample ? input[i] : input[2 * i]};
+        for(gsl::index section = 0; section < nb_coefficients; ++section)
+        {
+          auto value = paths[section % 2];
+          auto result = (coefficients[section] * value + last_input[section]) - coefficients[section] * last_output[section];
+          last_input[section] = value;
+          last_output[section] = result;
+          paths[section % 2] = result;
+        }
+        if(upsample)
+        {
+          output[2 * i] = paths[0];
+          output[2 * i + 1] = paths[1];
+        }
+        else
+        {
+          output[i] = static_cast<DataType>(.5) * (paths[0] + paths[1]);
+        }
+      }
+
+      for(gsl::index section = 0; section < nb_coefficients; ++section)
+      {
+        state[section] = last_input[section];
+        state[nb_coefficients + section] = last_output[section];
+      }
+    }
+  }
+
+  /// A rate change by 2
+  template<typename DataType_>
+  class HalfbandCascade<DataType_>::Stage
+  {
+  public:
+    virtual ~Stage() = default;
+    /// Group delay of the low frequencies at the high rate
+    virtual double get_latency() const = 0;
+    virtual void reset() = 0;
+    /// Writes 2 * size samples
+    virtual void upsample(const DataType* ATK_RESTRICT input, DataType* ATK_RESTRICT output, gsl::index size) = 0;
+    /// Reads 2 * size samples
+    virtual void downsample(const DataType* ATK_RESTRICT input, DataType* ATK_RESTRICT output, gsl::index size) = 0;
+  };
+
+  /// Polyphase half-band FIR, only the even taps and the center one are not null
+  template<typename DataType_>
+  class HalfbandCascade<DataType_>::FIRStage final : public Stage
+  {
+    /// Even taps up to the center, the others are symmetric
+    std::vector<DataType> coefficients;
+    gsl::index half_length;
+    /// Number of past samples of a polyphase branch
+    gsl::index history_size;
+    /// The branches of the polyphase decomposition, history followed by the block
+    AlignedVector even;
+    AlignedVector odd;
+    AlignedVector accumulator;
+
+    /// Adds the symmetric taps of the filter to size samples
+    void convolve(const DataType* ATK_RESTRICT input, DataType* ATK_RESTRICT output, gsl::index size, DataType gain) const
+    {
+      for(gsl::index j = 0; j < half_length; ++j)
+      {
+        auto coefficient = gain * coefficients[j];
+        const DataType* ATK_RESTRICT recent = input - j;
+        const DataType* ATK_RESTRICT old = input - history_size + j;
+        for(gsl::index i = 0; i < size; ++i)
+        {
+          output[i] += coefficient * (recent[i] + old[i]);
+        }
+      }
+    }
+
+    /// Keeps the end of a branch for the next block
+    void shift(AlignedVector& branch, gsl::index size)
+    {
+      std::copy(branch.begin() + size, branch.begin() + size + history_size, branch.begin());
+    }
+
+  public:
+    FIRStage(double width, gsl::index max_size)
+    {
+      auto design = design_fir(width);
+      coefficients.assign(design.begin(), design.end());
+      half_length = static_cast<gsl::index>(coefficients.size());
+      history_size = 2 * half_length - 1;
+      even.assign(history_size + max_size, 0);
+      odd.assign(history_size + max_size, 0);
+      accumulator.assign(max_size, 0);
+    }
+
+    double get_latency() const final
+    {
+      return static_cast<double>(history_size);
+    }
+
+    void reset() final
+    {
+      std::fill(even.begin(), even.end(), 0);
+      std::fill(odd.begin(), odd.end(), 0);
+    }
+
+    void upsample(const DataType* ATK_RESTRICT input, DataType* ATK_RESTRICT output, gsl::index size) final
+    {
+      DataType* ATK_RESTRICT current = even.data() + history_size;
+      std::copy(input, input + size, current);
+
+      // The even samples are filtered, the odd ones are the delayed input
+      DataType* ATK_RESTRICT filtered = accumulator.data();
+      std::fill(filtered, filtered + size, 0);
+      convolve(current, filtered, size, 2);
+      const DataType* ATK_RESTRICT delayed = current - half_length + 1;
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        output[2 * i] = filtered[i];
+        output[2 * i + 1] = delayed[i];
+      }
+      shift(even, size);
+    }
+
+    void downsample(const DataType* ATK_RESTRICT input, DataType* ATK_RESTRICT output, gsl::index size) final
+    {
+      DataType* ATK_RESTRICT current_even = even.data() + history_size;
+      DataType* ATK_RESTRICT current_odd = odd.data() + history_size;
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        current_even[i] = input[2 * i];
+        current_odd[i] = input[2 * i + 1];
+      }
+
+      // The output is aligned on the odd samples, the even branch only goes through the center tap
+      const DataType* ATK_RESTRICT delayed = current_even - half_length + 1;
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        output[i] = static_cast<DataType>(.5) * delayed[i];
+      }
+      convolve(current_odd, output, size, 1);
+      shift(even, size);
+      shift(odd, size);
+    }
+  };
+
+  /// Polyphase half-band made of two paths of allpass filters
+  template<typename DataType_>
+  class HalfbandCascade<DataType_>::IIRStage final : public Stage
+  {
+    using Kernel = void (*)(const DataType*, DataType*, const DataType*, DataType*, gsl::index);
+
+    /// Coefficients alternating between the two paths
+    std::vector<DataType> coefficients;
+    /// Last inputs of the sections followed by their last outputs
+    std::vector<DataType> state;
+    Kernel upsample_kernel;
+    Kernel downsample_kernel;
+
+    template<std::size_t... nb_coefficients>
+    static Kernel select_kernel(gsl::index size, bool upsample, std::index_sequence<nb_coefficients...>)
+    {
+      constexpr Kernel upsample_kernels[] = {&process_allpass<nb_coefficients + 1, true, DataType>...};
+      constexpr Kernel downsample_kernels[] = {&process_allpass<nb_coefficients + 1, false, DataType>...};
+      return upsample ? upsample_kernels[size - 1] : downsample_kernels[size - 1];
+    }
+
+  public:
+    explicit IIRStage(double width)
+    {
+      auto design = design_iir(width);
+      coefficients.assign(design.begin(), design.end());
+      state.assign(2 * coefficients.size(), 0);
+      auto nb_coefficients = static_cast<gsl::index>(coefficients.size());
+      assert(nb_coefficients <= MAX_ALLPASS_COEFFICIENTS);
+      upsample_kernel = select_kernel(nb_coefficients, true, std::make_index_sequence<MAX_ALLPASS_COEFFICIENTS>());
+      downsample_kernel = select_kernel(nb_coefficients, false, std::make_index_sequence<MAX_ALLPASS_COEFFICIENTS>());
+    }
+
+    double get_latency() const final
+    {
+      // Each section delays the low frequencies by (1 - a) / (1 + a) samples at the low rate
+      double delays[2] = {0, 1};
+      for(std::size_t section = 0; section < coefficients.size(); ++section)
+      {
+        double coefficient = static_cast<double>(coefficients[section]);
+        delays[section % 2] += 2 * (1 - coefficient) / (1 + coefficient);
+      }
+      return (delays[0] + delays[1]) / 2;
+    }
+
+    void reset() final
+    {
+      std::fill(state.begin(), state.end(), 0);
+    }
+
+    void upsample(const DataType* ATK_RESTRICT input, DataType* ATK_RESTRICT output, gsl::index size) final
+    {
+      upsample_kernel(coefficients.data(), state.data(), input, output, size);
+    }
+
+    void downsample(const DataType* ATK_RESTRICT input, DataType* ATK_RESTRICT output, gsl::index size) final
+    {
+      downsample_kernel(coefficients.data(), state.data(), input, output, size);
+    }
+  };
+
+  template<typename DataType_>
+  HalfbandCascade<DataType_>::HalfbandCascade(gsl::index factor, HalfbandDesign design)
+  :factor(factor), design(design)
+  {
+    if(factor < 2 || factor > 32 || (factor & (factor - 1)) != 0)
+    {
+      throw ATK::RuntimeError("Factor must be a power of 2 between 2 and 32");
+    }
+    for(gsl::index stage = 0; (gsl::index(2) << stage) <= factor; ++stage)
+    {
+      if(design == HalfbandDesign::LinearPhaseFIR)
+      {
+        stages.push_back(std::make_unique<FIRStage>(transition_width(stage), CHUNK_SIZE << stage));
+      }
+      else
+      {
+        stages.push_back(std::make_unique<IIRStage>(transition_width(stage)));
+      }
+    }
+    for(gsl::index stage = 1; stage < static_cast<gsl::index>(stages.size()); ++stage)
+    {
+      buffers.emplace_back(CHUNK_SIZE << stage, 0);
+    }
+  }
+
+  template<typename DataType_>
+  HalfbandCascade<DataType_>::~HalfbandCascade()
+  {
+  }
+
+  template<typename DataType_>
+  gsl::index HalfbandCascade<DataType_>::get_factor() const
+  {
+    return factor;
+  }
+
+  template<typename DataType_>
+  HalfbandDesign HalfbandCascade<DataType_>::get_design() const
+  {
+    return design;
+  }
+
+  template<typename DataType_>
+  double HalfbandCascade<DataType_>::get_upsampling_latency() const
+  {
+    double latency = 0;
+    for(gsl::index stage = 0; stage < static_cast<gsl::index>(stages.size()); ++stage)
+    {
+      latency += stages[stage]->get_latency() * (factor >> (stage + 1));
+    }
+    return latency;
+  }
+
+  template<typename DataType_>
+  double HalfbandCascade<DataType_>::get_downsampling_latency() const
+  {
+    // The outputs of the stages are aligned on the odd input samples
+    double latency = 0;
+    for(gsl::index stage = 0; stage < static_cast<gsl::index>(stages.size()); ++stage)
+    {
+      latency += (stages[stage]->get_latency() - 1) * (factor >> (stage + 1));
+    }
+    return latency;
+  }
+
+  template<typename DataType_>
+  void HalfbandCascade<DataType_>::reset()
+  {
+    for(auto& stage: stages)
+    {
+      stage->reset();
+    }
+  }
+
+  template<typename DataType_>
+  void HalfbandCascade<DataType_>::upsample(const DataType* input, DataType* output, gsl::index size)
+  {
+    auto nb_stages = static_cast<gsl::index>(stages.size());
+    for(gsl::index processed = 0; processed < size; processed += CHUNK_SIZE)
+    {
+      auto chunk_size = std::min(CHUNK_SIZE, size - processed);
+      const DataType* stage_input = input + processed;
+      for(gsl::index stage = 0; stage < nb_stages; ++stage)
+      {
+        DataType* stage_output = stage + 1 == nb_stages ? output + processed * factor : buffers[stage].data();
+        stages[stage]->upsample(stage_input, stage_output, chunk_size << stage);
+        stage_input = stage_output;
+      }
+    }
+  }
+
+  template<typename DataType_>
+  void HalfbandCascade<DataType_>::downsample(const DataType* input, DataType* output, gsl::index size)
+  {
+    auto nb_stages = static_cast<gsl::index>(stages.size());
+    for(gsl::index processed = 0; processed < size; processed += CHUNK_SIZE)
+    {
+      auto chunk_size = std::min(CHUNK_SIZE, size - processed);
+      const DataType* stage_input = input + processed * factor;
+      for(gsl::index stage = nb_stages - 1; stage >= 0; --stage)
+      {
+        DataType* stage_output = stage == 0 ? output + processed : buffers[stage - 1].data();
+        stages[stage]->downsample(stage_input, stage_output, chunk_size << stage);
+        stage_input = stage_output;
+      }
+    }
+  }
+
+  template class HalfbandCascade<double>;
+#if ATK_ENABLE_INSTANTIATION
+  template class HalfbandCascade<float>;
+#endif
+}
@@ -0,0 +1,91 @@
+/**
+ * \file HalfbandCascade.h
+ */
+
+#ifndef ATK_TOOLS_HALFBANDCASCADE_H
+#define ATK_TOOLS_HALFBANDCASCADE_H
+
+#include <ATK/Core/TypedBaseFilter.h>
+#include <ATK/Tools/config.h>
+
+#include <boost/align/aligned_allocator.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace ATK
+{
+  /// Design of the half-band stages of a HalfbandCascade
+  enum class HalfbandDesign
+  {
+    /// Kaiser windowed FIR, linear phase
+    LinearPhaseFIR,
+    /// Two paths of first order allpass filters, a fraction of the latency of the FIR but with a nonlinear phase
+    AllpassIIR
+  };
+
+  /// Changes the sampling rate by a power of 2 with a cascade of polyphase half-band filters
+  /*!
+   * Each stage doubles or halves the sampling rate and is computed at the lowest of its two rates. The first stage,
+   * at the lowest rate, has the sharpest transition band, the following ones only remove the images of the audio band.
+   * An instance keeps the history of one signal and is used either to upsample or to downsample.
+   */
+  template<typename DataType_>
+  class ATK_TOOLS_EXPORT HalfbandCascade final
+  {
+  public:
+    using DataType = DataType_;
+
+    /*!
+     * @brief Constructor
+     * @param factor is the ratio between the high and the low sampling rates, a power of 2 between 2 and 32
+     * @param design is the design of the half-band stages
+     */
+    HalfbandCascade(gsl::index factor, HalfbandDesign design);
+    /// Destructor
+    ~HalfbandCascade();
+
+    /// Returns the ratio between the high and the low sampling rates
+    gsl::index get_factor() const;
+    /// Returns the design of the stages
+    HalfbandDesign get_design() const;
+    /// Returns the delay of the low frequencies when upsampling, in samples at the high rate
+    double get_upsampling_latency() const;
+    /// Returns the delay of the low frequencies when downsampling, in samples at the high rate
+    double get_downsampling_latency() const;
+
+    /// Clears the history
+    void reset();
+
+    /*!
+     * @brief Upsamples a block
+     * @param input is the block at the low rate
+     * @param output receives size * factor samples
+     * @param size is the number of input samples
+     */
+    void upsample(const DataType* input, DataType* output, gsl::index size);
+    /*!
+     * @brief Downsamples a block
+     * @param input is the block of size * factor samples at the high rate
+     * @param output receives the block at the low rate
+     * @param size is the number of output samples
+     */
+    void downsample(const DataType* input, DataType* output, gsl::index size);
+
+  private:
+    class Stage;
+    class FIRStage;
+    class IIRStage;
+
+    using AlignedVector = std::vector<DataType, boost::alignment::aligned_allocator<DataType, 32>>;
+
+    gsl::index factor;
+    HalfbandDesign design;
+    /// The stages, from the lowest to the highest rate
+    std::vector<std::unique_ptr<Stage>> stages;
+    /// The block between stages i and i + 1
+    std::vector<AlignedVector> buffers;
+  };
+}
+
+#endif
@@ -17,22 +17,30 @@ namespace ATK
   {
   }
   
+  template<typename DataType_>
+  gsl::index MuteSoloBufferFilter<DataType_>::get_in_place_input(gsl::index output_port) const
+  {
+    return output_port;
+  }
+
   template<typename DataType_>
   void MuteSoloBufferFilter<DataType_>::process_impl(gsl::index size) const
   {
     for(gsl::index channel = 0; channel < nb_input_ports; ++channel)
     {
-      const DataType* ATK_RESTRICT input = converted_inputs[channel];
-      DataType* ATK_RESTRICT output = outputs[channel];
       if(mute_statuses[channel] || (any_solo && !solo_statuses[channel]))
       {
+        DataType* ATK_RESTRICT output = outputs[channel];
         for(gsl::index i = 0; i < size; ++i)
         {
           output[i] = 0;
         }
       }
-      else
+      else if(converted_inputs[channel] != outputs[channel])
       {
+        // Nothing to copy when computed in place
+        const DataType* ATK_RESTRICT input = converted_inputs[channel];
+        DataType* ATK_RESTRICT output = outputs[channel];
         for(gsl::index i = 0; i < size; ++i)
         {
           output[i] = input[i];
@@ -36,16 +36,34 @@ namespace ATK
     return offset;
   }
 
+  template<typename DataType_>
+  gsl::index OffsetVolumeFilter<DataType_>::get_in_place_input(gsl::index output_port) const
+  {
+    return output_port;
+  }
+
   template<typename DataType_>
   void OffsetVolumeFilter<DataType_>::process_impl(gsl::index size) const
   {
     for(gsl::index channel = 0; channel < nb_input_ports; ++channel)
     {
-      const DataType* ATK_RESTRICT input = converted_inputs[channel];
-      DataType* ATK_RESTRICT output = outputs[channel];
-      for(gsl::index i = 0; i < size; ++i)
+      if(converted_inputs[channel] == outputs[channel])
+      {
+        // Computed in place
+        DataType* output = outputs[channel];
+        for(gsl::index i = 0; i < size; ++i)
+        {
+          output[i] = offset + volume * output[i];
+        }
+      }
+      else
       {
-        output[i] = offset + volume * input[i];
+        const DataType* ATK_RESTRICT input = converted_inputs[channel];
+        DataType* ATK_RESTRICT output = outputs[channel];
+        for(gsl::index i = 0; i < size; ++i)
+        {
+          output[i] = offset + volume * input[i];
+        }
       }
     }
   }
@@ -0,0 +1,104 @@
+/**
+ * \file OversampledSubgraph.cpp
+ */
+
+#include "OversampledSubgraph.h"
+#include <ATK/Core/Utilities.h>
+
+#include <cmath>
+
+namespace ATK
+{
+  template<typename DataType_>
+  OversampledSubgraph<DataType_>::OversampledSubgraph(gsl::index nb_input_ports, gsl::index nb_output_ports, gsl::index factor, const Builder& fun, HalfbandDesign design)
+  :Parent(nb_input_ports, nb_output_ports), factor(factor), oversampling(nb_input_ports, design), decimation(nb_output_ports, design)
+  {
+    if(factor < 2 || factor > 32 || (factor & (factor - 1)) != 0)
+    {
+      throw ATK::RuntimeError("Factor must be a power of 2 between 2 and 32");
+    }
+    input_filters.reserve(nb_input_ports);
+    for(gsl::index port = 0; port < nb_input_ports; ++port)
+    {
+      input_filters.emplace_back(nullptr, 1, 0, false);
+      oversampling.set_input_port(port, input_filters.back(), 0);
+    }
+    output_filters.reserve(nb_output_ports);
+    for(gsl::index port = 0; port < nb_output_ports; ++port)
+    {
+      output_filters.emplace_back(nullptr, 1, 0, false);
+      output_filters.back().set_input_port(0, decimation, port);
+      sink.add_filter(&output_filters.back());
+    }
+
+    fun(oversampling, decimation, filters);
+  }
+
+  template<typename DataType_>
+  gsl::index OversampledSubgraph<DataType_>::get_factor() const
+  {
+    return factor;
+  }
+
+  template<typename DataType_>
+  void OversampledSubgraph<DataType_>::full_setup()
+  {
+    auto high_rate = input_sampling_rate * factor;
+    for(auto& filter: input_filters)
+    {
+      filter.set_output_sampling_rate(input_sampling_rate);
+    }
+    // The output rates are cleared first, so that the rates never have an unsupported ratio in between
+    oversampling.set_output_sampling_rate(0);
+    oversampling.set_input_sampling_rate(input_sampling_rate);
+    oversampling.set_output_sampling_rate(high_rate);
+    for(auto& filter: filters)
+    {
+      filter->set_input_sampling_rate(high_rate);
+      filter->set_output_sampling_rate(high_rate);
+    }
+    decimation.set_output_sampling_rate(0);
+    decimation.set_input_sampling_rate(high_rate);
+    decimation.set_output_sampling_rate(input_sampling_rate);
+    for(auto& filter: output_filters)
+    {
+      filter.set_input_sampling_rate(input_sampling_rate);
+    }
+    sink.set_input_sampling_rate(input_sampling_rate);
+
+    // The latencies up to the decimation are counted at the high rate
+    auto high_rate_latency = static_cast<double>(decimation.get_global_latency() - decimation.get_latency());
+    this->set_latency(std::lround(high_rate_latency / factor) + decimation.get_latency());
+    Parent::full_setup();
+  }
+
+  template<typename DataType_>
+  void OversampledSubgraph<DataType_>::preallocate(gsl::index size)
+  {
+    Parent::preallocate(size);
+    // Propagates to the whole subgraph with the oversampling factor
+    for(auto& filter: output_filters)
+    {
+      filter.set_max_block_size(size);
+    }
+  }
+
+  template<typename DataType_>
+  void OversampledSubgraph<DataType_>::process_impl(gsl::index size) const
+  {
+    for(gsl::index port = 0; port < nb_input_ports; ++port)
+    {
+      input_filters[port].set_pointer(converted_inputs[port], size);
+    }
+    for(gsl::index port = 0; port < nb_output_ports; ++port)
+    {
+      output_filters[port].set_pointer(outputs[port], size);
+    }
+    sink.process(size);
+  }
+
+  template class OversampledSubgraph<double>;
+#if ATK_ENABLE_INSTANTIATION
+  template class OversampledSubgraph<float>;
+#endif
+}
@@ -0,0 +1,78 @@
+/**
+ * \file OversampledSubgraph.h
+ */
+
+#ifndef ATK_TOOLS_OVERSAMPLEDSUBGRAPH_H
+#define ATK_TOOLS_OVERSAMPLEDSUBGRAPH_H
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+#include <ATK/Core/PipelineGlobalSinkFilter.h>
+#include <ATK/Core/TypedBaseFilter.h>
+#include <ATK/Tools/PolyphaseDecimationFilter.h>
+#include <ATK/Tools/PolyphaseOversamplingFilter.h>
+#include <ATK/Tools/config.h>
+
+#include <functional>
+#include <vector>
+
+namespace ATK
+{
+  /// Wraps a set of filters that run at a multiple of the sampling rate, typically nonlinear filters
+  /*!
+   * The inputs are oversampled by a PolyphaseOversamplingFilter and the outputs of the subgraph are decimated by a
+   * PolyphaseDecimationFilter. The sampling rates of the wrapped filters are set by full_setup(), only the ports at the
+   * original rate are visible. The latency of the wrapper is the latency of the resamplers and of the subgraph, as it
+   * is when full_setup() is called.
+   */
+  template<typename DataType_>
+  class ATK_TOOLS_EXPORT OversampledSubgraph final : public TypedBaseFilter<DataType_>
+  {
+  protected:
+    /// Simplify parent calls
+    using Parent = TypedBaseFilter<DataType_>;
+    using typename Parent::DataType;
+    using Parent::converted_inputs;
+    using Parent::outputs;
+    using Parent::input_sampling_rate;
+    using Parent::nb_input_ports;
+    using Parent::nb_output_ports;
+
+  public:
+    /// Builds the subgraph from the outputs of the oversampling filter to the inputs of the decimation filter
+    using Builder = std::function<void(BaseFilter& oversampling, BaseFilter& decimation, std::vector<gsl::unique_ptr<BaseFilter>>& filters)>;
+
+    /*!
+     * @brief Constructor of the wrapper
+     * @param nb_input_ports is the number of inputs, also the number of outputs of the oversampling filter
+     * @param nb_output_ports is the number of outputs, also the number of inputs of the decimation filter
+     * @param factor is the oversampling factor, a power of 2 between 2 and 32
+     * @param fun connects the subgraph and moves its filters to the last argument
+     * @param design is the design of the resamplers
+     */
+    OversampledSubgraph(gsl::index nb_input_ports, gsl::index nb_output_ports, gsl::index factor, const Builder& fun, HalfbandDesign design = HalfbandDesign::LinearPhaseFIR);
+    /// Destructor
+    ~OversampledSubgraph() override = default;
+
+    /// Returns the oversampling factor
+    gsl::index get_factor() const;
+
+    void full_setup() final;
+
+  protected:
+    void process_impl(gsl::index size) const final;
+    void preallocate(gsl::index size) final;
+
+  private:
+    gsl::index factor;
+    mutable std::vector<InPointerFilter<DataType>> input_filters;
+    PolyphaseOversamplingFilter<DataType> oversampling;
+    /// Filters of the subgraph
+    std::vector<gsl::unique_ptr<BaseFilter>> filters;
+    PolyphaseDecimationFilter<DataType> decimation;
+    mutable std::vector<OutPointerFilter<DataType>> output_filters;
+    mutable PipelineGlobalSinkFilter sink;
+  };
+}
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ * \file PolyphaseDecimationFilter.cpp
+ */
+
+#include "PolyphaseDecimationFilter.h"
+#include <ATK/Core/Utilities.h>
+
+#include <cassert>
+#include <cmath>
+
+namespace ATK
+{
+  template<class DataType>
+  PolyphaseDecimationFilter<DataType>::PolyphaseDecimationFilter(gsl::index nb_channels, HalfbandDesign design)
+  :Parent(nb_channels, nb_channels), design(design)
+  {
+  }
+
+  template<class DataType>
+  PolyphaseDecimationFilter<DataType>::~PolyphaseDecimationFilter()
+  {
+  }
+
+  template<class DataType>
+  void PolyphaseDecimationFilter<DataType>::set_design(HalfbandDesign design)
+  {
+    this->design = design;
+    setup();
+  }
+
+  template<class DataType>
+  HalfbandDesign PolyphaseDecimationFilter<DataType>::get_design() const
+  {
+    return design;
+  }
+
+  template<class DataType>
+  void PolyphaseDecimationFilter<DataType>::setup()
+  {
+    Parent::setup();
+    cascades.clear();
+    this->set_latency(0);
+    // Equal rates are allowed until the output rate is set
+    if(input_sampling_rate == 0 || output_sampling_rate == 0 || input_sampling_rate == output_sampling_rate)
+    {
+      return;
+    }
+    auto factor = input_sampling_rate / output_sampling_rate;
+    if(input_sampling_rate % output_sampling_rate != 0 || factor < 2 || factor > 32 || (factor & (factor - 1)) != 0)
+    {
+      throw ATK::RuntimeError("The input sampling rate must be the output one times a power of 2 between 2 and 32");
+    }
+    for(gsl::index channel = 0; channel < nb_input_ports; ++channel)
+    {
+      cascades.push_back(std::make_unique<HalfbandCascade<DataType>>(factor, design));
+    }
+    // The latency is given at the output rate
+    this->set_latency(std::lround(cascades[0]->get_downsampling_latency() / factor));
+  }
+
+  template<class DataType>
+  void PolyphaseDecimationFilter<DataType>::process_impl(gsl::index size) const
+  {
+    assert(nb_input_ports == nb_output_ports);
+    if(cascades.empty())
+    {
+      throw ATK::RuntimeError("The input sampling rate must be the output one times a power of 2 between 2 and 32");
+    }
+
+    for(gsl::index channel = 0; channel < nb_input_ports; ++channel)
+    {
+      cascades[channel]->downsample(converted_inputs[channel], outputs[channel], size);
+    }
+  }
+
+  template class PolyphaseDecimationFilter<double>;
+#if ATK_ENABLE_INSTANTIATION
+  template class PolyphaseDecimationFilter<float>;
+#endif
+}
@@ -0,0 +1,64 @@
+/**
+ * \file PolyphaseDecimationFilter.h
+ */
+
+#ifndef ATK_TOOLS_POLYPHASEDECIMATIONFILTER_H
+#define ATK_TOOLS_POLYPHASEDECIMATIONFILTER_H
+
+#include <ATK/Core/TypedBaseFilter.h>
+#include <ATK/Tools/HalfbandCascade.h>
+#include <ATK/Tools/config.h>
+
+#include <memory>
+#include <vector>
+
+namespace ATK
+{
+  /// Decimates by a power of 2 between 2 and 32 with a cascade of half-band anti-aliasing filters
+  /*!
+   * The factor is the ratio between the input and the output sampling rates. The latency is set in samples at the
+   * output rate.
+   * Setting rates with an unsupported ratio throws, except for equal rates which are the state of the filter between
+   * the two calls. Any output block size is supported, the input block is always factor times larger.
+   */
+  template<class DataType_>
+  class ATK_TOOLS_EXPORT PolyphaseDecimationFilter final : public TypedBaseFilter<DataType_>
+  {
+  protected:
+    /// Simplify parent calls
+    using Parent = TypedBaseFilter<DataType_>;
+    using typename Parent::DataType;
+    using Parent::converted_inputs;
+    using Parent::outputs;
+    using Parent::input_sampling_rate;
+    using Parent::output_sampling_rate;
+    using Parent::nb_input_ports;
+    using Parent::nb_output_ports;
+
+  public:
+    /*!
+    * @brief Constructor
+    * @param nb_channels is the number of input and output channels
+    * @param design is the design of the half-band filters
+    */
+    explicit PolyphaseDecimationFilter(gsl::index nb_channels = 1, HalfbandDesign design = HalfbandDesign::LinearPhaseFIR);
+    /// Destructor
+    ~PolyphaseDecimationFilter() override;
+
+    /// Changes the design of the half-band filters, resets the history
+    void set_design(HalfbandDesign design);
+    /// Returns the design of the half-band filters
+    HalfbandDesign get_design() const;
+
+  protected:
+    void process_impl(gsl::index size) const final;
+    void setup() final;
+
+  private:
+    HalfbandDesign design;
+    /// One cascade per channel, empty if the sampling rates are not supported
+    std::vector<std::unique_ptr<HalfbandCascade<DataType_>>> cascades;
+  };
+}
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * \file PolyphaseOversamplingFilter.cpp
+ */
+
+#include "PolyphaseOversamplingFilter.h"
+#include <ATK/Core/Utilities.h>
+
+#include <cassert>
+#include <cmath>
+
+namespace ATK
+{
+  template<class DataType>
+  PolyphaseOversamplingFilter<DataType>::PolyphaseOversamplingFilter(gsl::index nb_channels, HalfbandDesign design)
+  :Parent(nb_channels, nb_channels), design(design)
+  {
+  }
+
+  template<class DataType>
+  PolyphaseOversamplingFilter<DataType>::~PolyphaseOversamplingFilter()
+  {
+  }
+
+  template<class DataType>
+  void PolyphaseOversamplingFilter<DataType>::set_design(HalfbandDesign design)
+  {
+    this->design = design;
+    setup();
+  }
+
+  template<class DataType>
+  HalfbandDesign PolyphaseOversamplingFilter<DataType>::get_design() const
+  {
+    return design;
+  }
+
+  template<class DataType>
+  void PolyphaseOversamplingFilter<DataType>::setup()
+  {
+    Parent::setup();
+    cascades.clear();
+    this->set_latency(0);
+    // Equal rates are allowed until the output rate is set
+    if(input_sampling_rate == 0 || output_sampling_rate == 0 || input_sampling_rate == output_sampling_rate)
+    {
+      return;
+    }
+    auto factor = output_sampling_rate / input_sampling_rate;
+    if(output_sampling_rate % input_sampling_rate != 0 || factor < 2 || factor > 32 || (factor & (factor - 1)) != 0)
+    {
+      throw ATK::RuntimeError("The output sampling rate must be the input one times a power of 2 between 2 and 32");
+    }
+    for(gsl::index channel = 0; channel < nb_input_ports; ++channel)
+    {
+      cascades.push_back(std::make_unique<HalfbandCascade<DataType>>(factor, design));
+    }
+    this->set_latency(std::lround(cascades[0]->get_upsampling_latency()));
+  }
+
+  template<class DataType>
+  void PolyphaseOversamplingFilter<DataType>::process_impl(gsl::index size) const
+  {
+    assert(nb_input_ports == nb_output_ports);
+    if(cascades.empty())
+    {
+      throw ATK::RuntimeError("The output sampling rate must be the input one times a power of 2 between 2 and 32");
+    }
+
+    auto factor = cascades[0]->get_factor();
+    if(size % factor != 0)
+    {
+      throw ATK::RuntimeError("The size of the block must be a multiple of the oversampling factor");
+    }
+    for(gsl::index channel = 0; channel < nb_input_ports; ++channel)
+    {
+      cascades[channel]->upsample(converted_inputs[channel], outputs[channel], size / factor);
+    }
+  }
+
+  template class PolyphaseOversamplingFilter<double>;
+#if ATK_ENABLE_INSTANTIATION
+  template class PolyphaseOversamplingFilter<float>;
+#endif
+}
@@ -0,0 +1,322 @@
+/**
+ * \file ResamplingFilter.cpp
+ */
+
+#include "ResamplingFilter.h"
+#include <ATK/Core/Utilities.h>
+
+#include <boost/math/constants/constants.hpp>
+#include <boost/math/special_functions/bessel.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+
+namespace ATK
+{
+  namespace
+  {
+    /// End of the preserved band, relative to the lowest of the sampling rates
+    constexpr double PASSBAND = 0.45;
+    /// Rejection of the images and of the aliases, in dB
+    constexpr double ATTENUATION = 100;
+    /// Largest ratio denominator with a precomputed phase for each output sample
+    constexpr std::uint64_t MAX_EXACT_PHASES = 1024;
+    /// Number of phases when the coefficients are interpolated
+    constexpr gsl::index INTERPOLATED_PHASES = 256;
+    /// Number of partial sums, the number of taps is a multiple of it
+    constexpr gsl::index LANES = 8;
+    /// Largest drift of the input clock
+    constexpr double MAX_DRIFT = 0.01;
+    /// Time constant of the drift tracking, in seconds
+    constexpr double TRACKING_TIME = 0.1;
+    /// Natural pulsation of the drift estimation loop, critically damped, in radians per second
+    constexpr double ESTIMATION_PULSATION = 0.5;
+
+    /// Kaiser windowed sinc, tau in input samples
+    double windowed_sinc(double tau, double cutoff, double half_length, double beta)
+    {
+      auto x = tau / half_length;
+      if(std::abs(x) >= 1)
+      {
+        return 0;
+      }
+      auto window = boost::math::cyl_bessel_i(0, beta * std::sqrt(1 - x * x)) / boost::math::cyl_bessel_i(0, beta);
+      auto arg = boost::math::constants::pi<double>() * 2 * cutoff * tau;
+      auto sinc = arg == 0 ? 1 : std::sin(arg) / arg;
+      return 2 * cutoff * sinc * window;
+    }
+
+    /// Dot product with independent partial sums, so that it is vectorized
+    template<typename DataType>
+    DataType convolve(const DataType* ATK_RESTRICT input, const DataType* ATK_RESTRICT coefficients, gsl::index size)
+    {
+      DataType partial[LANES] = {0};
+      for(gsl::index i = 0; i < size; i += LANES)
+      {
+        for(gsl::index j = 0; j < LANES; ++j)
+        {
+          partial[j] += input[i + j] * coefficients[i + j];
+        }
+      }
+      return std::accumulate(partial, partial + LANES, DataType(0));
+    }
+  }
+
+  template<class DataType>
+  ResamplingFilter<DataType>::ResamplingFilter(gsl::index nb_channels)
+  :Parent(nb_channels, nb_channels)
+  {
+  }
+
+  template<class DataType>
+  ResamplingFilter<DataType>::~ResamplingFilter()
+  {
+  }
+
+  template<class DataType>
+  void ResamplingFilter<DataType>::set_asynchronous(bool asynchronous)
+  {
+    this->asynchronous = asynchronous;
+    setup();
+  }
+
+  template<class DataType>
+  bool ResamplingFilter<DataType>::get_asynchronous() const
+  {
+    return asynchronous;
+  }
+
+  template<class DataType>
+  void ResamplingFilter<DataType>::set_drift(double drift)
+  {
+    if(std::abs(drift) > MAX_DRIFT)
+    {
+      throw RuntimeError("Drift must be between -0.01 and 0.01");
+    }
+    this->drift = drift;
+  }
+
+  template<class DataType>
+  double ResamplingFilter<DataType>::get_drift() const
+  {
+    return drift;
+  }
+
+  template<class DataType>
+  void ResamplingFilter<DataType>::set_target_fill_level(double fill_level)
+  {
+    if(fill_level < 0)
+    {
+      throw RuntimeError("Fill level can't be negative");
+    }
+    target_fill_level = fill_level;
+  }
+
+  template<class DataType>
+  double ResamplingFilter<DataType>::get_target_fill_level() const
+  {
+    return target_fill_level;
+  }
+
+  template<class DataType>
+  void ResamplingFilter<DataType>::set_fill_level(double fill_level)
+  {
+    if(!asynchronous || input_sampling_rate == 0 || output_sampling_rate == 0)
+    {
+      throw RuntimeError("The fill level is only used by the asynchronous mode, once the sampling rates are set");
+    }
+    // The level rises by input_sampling_rate * (drift - estimated drift) per second, the loop is a PI on the level
+    // error in seconds, with gains sqrt(2) w and w^2 so that it is critically damped
+    auto error = (fill_level - target_fill_level) / input_sampling_rate;
+    auto elapsed = static_cast<double>(samples_since_fill_level) / output_sampling_rate;
+    samples_since_fill_level = 0;
+    auto integral_gain = ESTIMATION_PULSATION * ESTIMATION_PULSATION;
+    // The integral alone never goes beyond the drift range, so that it doesn't wind up
+    fill_level_integral = std::clamp(fill_level_integral + error * elapsed, -MAX_DRIFT / integral_gain, MAX_DRIFT / integral_gain);
+    auto estimation = boost::math::constants::root_two<double>() * ESTIMATION_PULSATION * error + integral_gain * fill_level_integral;
+    drift = std::clamp(estimation, -MAX_DRIFT, MAX_DRIFT);
+  }
+
+  template<class DataType>
+  double ResamplingFilter<DataType>::get_ratio() const
+  {
+    return asynchronous ? nominal_ratio * (1 + current_drift) : nominal_ratio;
+  }
+
+  template<class DataType>
+  void ResamplingFilter<DataType>::setup()
+  {
+    Parent::setup();
+    design();
+    phase = 0;
+    position = 0;
+    current_drift = drift;
+    fill_level_integral = 0;
+    samples_since_fill_level = 0;
+    this->set_input_delay(nb_taps);
+    // The filter is centered nb_taps / 2 samples before the last input sample it reads
+    this->set_latency(nb_taps == 0 ? 0 : std::lround((nb_taps / 2 + 1) / nominal_ratio));
+  }
+
+  template<class DataType>
+  void ResamplingFilter<DataType>::design()
+  {
+    coefficients.clear();
+    differences.clear();
+    nb_taps = 0;
+    if(input_sampling_rate == 0 || output_sampling_rate == 0)
+    {
+      return;
+    }
+    auto divisor = std::gcd(input_sampling_rate, output_sampling_rate);
+    decimation = static_cast<std::uint64_t>(input_sampling_rate / divisor);
+    interpolation = static_cast<std::uint64_t>(output_sampling_rate / divisor);
+    nominal_ratio = static_cast<double>(input_sampling_rate) / output_sampling_rate;
+
+    // When downsampling, the filter is stretched so that its transition band is constant at the output rate
+    auto scale = std::min(1., 1 / nominal_ratio);
+    auto width = .5 - PASSBAND;
+    auto length = std::ceil((ATTENUATION - 8) / (2.285 * 2 * boost::math::constants::pi<double>() * width) / scale);
+    nb_taps = (static_cast<gsl::index>(length) + LANES - 1) / LANES * LANES;
+    auto cutoff = scale * (.5 - width / 2);
+    auto beta = 0.1102 * (ATTENUATION - 8.7);
+
+    interpolated_phases = asynchronous || interpolation > MAX_EXACT_PHASES;
+    nb_phases = interpolated_phases ? INTERPOLATED_PHASES : static_cast<gsl::index>(interpolation);
+    std::vector<double> taps(nb_taps);
+    coefficients.assign((nb_phases + 1) * nb_taps, 0);
+    for(gsl::index phase = 0; phase <= nb_phases; ++phase)
+    {
+      double fraction = static_cast<double>(phase) / nb_phases;
+      for(gsl::index i = 0; i < nb_taps; ++i)
+      {
+        taps[i] = windowed_sinc(nb_taps / 2 - 1 - i + fraction, cutoff, nb_taps / 2., beta);
+      }
+      // Each phase has a unit gain for the continuous component
+      auto gain = std::accumulate(taps.begin(), taps.end(), 0.);
+      for(gsl::index i = 0; i < nb_taps; ++i)
+      {
+        coefficients[phase * nb_taps + i] = static_cast<DataType>(taps[i] / gain);
+      }
+    }
+    if(interpolated_phases)
+    {
+      differences.assign(nb_phases * nb_taps, 0);
+      for(gsl::index i = 0; i < nb_phases * nb_taps; ++i)
+      {
+        differences[i] = coefficients[i + nb_taps] - coefficients[i];
+      }
+    }
+  }
+
+  template<class DataType>
+  double ResamplingFilter<DataType>::get_next_drift(gsl::index size) const
+  {
+    auto smoothing = std::exp(-size / (TRACKING_TIME * output_sampling_rate));
+    return drift + (current_drift - drift) * smoothing;
+  }
+
+  template<class DataType>
+  double ResamplingFilter<DataType>::get_position(gsl::index index, gsl::index size, double next_ratio) const
+  {
+    // The increment moves linearly from the current ratio to the next one during the block
+    auto ratio = nominal_ratio * (1 + current_drift);
+    return position + index * ratio + (next_ratio - ratio) * index * (index - 1) / (2. * size);
+  }
+
+  template<class DataType>
+  gsl::index ResamplingFilter<DataType>::get_input_size(gsl::index size) const
+  {
+    if(nb_taps == 0)
+    {
+      return Parent::get_input_size(size);
+    }
+    if(asynchronous)
+    {
+      return static_cast<gsl::index>(get_position(size, size, nominal_ratio * (1 + get_next_drift(size))));
+    }
+    return static_cast<gsl::index>((phase + size * decimation) / interpolation);
+  }
+
+  template<class DataType>
+  gsl::index ResamplingFilter<DataType>::get_max_input_size(gsl::index size) const
+  {
+    if(nb_taps == 0)
+    {
+      return Parent::get_max_input_size(size);
+    }
+    if(asynchronous)
+    {
+      return static_cast<gsl::index>(std::ceil(size * nominal_ratio * (1 + MAX_DRIFT))) + 1;
+    }
+    return static_cast<gsl::index>((size * decimation + interpolation - 1) / interpolation);
+  }
+
+  template<class DataType>
+  void ResamplingFilter<DataType>::process_impl(gsl::index size) const
+  {
+    assert(nb_input_ports == nb_output_ports);
+    assert(nb_taps > 0);
+
+    const DataType* ATK_RESTRICT table = coefficients.data();
+    const DataType* ATK_RESTRICT table_differences = differences.data();
+    if(asynchronous)
+    {
+      auto next_drift = get_next_drift(size);
+      auto next_ratio = nominal_ratio * (1 + next_drift);
+      for(gsl::index channel = 0; channel < nb_input_ports; ++channel)
+      {
+        const DataType* ATK_RESTRICT input = converted_inputs[channel];
+        DataType* ATK_RESTRICT output = outputs[channel];
+        for(gsl::index i = 0; i < size; ++i)
+        {
+          auto current_position = get_position(i, size, next_ratio);
+          auto index = static_cast<gsl::index>(current_position);
+          auto scaled = (current_position - index) * nb_phases;
+          auto row = std::min(static_cast<gsl::index>(scaled), nb_phases - 1);
+          // Two separate sums are faster than a single loop with two accumulators
+          auto start = input + index - nb_taps;
+          output[i] = convolve(start, table + row * nb_taps, nb_taps) + static_cast<DataType>(scaled - row) * convolve(start, table_differences + row * nb_taps, nb_taps);
+        }
+      }
+      auto end = get_position(size, size, next_ratio);
+      position = end - std::floor(end);
+      current_drift = next_drift;
+      samples_since_fill_level += size;
+      return;
+    }
+
+    for(gsl::index channel = 0; channel < nb_input_ports; ++channel)
+    {
+      const DataType* ATK_RESTRICT input = converted_inputs[channel];
+      DataType* ATK_RESTRICT output = outputs[channel];
+      auto accumulator = phase;
+      for(gsl::index i = 0; i < size; ++i, accumulator += decimation)
+      {
+        // The last input sample read is the one before the output position
+        auto index = static_cast<gsl::index>(accumulator / interpolation);
+        auto fraction = accumulator % interpolation;
+        if(interpolated_phases)
+        {
+          auto scaled = fraction * nb_phases;
+          auto row = static_cast<gsl::index>(scaled / interpolation);
+          auto alpha = static_cast<DataType>(scaled % interpolation) / interpolation;
+          auto start = input + index - nb_taps;
+          output[i] = convolve(start, table + row * nb_taps, nb_taps) + alpha * convolve(start, table_differences + row * nb_taps, nb_taps);
+        }
+        else
+        {
+          output[i] = convolve(input + index - nb_taps, table + fraction * nb_taps, nb_taps);
+        }
+      }
+    }
+    phase = (phase + size * decimation) % interpolation;
+  }
+
+  template class ResamplingFilter<double>;
+#if ATK_ENABLE_INSTANTIATION
+  template class ResamplingFilter<float>;
+#endif
+}
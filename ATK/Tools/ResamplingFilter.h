@@ -0,0 +1,133 @@
+/**
+ * \file ResamplingFilter.h
+ */
+
+#ifndef ATK_TOOLS_RESAMPLINGFILTER_H
+#define ATK_TOOLS_RESAMPLINGFILTER_H
+
+#include <ATK/Core/TypedBaseFilter.h>
+#include <ATK/Tools/config.h>
+
+#include <boost/align/aligned_allocator.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace ATK
+{
+  /// Changes the sampling rate by any ratio with a polyphase Kaiser windowed sinc
+  /*!
+   * The ratio is reduced to a fraction, 147/160 from 44.1 kHz to 48 kHz. If its denominator is small enough, each
+   * phase of the filter is precomputed, otherwise the coefficients are interpolated between a fixed number of phases.
+   * The blocks don't need to be multiples of the denominator, the filter asks its inputs for the number of samples
+   * each block actually consumes.
+   *
+   * In asynchronous mode, the input clock may drift from its nominal rate, for instance when the input comes from a
+   * device with its own clock. The ratio follows the drift with a time constant of 100ms, and the number of input
+   * samples consumed by each block follows the ratio. The drift is either given by set_drift(), or estimated from the
+   * fill level of the input buffer reported before each block with set_fill_level(). A PI loop then brings the fill
+   * level back to its target, and locks on the drift in about 10s.
+   *
+   * The latency is set in samples at the output rate.
+   */
+  template<class DataType_>
+  class ATK_TOOLS_EXPORT ResamplingFilter final : public TypedBaseFilter<DataType_>
+  {
+  protected:
+    /// Simplify parent calls
+    using Parent = TypedBaseFilter<DataType_>;
+    using typename Parent::DataType;
+    using Parent::converted_inputs;
+    using Parent::outputs;
+    using Parent::input_sampling_rate;
+    using Parent::output_sampling_rate;
+    using Parent::nb_input_ports;
+    using Parent::nb_output_ports;
+
+  public:
+    /*!
+    * @brief Constructor
+    * @param nb_channels is the number of input and output channels
+    */
+    explicit ResamplingFilter(gsl::index nb_channels = 1);
+    /// Destructor
+    ~ResamplingFilter() override;
+
+    /// Switches between the exact rational ratio and the asynchronous mode, resets the history
+    void set_asynchronous(bool asynchronous);
+    /// Is the ratio tracking a drift?
+    bool get_asynchronous() const;
+    /*!
+     * @brief Sets the relative deviation of the input clock from its nominal rate, in asynchronous mode
+     * @param drift is the actual input rate divided by the nominal one, minus 1, between -0.01 and 0.01
+     */
+    void set_drift(double drift);
+    /// Returns the drift the filter is tracking, given or estimated
+    double get_drift() const;
+    /*!
+     * @brief Sets the number of samples the input buffer should hold, in asynchronous mode
+     * @param fill_level is the target of the drift estimation, in input samples
+     */
+    void set_target_fill_level(double fill_level);
+    /// Returns the target of the drift estimation
+    double get_target_fill_level() const;
+    /*!
+     * @brief Reports the number of samples waiting in the input buffer before a block is processed, in asynchronous mode
+     * The drift is estimated from the difference between the fill level and its target, and replaces the one given by
+     * set_drift().
+     * @param fill_level is the number of input samples available and not consumed yet
+     */
+    void set_fill_level(double fill_level);
+    /// Returns the current number of input samples per output sample
+    double get_ratio() const;
+
+  protected:
+    void process_impl(gsl::index size) const final;
+    void setup() final;
+    gsl::index get_input_size(gsl::index size) const final;
+    gsl::index get_max_input_size(gsl::index size) const final;
+
+  private:
+    using AlignedVector = std::vector<DataType, boost::alignment::aligned_allocator<DataType, 32>>;
+
+    /// Computes the table of coefficients for the current sampling rates
+    void design();
+    /// Returns the drift at the end of a block
+    double get_next_drift(gsl::index size) const;
+    /// Returns the position of an output sample in the input block, in asynchronous mode
+    double get_position(gsl::index index, gsl::index size, double next_ratio) const;
+
+    bool asynchronous{false};
+    double drift{0};
+    double target_fill_level{0};
+    /// Integral over time of the fill level error, in seconds, for the drift estimation
+    double fill_level_integral{0};
+
+    /// Reduced ratio, decimation input samples for interpolation output samples
+    std::uint64_t interpolation{0};
+    std::uint64_t decimation{0};
+    /// Nominal number of input samples per output sample
+    double nominal_ratio{0};
+    /// Number of taps of each phase, a multiple of the vector size
+    gsl::index nb_taps{0};
+    /// Number of phases in the table, each phase is a fraction of an input sample
+    gsl::index nb_phases{0};
+    /// Are the coefficients interpolated between phases?
+    bool interpolated_phases{false};
+    /// The reversed taps of each phase, with one more phase for the interpolation
+    AlignedVector coefficients;
+    /// Difference between the taps of a phase and of the next one
+    AlignedVector differences;
+
+    /// Current position between two input samples, in 1 / interpolation
+    mutable std::uint64_t phase{0};
+    /// Current position between two input samples, in asynchronous mode
+    mutable double position{0};
+    /// Drift at the beginning of the next block
+    mutable double current_drift{0};
+    /// Number of output samples since the last reported fill level
+    mutable gsl::index samples_since_fill_level{0};
+  };
+}
+
+#endif
@@ -41,6 +41,7 @@ namespace ATK
     
   protected:
     void process_impl(gsl::index size) const final;
+    gsl::index get_in_place_input(gsl::index output_port) const final;
     
   private:
     DataType_ volume{1};
@@ -31,16 +31,34 @@ namespace ATK
     return volume;
   }
 
+  template<typename DataType_>
+  gsl::index VolumeFilter<DataType_>::get_in_place_input(gsl::index output_port) const
+  {
+    return output_port;
+  }
+
   template<typename DataType_>
   void VolumeFilter<DataType_>::process_impl(gsl::index size) const
   {
     for(gsl::index channel = 0; channel < nb_input_ports; ++channel)
     {
-      const DataType* ATK_RESTRICT input = converted_inputs[channel];
-      DataType* ATK_RESTRICT output = outputs[channel];
-      for(gsl::index i = 0; i < size; ++i)
+      if(converted_inputs[channel] == outputs[channel])
+      {
+        // Computed in place
+        DataType* output = outputs[channel];
+        for(gsl::index i = 0; i < size; ++i)
+        {
+          output[i] = volume * output[i];
+        }
+      }
+      else
       {
-        output[i] = volume * input[i];
+        const DataType* ATK_RESTRICT input = converted_inputs[channel];
+        DataType* ATK_RESTRICT output = outputs[channel];
+        for(gsl::index i = 0; i < size; ++i)
+        {
+          output[i] = volume * input[i];
+        }
       }
     }
   }
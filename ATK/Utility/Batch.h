@@ -0,0 +1,158 @@
+/**
+ * \file Batch.h
+ */
+
+#ifndef ATK_UTILITY_BATCH_H
+#define ATK_UTILITY_BATCH_H
+
+#include <ATK/config.h>
+
+#include <gsl/gsl>
+
+#include <algorithm>
+#include <cstddef>
+
+namespace ATK
+{
+  /// Size in bytes of the widest vector registers available on the compilation target
+#if defined(__AVX512F__)
+  constexpr gsl::index SIMD_REGISTER_SIZE = 64;
+#elif defined(__AVX__)
+  constexpr gsl::index SIMD_REGISTER_SIZE = 32;
+#else
+  // SSE2 and NEON
+  constexpr gsl::index SIMD_REGISTER_SIZE = 16;
+#endif
+
+  /// Returns the number of elements of a type that fit in a vector register
+  template<typename DataType>
+  constexpr gsl::index native_batch_size()
+  {
+    return std::max<gsl::index>(1, SIMD_REGISTER_SIZE / static_cast<gsl::index>(sizeof(DataType)));
+  }
+
+  /// A fixed number of values, one per SIMD lane, that are processed with the same instructions
+  /*!
+   * All operations are fixed size loops over the lanes without dependencies between them, so that the compiler can map
+   * them on SSE/AVX/AVX-512/NEON instructions depending on the target architecture flags.
+   * The number of lanes should be a power of two.
+   */
+  template<typename DataType_, gsl::index size_ = native_batch_size<DataType_>()>
+  struct alignas(std::min<std::size_t>(sizeof(DataType_) * size_, SIMD_REGISTER_SIZE)) Batch
+  {
+    using DataType = DataType_;
+    /// Number of lanes
+    static constexpr gsl::index size = size_;
+
+    DataType values[size];
+
+    Batch() = default;
+
+    /// Sets all the lanes to the same value
+    explicit Batch(DataType value)
+    {
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        values[i] = value;
+      }
+    }
+
+    /// Loads consecutive values
+    static Batch load(const DataType* ATK_RESTRICT ptr)
+    {
+      Batch result;
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        result.values[i] = ptr[i];
+      }
+      return result;
+    }
+
+    /// Stores the lanes in consecutive values
+    void store(DataType* ATK_RESTRICT ptr) const
+    {
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        ptr[i] = values[i];
+      }
+    }
+
+    DataType& operator[](gsl::index lane)
+    {
+      return values[lane];
+    }
+
+    const DataType& operator[](gsl::index lane) const
+    {
+      return values[lane];
+    }
+
+    Batch& operator+=(const Batch& other)
+    {
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        values[i] += other.values[i];
+      }
+      return *this;
+    }
+
+    Batch& operator-=(const Batch& other)
+    {
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        values[i] -= other.values[i];
+      }
+      return *this;
+    }
+
+    Batch& operator*=(const Batch& other)
+    {
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        values[i] *= other.values[i];
+      }
+      return *this;
+    }
+
+    /// Multiplies all lanes by a scalar
+    template<typename Scalar>
+    Batch& operator*=(Scalar scalar)
+    {
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        values[i] *= scalar;
+      }
+      return *this;
+    }
+
+    /// Adds scalar * other to all lanes
+    template<typename Scalar>
+    void multiply_add(Scalar scalar, const Batch& other)
+    {
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        values[i] += scalar * other.values[i];
+      }
+    }
+  };
+
+  template<typename DataType, gsl::index size>
+  Batch<DataType, size> operator+(Batch<DataType, size> lhs, const Batch<DataType, size>& rhs)
+  {
+    return lhs += rhs;
+  }
+
+  template<typename DataType, gsl::index size>
+  Batch<DataType, size> operator-(Batch<DataType, size> lhs, const Batch<DataType, size>& rhs)
+  {
+    return lhs -= rhs;
+  }
+
+  template<typename DataType, gsl::index size>
+  Batch<DataType, size> operator*(Batch<DataType, size> lhs, const Batch<DataType, size>& rhs)
+  {
+    return lhs *= rhs;
+  }
+}
+
+#endif
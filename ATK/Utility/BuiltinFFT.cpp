@@ -0,0 +1,376 @@
+/**
+ * \file BuiltinFFT.cpp
+ */
+
+#include "BuiltinFFT.h"
+#include "FFTPlanCache.h"
+
+#include <ATK/config.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ATK
+{
+  /// Built-in FFT plan, Stockham autosort for powers of 2 and Bluestein algorithm for the other sizes
+  /*!
+   * Complex signals are processed in place as separate real and imaginary arrays, so that the butterflies are
+   * vectorized. Even real signals are transformed as complex signals of half their size.
+   */
+  class BuiltinFFT::Plan
+  {
+  public:
+    Plan(gsl::index size, FFTDirection direction, FFTType type)
+    :size(size), direction(direction), type(type)
+    {
+      double sign = direction == FFTDirection::Forward ? -1 : 1;
+      const double pi = std::acos(-1.);
+      if(type == FFTType::Real)
+      {
+        if(size % 2 == 0)
+        {
+          sub_plan = FFTPlanCache<Plan>::get(size / 2, direction, FFTType::Complex);
+          for(gsl::index k = 0; k <= size / 2; ++k)
+          {
+            twiddles_real.push_back(std::cos(sign * 2 * pi * k / size));
+            twiddles_imag.push_back(std::sin(sign * 2 * pi * k / size));
+          }
+        }
+        else
+        {
+          sub_plan = FFTPlanCache<Plan>::get(size, direction, FFTType::Complex);
+        }
+      }
+      else if((size & (size - 1)) == 0)
+      {
+        // The twiddles of each pass, one after the other
+        for(gsl::index n = size; n > 1; n /= 2)
+        {
+          for(gsl::index p = 0; p < n / 2; ++p)
+          {
+            twiddles_real.push_back(std::cos(sign * 2 * pi * p / n));
+            twiddles_imag.push_back(std::sin(sign * 2 * pi * p / n));
+          }
+        }
+      }
+      else
+      {
+        // The transform is computed as a circular convolution with a chirp, with powers of 2 FFTs
+        convolution_size = 1;
+        while(convolution_size < 2 * size - 1)
+        {
+          convolution_size *= 2;
+        }
+        sub_plan = FFTPlanCache<Plan>::get(convolution_size, FFTDirection::Forward, FFTType::Complex);
+        inverse_sub_plan = FFTPlanCache<Plan>::get(convolution_size, FFTDirection::Backward, FFTType::Complex);
+
+        for(gsl::index k = 0; k < size; ++k)
+        {
+          // k^2 is reduced modulo 2 * size to keep the angle accurate
+          auto angle = sign * pi * static_cast<double>((k * k) % (2 * size)) / size;
+          twiddles_real.push_back(std::cos(angle));
+          twiddles_imag.push_back(std::sin(angle));
+        }
+        chirp_spectrum_real.assign(convolution_size, 0);
+        chirp_spectrum_imag.assign(convolution_size, 0);
+        for(gsl::index k = 0; k < size; ++k)
+        {
+          chirp_spectrum_real[k] = twiddles_real[k] / convolution_size;
+          chirp_spectrum_imag[k] = -twiddles_imag[k] / convolution_size;
+          if(k > 0)
+          {
+            chirp_spectrum_real[convolution_size - k] = chirp_spectrum_real[k];
+            chirp_spectrum_imag[convolution_size - k] = chirp_spectrum_imag[k];
+          }
+        }
+        std::vector<double> work(sub_plan->get_work_size());
+        sub_plan->execute(chirp_spectrum_real.data(), chirp_spectrum_imag.data(), work.data());
+      }
+    }
+
+    /// Number of values needed as working memory
+    gsl::index get_work_size() const
+    {
+      if(type == FFTType::Real)
+      {
+        return 2 * sub_plan->size + sub_plan->get_work_size();
+      }
+      if(convolution_size > 0)
+      {
+        return 2 * convolution_size + sub_plan->get_work_size();
+      }
+      return 2 * size;
+    }
+
+    /// Transforms in place a complex signal, not normalized
+    void execute(double* real, double* imag, double* work) const
+    {
+      if(convolution_size > 0)
+      {
+        bluestein(real, imag, work);
+      }
+      else
+      {
+        stockham(real, imag, work, work + size);
+      }
+    }
+
+    /// Transforms a real signal into the first size / 2 + 1 bins of its spectrum
+    void execute_forward_real(const double* ATK_RESTRICT input, std::complex<double>* ATK_RESTRICT output, double* work) const
+    {
+      auto half = sub_plan->size;
+      double* ATK_RESTRICT real = work;
+      double* ATK_RESTRICT imag = work + half;
+      if(size % 2 != 0)
+      {
+        std::copy(input, input + size, real);
+        std::fill(imag, imag + size, 0);
+        sub_plan->execute(real, imag, work + 2 * half);
+        for(gsl::index k = 0; k <= size / 2; ++k)
+        {
+          output[k] = std::complex<double>(real[k], imag[k]);
+        }
+        return;
+      }
+
+      for(gsl::index j = 0; j < half; ++j)
+      {
+        real[j] = input[2 * j];
+        imag[j] = input[2 * j + 1];
+      }
+      sub_plan->execute(real, imag, work + 2 * half);
+      // Split the spectra of the even and odd samples, then recombine them
+      for(gsl::index k = 0; k <= half; ++k)
+      {
+        std::complex<double> z(real[k % half], imag[k % half]);
+        std::complex<double> z_mirror(real[(half - k) % half], -imag[(half - k) % half]);
+        auto even = (z + z_mirror) * 0.5;
+        auto odd = (z - z_mirror) * std::complex<double>(0, -0.5);
+        output[k] = even + std::complex<double>(twiddles_real[k], twiddles_imag[k]) * odd;
+      }
+    }
+
+    /// Transforms the first size / 2 + 1 bins of the spectrum of a real signal back, not normalized
+    void execute_backward_real(const std::complex<double>* ATK_RESTRICT input, double* ATK_RESTRICT output, double* work) const
+    {
+      auto half = sub_plan->size;
+      double* ATK_RESTRICT real = work;
+      double* ATK_RESTRICT imag = work + half;
+      if(size % 2 != 0)
+      {
+        for(gsl::index k = 0; k <= size / 2; ++k)
+        {
+          real[k] = input[k].real();
+          imag[k] = input[k].imag();
+        }
+        for(gsl::index k = size / 2 + 1; k < size; ++k)
+        {
+          real[k] = input[size - k].real();
+          imag[k] = -input[size - k].imag();
+        }
+        sub_plan->execute(real, imag, work + 2 * half);
+        std::copy(real, real + size, output);
+        return;
+      }
+
+      for(gsl::index k = 0; k < half; ++k)
+      {
+        auto mirror = std::conj(input[half - k]);
+        auto even = input[k] + mirror;
+        auto odd = (input[k] - mirror) * std::complex<double>(twiddles_real[k], twiddles_imag[k]);
+        auto z = even + std::complex<double>(0, 1) * odd;
+        real[k] = z.real();
+        imag[k] = z.imag();
+      }
+      sub_plan->execute(real, imag, work + 2 * half);
+      for(gsl::index j = 0; j < half; ++j)
+      {
+        output[2 * j] = real[j];
+        output[2 * j + 1] = imag[j];
+      }
+    }
+
+  private:
+    /// Radix 2 passes, alternating between the signal and the work arrays
+    void stockham(double* real, double* imag, double* work_real, double* work_imag) const
+    {
+      double* x_real = real;
+      double* x_imag = imag;
+      double* y_real = work_real;
+      double* y_imag = work_imag;
+      const double* twiddles_real_ptr = twiddles_real.data();
+      const double* twiddles_imag_ptr = twiddles_imag.data();
+      gsl::index stride = 1;
+      for(gsl::index n = size; n > 1; n /= 2)
+      {
+        auto half = n / 2;
+        // The innermost loop is the longest one, so that it is vectorized
+        if(stride >= half)
+        {
+          for(gsl::index p = 0; p < half; ++p)
+          {
+            auto w_real = twiddles_real_ptr[p];
+            auto w_imag = twiddles_imag_ptr[p];
+            const double* ATK_RESTRICT a_real = x_real + stride * p;
+            const double* ATK_RESTRICT a_imag = x_imag + stride * p;
+            const double* ATK_RESTRICT b_real = x_real + stride * (p + half);
+            const double* ATK_RESTRICT b_imag = x_imag + stride * (p + half);
+            double* ATK_RESTRICT sum_real = y_real + stride * 2 * p;
+            double* ATK_RESTRICT sum_imag = y_imag + stride * 2 * p;
+            double* ATK_RESTRICT diff_real = y_real + stride * (2 * p + 1);
+            double* ATK_RESTRICT diff_imag = y_imag + stride * (2 * p + 1);
+            ATK_VECTORIZE for(gsl::index q = 0; q < stride; ++q)
+            {
+              sum_real[q] = a_real[q] + b_real[q];
+              sum_imag[q] = a_imag[q] + b_imag[q];
+              auto d_real = a_real[q] - b_real[q];
+              auto d_imag = a_imag[q] - b_imag[q];
+              diff_real[q] = d_real * w_real - d_imag * w_imag;
+              diff_imag[q] = d_real * w_imag + d_imag * w_real;
+            }
+          }
+        }
+        else
+        {
+          for(gsl::index q = 0; q < stride; ++q)
+          {
+            const double* ATK_RESTRICT in_real = x_real + q;
+            const double* ATK_RESTRICT in_imag = x_imag + q;
+            double* ATK_RESTRICT out_real = y_real + q;
+            double* ATK_RESTRICT out_imag = y_imag + q;
+            ATK_VECTORIZE for(gsl::index p = 0; p < half; ++p)
+            {
+              auto a_real = in_real[stride * p];
+              auto a_imag = in_imag[stride * p];
+              auto b_real = in_real[stride * (p + half)];
+              auto b_imag = in_imag[stride * (p + half)];
+              out_real[stride * 2 * p] = a_real + b_real;
+              out_imag[stride * 2 * p] = a_imag + b_imag;
+              auto d_real = a_real - b_real;
+              auto d_imag = a_imag - b_imag;
+              out_real[stride * (2 * p + 1)] = d_real * twiddles_real_ptr[p] - d_imag * twiddles_imag_ptr[p];
+              out_imag[stride * (2 * p + 1)] = d_real * twiddles_imag_ptr[p] + d_imag * twiddles_real_ptr[p];
+            }
+          }
+        }
+        twiddles_real_ptr += half;
+        twiddles_imag_ptr += half;
+        stride *= 2;
+        std::swap(x_real, y_real);
+        std::swap(x_imag, y_imag);
+      }
+      // After an odd number of passes, the result is in the work arrays
+      if(x_real != real)
+      {
+        std::copy(x_real, x_real + size, real);
+        std::copy(x_imag, x_imag + size, imag);
+      }
+    }
+
+    void bluestein(double* ATK_RESTRICT real, double* ATK_RESTRICT imag, double* work) const
+    {
+      double* ATK_RESTRICT a_real = work;
+      double* ATK_RESTRICT a_imag = work + convolution_size;
+      double* sub_work = work + 2 * convolution_size;
+      for(gsl::index k = 0; k < size; ++k)
+      {
+        a_real[k] = real[k] * twiddles_real[k] - imag[k] * twiddles_imag[k];
+        a_imag[k] = real[k] * twiddles_imag[k] + imag[k] * twiddles_real[k];
+      }
+      std::fill(a_real + size, a_real + convolution_size, 0);
+      std::fill(a_imag + size, a_imag + convolution_size, 0);
+
+      sub_plan->execute(a_real, a_imag, sub_work);
+      const double* ATK_RESTRICT chirp_real = chirp_spectrum_real.data();
+      const double* ATK_RESTRICT chirp_imag = chirp_spectrum_imag.data();
+      ATK_VECTORIZE for(gsl::index k = 0; k < convolution_size; ++k)
+      {
+        auto product_real = a_real[k] * chirp_real[k] - a_imag[k] * chirp_imag[k];
+        auto product_imag = a_real[k] * chirp_imag[k] + a_imag[k] * chirp_real[k];
+        a_real[k] = product_real;
+        a_imag[k] = product_imag;
+      }
+      inverse_sub_plan->execute(a_real, a_imag, sub_work);
+
+      for(gsl::index k = 0; k < size; ++k)
+      {
+        real[k] = a_real[k] * twiddles_real[k] - a_imag[k] * twiddles_imag[k];
+        imag[k] = a_real[k] * twiddles_imag[k] + a_imag[k] * twiddles_real[k];
+      }
+    }
+
+    gsl::index size;
+    FFTDirection direction;
+    FFTType type;
+    /// Twiddles of the passes, of the real recombination or the chirp
+    std::vector<double> twiddles_real;
+    std::vector<double> twiddles_imag;
+    /// Size of the convolution for Bluestein algorithm, 0 for powers of 2
+    gsl::index convolution_size{0};
+    /// Spectrum of the conjugated chirp, normalized
+    std::vector<double> chirp_spectrum_real;
+    std::vector<double> chirp_spectrum_imag;
+    /// Complex transform used by a real transform or by Bluestein algorithm
+    std::shared_ptr<const Plan> sub_plan;
+    std::shared_ptr<const Plan> inverse_sub_plan;
+  };
+
+  BuiltinFFT::BuiltinFFT()
+  {
+  }
+
+  BuiltinFFT::~BuiltinFFT()
+  {
+  }
+
+  void BuiltinFFT::set_size(gsl::index size)
+  {
+    this->size = size;
+    forward_plan = FFTPlanCache<Plan>::get(size, FFTDirection::Forward, FFTType::Complex);
+    backward_plan = FFTPlanCache<Plan>::get(size, FFTDirection::Backward, FFTType::Complex);
+    real_forward_plan = FFTPlanCache<Plan>::get(size, FFTDirection::Forward, FFTType::Real);
+    real_backward_plan = FFTPlanCache<Plan>::get(size, FFTDirection::Backward, FFTType::Real);
+    work.assign(2 * size + std::max({forward_plan->get_work_size(), backward_plan->get_work_size(), real_forward_plan->get_work_size(), real_backward_plan->get_work_size()}), 0);
+  }
+
+  gsl::index BuiltinFFT::get_size() const
+  {
+    return size;
+  }
+
+  void BuiltinFFT::forward(const std::complex<double>* input, std::complex<double>* output)
+  {
+    execute(*forward_plan, input, output);
+  }
+
+  void BuiltinFFT::backward(const std::complex<double>* input, std::complex<double>* output)
+  {
+    execute(*backward_plan, input, output);
+  }
+
+  void BuiltinFFT::forward_real(const double* input, std::complex<double>* output)
+  {
+    real_forward_plan->execute_forward_real(input, output, work.data());
+  }
+
+  void BuiltinFFT::backward_real(const std::complex<double>* input, double* output)
+  {
+    real_backward_plan->execute_backward_real(input, output, work.data());
+  }
+
+  void BuiltinFFT::execute(const Plan& plan, const std::complex<double>* input, std::complex<double>* output)
+  {
+    double* ATK_RESTRICT real = work.data();
+    double* ATK_RESTRICT imag = work.data() + size;
+    for(gsl::index j = 0; j < size; ++j)
+    {
+      real[j] = input[j].real();
+      imag[j] = input[j].imag();
+    }
+    plan.execute(real, imag, work.data() + 2 * size);
+    for(gsl::index j = 0; j < size; ++j)
+    {
+      output[j] = std::complex<double>(real[j], imag[j]);
+    }
+  }
+}
@@ -0,0 +1,63 @@
+/**
+ * \file BuiltinFFT.h
+ */
+
+#ifndef ATK_UTILITY_BUILTINFFT_H
+#define ATK_UTILITY_BUILTINFFT_H
+
+#include <ATK/Utility/config.h>
+
+#include <gsl/gsl>
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+namespace ATK
+{
+  /// Built-in FFT, Stockham autosort for powers of 2 and Bluestein algorithm for the other sizes
+  /*!
+   * This is the backend of FFT when neither IPP nor FFTW is available. It is always built, so that it can be tested
+   * whatever the configuration. Transforms are not normalized, plans are shared by all the objects with the same size.
+   */
+  class ATK_UTILITY_EXPORT BuiltinFFT
+  {
+  public:
+    /// Builds an empty transform, set_size must be called before processing
+    BuiltinFFT();
+    /// Destructor
+    ~BuiltinFFT();
+
+    BuiltinFFT(const BuiltinFFT&) = delete;
+    BuiltinFFT& operator=(const BuiltinFFT&) = delete;
+
+    /// Sets the size of the transforms and gets the associated plans
+    void set_size(gsl::index size);
+    /// Returns the size of the transforms
+    gsl::index get_size() const;
+
+    /// Transforms a complex signal of size elements, input and output may be the same array
+    void forward(const std::complex<double>* input, std::complex<double>* output);
+    /// Transforms back a spectrum of size elements, input and output may be the same array
+    void backward(const std::complex<double>* input, std::complex<double>* output);
+    /// Transforms a real signal of size elements into the first size / 2 + 1 bins of its spectrum
+    void forward_real(const double* input, std::complex<double>* output);
+    /// Transforms the first size / 2 + 1 bins of the spectrum of a real signal back into size elements
+    void backward_real(const std::complex<double>* input, double* output);
+
+  private:
+    class Plan;
+
+    /// Executes a complex plan through the split real and imaginary parts of the working buffer
+    void execute(const Plan& plan, const std::complex<double>* input, std::complex<double>* output);
+
+    gsl::index size{0};
+    std::shared_ptr<const Plan> forward_plan;
+    std::shared_ptr<const Plan> backward_plan;
+    std::shared_ptr<const Plan> real_forward_plan;
+    std::shared_ptr<const Plan> real_backward_plan;
+    std::vector<double> work;
+  };
+}
+
+#endif
@@ -3,6 +3,8 @@
  */
 
 #include "FFT.h"
+#include "BuiltinFFT.h"
+#include "FFTPlanCache.h"
 
 #include <ATK/config.h>
 #if ATK_USE_FFTW == 1
@@ -15,19 +17,72 @@
 #include <gsl/gsl>
 
 #include <algorithm>
+#include <cmath>
 #include <complex>
 #include <cstdlib>
+#include <mutex>
 
 namespace ATK
 {
+#if ATK_USE_FFTW == 1
+  namespace
+  {
+    /// The FFTW planner is not thread safe
+    std::mutex& get_planner_mutex()
+    {
+      static std::mutex mutex;
+      return mutex;
+    }
+
+    /// A FFTW plan, executed on the arrays of each FFT object
+    class FFTWPlan
+    {
+    public:
+      FFTWPlan(gsl::index size, FFTDirection direction, FFTType type)
+      {
+        std::lock_guard<std::mutex> lock(get_planner_mutex());
+        // Arrays allocated by FFTW all have the same alignment, so the plan can be executed on other arrays
+        auto* complex_data = fftw_alloc_complex(size);
+        auto* complex_freqs = fftw_alloc_complex(size);
+        auto* real_data = fftw_alloc_real(size);
+        if(type == FFTType::Complex)
+        {
+          plan = direction == FFTDirection::Forward ? fftw_plan_dft_1d(static_cast<int>(size), complex_data, complex_freqs, FFTW_FORWARD, FFTW_ESTIMATE) : fftw_plan_dft_1d(static_cast<int>(size), complex_freqs, complex_data, FFTW_BACKWARD, FFTW_ESTIMATE);
+        }
+        else
+        {
+          plan = direction == FFTDirection::Forward ? fftw_plan_dft_r2c_1d(static_cast<int>(size), real_data, complex_freqs, FFTW_ESTIMATE) : fftw_plan_dft_c2r_1d(static_cast<int>(size), complex_data, real_data, FFTW_ESTIMATE);
+        }
+        fftw_free(complex_data);
+        fftw_free(complex_freqs);
+        fftw_free(real_data);
+      }
+
+      ~FFTWPlan()
+      {
+        std::lock_guard<std::mutex> lock(get_planner_mutex());
+        fftw_destroy_plan(plan);
+      }
+
+      FFTWPlan(const FFTWPlan&) = delete;
+      FFTWPlan& operator=(const FFTWPlan&) = delete;
+
+      fftw_plan plan;
+    };
+  }
+#endif
+
   template<class DataType_>
   class FFT<DataType_>::FFTImpl
   {
 #if ATK_USE_FFTW == 1
-    fftw_plan fft_plan;
-    fftw_plan fft_reverse_plan;
     fftw_complex* input_data;
     fftw_complex* output_freqs;
+    double* real_data;
+    std::shared_ptr<const FFTWPlan> forward_plan;
+    std::shared_ptr<const FFTWPlan> backward_plan;
+    std::shared_ptr<const FFTWPlan> real_forward_plan;
+    std::shared_ptr<const FFTWPlan> real_backward_plan;
 #endif
 #if ATK_USE_IPP == 1
     Ipp64fc *pSrc;
@@ -38,25 +93,33 @@ namespace ATK
     Ipp8u* pFFTInitBuf;
     Ipp8u* pFFTWorkBuf;
     bool power_of_two;
+    std::vector<double> real_data;
 #endif
+#if ATK_USE_FFTW == 0 && ATK_USE_IPP == 0
+    std::vector<std::complex<double> > input_data;
+    std::vector<std::complex<double> > output_freqs;
+    std::vector<double> real_data;
+    BuiltinFFT builtin;
+#endif
+    gsl::index size{0};
+
   public:
     FFTImpl()
 #if ATK_USE_FFTW == 1
-    :fft_plan(nullptr), fft_reverse_plan(nullptr), input_data(nullptr), output_freqs(nullptr)
+    :input_data(nullptr), output_freqs(nullptr), real_data(nullptr)
 #endif
 #if ATK_USE_IPP == 1
     :pSrc(nullptr), pDst(nullptr), pFFTSpec(nullptr), pDFTSpec(nullptr), pFFTSpecBuf(nullptr), pFFTInitBuf(nullptr), pFFTWorkBuf(nullptr), power_of_two(false)
 #endif
     {
     }
-    
+
     ~FFTImpl()
     {
 #if ATK_USE_FFTW == 1
       fftw_free(input_data);
       fftw_free(output_freqs);
-      fftw_destroy_plan(fft_plan);
-      fftw_destroy_plan(fft_reverse_plan);
+      fftw_free(real_data);
 #endif
 #if ATK_USE_IPP == 1
       if (pSrc)
@@ -84,17 +147,20 @@ namespace ATK
 
     void set_size(gsl::index size)
     {
+      this->size = size;
 #if ATK_USE_FFTW == 1
       fftw_free(input_data);
       fftw_free(output_freqs);
-      fftw_destroy_plan(fft_plan);
-      fftw_destroy_plan(fft_reverse_plan);
-      
+      fftw_free(real_data);
+
       input_data = fftw_alloc_complex(size);
       output_freqs = fftw_alloc_complex(size);
-      
-      fft_plan = fftw_plan_dft_1d(size, input_data, output_freqs, FFTW_FORWARD, FFTW_ESTIMATE);
-      fft_reverse_plan = fftw_plan_dft_1d(size, output_freqs, input_data, FFTW_BACKWARD, FFTW_ESTIMATE);
+      real_data = fftw_alloc_real(size);
+
+      forward_plan = FFTPlanCache<FFTWPlan>::get(size, FFTDirection::Forward, FFTType::Complex);
+      backward_plan = FFTPlanCache<FFTWPlan>::get(size, FFTDirection::Backward, FFTType::Complex);
+      real_forward_plan = FFTPlanCache<FFTWPlan>::get(size, FFTDirection::Forward, FFTType::Real);
+      real_backward_plan = FFTPlanCache<FFTWPlan>::get(size, FFTDirection::Backward, FFTType::Real);
 #endif
 #if ATK_USE_IPP == 1
       power_of_two = ((size & (size - 1)) == 0);
@@ -131,13 +197,13 @@ namespace ATK
       int sizeFFTSpec, sizeFFTInitBuf, sizeFFTWorkBuf;
       if (power_of_two)
       {
-        ippsFFTGetSize_C_64fc(static_cast<int>(std::lround(std::log(size) / std::log(2))), IPP_FFT_DIV_FWD_BY_N, ippAlgHintAccurate, &sizeFFTSpec, &sizeFFTInitBuf, &sizeFFTWorkBuf);
+        ippsFFTGetSize_C_64fc(static_cast<int>(std::lround(std::log(size) / std::log(2))), IPP_FFT_NODIV_BY_ANY, ippAlgHintAccurate, &sizeFFTSpec, &sizeFFTInitBuf, &sizeFFTWorkBuf);
       }
       else
       {
-        ippsDFTGetSize_C_64fc(static_cast<int>(size), IPP_FFT_DIV_FWD_BY_N, ippAlgHintAccurate, &sizeFFTSpec, &sizeFFTInitBuf, &sizeFFTWorkBuf);
+        ippsDFTGetSize_C_64fc(static_cast<int>(size), IPP_FFT_NODIV_BY_ANY, ippAlgHintAccurate, &sizeFFTSpec, &sizeFFTInitBuf, &sizeFFTWorkBuf);
       }
-      
+
       pFFTSpecBuf = ippsMalloc_8u(sizeFFTSpec);
       pFFTInitBuf = ippsMalloc_8u(sizeFFTInitBuf);
       pFFTWorkBuf = ippsMalloc_8u(sizeFFTWorkBuf);
@@ -145,132 +211,71 @@ namespace ATK
       pDst = ippsMalloc_64fc(static_cast<int>(size));
       if (power_of_two)
       {
-        ippsFFTInit_C_64fc(&pFFTSpec, static_cast<int>(std::lround(std::log(size) / std::log(2))), IPP_FFT_DIV_FWD_BY_N, ippAlgHintAccurate, pFFTSpecBuf, pFFTInitBuf);
+        ippsFFTInit_C_64fc(&pFFTSpec, static_cast<int>(std::lround(std::log(size) / std::log(2))), IPP_FFT_NODIV_BY_ANY, ippAlgHintAccurate, pFFTSpecBuf, pFFTInitBuf);
       }
       else
       {
         pDFTSpec = (IppsDFTSpec_C_64fc*)ippsMalloc_8u(sizeFFTSpec);
-        ippsDFTInit_C_64fc(static_cast<int>(size), IPP_FFT_DIV_FWD_BY_N, ippAlgHintAccurate, pDFTSpec, pFFTInitBuf);
+        ippsDFTInit_C_64fc(static_cast<int>(size), IPP_FFT_NODIV_BY_ANY, ippAlgHintAccurate, pDFTSpec, pFFTInitBuf);
       }
       if (pFFTInitBuf)
         ippFree(pFFTInitBuf);
       pFFTInitBuf = nullptr;
+      real_data.assign(size, 0);
+#endif
+#if ATK_USE_FFTW == 0 && ATK_USE_IPP == 0
+      input_data.assign(size, 0);
+      output_freqs.assign(size, 0);
+      real_data.assign(size, 0);
+      builtin.set_size(size);
 #endif
     }
 
-    void process(const DataType_* input, gsl::index input_size, gsl::index size) const
+    /// Complex signal, input of the forward transform and output of the backward one
+    std::complex<double>* get_signal()
     {
 #if ATK_USE_FFTW == 1
-      double factor = static_cast<double>(size);
-      for(gsl::index j = 0; j < std::min(input_size, size); ++j)
-      {
-        input_data[j][0] = input[j] / factor;
-        input_data[j][1] = 0;
-      }
-      for(gsl::index j = input_size; j < size; ++j)
-      {
-        input_data[j][0] = 0;
-        input_data[j][1] = 0;
-      }
-      fftw_execute(fft_plan);
+      return reinterpret_cast<std::complex<double>*>(input_data);
 #endif
 #if ATK_USE_IPP == 1
-      for (gsl::index j = 0; j < std::min(input_size, size); ++j)
-      {
-        pSrc[j].re = input[j];
-        pSrc[j].im = 0;
-      }
-      for (gsl::index j = input_size; j < size; ++j)
-      {
-        pSrc[j].re = 0;
-        pSrc[j].im = 0;
-      }
-      if (power_of_two)
-      {
-        ippsFFTFwd_CToC_64fc(pSrc, pDst, pFFTSpec, pFFTWorkBuf);
-      }
-      else
-      {
-        ippsDFTFwd_CToC_64fc(pSrc, pDst, pDFTSpec, pFFTWorkBuf);
-      }
+      return reinterpret_cast<std::complex<double>*>(pSrc);
+#endif
+#if ATK_USE_FFTW == 0 && ATK_USE_IPP == 0
+      return input_data.data();
 #endif
     }
-    
-    void process_forward(std::complex<DataType_>* output, gsl::index size) const
+
+    /// Spectrum, output of the forward transforms and input of the backward ones
+    std::complex<double>* get_spectrum()
     {
-      for(gsl::index j = 0; j < size; ++j)
-      {
 #if ATK_USE_FFTW == 1
-        output[j] = std::complex<DataType_>(output_freqs[j][0], output_freqs[j][1]);
+      return reinterpret_cast<std::complex<double>*>(output_freqs);
 #endif
 #if ATK_USE_IPP == 1
-        output[j] = std::complex<DataType_>(pDst[j].re, pDst[j].im);
+      return reinterpret_cast<std::complex<double>*>(pDst);
+#endif
+#if ATK_USE_FFTW == 0 && ATK_USE_IPP == 0
+      return output_freqs.data();
 #endif
-      }
     }
-    
-    void process_backward(const std::complex<DataType_>* input, DataType_* output, gsl::index input_size, gsl::index size) const
+
+    /// Real signal, input of the real forward transform and output of the real backward one
+    double* get_real_signal()
     {
 #if ATK_USE_FFTW == 1
-      for(gsl::index j = 0; j < size; ++j)
-      {
-        output_freqs[j][0] = input[j].real();
-        output_freqs[j][1] = input[j].imag();
-      }
-      fftw_execute(fft_reverse_plan);
-      for(gsl::index j = 0; j < input_size; ++j)
-      {
-        output[j] = input_data[j][0];
-      }
-#endif
-#if ATK_USE_IPP == 1
-      for (gsl::index j = 0; j < size; ++j)
-      {
-        pDst[j].re = input[j].real();
-        pDst[j].im = input[j].imag();
-      }
-      if (power_of_two)
-      {
-        ippsFFTInv_CToC_64fc(pDst, pDst, pFFTSpec, pFFTWorkBuf);
-      }
-      else
-      {
-        ippsDFTInv_CToC_64fc(pDst, pDst, pDFTSpec, pFFTWorkBuf);
-      }
-      for (gsl::index j = 0; j < input_size; ++j)
-      {
-        output[j] = pDst[j].re;
-      }
+      return real_data;
+#else
+      return real_data.data();
 #endif
     }
 
-    void process(const std::complex<DataType_>* input, gsl::index input_size, gsl::index size) const
+    /// Transforms the complex signal into the spectrum
+    void forward()
     {
 #if ATK_USE_FFTW == 1
-      double factor = static_cast<double>(size);
-      for (gsl::index j = 0; j < std::min(input_size, size); ++j)
-      {
-        input_data[j][0] = std::real(input[j]) / factor;
-        input_data[j][1] = std::imag(input[j]) / factor;
-      }
-      for (gsl::index j = input_size; j < size; ++j)
-      {
-        input_data[j][0] = 0;
-        input_data[j][1] = 0;
-      }
-      fftw_execute(fft_plan);
+      fftw_execute_dft(forward_plan->plan, input_data, output_freqs);
 #endif
 #if ATK_USE_IPP == 1
-      for (gsl::index j = 0; j < std::min(input_size, size); ++j)
-      {
-        pSrc[j].re = std::real(input[j]);
-        pSrc[j].im = std::imag(input[j]);
-      }
-      for (gsl::index j = input_size; j < size; ++j)
-      {
-        pSrc[j].re = 0;
-        pSrc[j].im = 0;
-      }
       if (power_of_two)
       {
         ippsFFTFwd_CToC_64fc(pSrc, pDst, pFFTSpec, pFFTWorkBuf);
@@ -279,73 +284,77 @@ namespace ATK
       {
         ippsDFTFwd_CToC_64fc(pSrc, pDst, pDFTSpec, pFFTWorkBuf);
       }
+#endif
+#if ATK_USE_FFTW == 0 && ATK_USE_IPP == 0
+      builtin.forward(input_data.data(), output_freqs.data());
 #endif
     }
-    
-    void process_backward(const std::complex<DataType_>* input, std::complex<DataType_>* output, gsl::index input_size, gsl::index size) const
+
+    /// Transforms the spectrum back into the complex signal
+    void backward()
     {
 #if ATK_USE_FFTW == 1
-      for (gsl::index j = 0; j < size; ++j)
-      {
-        output_freqs[j][0] = input[j].real();
-        output_freqs[j][1] = input[j].imag();
-      }
-      fftw_execute(fft_reverse_plan);
-      for (gsl::index j = 0; j < input_size; ++j)
-      {
-        output[j] = std::complex<DataType_>(input_data[j][0], input_data[j][1]);
-      }
+      fftw_execute_dft(backward_plan->plan, output_freqs, input_data);
 #endif
 #if ATK_USE_IPP == 1
-      for (gsl::index j = 0; j < size; ++j)
-      {
-        pDst[j].re = input[j].real();
-        pDst[j].im = input[j].imag();
-      }
       if (power_of_two)
       {
-        ippsFFTInv_CToC_64fc(pDst, pDst, pFFTSpec, pFFTWorkBuf);
+        ippsFFTInv_CToC_64fc(pDst, pSrc, pFFTSpec, pFFTWorkBuf);
       }
       else
       {
-        ippsDFTInv_CToC_64fc(pDst, pDst, pDFTSpec, pFFTWorkBuf);
-      }
-      for (gsl::index j = 0; j < input_size; ++j)
-      {
-        output[j] = std::complex<DataType_>(pDst[j].re, pDst[j].im);
+        ippsDFTInv_CToC_64fc(pDst, pSrc, pDFTSpec, pFFTWorkBuf);
       }
+#endif
+#if ATK_USE_FFTW == 0 && ATK_USE_IPP == 0
+      builtin.backward(output_freqs.data(), input_data.data());
 #endif
     }
-    
-    void get_amp(std::vector<DataType_>& amp) const
+
+    /// Transforms the real signal into the first size / 2 + 1 bins of the spectrum
+    void forward_real()
     {
-      for(size_t i = 0; i < amp.size(); ++i)
-      {
 #if ATK_USE_FFTW == 1
-        amp[i] = output_freqs[i][0] * output_freqs[i][0];
-        amp[i] += output_freqs[i][1] * output_freqs[i][1];
-        amp[i] = std::sqrt(amp[i]);
+      fftw_execute_dft_r2c(real_forward_plan->plan, real_data, output_freqs);
 #endif
 #if ATK_USE_IPP == 1
-        amp[i] = pDst[i].re * pDst[i].re;
-        amp[i] += pDst[i].im * pDst[i].im;
-        amp[i] = std::sqrt(amp[i]);
-#endif
+      for (gsl::index j = 0; j < size; ++j)
+      {
+        pSrc[j].re = real_data[j];
+        pSrc[j].im = 0;
       }
+      forward();
+#endif
+#if ATK_USE_FFTW == 0 && ATK_USE_IPP == 0
+      builtin.forward_real(real_data.data(), output_freqs.data());
+#endif
     }
-    
-    void get_angle(std::vector<DataType_>& angle) const
+
+    /// Transforms the first size / 2 + 1 bins of the spectrum back into the real signal
+    void backward_real()
     {
-      for(size_t i = 0; i < angle.size(); ++i)
-      {
 #if ATK_USE_FFTW == 1
-        angle[i] = std::arg(std::complex<DataType_>(output_freqs[i][0], output_freqs[i][1]));
+      // The complex to real transform overwrites its input
+      std::copy(get_spectrum(), get_spectrum() + size / 2 + 1, get_signal());
+      fftw_execute_dft_c2r(real_backward_plan->plan, input_data, real_data);
 #endif
 #if ATK_USE_IPP == 1
-        angle[i] = std::arg(std::complex<DataType_>(pDst[i].re, pDst[i].im));
-#endif
+      for (gsl::index j = size / 2 + 1; j < size; ++j)
+      {
+        pDst[j].re = pDst[size - j].re;
+        pDst[j].im = -pDst[size - j].im;
+      }
+      backward();
+      for (gsl::index j = 0; j < size; ++j)
+      {
+        real_data[j] = pSrc[j].re;
       }
+#endif
+#if ATK_USE_FFTW == 0 && ATK_USE_IPP == 0
+      builtin.backward_real(output_freqs.data(), real_data.data());
+#endif
     }
+
   };
 
   template<class DataType_>
@@ -353,7 +362,7 @@ namespace ATK
   :size(0), impl(std::make_unique<FFTImpl>())
   {
   }
-  
+
 
   template<class DataType_>
   FFT<DataType_>::~FFT()
@@ -380,54 +389,158 @@ namespace ATK
   template<class DataType_>
   void FFT<DataType_>::process(const DataType_* input, gsl::index input_size) const
   {
-    impl->process(input, input_size, size);
+    auto* real_signal = impl->get_real_signal();
+    double factor = static_cast<double>(size);
+    for(gsl::index j = 0; j < std::min(input_size, size); ++j)
+    {
+      real_signal[j] = input[j] / factor;
+    }
+    for(gsl::index j = input_size; j < size; ++j)
+    {
+      real_signal[j] = 0;
+    }
+    impl->forward_real();
   }
-  
+
   template<class DataType_>
   void FFT<DataType_>::process_forward(const DataType_* input, std::complex<DataType_>* output, gsl::index input_size) const
   {
     process(input, input_size);
-    impl->process_forward(output, size);
+    // The spectrum of a real signal is symmetric
+    const auto* spectrum = impl->get_spectrum();
+    for(gsl::index j = 0; j <= size / 2; ++j)
+    {
+      output[j] = std::complex<DataType_>(spectrum[j]);
+    }
+    for(gsl::index j = size / 2 + 1; j < size; ++j)
+    {
+      output[j] = std::complex<DataType_>(std::conj(spectrum[size - j]));
+    }
   }
 
   template<class DataType_>
   void FFT<DataType_>::process_backward(const std::complex<DataType_>* input, DataType_* output, gsl::index input_size) const
   {
-    impl->process_backward(input, output, input_size, size);
+    // The real part of the signal is the transform of the symmetric part of the spectrum
+    auto* spectrum = impl->get_spectrum();
+    for(gsl::index j = 0; j <= size / 2; ++j)
+    {
+      spectrum[j] = (std::complex<double>(input[j]) + std::conj(std::complex<double>(input[(size - j) % size]))) * 0.5;
+    }
+    impl->backward_real();
+    const auto* real_signal = impl->get_real_signal();
+    for(gsl::index j = 0; j < input_size; ++j)
+    {
+      output[j] = static_cast<DataType_>(real_signal[j]);
+    }
   }
 
   template<class DataType_>
   void FFT<DataType_>::process(const std::complex<DataType_>* input, gsl::index input_size) const
   {
-    impl->process(input, input_size, size);
+    auto* signal = impl->get_signal();
+    double factor = static_cast<double>(size);
+    for(gsl::index j = 0; j < std::min(input_size, size); ++j)
+    {
+      signal[j] = std::complex<double>(input[j]) / factor;
+    }
+    for(gsl::index j = input_size; j < size; ++j)
+    {
+      signal[j] = 0;
+    }
+    impl->forward();
   }
 
   template<class DataType_>
   void FFT<DataType_>::process_forward(const std::complex<DataType_>* input, std::complex<DataType_>* output, gsl::index input_size) const
   {
     process(input, input_size);
-    impl->process_forward(output, size);
+    const auto* spectrum = impl->get_spectrum();
+    for(gsl::index j = 0; j < size; ++j)
+    {
+      output[j] = std::complex<DataType_>(spectrum[j]);
+    }
   }
 
   template<class DataType_>
   void FFT<DataType_>::process_backward(const std::complex<DataType_>* input, std::complex<DataType_>* output, gsl::index input_size) const
   {
-    impl->process_backward(input, output, input_size, size);
+    auto* spectrum = impl->get_spectrum();
+    for(gsl::index j = 0; j < size; ++j)
+    {
+      spectrum[j] = std::complex<double>(input[j]);
+    }
+    impl->backward();
+    const auto* signal = impl->get_signal();
+    for(gsl::index j = 0; j < input_size; ++j)
+    {
+      output[j] = std::complex<DataType_>(signal[j]);
+    }
+  }
+
+  template<class DataType_>
+  void FFT<DataType_>::process_forward_real(const DataType_* input, std::complex<DataType_>* output, gsl::index input_size, gsl::index nb_channels) const
+  {
+    auto nb_bins = size / 2 + 1;
+    // Batched plans would need working buffers for all the channels, so the channels reuse the single transform
+    for(gsl::index channel = 0; channel < nb_channels; ++channel)
+    {
+      process(input + channel * input_size, input_size);
+      const auto* spectrum = impl->get_spectrum();
+      std::complex<DataType_>* channel_output = output + channel * nb_bins;
+      for(gsl::index j = 0; j < nb_bins; ++j)
+      {
+        channel_output[j] = std::complex<DataType_>(spectrum[j]);
+      }
+    }
+  }
+
+  template<class DataType_>
+  void FFT<DataType_>::process_backward_real(const std::complex<DataType_>* input, DataType_* output, gsl::index output_size, gsl::index nb_channels) const
+  {
+    auto nb_bins = size / 2 + 1;
+    for(gsl::index channel = 0; channel < nb_channels; ++channel)
+    {
+      auto* spectrum = impl->get_spectrum();
+      const std::complex<DataType_>* channel_input = input + channel * nb_bins;
+      for(gsl::index j = 0; j < nb_bins; ++j)
+      {
+        spectrum[j] = std::complex<double>(channel_input[j]);
+      }
+      impl->backward_real();
+      const auto* real_signal = impl->get_real_signal();
+      DataType_* channel_output = output + channel * output_size;
+      for(gsl::index j = 0; j < output_size; ++j)
+      {
+        channel_output[j] = static_cast<DataType_>(real_signal[j]);
+      }
+    }
   }
 
   template<class DataType_>
   void FFT<DataType_>::get_amp(std::vector<DataType_>& amp) const
   {
     amp.assign(size / 2 + 1, 0);
-    impl->get_amp(amp);
+    const auto* spectrum = impl->get_spectrum();
+    for(size_t i = 0; i < amp.size(); ++i)
+    {
+      amp[i] = static_cast<DataType_>(std::abs(spectrum[i]));
+    }
   }
-  
+
   template<class DataType_>
   void FFT<DataType_>::get_angle(std::vector<DataType_>& angle) const
   {
     angle.assign(size / 2 + 1, 0);
-    impl->get_angle(angle);
+    const auto* spectrum = impl->get_spectrum();
+    for(size_t i = 0; i < angle.size(); ++i)
+    {
+      angle[i] = static_cast<DataType_>(std::arg(spectrum[i]));
+    }
   }
 
   template class FFT<double>;
+#if ATK_ENABLE_INSTANTIATION
+  template class FFT<float>;
+#endif
 }
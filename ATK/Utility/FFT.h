@@ -17,6 +17,12 @@
 namespace ATK
 {
   /// An FFT class
+  /*!
+   * Plans are shared by all the FFT objects with the same size through a process wide cache, each object only owns
+   * its working buffers. Depending on the configuration, the transforms are computed by IPP, FFTW or a built-in
+   * implementation (Stockham for powers of 2, Bluestein for other sizes).
+   * Forward transforms are normalized by the size of the FFT, backward transforms are not.
+   */
   template<class DataType_>
   class ATK_UTILITY_EXPORT FFT
   {
@@ -76,6 +82,25 @@ namespace ATK
     */
     void process_backward(const std::complex<DataType_>* input, std::complex<DataType_>* output, gsl::index input_size) const;
     /*!
+    * @brief Processes FFTs of real signals, only the size / 2 + 1 first bins of their symmetric spectra are computed
+    * The channels are transformed one after the other with the plan and the working buffers of a single transform,
+    * this is a convenience loop and not a batched transform of the backend.
+    * @param input is the real input array, nb_channels signals of input_size samples one after the other
+    * @param output is the complex output array, nb_channels spectra of size / 2 + 1 bins one after the other
+    * @param input_size is the size of each input signal
+    * @param nb_channels is the number of signals to transform
+    */
+    void process_forward_real(const DataType_* input, std::complex<DataType_>* output, gsl::index input_size, gsl::index nb_channels = 1) const;
+    /*!
+    * @brief Processes inverse FFTs of the spectra of real signals
+    * As for process_forward_real, the channels are transformed one after the other.
+    * @param input is the complex input array, nb_channels spectra of size / 2 + 1 bins one after the other
+    * @param output is the real output array, nb_channels signals of output_size samples one after the other
+    * @param output_size is the number of samples kept for each output signal
+    * @param nb_channels is the number of spectra to transform
+    */
+    void process_backward_real(const std::complex<DataType_>* input, DataType_* output, gsl::index output_size, gsl::index nb_channels = 1) const;
+    /*!
     * @brief Computes the amplitude of the resulting spectrum
     * @param amp is the output angle container
     */
@@ -0,0 +1,61 @@
+/**
+ * \file FFTPlanCache.h
+ */
+
+#ifndef ATK_UTILITY_FFTPLANCACHE_H
+#define ATK_UTILITY_FFTPLANCACHE_H
+
+#include <gsl/gsl>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+namespace ATK
+{
+  /// Direction of a transform
+  enum class FFTDirection {Forward, Backward};
+  /// Type of the signal of a transform
+  enum class FFTType {Complex, Real};
+
+  /// Process wide cache of the plans, shared by all the FFT objects with the same size, direction and type
+  /*!
+   * Plan must be constructible from a size, a direction and a type. Plans are destroyed when no FFT object uses them
+   * anymore.
+   */
+  template<class Plan>
+  class FFTPlanCache
+  {
+  public:
+    static std::shared_ptr<const Plan> get(gsl::index size, FFTDirection direction, FFTType type)
+    {
+      static FFTPlanCache cache;
+      auto key = std::make_tuple(size, direction, type);
+      {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        if(auto plan = cache.plans[key].lock())
+        {
+          return plan;
+        }
+      }
+      // Plans may depend on smaller plans, so they are created without holding the lock
+      auto plan = std::make_shared<const Plan>(size, direction, type);
+      std::lock_guard<std::mutex> lock(cache.mutex);
+      auto& cached_plan = cache.plans[key];
+      if(auto other_plan = cached_plan.lock())
+      {
+        // Another thread created the same plan in the meantime
+        return other_plan;
+      }
+      cached_plan = plan;
+      return plan;
+    }
+
+  private:
+    std::mutex mutex;
+    std::map<std::tuple<gsl::index, FFTDirection, FFTType>, std::weak_ptr<const Plan> > plans;
+  };
+}
+
+#endif
@@ -8,16 +8,16 @@
 #include <ATK/config.h>
 
 #include <cmath>
-#if ATK_PROFILING == 1
-#include <iostream>
-#endif
+#include <cstdint>
 #include <limits>
+#include <vector>
 
 namespace ATK
 {
   /// Scalar Newton Raphson optimizer
   /*!
    * A NR optimizer, 10 iterations max
+   * When ATK_PROFILING is set, the optimizer counts how many iterations each sample needed.
    */
   template<typename Function, int max_iterations=10, bool check_convergence=true>
   class ScalarNewtonRaphson
@@ -30,8 +30,7 @@ namespace ATK
     DataType maxstep{1};
     
 #if ATK_PROFILING == 1
-    int64_t nb_iterations{0};
-    int64_t nb_optimizations{0};
+    std::vector<int64_t> histogram = std::vector<int64_t>(max_iterations + 2, 0);
 #endif
     
   public:
@@ -50,24 +49,20 @@ namespace ATK
       }
     }
 
+    ScalarNewtonRaphson(const ScalarNewtonRaphson&) = delete;
+    ScalarNewtonRaphson& operator=(const ScalarNewtonRaphson&) = delete;
+
 #if ATK_PROFILING == 1
-    ~ScalarNewtonRaphson()
+    /// Returns the number of optimizations that converged after each number of iterations, the last element counts the failures
+    const std::vector<int64_t>& get_iteration_histogram() const
     {
-      std::cout << "nb optimizations: " << nb_optimizations << std::endl;
-      std::cout << "nb iterations: " << nb_iterations << std::endl;
-      std::cout << "average: " << nb_iterations / double(nb_optimizations) << std::endl;
+      return histogram;
     }
 #endif
-    
-    ScalarNewtonRaphson(const ScalarNewtonRaphson&) = delete;
-    ScalarNewtonRaphson& operator=(const ScalarNewtonRaphson&) = delete;
 
     /// Optimize the function and sets its internal state
     void optimize(const DataType* ATK_RESTRICT input, DataType* ATK_RESTRICT output)
     {
-#if ATK_PROFILING == 1
-      ++nb_optimizations;
-#endif
       output[0] = optimize_impl(input, output);
     }
 
@@ -84,6 +79,14 @@ namespace ATK
     }
 
   protected:
+    /// Records the number of iterations of an optimization, max_iterations + 1 for a failure
+    void record(gsl::index iterations)
+    {
+#if ATK_PROFILING == 1
+      ++histogram[iterations];
+#endif
+    }
+
     /// Just optimize the function
     DataType optimize_impl(const DataType* ATK_RESTRICT input, DataType* ATK_RESTRICT output)
     {
@@ -92,12 +95,10 @@ namespace ATK
       
       for(i = 0; i < max_iterations; ++i)
       {
-#if ATK_PROFILING == 1
-        ++nb_iterations;
-#endif
         std::pair<DataType, DataType> all = function(input, output, y1);
         if(std::abs(all.second) < std::numeric_limits<DataType>::epsilon() )
         {
+          record(i + 1);
           return y1;
         }
         DataType cx = all.first / all.second;
@@ -112,10 +113,12 @@ namespace ATK
         DataType yk = y1 - cx;
         if( std::abs(yk - y1) < precision )
         {
+          record(i + 1);
           return yk;
         }
         y1 = yk;
       }
+      record(max_iterations + 1);
       if(check_convergence && i == max_iterations)
       {
         return output[-1]; // Stay the same
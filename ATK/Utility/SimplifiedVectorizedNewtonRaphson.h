@@ -6,23 +6,38 @@
 #define ATK_UTILITY_SIMPLIFIEDVECTORIZEDNEWTONRAPHSON_H
 
 #include <ATK/config.h>
+#include <ATK/Utility/VectorizedNewtonRaphson.h>
 
 #include <Eigen/Dense>
 
 #include <cmath>
 #include <limits>
+#include <type_traits>
+#include <utility>
 
 namespace ATK
 {
   /// Simplified Vectorized Newton Raphson optimizer
   /*!
    * A NR optimizer, 10 iterations max, for stabilized computation
+   * As with VectorizedNewtonRaphson, the function returns either the step or the residual and its Jacobian.
    */
   template<typename Function, int size, int max_iterations=10>
   class SimplifiedVectorizedNewtonRaphson
   {
     using DataType = typename Function::DataType;
     using Vector = Eigen::Matrix<DataType, size, 1>;
+    using Matrix = Eigen::Matrix<DataType, size, size>;
+
+    /// Does the function give the residual and the Jacobian instead of the step?
+    template<typename F, typename = void>
+    struct has_jacobian: std::false_type
+    {
+    };
+    template<typename F>
+    struct has_jacobian<F, std::void_t<decltype(std::declval<F&>()(std::declval<const Vector&>(), std::declval<Vector&>(), std::declval<Matrix&>()))>>: std::true_type
+    {
+    };
 
     Function function;
     
@@ -66,7 +81,7 @@ namespace ATK
       gsl::index j;
       for(j = 0; j < max_iterations; ++j)
       {
-        Vector cx = function(y1);
+        Vector cx = step(y1);
         auto maximum = cx.maxCoeff();
         auto minimum = cx.minCoeff();
         auto r = std::max(maximum, -minimum);
@@ -84,6 +99,23 @@ namespace ATK
       }
       return y1;
     }
+
+  protected:
+    /// Returns the Newton step from y1
+    Vector step(const Vector& y1)
+    {
+      if constexpr(has_jacobian<Function>::value)
+      {
+        Vector F;
+        Matrix J;
+        function(y1, F, J);
+        return newton_solve<DataType, size>(J, F);
+      }
+      else
+      {
+        return function(y1);
+      }
+    }
   };
 }
 
@@ -6,36 +6,74 @@
 #define ATK_UTILITY_VECTORIZEDNEWTONRAPHSON_H
 
 #include <cmath>
-#if ATK_PROFILING == 1
-#include <iostream>
-#endif
+#include <cstdint>
 #include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <ATK/config.h>
 
+#include <gsl/gsl>
+
 #include <Eigen/Dense>
 
 namespace ATK
 {
+  /// Solves J x = F
+  /*!
+   * Up to 4x4, the closed form of the inverse (cofactors) is faster than any factorization, the larger systems are
+   * factored once with partial pivoting and solved without building the inverse.
+   */
+  template<typename DataType, int size>
+  Eigen::Matrix<DataType, size, 1> newton_solve(const Eigen::Matrix<DataType, size, size>& J, const Eigen::Matrix<DataType, size, 1>& F)
+  {
+    if constexpr(size <= 4)
+    {
+      return J.inverse() * F;
+    }
+    else
+    {
+      return J.partialPivLu().solve(F);
+    }
+  }
+
   /// Vectorized Newton Raphson optimizer
   /*!
    * A NR optimizer, 10 iterations max
+   *
+   * The function either returns the Newton step itself, or fills the residual F and its Jacobian J, in which case the
+   * optimizer solves J step = F and can also limit the steps and search along them.
+   * When ATK_PROFILING is set, the optimizer counts how many iterations each sample needed.
    */
   template<typename Function, gsl::index size, gsl::index max_iterations=10, bool check_convergence=true>
   class VectorizedNewtonRaphson
   {
     using DataType = typename Function::DataType;
-    
+    using Vector = Eigen::Matrix<DataType, size, 1>;
+    using Matrix = Eigen::Matrix<DataType, size, size>;
+
+    /// Does the function give the residual and the Jacobian instead of the step?
+    template<typename F, typename = void>
+    struct has_jacobian: std::false_type
+    {
+    };
+    template<typename F>
+    struct has_jacobian<F, std::void_t<decltype(std::declval<F&>()(gsl::index(), std::declval<const DataType* const *>(), std::declval<DataType* const *>(), std::declval<const Vector&>(), std::declval<Vector&>(), std::declval<Matrix&>()))>>: std::true_type
+    {
+    };
+
     Function function;
-    
+
     DataType precision;
-    
+    DataType max_step{0};
+    gsl::index line_search{0};
+    gsl::index extra_iterations{0};
+
 #if ATK_PROFILING == 1
-    int64_t nb_iterations{0};
-    int64_t nb_optimizations{0};
+    std::vector<int64_t> histogram = std::vector<int64_t>(max_iterations + 2, 0);
 #endif
-    using Vector = Eigen::Matrix<DataType, size, 1>;
-    
+
   public:
     /*!
      * @brief Constructs the optimizer
@@ -51,25 +89,66 @@ namespace ATK
         this->precision = std::sqrt(std::numeric_limits<DataType>::epsilon());
       }
     }
-    
+
+    VectorizedNewtonRaphson(const VectorizedNewtonRaphson&) = delete;
+    VectorizedNewtonRaphson& operator=(const VectorizedNewtonRaphson&) = delete;
+
+    /// Limits the largest change of a coordinate during one iteration, 0 (the default) for no limit
+    void set_max_step(DataType max_step)
+    {
+      this->max_step = max_step;
+    }
+
+    /// Returns the largest change of a coordinate during one iteration
+    DataType get_max_step() const
+    {
+      return max_step;
+    }
+
+    /*!
+     * @brief Halves the step while it increases the residual, only for the functions giving their Jacobian
+     * @param halvings is the largest number of halvings, 0 (the default) disables the search
+     */
+    void set_line_search(gsl::index halvings)
+    {
+      line_search = halvings;
+    }
+
+    /// Returns the largest number of halvings of a step
+    gsl::index get_line_search() const
+    {
+      return line_search;
+    }
+
+    /*!
+     * @brief Allows more iterations than max_iterations as long as the steps keep shrinking
+     * @param iterations is the largest number of additional iterations, 0 by default
+     */
+    void set_extra_iterations(gsl::index iterations)
+    {
+      extra_iterations = iterations;
+#if ATK_PROFILING == 1
+      histogram.assign(max_iterations + extra_iterations + 2, 0);
+#endif
+    }
+
+    /// Returns the largest number of additional iterations
+    gsl::index get_extra_iterations() const
+    {
+      return extra_iterations;
+    }
+
 #if ATK_PROFILING == 1
-    ~VectorizedNewtonRaphson()
+    /// Returns the number of optimizations that converged after each number of iterations, the last element counts the failures
+    const std::vector<int64_t>& get_iteration_histogram() const
     {
-      std::cout << "nb optimizations: " << nb_optimizations << std::endl;
-      std::cout << "nb iterations: " << nb_iterations << std::endl;
-      std::cout << "average: " << nb_iterations / double(nb_optimizations) << std::endl;
+      return histogram;
     }
 #endif
-    
-    VectorizedNewtonRaphson(const VectorizedNewtonRaphson&) = delete;
-    VectorizedNewtonRaphson& operator=(const VectorizedNewtonRaphson&) = delete;
 
     /// Optimize the function and sets its internal state
     void optimize(gsl::index i, const DataType* const * ATK_RESTRICT input, DataType* const * ATK_RESTRICT output)
     {
-#if ATK_PROFILING == 1
-      ++nb_optimizations;
-#endif
       auto res = optimize_impl(i, input, output);
       for(gsl::index j = 0; j < size; ++j)
       {
@@ -90,26 +169,87 @@ namespace ATK
     }
 
   protected:
+    /// Returns the Newton step from y1
+    Vector step(gsl::index i, const DataType* const * ATK_RESTRICT input, DataType* const * ATK_RESTRICT output, const Vector& y1)
+    {
+      if constexpr(has_jacobian<Function>::value)
+      {
+        Vector F;
+        Matrix J;
+        function(i, input, output, y1, F, J);
+        Vector cx = newton_solve<DataType, size>(J, F);
+        limit(cx);
+        if(line_search > 0)
+        {
+          auto residual = F.squaredNorm();
+          for(gsl::index k = 0; k < line_search; ++k)
+          {
+            function(i, input, output, y1 - cx, F, J);
+            if(F.squaredNorm() <= residual)
+            {
+              break;
+            }
+            cx /= 2;
+          }
+        }
+        return cx;
+      }
+      else
+      {
+        Vector cx = function(i, input, output, y1);
+        limit(cx);
+        return cx;
+      }
+    }
+
+    /// Scales the step so that no coordinate changes by more than max_step
+    void limit(Vector& cx) const
+    {
+      if(max_step > 0)
+      {
+        auto largest = cx.cwiseAbs().maxCoeff();
+        if(largest > max_step)
+        {
+          cx *= max_step / largest;
+        }
+      }
+    }
+
+    /// Records the number of iterations of an optimization, max_iterations + extra_iterations + 1 for a failure
+    void record(gsl::index iterations)
+    {
+#if ATK_PROFILING == 1
+      ++histogram[iterations];
+#endif
+    }
+
     /// Just optimize the function
     Vector optimize_impl(gsl::index i, const DataType* const * ATK_RESTRICT input, DataType* const * ATK_RESTRICT output)
     {
       Vector y1 = function.estimate(i, input, output);
-      
-      gsl::index j;
-      for(j = 0; j < max_iterations; ++j)
+
+      gsl::index budget = max_iterations;
+      DataType last_step = std::numeric_limits<DataType>::max();
+      for(gsl::index j = 0; j < budget; ++j)
       {
-#if ATK_PROFILING == 1
-        ++nb_iterations;
-#endif
-        auto cx = function(i, input, output, y1);
-        auto yk = y1 - cx;
+        Vector cx = step(i, input, output, y1);
+        Vector yk = y1 - cx;
         if((cx.array().abs() < precision).all())
         {
+          record(j + 1);
           return yk;
         }
+        // The budget only grows while the iterations converge
+        auto largest = cx.cwiseAbs().maxCoeff();
+        if(j + 1 == budget && budget < max_iterations + extra_iterations && largest < last_step)
+        {
+          ++budget;
+        }
+        last_step = largest;
         y1 = yk;
       }
-      if(check_convergence && j == max_iterations)
+      record(max_iterations + extra_iterations + 1);
+      if(check_convergence)
       {
         Vector y0;
         for(gsl::index j = 0; j < size; ++j)
@@ -0,0 +1,130 @@
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+
+#include <ATK/EQ/ModulatedSVFFilter.h>
+#include <ATK/EQ/TimeVaryingIIRFilter.h>
+#include <ATK/EQ/TimeVaryingSecondOrderFilter.h>
+#include <ATK/EQ/TimeVaryingSecondOrderSVFFilter.h>
+
+#include <ATK/Tools/TanFilter.h>
+
+constexpr gsl::index SAMPLING_RATE = 48000;
+constexpr gsl::index BLOCK_SIZE = 256;
+constexpr gsl::index NB_BLOCKS = 4096;
+constexpr gsl::index NB_CHANNELS = 8;
+
+/// Sweeps the cut frequency of NB_CHANNELS low pass filters over white noise
+class Modulation
+{
+public:
+  Modulation()
+  :input(NB_CHANNELS * BLOCK_SIZE), cut_frequencies(BLOCK_SIZE), output(NB_CHANNELS * BLOCK_SIZE),
+  generator(input.data(), NB_CHANNELS, BLOCK_SIZE, false), cut_generator(cut_frequencies.data(), 1, BLOCK_SIZE, false),
+  sink(output.data(), NB_CHANNELS, BLOCK_SIZE, false)
+  {
+    for(auto& value: input)
+    {
+      value = static_cast<double>(std::rand()) / RAND_MAX - .5;
+    }
+    for(gsl::index i = 0; i < BLOCK_SIZE; ++i)
+    {
+      cut_frequencies[i] = 1000 + 900 * std::sin(2 * 3.14159265358979 * i / BLOCK_SIZE);
+    }
+    generator.set_output_sampling_rate(SAMPLING_RATE);
+    cut_generator.set_output_sampling_rate(SAMPLING_RATE);
+    sink.set_input_sampling_rate(SAMPLING_RATE);
+  }
+
+  /// Processes NB_BLOCKS blocks and prints the time per sample and per channel
+  void profile(const char* name)
+  {
+    sink.set_max_block_size(BLOCK_SIZE);
+    auto start = std::chrono::steady_clock::now();
+    for(gsl::index i = 0; i < NB_BLOCKS; ++i)
+    {
+      generator.set_pointer(input.data(), BLOCK_SIZE);
+      cut_generator.set_pointer(cut_frequencies.data(), BLOCK_SIZE);
+      sink.set_pointer(output.data(), BLOCK_SIZE);
+      sink.process(BLOCK_SIZE);
+    }
+    std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": " << duration.count() / (NB_BLOCKS * BLOCK_SIZE * NB_CHANNELS) << "ns per sample and channel" << std::endl;
+  }
+
+  std::vector<double> input;
+  std::vector<double> cut_frequencies;
+  std::vector<double> output;
+  ATK::InPointerFilter<double> generator;
+  ATK::InPointerFilter<double> cut_generator;
+  ATK::OutPointerFilter<double> sink;
+};
+
+void profile_iir()
+{
+  Modulation modulation;
+  std::vector<std::unique_ptr<ATK::TimeVaryingIIRFilter<ATK::TimeVaryingLowPassCoefficients<double> > > > filters;
+  for(gsl::index channel = 0; channel < NB_CHANNELS; ++channel)
+  {
+    filters.push_back(std::make_unique<ATK::TimeVaryingIIRFilter<ATK::TimeVaryingLowPassCoefficients<double> > >());
+    auto& filter = *filters.back();
+    filter.set_input_sampling_rate(SAMPLING_RATE);
+    filter.set_min_frequency(100);
+    filter.set_max_frequency(2000);
+    filter.set_number_of_steps(1024);
+    filter.set_input_port(0, modulation.generator, channel);
+    filter.set_input_port(1, modulation.cut_generator, 0);
+    modulation.sink.set_input_port(channel, filter, 0);
+  }
+  modulation.profile("TimeVaryingIIRFilter");
+}
+
+void profile_svf()
+{
+  Modulation modulation;
+  // The cut frequency has to be warped for each sample
+  ATK::TanFilter<double> tan;
+  tan.set_input_sampling_rate(SAMPLING_RATE);
+  tan.set_input_port(0, modulation.cut_generator, 0);
+  ATK::TimeVaryingSecondOrderSVFFilter<ATK::TimeVaryingSecondOrderSVFLowPassCoefficients<double> > filter(NB_CHANNELS);
+  filter.set_input_sampling_rate(SAMPLING_RATE);
+  filter.set_input_port(0, tan, 0);
+  for(gsl::index channel = 0; channel < NB_CHANNELS; ++channel)
+  {
+    filter.set_input_port(channel + 1, modulation.generator, channel);
+    modulation.sink.set_input_port(channel, filter, channel);
+  }
+  modulation.profile("TimeVaryingSecondOrderSVFFilter");
+}
+
+void profile_modulated_svf(gsl::index control_period)
+{
+  Modulation modulation;
+  ATK::ModulatedSVFFilter<double> filter(NB_CHANNELS);
+  filter.set_input_sampling_rate(SAMPLING_RATE);
+  filter.set_control_period(control_period);
+  filter.set_input_port(0, modulation.cut_generator, 0);
+  for(gsl::index channel = 0; channel < NB_CHANNELS; ++channel)
+  {
+    filter.set_input_port(channel + 1, modulation.generator, channel);
+    modulation.sink.set_input_port(channel, filter, channel);
+  }
+  modulation.profile(control_period == 1 ? "ModulatedSVFFilter (audio rate)" : "ModulatedSVFFilter (control rate)");
+}
+
+int main(int argc, char** argv)
+{
+  profile_iir();
+  profile_svf();
+  profile_modulated_svf(1);
+  profile_modulated_svf(32);
+
+  return EXIT_SUCCESS;
+}
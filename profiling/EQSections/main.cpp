@@ -0,0 +1,68 @@
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+
+#include <ATK/EQ/ButterworthFilter.h>
+#include <ATK/EQ/IIRFilter.h>
+#include <ATK/EQ/SOSFilter.h>
+
+constexpr gsl::index SAMPLING_RATE = 192000;
+constexpr gsl::index BLOCK_SIZE = 512;
+constexpr gsl::index NB_BLOCKS = 4096;
+
+/// Processes NB_BLOCKS blocks of white noise through an order 8 Butterworth low pass filter and prints the time per sample
+template<typename Filter>
+void profile(const char* name, gsl::index nb_channels, float cut_frequency)
+{
+  std::vector<float> input(nb_channels * BLOCK_SIZE);
+  for(auto& value: input)
+  {
+    value = static_cast<float>(std::rand()) / RAND_MAX - .5f;
+  }
+  std::vector<float> output(nb_channels * BLOCK_SIZE);
+
+  ATK::InPointerFilter<float> generator(input.data(), static_cast<int>(nb_channels), BLOCK_SIZE, false);
+  generator.set_output_sampling_rate(SAMPLING_RATE);
+  Filter filter(nb_channels);
+  filter.set_input_sampling_rate(SAMPLING_RATE);
+  filter.set_cut_frequency(cut_frequency);
+  filter.set_order(8);
+  ATK::OutPointerFilter<float> sink(output.data(), static_cast<int>(nb_channels), BLOCK_SIZE, false);
+  sink.set_input_sampling_rate(SAMPLING_RATE);
+
+  for(gsl::index channel = 0; channel < nb_channels; ++channel)
+  {
+    filter.set_input_port(channel, &generator, channel);
+    sink.set_input_port(channel, &filter, channel);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for(gsl::index i = 0; i < NB_BLOCKS; ++i)
+  {
+    generator.set_pointer(input.data(), BLOCK_SIZE);
+    sink.set_pointer(output.data(), BLOCK_SIZE);
+    sink.process(BLOCK_SIZE);
+  }
+  std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - start;
+
+  std::cout << name << " " << nb_channels << " channel(s), " << cut_frequency << "Hz: " << duration.count() / (NB_BLOCKS * BLOCK_SIZE * nb_channels) << " ns/sample, last output " << output.back() << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  for(gsl::index nb_channels: {1, 2, 8, 32})
+  {
+    for(float cut_frequency: {20.f, 1000.f})
+    {
+      profile<ATK::IIRFilter<ATK::ButterworthLowPassCoefficients<float> > >("IIRFilter", nb_channels, cut_frequency);
+      profile<ATK::SOSFilter<ATK::ButterworthLowPassCoefficients<float> > >("SOSFilter", nb_channels, cut_frequency);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
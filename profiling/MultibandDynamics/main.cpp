@@ -0,0 +1,83 @@
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+
+#include <ATK/Dynamic/GainCompressorFilter.h>
+#include <ATK/Dynamic/MultibandDynamicsFilter.h>
+
+constexpr gsl::index SAMPLING_RATE = 48000;
+constexpr gsl::index BLOCK_SIZE = 64;
+constexpr gsl::index NB_BLOCKS = 16384;
+
+/// Processes NB_BLOCKS blocks of white noise through a multiband compressor and prints the time per block
+template<typename DataType>
+void profile(const char* name, gsl::index nb_channels, gsl::index nb_bands, bool sidechain)
+{
+  auto nb_inputs = sidechain ? 2 * nb_channels : nb_channels;
+  std::vector<DataType> input(nb_inputs * BLOCK_SIZE);
+  for(auto& value: input)
+  {
+    value = static_cast<DataType>(std::rand()) / RAND_MAX - static_cast<DataType>(.5);
+  }
+  std::vector<DataType> output(nb_channels * BLOCK_SIZE);
+
+  ATK::InPointerFilter<DataType> generator(input.data(), static_cast<int>(nb_inputs), BLOCK_SIZE, false);
+  generator.set_output_sampling_rate(SAMPLING_RATE);
+  ATK::MultibandDynamicsFilter<ATK::GainCompressorFilter<DataType> > filter(nb_channels, nb_bands, sidechain);
+  filter.set_input_sampling_rate(SAMPLING_RATE);
+  filter.set_output_sampling_rate(SAMPLING_RATE);
+  filter.set_lookahead(32);
+  for(gsl::index band = 0; band < nb_bands; ++band)
+  {
+    filter.set_memory(band, static_cast<DataType>(.99));
+    filter.set_attack(band, static_cast<DataType>(.9));
+    filter.set_release(band, static_cast<DataType>(.999));
+    filter.get_gain_computer(band).set_threshold(static_cast<DataType>(.01));
+    filter.get_gain_computer(band).set_ratio(4);
+    filter.get_gain_computer(band).wait_for_LUT_completion();
+  }
+  ATK::OutPointerFilter<DataType> sink(output.data(), static_cast<int>(nb_channels), BLOCK_SIZE, false);
+  sink.set_input_sampling_rate(SAMPLING_RATE);
+
+  for(gsl::index channel = 0; channel < nb_inputs; ++channel)
+  {
+    filter.set_input_port(channel, &generator, channel);
+  }
+  for(gsl::index channel = 0; channel < nb_channels; ++channel)
+  {
+    sink.set_input_port(channel, &filter, channel);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for(gsl::index i = 0; i < NB_BLOCKS; ++i)
+  {
+    generator.set_pointer(input.data(), BLOCK_SIZE);
+    sink.set_pointer(output.data(), BLOCK_SIZE);
+    sink.process(BLOCK_SIZE);
+  }
+  std::chrono::duration<double, std::micro> duration = std::chrono::steady_clock::now() - start;
+
+  std::cout << name << " " << nb_channels << " channel(s), " << nb_bands << " bands" << (sidechain ? " with sidechain: " : ": ")
+    << duration.count() / NB_BLOCKS << " us per block of " << BLOCK_SIZE << " samples (budget " << 1e6 * BLOCK_SIZE / SAMPLING_RATE
+    << " us), last output " << output.back() << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  for(gsl::index nb_channels: {2, 8})
+  {
+    for(gsl::index nb_bands: {3, 5, 8})
+    {
+      profile<float>("float", nb_channels, nb_bands, false);
+      profile<double>("double", nb_channels, nb_bands, false);
+    }
+    profile<double>("double", nb_channels, 5, true);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,92 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+
+#include <ATK/Tools/DecimationFilter.h>
+#include <ATK/Tools/OversamplingFilter.h>
+#include <ATK/Tools/PolyphaseDecimationFilter.h>
+#include <ATK/Tools/PolyphaseOversamplingFilter.h>
+
+constexpr gsl::index SAMPLING_RATE = 48000;
+constexpr gsl::index BLOCK_SIZE = 256;
+constexpr gsl::index NB_BLOCKS = 2048;
+
+/// Oversamples and decimates white noise, the time is given per sample at the original rate
+void profile(const std::string& name, gsl::index factor, ATK::BaseFilter& oversampling, ATK::BaseFilter& decimation)
+{
+  std::vector<double> input(BLOCK_SIZE);
+  std::vector<double> output(BLOCK_SIZE);
+  for(auto& value: input)
+  {
+    value = static_cast<double>(std::rand()) / RAND_MAX - .5;
+  }
+
+  ATK::InPointerFilter<double> generator(input.data(), 1, BLOCK_SIZE, false);
+  generator.set_output_sampling_rate(SAMPLING_RATE);
+  oversampling.set_input_sampling_rate(SAMPLING_RATE);
+  oversampling.set_output_sampling_rate(SAMPLING_RATE * factor);
+  oversampling.set_input_port(0, generator, 0);
+  decimation.set_input_sampling_rate(SAMPLING_RATE * factor);
+  decimation.set_output_sampling_rate(SAMPLING_RATE);
+  decimation.set_input_port(0, oversampling, 0);
+
+  ATK::OutPointerFilter<double> sink(output.data(), 1, BLOCK_SIZE, false);
+  sink.set_input_sampling_rate(SAMPLING_RATE);
+  sink.set_input_port(0, decimation, 0);
+  sink.set_max_block_size(BLOCK_SIZE);
+
+  auto start = std::chrono::steady_clock::now();
+  for(gsl::index i = 0; i < NB_BLOCKS; ++i)
+  {
+    generator.set_pointer(input.data(), BLOCK_SIZE);
+    sink.set_pointer(output.data(), BLOCK_SIZE);
+    sink.process(BLOCK_SIZE);
+  }
+  std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - start;
+  std::cout << name << " x" << factor << ": " << duration.count() / (NB_BLOCKS * BLOCK_SIZE) << "ns per sample, latency "
+    << oversampling.get_latency() / static_cast<double>(factor) + decimation.get_latency() << " samples" << std::endl;
+}
+
+/// Polynomial interpolation and decimation without filter
+template<typename Coefficients>
+void profile_polynomial()
+{
+  ATK::OversamplingFilter<double, Coefficients> oversampling;
+  ATK::DecimationFilter<double> decimation;
+  profile("Polynomial", Coefficients::oversampling_factor, oversampling, decimation);
+}
+
+void profile_polyphase(gsl::index factor)
+{
+  {
+    ATK::PolyphaseOversamplingFilter<double> oversampling(1, ATK::HalfbandDesign::LinearPhaseFIR);
+    ATK::PolyphaseDecimationFilter<double> decimation(1, ATK::HalfbandDesign::LinearPhaseFIR);
+    profile("Half-band FIR", factor, oversampling, decimation);
+  }
+  {
+    ATK::PolyphaseOversamplingFilter<double> oversampling(1, ATK::HalfbandDesign::AllpassIIR);
+    ATK::PolyphaseDecimationFilter<double> decimation(1, ATK::HalfbandDesign::AllpassIIR);
+    profile("Half-band IIR", factor, oversampling, decimation);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  profile_polynomial<ATK::Oversampling6points5order_2<double>>();
+  profile_polyphase(2);
+  profile_polynomial<ATK::Oversampling6points5order_4<double>>();
+  profile_polyphase(4);
+  profile_polynomial<ATK::Oversampling6points5order_8<double>>();
+  profile_polyphase(8);
+  profile_polynomial<ATK::Oversampling6points5order_16<double>>();
+  profile_polyphase(16);
+  profile_polynomial<ATK::Oversampling6points5order_32<double>>();
+  profile_polyphase(32);
+
+  return EXIT_SUCCESS;
+}
@@ -1,25 +1,99 @@
 
+#include <chrono>
+#include <cmath>
 #include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+
 #include <ATK/Preamplifier/EnhancedKorenTriodeFunction.h>
+#include <ATK/Preamplifier/TriodeFilter.h>
 #include <ATK/Preamplifier/Triode2Filter.h>
 
-#include <ATK/Mock/SimpleSinusGeneratorFilter.h>
+#include <boost/math/constants/constants.hpp>
 
-int main(int argc, char** argv)
+constexpr gsl::index SAMPLING_RATE = 48000 * 4;
+constexpr gsl::index BLOCK_SIZE = 1024;
+constexpr gsl::index NB_BLOCKS = 256;
+
+/// Processes a 10V chirp up to 2kHz, returns the output, the processing time per sample and the setup time
+template<typename Filter>
+std::vector<double> process(Filter& filter, double& time, double& setup_time)
+{
+  std::vector<double> input(BLOCK_SIZE * NB_BLOCKS);
+  std::vector<double> output(BLOCK_SIZE * NB_BLOCKS);
+  for(gsl::index i = 0; i < BLOCK_SIZE * NB_BLOCKS; ++i)
+  {
+    auto frequency = 100 + 1900. * i / (BLOCK_SIZE * NB_BLOCKS);
+    input[i] = 10 * std::sin(boost::math::constants::pi<double>() * frequency * i / SAMPLING_RATE);
+  }
+
+  ATK::InPointerFilter<double> generator(input.data(), 1, BLOCK_SIZE * NB_BLOCKS, false);
+  generator.set_output_sampling_rate(SAMPLING_RATE);
+
+  auto setup_start = std::chrono::steady_clock::now();
+  filter.set_input_sampling_rate(SAMPLING_RATE);
+  filter.set_output_sampling_rate(SAMPLING_RATE);
+  std::chrono::duration<double, std::milli> setup_duration = std::chrono::steady_clock::now() - setup_start;
+  setup_time = setup_duration.count();
+  filter.set_input_port(0, generator, 0);
+
+  ATK::OutPointerFilter<double> sink(output.data(), 1, BLOCK_SIZE * NB_BLOCKS, false);
+  sink.set_input_sampling_rate(SAMPLING_RATE);
+  sink.set_input_port(0, filter, 0);
+  sink.set_max_block_size(BLOCK_SIZE);
+
+  auto start = std::chrono::steady_clock::now();
+  for(gsl::index i = 0; i < NB_BLOCKS; ++i)
+  {
+    sink.process(BLOCK_SIZE);
+  }
+  std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - start;
+  time = duration.count() / (BLOCK_SIZE * NB_BLOCKS);
+  return output;
+}
+
+/// Prints the accuracy of each table against the Newton-Raphson solver, and the speed of each solver
+template<typename Filter>
+void report(const std::string& name)
 {
-  ATK::SimpleSinusGeneratorFilter<double> generator;
-  generator.set_output_sampling_rate(1024 * 64);
-  generator.set_amplitude(1);
-  generator.set_frequency(1000);
+  double reference_time;
+  double setup_time;
+  auto reference_filter = Filter::build_standard_filter();
+  auto reference = process(reference_filter, reference_time, setup_time);
+  std::cout << name << " Newton-Raphson: " << reference_time << "ns per sample" << std::endl;
 
-  auto filter = ATK::Triode2Filter<double, ATK::EnhancedKorenTriodeFunction<double>>::build_standard_filter();
-  filter.set_input_sampling_rate(1024 * 64);
-  filter.set_output_sampling_rate(1024 * 64);
+  for(auto solver: {ATK::TriodeSolver::LinearTable, ATK::TriodeSolver::CubicTable})
+  {
+    for(gsl::index size: {64, 128, 256, 512})
+    {
+      auto filter = Filter::build_standard_filter();
+      filter.set_solver(solver);
+      filter.set_table_size(size);
+      double time;
+      auto output = process(filter, time, setup_time);
 
-  filter.set_input_port(0, &generator, 0);
+      double max_error = 0;
+      double error = 0;
+      for(gsl::index i = 0; i < BLOCK_SIZE * NB_BLOCKS; ++i)
+      {
+        max_error = std::max(max_error, std::abs(output[i] - reference[i]));
+        error += (output[i] - reference[i]) * (output[i] - reference[i]);
+      }
+      std::cout << name << (solver == ATK::TriodeSolver::LinearTable ? " linear " : " cubic ") << size << "x" << size << ": "
+        << time << "ns per sample, max error " << max_error << "V, RMS error " << std::sqrt(error / (BLOCK_SIZE * NB_BLOCKS))
+        << "V, built in " << setup_time << "ms" << std::endl;
+    }
+  }
+}
 
-  for(size_t i = 0; i < 1024*1024; ++i)
-    filter.process(1024);
+int main(int argc, char** argv)
+{
+  report<ATK::TriodeFilter<double, ATK::EnhancedKorenTriodeFunction<double>>>("TriodeFilter");
+  report<ATK::Triode2Filter<double, ATK::EnhancedKorenTriodeFunction<double>>>("Triode2Filter");
 
   return EXIT_SUCCESS;
 }
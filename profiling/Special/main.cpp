@@ -0,0 +1,88 @@
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+
+#include <ATK/Special/ConvolutionFilter.h>
+#include <ATK/Special/PartitionedConvolutionFilter.h>
+
+constexpr gsl::index SAMPLING_RATE = 48000;
+constexpr gsl::index IMPULSE_SIZE = 3 * SAMPLING_RATE;
+constexpr gsl::index BLOCK_SIZE = 64;
+constexpr gsl::index PROCESSED_SECONDS = 10;
+
+/// Processes PROCESSED_SECONDS of white noise through the convolution and prints the load
+template<typename Filter>
+void profile(const std::string& name, Filter& convolution)
+{
+  std::vector<double> input(BLOCK_SIZE);
+  for(auto& value: input)
+  {
+    value = static_cast<double>(std::rand()) / RAND_MAX - .5;
+  }
+  std::vector<double> output(BLOCK_SIZE);
+
+  ATK::InPointerFilter<double> generator(input.data(), 1, BLOCK_SIZE, false);
+  generator.set_output_sampling_rate(SAMPLING_RATE);
+
+  convolution.set_input_sampling_rate(SAMPLING_RATE);
+  convolution.set_input_port(0, generator, 0);
+
+  ATK::OutPointerFilter<double> sink(output.data(), 1, BLOCK_SIZE, false);
+  sink.set_input_sampling_rate(SAMPLING_RATE);
+  sink.set_input_port(0, convolution, 0);
+  sink.set_max_block_size(BLOCK_SIZE);
+
+  auto nb_blocks = PROCESSED_SECONDS * SAMPLING_RATE / BLOCK_SIZE;
+  std::chrono::duration<double> duration(0);
+  std::chrono::duration<double, std::micro> max_block_duration(0);
+  for(gsl::index i = 0; i < nb_blocks; ++i)
+  {
+    auto start = std::chrono::steady_clock::now();
+    generator.set_pointer(input.data(), BLOCK_SIZE);
+    sink.set_pointer(output.data(), BLOCK_SIZE);
+    sink.process(BLOCK_SIZE);
+    auto block_duration = std::chrono::steady_clock::now() - start;
+    duration += block_duration;
+    max_block_duration = std::max<std::chrono::duration<double, std::micro> >(max_block_duration, block_duration);
+  }
+
+  std::cout << name << ", 3s impulse, " << BLOCK_SIZE << " samples blocks: " << duration.count() / PROCESSED_SECONDS * 100 << "% of a core, longest block " << max_block_duration.count() << "us" << std::endl;
+}
+
+ATK::ConvolutionFilter<double>::AlignedScalarVector create_impulse()
+{
+  ATK::ConvolutionFilter<double>::AlignedScalarVector impulse(IMPULSE_SIZE);
+  for(gsl::index i = 0; i < IMPULSE_SIZE; ++i)
+  {
+    impulse[i] = (static_cast<double>(std::rand()) / RAND_MAX - .5) * std::exp(-3. * i / IMPULSE_SIZE);
+  }
+  return impulse;
+}
+
+int main(int argc, char** argv)
+{
+  auto impulse = create_impulse();
+  {
+    ATK::ConvolutionFilter<double> convolution;
+    convolution.set_split_size(BLOCK_SIZE);
+    convolution.set_impulse(impulse);
+    profile("ConvolutionFilter", convolution);
+  }
+  for(bool background_processing: {false, true})
+  {
+    ATK::PartitionedConvolutionFilter<double> convolution;
+    convolution.set_head_size(BLOCK_SIZE);
+    convolution.set_max_partition_size(8192);
+    convolution.set_background_processing(background_processing);
+    convolution.set_impulse(impulse);
+    profile(background_processing ? "PartitionedConvolutionFilter (background)" : "PartitionedConvolutionFilter", convolution);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,106 @@
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+
+#include <ATK/Distortion/TanhShaperFilter.h>
+#include <ATK/Tools/ApplyGainFilter.h>
+#include <ATK/Tools/DryWetFilter.h>
+#include <ATK/Tools/FusedFilter.h>
+#include <ATK/Tools/FusedOperators.h>
+#include <ATK/Tools/OffsetVolumeFilter.h>
+#include <ATK/Tools/VolumeFilter.h>
+
+constexpr gsl::index SAMPLING_RATE = 48000;
+constexpr gsl::index PROCESSED_SAMPLES = 100 * SAMPLING_RATE;
+
+/// Processes PROCESSED_SAMPLES through the chain ending in filter and prints the throughput and the memory traffic
+void profile(const std::string& name, ATK::InPointerFilter<double>& generator, const double* input, ATK::BaseFilter& filter, gsl::index block_size, gsl::index nb_streamed_buffers)
+{
+  std::vector<double> output(block_size);
+  ATK::OutPointerFilter<double> sink(output.data(), 1, block_size, false);
+  sink.set_input_sampling_rate(SAMPLING_RATE);
+  sink.set_input_port(0, filter, 0);
+  sink.set_max_block_size(block_size);
+
+  auto nb_blocks = PROCESSED_SAMPLES / block_size;
+  auto start = std::chrono::steady_clock::now();
+  for(gsl::index i = 0; i < nb_blocks; ++i)
+  {
+    generator.set_pointer(input, block_size);
+    sink.set_pointer(output.data(), block_size);
+    sink.process(block_size);
+  }
+  std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - start;
+
+  std::cout << name << ", " << block_size << " samples blocks: " << duration.count() / (nb_blocks * block_size) << "ns per sample, "
+    << nb_streamed_buffers * sizeof(double) << " bytes streamed per sample" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  for(gsl::index block_size: {64, 16384})
+  {
+    // Channel 0 is the signal, channel 1 the gain
+    std::vector<double> input(2 * block_size);
+    for(auto& value: input)
+    {
+      value = static_cast<double>(std::rand()) / RAND_MAX - .5;
+    }
+    ATK::InPointerFilter<double> generator(input.data(), 2, block_size, false);
+    generator.set_output_sampling_rate(SAMPLING_RATE);
+
+    {
+      ATK::VolumeFilter<double> volume;
+      volume.set_input_sampling_rate(SAMPLING_RATE);
+      volume.set_volume(4);
+      volume.set_input_port(0, generator, 0);
+      ATK::OffsetVolumeFilter<double> offset_volume;
+      offset_volume.set_input_sampling_rate(SAMPLING_RATE);
+      offset_volume.set_offset(.1);
+      offset_volume.set_input_port(0, volume, 0);
+      ATK::TanhShaperFilter<double> shaper;
+      shaper.set_input_sampling_rate(SAMPLING_RATE);
+      shaper.set_coefficient(2);
+      shaper.set_input_port(0, offset_volume, 0);
+      ATK::DryWetFilter<double> drywet;
+      drywet.set_input_sampling_rate(SAMPLING_RATE);
+      drywet.set_dry(.7);
+      drywet.set_input_port(0, shaper, 0);
+      drywet.set_input_port(1, generator, 0);
+      ATK::ApplyGainFilter<double> gain;
+      gain.set_input_sampling_rate(SAMPLING_RATE);
+      gain.set_input_port(0, drywet, 0);
+      gain.set_input_port(1, generator, 1);
+      ATK::VolumeFilter<double> output_volume;
+      output_volume.set_input_sampling_rate(SAMPLING_RATE);
+      output_volume.set_volume(.5);
+      output_volume.set_input_port(0, gain, 0);
+
+      // Each filter reads its inputs and writes its output
+      profile("Filter chain", generator, input.data(), output_volume, block_size, 2 + 2 + 2 + 3 + 3 + 2);
+    }
+    {
+      using namespace ATK::FusedOperators;
+      ATK::FusedFilter<double, Volume<double>, OffsetVolume<double>, TanhShaper<double>, DryWet<double>, ApplyGain<double>, Volume<double> > fused;
+      fused.get_operator<0>().set_volume(4);
+      fused.get_operator<1>().set_offset(.1);
+      fused.get_operator<2>().set_coefficient(2);
+      fused.get_operator<3>().set_dry(.7);
+      fused.get_operator<5>().set_volume(.5);
+      fused.set_input_sampling_rate(SAMPLING_RATE);
+      fused.set_input_port(0, generator, 0);
+      fused.set_input_port(1, generator, 1);
+
+      // The signal and the gain are read, the output written once
+      profile("Fused chain", generator, input.data(), fused, block_size, 3);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,66 @@
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <ATK/Utility/fmath.h>
+
+constexpr size_t BLOCK_SIZE = 1024;
+constexpr size_t NB_BLOCKS = 10000;
+
+/// Runs a function on NB_BLOCKS blocks and prints the time per value
+template<typename T, typename Function>
+void profile(const std::string& name, const std::vector<T>& input, Function function)
+{
+  std::vector<T> output(BLOCK_SIZE);
+  T checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for(size_t i = 0; i < NB_BLOCKS; ++i)
+  {
+    function(input.data(), output.data(), BLOCK_SIZE);
+    checksum += output[i % BLOCK_SIZE];
+  }
+  std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - start;
+  // The checksum keeps the compiler from removing the calls
+  std::cout << name << (sizeof(T) == sizeof(float) ? " float: " : " double: ") << duration.count() / (NB_BLOCKS * BLOCK_SIZE)
+    << "ns per value (" << checksum << ")" << std::endl;
+}
+
+/// Compares the standard library, the scalar fmath functions and the batch functions
+template<typename T>
+void profile_all()
+{
+  std::vector<T> input(BLOCK_SIZE);
+  for(size_t i = 0; i < BLOCK_SIZE; ++i)
+  {
+    input[i] = static_cast<T>(.1 + 10. * i / BLOCK_SIZE);
+  }
+
+  profile<T>("std::exp", input, [](const T* in, T* out, size_t n) {for(size_t i = 0; i < n; ++i) out[i] = std::exp(in[i]);});
+  profile<T>("fmath::exp scalar", input, [](const T* in, T* out, size_t n) {for(size_t i = 0; i < n; ++i) out[i] = fmath::exp(in[i]);});
+  profile<T>("fmath::exp batch", input, [](const T* in, T* out, size_t n) {fmath::exp(in, out, n);});
+  profile<T>("std::log", input, [](const T* in, T* out, size_t n) {for(size_t i = 0; i < n; ++i) out[i] = std::log(in[i]);});
+  profile<T>("fmath::log scalar", input, [](const T* in, T* out, size_t n) {for(size_t i = 0; i < n; ++i) out[i] = fmath::log(in[i]);});
+  profile<T>("fmath::log batch", input, [](const T* in, T* out, size_t n) {fmath::log(in, out, n);});
+  profile<T>("std::log10", input, [](const T* in, T* out, size_t n) {for(size_t i = 0; i < n; ++i) out[i] = std::log10(in[i]);});
+  profile<T>("fmath::log10 batch", input, [](const T* in, T* out, size_t n) {fmath::log10(in, out, n);});
+  profile<T>("std::pow(10, x)", input, [](const T* in, T* out, size_t n) {for(size_t i = 0; i < n; ++i) out[i] = std::pow(T(10), in[i]);});
+  profile<T>("fmath::pow10 batch", input, [](const T* in, T* out, size_t n) {fmath::pow10(in, out, n);});
+  profile<T>("std::tanh", input, [](const T* in, T* out, size_t n) {for(size_t i = 0; i < n; ++i) out[i] = std::tanh(in[i]);});
+  profile<T>("fmath::tanh batch", input, [](const T* in, T* out, size_t n) {fmath::tanh(in, out, n);});
+  profile<T>("std::sinh", input, [](const T* in, T* out, size_t n) {for(size_t i = 0; i < n; ++i) out[i] = std::sinh(in[i]);});
+  profile<T>("fmath::sinh batch", input, [](const T* in, T* out, size_t n) {fmath::sinh(in, out, n);});
+  profile<T>("std::asinh", input, [](const T* in, T* out, size_t n) {for(size_t i = 0; i < n; ++i) out[i] = std::asinh(in[i]);});
+  profile<T>("fmath::asinh batch", input, [](const T* in, T* out, size_t n) {fmath::asinh(in, out, n);});
+}
+
+int main(int argc, char** argv)
+{
+  profile_all<float>();
+  profile_all<double>();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,69 @@
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+
+#include <ATK/Delay/VariableDelayLineFilter.h>
+
+constexpr gsl::index SAMPLING_RATE = 48000;
+constexpr gsl::index BLOCK_SIZE = 256;
+constexpr gsl::index NB_BLOCKS = 4096;
+
+/// Modulates the delay of white noise around the middle of the delay line, as a chorus would
+void profile(gsl::index max_delay, ATK::DelayInterpolation interpolation, const char* name)
+{
+  std::vector<double> input(BLOCK_SIZE);
+  std::vector<double> delay(BLOCK_SIZE);
+  std::vector<double> output(BLOCK_SIZE);
+  for(gsl::index i = 0; i < BLOCK_SIZE; ++i)
+  {
+    input[i] = static_cast<double>(std::rand()) / RAND_MAX - .5;
+    delay[i] = max_delay / 2. + max_delay / 4. * std::sin(2 * 3.14159265358979 * i / BLOCK_SIZE);
+  }
+
+  ATK::InPointerFilter<double> generator(input.data(), 1, BLOCK_SIZE, false);
+  generator.set_output_sampling_rate(SAMPLING_RATE);
+  ATK::InPointerFilter<double> delay_generator(delay.data(), 1, BLOCK_SIZE, false);
+  delay_generator.set_output_sampling_rate(SAMPLING_RATE);
+
+  ATK::VariableDelayLineFilter<double> filter(max_delay);
+  filter.set_input_sampling_rate(SAMPLING_RATE);
+  filter.set_interpolation(interpolation);
+  filter.set_input_port(0, generator, 0);
+  filter.set_input_port(1, delay_generator, 0);
+
+  ATK::OutPointerFilter<double> sink(output.data(), 1, BLOCK_SIZE, false);
+  sink.set_input_sampling_rate(SAMPLING_RATE);
+  sink.set_input_port(0, filter, 0);
+  sink.set_max_block_size(BLOCK_SIZE);
+
+  auto start = std::chrono::steady_clock::now();
+  for(gsl::index i = 0; i < NB_BLOCKS; ++i)
+  {
+    generator.set_pointer(input.data(), BLOCK_SIZE);
+    delay_generator.set_pointer(delay.data(), BLOCK_SIZE);
+    sink.set_pointer(output.data(), BLOCK_SIZE);
+    sink.process(BLOCK_SIZE);
+  }
+  std::chrono::duration<double, std::nano> duration = std::chrono::steady_clock::now() - start;
+  std::cout << name << " (max delay " << max_delay << "): " << duration.count() / (NB_BLOCKS * BLOCK_SIZE) << "ns per sample" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  for(gsl::index max_delay: {1000, 10000, 100000, 1000000})
+  {
+    profile(max_delay, ATK::DelayInterpolation::Linear, "Linear");
+    profile(max_delay, ATK::DelayInterpolation::Lagrange, "Lagrange");
+    profile(max_delay, ATK::DelayInterpolation::Thiran, "Thiran");
+    profile(max_delay, ATK::DelayInterpolation::Sinc8, "Sinc8");
+    profile(max_delay, ATK::DelayInterpolation::Sinc16, "Sinc16");
+  }
+
+  return EXIT_SUCCESS;
+}
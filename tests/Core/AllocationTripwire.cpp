@@ -0,0 +1,262 @@
+/**
+ * \file AllocationTripwire.cpp
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <ATK/Core/AllocationTripwire.h>
+#include <ATK/Core/ExecutionPlan.h>
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+
+#include <ATK/Tools/DerivativeFilter.h>
+#include <ATK/Tools/VolumeFilter.h>
+
+#include <gtest/gtest.h>
+
+constexpr gsl::index PROCESSSIZE = (1024 * 64);
+
+namespace
+{
+  /// Copies its input through a temporary vector
+  class AllocatingFilter final : public ATK::TypedBaseFilter<double>
+  {
+  public:
+    AllocatingFilter()
+    :TypedBaseFilter<double>(1, 1)
+    {
+    }
+
+  protected:
+    void process_impl(gsl::index size) const final
+    {
+      std::vector<double> temp(converted_inputs[0], converted_inputs[0] + size);
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        outputs[0][i] = temp[i];
+      }
+    }
+  };
+
+  /// Keeps the history of its input, its aligned array grows with each block
+  class GrowingFilter final : public ATK::TypedBaseFilter<double>
+  {
+  public:
+    GrowingFilter()
+    :TypedBaseFilter<double>(1, 1)
+    {
+    }
+
+  protected:
+    void process_impl(gsl::index size) const final
+    {
+      history.reserve(history.capacity() + size);
+      history.insert(history.end(), converted_inputs[0], converted_inputs[0] + size);
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        outputs[0][i] = history[history.size() - size + i];
+      }
+    }
+
+  private:
+    mutable AlignedVector history;
+  };
+
+  /// A generator, a derivative and a volume
+  class Chain
+  {
+  public:
+    Chain(const std::vector<double>& input, std::vector<double>& output)
+    :generator(input.data(), 1, input.size(), false), sink(output.data(), 1, output.size(), false)
+    {
+      generator.set_output_sampling_rate(48000);
+      derivative.set_input_sampling_rate(48000);
+      derivative.set_input_port(0, &generator, 0);
+      volume.set_input_sampling_rate(48000);
+      volume.set_volume(.5);
+      volume.set_input_port(0, &derivative, 0);
+      sink.set_input_sampling_rate(48000);
+      sink.set_input_port(0, &volume, 0);
+    }
+
+    ATK::InPointerFilter<double> generator;
+    ATK::DerivativeFilter<double> derivative;
+    ATK::VolumeFilter<double> volume;
+    ATK::OutPointerFilter<double> sink;
+  };
+}
+
+TEST(AllocationTripwire, max_block_size_test)
+{
+  std::vector<double> input(PROCESSSIZE);
+  std::vector<double> output(PROCESSSIZE);
+  Chain chain(input, output);
+  chain.sink.set_max_block_size(256);
+  ASSERT_EQ(chain.sink.get_max_block_size(), 256);
+  ASSERT_EQ(chain.derivative.get_max_block_size(), 256);
+  chain.sink.set_max_block_size(128);
+  ASSERT_EQ(chain.generator.get_max_block_size(), 256);
+}
+
+TEST(AllocationTripwire, preallocated_test)
+{
+  std::vector<double> input(PROCESSSIZE);
+  std::vector<double> output(PROCESSSIZE);
+  Chain chain(input, output);
+  chain.sink.set_max_block_size(256);
+  auto array = chain.derivative.get_output_array(0);
+  for(gsl::index size: {1, 256, 17, 128})
+  {
+    chain.sink.process(size);
+    ASSERT_EQ(array, chain.derivative.get_output_array(0));
+  }
+}
+
+TEST(AllocationTripwire, same_output_test)
+{
+  std::vector<double> input(PROCESSSIZE);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    input[i] = std::sin(i * 0.01);
+  }
+  std::vector<double> output1(PROCESSSIZE);
+  std::vector<double> output2(PROCESSSIZE);
+
+  Chain chain1(input, output1);
+  Chain chain2(input, output2);
+
+  gsl::index processed = 0;
+  for(gsl::index size: {10, 30, 20})
+  {
+    chain1.sink.process(size);
+    chain2.sink.process(size);
+    processed += size;
+  }
+  // The history of the derivative must be kept
+  chain2.sink.set_max_block_size(512);
+  for(gsl::index i = 0; processed + 200 <= PROCESSSIZE; ++i)
+  {
+    auto size = 200 + (i % 3) * 100 - 100;
+    chain1.sink.process(size);
+    chain2.sink.process(size);
+    processed += size;
+  }
+
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    ASSERT_EQ(output1[i], output2[i]);
+  }
+}
+
+TEST(AllocationTripwire, count_test)
+{
+  if(!ATK::AllocationTripwire::is_available())
+  {
+    GTEST_SKIP() << "AudioTK was built without ENABLE_ALLOCATION_TRIPWIRE";
+  }
+  ATK::AllocationTripwire tripwire;
+  ASSERT_EQ(tripwire.get_nb_allocations(), 0);
+  auto value = std::make_unique<double>(1);
+  ASSERT_EQ(tripwire.get_nb_allocations(), 1);
+  ASSERT_THROW(tripwire.check(), std::runtime_error);
+}
+
+TEST(AllocationTripwire, aligned_count_test)
+{
+  if(!ATK::AllocationTripwire::is_available())
+  {
+    GTEST_SKIP() << "AudioTK was built without ENABLE_ALLOCATION_TRIPWIRE";
+  }
+  ATK::AllocationTripwire tripwire;
+  ATK::TypedBaseFilter<double>::AlignedVector array(16);
+  ASSERT_EQ(tripwire.get_nb_allocations(), 1);
+  auto value = std::make_unique<std::max_align_t[]>(1);
+  ASSERT_EQ(tripwire.get_nb_allocations(), 2);
+}
+
+TEST(AllocationTripwire, allocation_free_test)
+{
+  if(!ATK::AllocationTripwire::is_available())
+  {
+    GTEST_SKIP() << "AudioTK was built without ENABLE_ALLOCATION_TRIPWIRE";
+  }
+  std::vector<double> input(PROCESSSIZE);
+  std::vector<double> output(PROCESSSIZE);
+  Chain chain(input, output);
+  chain.sink.set_max_block_size(256);
+  for(gsl::index i = 0; i < PROCESSSIZE; i += 256)
+  {
+    ASSERT_NO_THROW(chain.sink.process(256));
+  }
+}
+
+TEST(AllocationTripwire, allocating_filter_test)
+{
+  if(!ATK::AllocationTripwire::is_available())
+  {
+    GTEST_SKIP() << "AudioTK was built without ENABLE_ALLOCATION_TRIPWIRE";
+  }
+  std::vector<double> input(PROCESSSIZE);
+  std::vector<double> output(PROCESSSIZE);
+  ATK::InPointerFilter<double> generator(input.data(), 1, input.size(), false);
+  generator.set_output_sampling_rate(48000);
+  AllocatingFilter filter;
+  filter.set_input_sampling_rate(48000);
+  filter.set_input_port(0, &generator, 0);
+  ATK::OutPointerFilter<double> sink(output.data(), 1, output.size(), false);
+  sink.set_input_sampling_rate(48000);
+  sink.set_input_port(0, &filter, 0);
+
+  // Not checked without a maximum block size
+  ASSERT_NO_THROW(sink.process(64));
+  sink.set_max_block_size(64);
+  // Warm up
+  ASSERT_NO_THROW(sink.process(64));
+  ASSERT_THROW(sink.process(64), std::runtime_error);
+  // Not checked for bigger blocks
+  ASSERT_NO_THROW(sink.process(128));
+}
+
+TEST(AllocationTripwire, growing_filter_test)
+{
+  if(!ATK::AllocationTripwire::is_available())
+  {
+    GTEST_SKIP() << "AudioTK was built without ENABLE_ALLOCATION_TRIPWIRE";
+  }
+  std::vector<double> input(PROCESSSIZE);
+  std::vector<double> output(PROCESSSIZE);
+  ATK::InPointerFilter<double> generator(input.data(), 1, input.size(), false);
+  generator.set_output_sampling_rate(48000);
+  GrowingFilter filter;
+  filter.set_input_sampling_rate(48000);
+  filter.set_input_port(0, &generator, 0);
+  ATK::OutPointerFilter<double> sink(output.data(), 1, output.size(), false);
+  sink.set_input_sampling_rate(48000);
+  sink.set_input_port(0, &filter, 0);
+
+  sink.set_max_block_size(64);
+  // Warm up
+  ASSERT_NO_THROW(sink.process(64));
+  ASSERT_THROW(sink.process(64), std::runtime_error);
+}
+
+TEST(AllocationTripwire, plan_test)
+{
+  if(!ATK::AllocationTripwire::is_available())
+  {
+    GTEST_SKIP() << "AudioTK was built without ENABLE_ALLOCATION_TRIPWIRE";
+  }
+  std::vector<double> input(PROCESSSIZE);
+  std::vector<double> output(PROCESSSIZE);
+  Chain chain(input, output);
+  ATK::ExecutionPlan plan(&chain.sink);
+  plan.compile();
+  plan.set_max_block_size(256);
+  for(gsl::index i = 0; i < PROCESSSIZE; i += 128)
+  {
+    ASSERT_NO_THROW(plan.process(128));
+  }
+}
@@ -0,0 +1,375 @@
+/**
+ * \file ExecutionPlan.cpp
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <ATK/Core/ExecutionPlan.h>
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+
+#include <ATK/Mock/TriangleCheckerFilter.h>
+#include <ATK/Mock/TriangleGeneratorFilter.h>
+
+#include <ATK/Tools/DerivativeFilter.h>
+#include <ATK/Tools/SumFilter.h>
+#include <ATK/Tools/VolumeFilter.h>
+
+#include <gtest/gtest.h>
+
+constexpr gsl::index PROCESSSIZE = (1024 * 64);
+
+TEST(ExecutionPlan, constructor_test)
+{
+  ASSERT_NO_THROW(ATK::ExecutionPlan plan);
+}
+
+TEST(ExecutionPlan, not_compiled_test)
+{
+  ATK::TriangleGeneratorFilter<int64_t> generator;
+  generator.set_output_sampling_rate(48000);
+
+  ATK::ExecutionPlan plan(&generator);
+  ASSERT_FALSE(plan.is_compiled());
+  ASSERT_THROW(plan.process(PROCESSSIZE), std::runtime_error);
+}
+
+TEST(ExecutionPlan, empty_test)
+{
+  ATK::ExecutionPlan plan;
+  ASSERT_THROW(plan.compile(), std::runtime_error);
+}
+
+TEST(ExecutionPlan, add_remove_sink_test)
+{
+  ATK::TriangleCheckerFilter<int64_t> checker;
+
+  ATK::ExecutionPlan plan;
+  ASSERT_NO_THROW(plan.add_sink(&checker));
+  ASSERT_THROW(plan.add_sink(&checker), std::runtime_error);
+  ASSERT_NO_THROW(plan.remove_sink(&checker));
+  ASSERT_THROW(plan.remove_sink(&checker), std::runtime_error);
+}
+
+TEST(ExecutionPlan, unconnected_test)
+{
+  ATK::TriangleCheckerFilter<int64_t> checker;
+  checker.set_input_sampling_rate(48000);
+
+  ATK::ExecutionPlan plan(&checker);
+  ASSERT_THROW(plan.compile(), std::runtime_error);
+}
+
+TEST(ExecutionPlan, sampling_rate_mismatch_test)
+{
+  ATK::TriangleGeneratorFilter<int64_t> generator;
+  generator.set_output_sampling_rate(48000);
+
+  ATK::TriangleCheckerFilter<int64_t> checker;
+  checker.set_input_sampling_rate(48000);
+  checker.set_input_port(0, &generator, 0);
+  generator.set_output_sampling_rate(44100);
+
+  ATK::ExecutionPlan plan(&checker);
+  ASSERT_THROW(plan.compile(), std::runtime_error);
+}
+
+TEST(ExecutionPlan, triangle_test)
+{
+  ATK::TriangleGeneratorFilter<int64_t> generator;
+  generator.set_output_sampling_rate(48000);
+  generator.set_amplitude(1000000);
+  generator.set_frequency(1000);
+
+  ATK::TriangleCheckerFilter<int64_t> checker;
+  checker.set_input_sampling_rate(48000);
+  checker.set_amplitude(1000000);
+  checker.set_frequency(1000);
+  checker.set_input_port(0, &generator, 0);
+
+  ATK::ExecutionPlan plan(&checker);
+  plan.compile();
+  ASSERT_EQ(plan.get_nb_nodes(), 2);
+  ASSERT_EQ(plan.get_node(0), &generator);
+  ASSERT_EQ(plan.get_node(1), &checker);
+
+  for(gsl::index i = 0; i < PROCESSSIZE; i += 64)
+  {
+    plan.process(64);
+  }
+}
+
+TEST(ExecutionPlan, 2sinks_test)
+{
+  ATK::TriangleGeneratorFilter<int64_t> generator;
+  generator.set_output_sampling_rate(48000);
+  generator.set_amplitude(1000000);
+  generator.set_frequency(1000);
+
+  ATK::TriangleCheckerFilter<int64_t> checker1;
+  checker1.set_input_sampling_rate(48000);
+  checker1.set_amplitude(1000000);
+  checker1.set_frequency(1000);
+  checker1.set_input_port(0, &generator, 0);
+
+  ATK::TriangleCheckerFilter<int64_t> checker2;
+  checker2.set_input_sampling_rate(48000);
+  checker2.set_amplitude(1000000);
+  checker2.set_frequency(1000);
+  checker2.set_input_port(0, &generator, 0);
+
+  ATK::ExecutionPlan plan;
+  plan.add_sink(&checker1);
+  plan.add_sink(&checker2);
+  plan.compile();
+  ASSERT_EQ(plan.get_nb_nodes(), 3);
+  ASSERT_EQ(plan.get_node_index(&generator), 0);
+
+  for(gsl::index i = 0; i < PROCESSSIZE; i += 64)
+  {
+    plan.process(64);
+  }
+}
+
+TEST(ExecutionPlan, diamond_test)
+{
+  ATK::TriangleGeneratorFilter<double> generator;
+  generator.set_output_sampling_rate(48000);
+  generator.set_amplitude(1000);
+  generator.set_frequency(1000);
+
+  ATK::VolumeFilter<double> volume;
+  volume.set_input_sampling_rate(48000);
+  volume.set_volume(-1);
+  volume.set_input_port(0, &generator, 0);
+
+  ATK::SumFilter<double> sum;
+  sum.set_input_sampling_rate(48000);
+  sum.set_input_port(0, &generator, 0);
+  sum.set_input_port(1, &volume, 0);
+
+  ATK::SumFilter<double> sum2;
+  sum2.set_input_sampling_rate(48000);
+  sum2.set_input_port(0, &sum, 0);
+  sum2.set_input_port(1, &generator, 0);
+
+  ATK::ExecutionPlan plan(&sum2);
+  plan.compile();
+  ASSERT_EQ(plan.get_nb_nodes(), 4);
+  ASSERT_LT(plan.get_node_index(&generator), plan.get_node_index(&volume));
+  ASSERT_LT(plan.get_node_index(&volume), plan.get_node_index(&sum));
+
+  ATK::TriangleGeneratorFilter<double> reference;
+  reference.set_output_sampling_rate(48000);
+  reference.set_amplitude(1000);
+  reference.set_frequency(1000);
+
+  for(gsl::index i = 0; i < 1024; ++i)
+  {
+    plan.process(64);
+    reference.process(64);
+    for(gsl::index j = 0; j < 64; ++j)
+    {
+      ASSERT_EQ(reference.get_output_array(0)[j], sum2.get_output_array(0)[j]);
+    }
+  }
+}
+
+TEST(ExecutionPlan, same_as_recursive_test)
+{
+  std::vector<double> input(PROCESSSIZE);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    input[i] = std::sin(i * 0.001);
+  }
+  std::vector<double> output1(PROCESSSIZE);
+  std::vector<double> output2(PROCESSSIZE);
+
+  ATK::InPointerFilter<double> generator1(input.data(), 1, PROCESSSIZE, false);
+  generator1.set_output_sampling_rate(48000);
+  ATK::VolumeFilter<double> volume1;
+  volume1.set_input_sampling_rate(48000);
+  volume1.set_volume(.5);
+  volume1.set_input_port(0, &generator1, 0);
+  ATK::OutPointerFilter<double> sink1(output1.data(), 1, PROCESSSIZE, false);
+  sink1.set_input_sampling_rate(48000);
+  sink1.set_input_port(0, &volume1, 0);
+
+  ATK::InPointerFilter<double> generator2(input.data(), 1, PROCESSSIZE, false);
+  generator2.set_output_sampling_rate(48000);
+  ATK::VolumeFilter<double> volume2;
+  volume2.set_input_sampling_rate(48000);
+  volume2.set_volume(.5);
+  volume2.set_input_port(0, &generator2, 0);
+  ATK::OutPointerFilter<double> sink2(output2.data(), 1, PROCESSSIZE, false);
+  sink2.set_input_sampling_rate(48000);
+  sink2.set_input_port(0, &volume2, 0);
+
+  ATK::ExecutionPlan plan(&sink1);
+  plan.compile();
+
+  for(gsl::index i = 0; i < PROCESSSIZE; i += 32)
+  {
+    plan.process(32);
+    sink2.process(32);
+  }
+
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    ASSERT_EQ(output1[i], output2[i]);
+  }
+}
+
+TEST(ExecutionPlan, buffer_aliasing_test)
+{
+  std::vector<double> input(PROCESSSIZE);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    input[i] = std::sin(i * 0.001);
+  }
+  std::vector<double> output(PROCESSSIZE);
+
+  ATK::InPointerFilter<double> generator(input.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(48000);
+  ATK::VolumeFilter<double> volume1;
+  volume1.set_input_sampling_rate(48000);
+  volume1.set_volume(.5);
+  volume1.set_input_port(0, &generator, 0);
+  ATK::VolumeFilter<double> volume2;
+  volume2.set_input_sampling_rate(48000);
+  volume2.set_volume(3);
+  volume2.set_input_port(0, &volume1, 0);
+  ATK::VolumeFilter<double> volume3;
+  volume3.set_input_sampling_rate(48000);
+  volume3.set_volume(-2);
+  volume3.set_input_port(0, &volume2, 0);
+  ATK::SumFilter<double> sum;
+  sum.set_input_sampling_rate(48000);
+  sum.set_input_port(0, &volume1, 0);
+  sum.set_input_port(1, &volume3, 0);
+  ATK::OutPointerFilter<double> sink(output.data(), 1, PROCESSSIZE, false);
+  sink.set_input_sampling_rate(48000);
+  sink.set_input_port(0, &sum, 0);
+
+  ATK::ExecutionPlan plan(&sink);
+  plan.set_buffer_aliasing(true);
+  ASSERT_TRUE(plan.get_buffer_aliasing());
+  plan.compile();
+
+  for(gsl::index i = 0; i < PROCESSSIZE; i += 32)
+  {
+    plan.process(32);
+    // volume1 is also read by the sum, volume3 can reuse the array of volume2
+    ASSERT_NE(volume1.get_output_array(0), volume2.get_output_array(0));
+    ASSERT_EQ(volume2.get_output_array(0), volume3.get_output_array(0));
+  }
+
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    ASSERT_NEAR(-2.5 * input[i], output[i], 1e-12);
+  }
+}
+
+TEST(ExecutionPlan, converted_bytes_test)
+{
+  std::vector<double> input(PROCESSSIZE);
+  std::vector<double> output(PROCESSSIZE);
+
+  ATK::InPointerFilter<double> generator(input.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(48000);
+  ATK::DerivativeFilter<double> derivative;
+  derivative.set_input_sampling_rate(48000);
+  derivative.set_input_port(0, &generator, 0);
+  ATK::OutPointerFilter<double> sink(output.data(), 1, PROCESSSIZE, false);
+  sink.set_input_sampling_rate(48000);
+  sink.set_input_port(0, &derivative, 0);
+
+  ATK::ExecutionPlan plan(&sink);
+  plan.compile();
+  plan.process(64);
+  // The derivative needs more history than the generator keeps
+  ASSERT_EQ(plan.get_converted_bytes(), 64 * sizeof(double));
+
+  plan.reset_converted_bytes();
+  plan.set_buffer_aliasing(true);
+  plan.compile();
+  ASSERT_EQ(generator.get_output_delay(), 1);
+  plan.process(64);
+  ASSERT_EQ(plan.get_converted_bytes(), 0);
+}
+
+TEST(ExecutionPlan, output_delay_restored_test)
+{
+  std::vector<double> input(PROCESSSIZE);
+  std::vector<double> output(PROCESSSIZE);
+
+  ATK::InPointerFilter<double> generator(input.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(48000);
+  ATK::DerivativeFilter<double> derivative;
+  derivative.set_input_sampling_rate(48000);
+  derivative.set_input_port(0, &generator, 0);
+  ATK::OutPointerFilter<double> sink(output.data(), 1, PROCESSSIZE, false);
+  sink.set_input_sampling_rate(48000);
+  sink.set_input_port(0, &derivative, 0);
+
+  {
+    ATK::ExecutionPlan plan(&sink);
+    plan.set_buffer_aliasing(true);
+    plan.compile();
+    ASSERT_EQ(generator.get_output_delay(), 1);
+    plan.set_buffer_aliasing(false);
+    plan.compile();
+    ASSERT_EQ(generator.get_output_delay(), 0);
+    plan.set_buffer_aliasing(true);
+    plan.compile();
+    ASSERT_EQ(generator.get_output_delay(), 1);
+  }
+  ASSERT_EQ(generator.get_output_delay(), 0);
+
+  // The delay set on the filter is kept
+  generator.set_output_delay(3);
+  {
+    ATK::ExecutionPlan plan(&sink);
+    plan.set_buffer_aliasing(true);
+    plan.compile();
+    ASSERT_EQ(generator.get_output_delay(), 3);
+  }
+  ASSERT_EQ(generator.get_output_delay(), 3);
+}
+
+TEST(ExecutionPlan, exclusive_reconnect_test)
+{
+  std::vector<double> input(PROCESSSIZE, 1);
+  std::vector<double> output(PROCESSSIZE);
+
+  ATK::InPointerFilter<double> generator(input.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(48000);
+  ATK::VolumeFilter<double> volume1;
+  volume1.set_input_sampling_rate(48000);
+  volume1.set_volume(.5);
+  volume1.set_input_port(0, &generator, 0);
+  ATK::VolumeFilter<double> volume2;
+  volume2.set_input_sampling_rate(48000);
+  volume2.set_volume(3);
+  volume2.set_input_port(0, &volume1, 0);
+  ATK::OutPointerFilter<double> sink(output.data(), 1, PROCESSSIZE, false);
+  sink.set_input_sampling_rate(48000);
+  sink.set_input_port(0, &volume2, 0);
+
+  ATK::ExecutionPlan plan(&sink);
+  plan.set_buffer_aliasing(true);
+  plan.compile();
+  plan.process(32);
+  ASSERT_EQ(volume1.get_output_array(0), volume2.get_output_array(0));
+
+  // A new reader of volume1 makes its array shared again, even before the plan is compiled again
+  ATK::VolumeFilter<double> volume3;
+  volume3.set_input_sampling_rate(48000);
+  volume3.set_input_port(0, &volume1, 0);
+  plan.process(32);
+  ASSERT_NE(volume1.get_output_array(0), volume2.get_output_array(0));
+  ASSERT_EQ(.5, volume1.get_output_array(0)[31]);
+  ASSERT_EQ(1.5, output[63]);
+}
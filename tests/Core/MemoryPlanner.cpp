@@ -0,0 +1,185 @@
+/**
+ * \file MemoryPlanner.cpp
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <ATK/Core/ExecutionPlan.h>
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/MemoryPlanner.h>
+#include <ATK/Core/OutPointerFilter.h>
+#include <ATK/Core/ParallelExecutionPlan.h>
+
+#include <ATK/Tools/DerivativeFilter.h>
+#include <ATK/Tools/SumFilter.h>
+#include <ATK/Tools/VolumeFilter.h>
+
+#include <gtest/gtest.h>
+
+constexpr gsl::index PROCESSSIZE = (1024 * 64);
+
+namespace
+{
+  /// A chain of volumes and derivatives, with a sum of the first and last stages
+  class Chain
+  {
+  public:
+    Chain(const std::vector<double>& input, std::vector<double>& output, gsl::index nb_stages)
+    :generator(input.data(), 1, input.size(), false), sink(output.data(), 1, output.size(), false)
+    {
+      generator.set_output_sampling_rate(48000);
+      BaseFilter* previous = &generator;
+      for(gsl::index i = 0; i < nb_stages; ++i)
+      {
+        std::unique_ptr<ATK::TypedBaseFilter<double>> filter;
+        if(i % 3 == 2)
+        {
+          filter = std::make_unique<ATK::DerivativeFilter<double>>();
+        }
+        else
+        {
+          auto volume = std::make_unique<ATK::VolumeFilter<double>>();
+          volume->set_volume(i % 2 == 0 ? 2. : .5);
+          filter = std::move(volume);
+        }
+        filter->set_input_sampling_rate(48000);
+        filter->set_input_port(0, previous, 0);
+        previous = filter.get();
+        filters.push_back(std::move(filter));
+      }
+      sum.set_input_sampling_rate(48000);
+      sum.set_input_port(0, filters.front().get(), 0);
+      sum.set_input_port(1, previous, 0);
+      sink.set_input_sampling_rate(48000);
+      sink.set_input_port(0, &sum, 0);
+    }
+
+    using BaseFilter = ATK::BaseFilter;
+    ATK::InPointerFilter<double> generator;
+    std::vector<std::unique_ptr<ATK::TypedBaseFilter<double>>> filters;
+    ATK::SumFilter<double> sum;
+    ATK::OutPointerFilter<double> sink;
+  };
+}
+
+TEST(MemoryPlanner, not_compiled_test)
+{
+  ATK::ExecutionPlan plan;
+  ATK::MemoryPlanner planner(plan);
+  ASSERT_THROW(planner.plan(64), std::runtime_error);
+}
+
+TEST(MemoryPlanner, parallel_test)
+{
+  std::vector<double> input(PROCESSSIZE);
+  std::vector<double> output(PROCESSSIZE);
+  Chain chain(input, output, 4);
+
+  ATK::ParallelExecutionPlan plan(1);
+  plan.add_sink(&chain.sink);
+  plan.compile();
+  ATK::MemoryPlanner planner(plan);
+  ASSERT_THROW(planner.plan(64), std::runtime_error);
+}
+
+TEST(MemoryPlanner, chain_test)
+{
+  std::vector<double> input(PROCESSSIZE);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    input[i] = std::sin(i * 0.001);
+  }
+  std::vector<double> output1(PROCESSSIZE);
+  std::vector<double> output2(PROCESSSIZE);
+
+  Chain chain1(input, output1, 20);
+  ATK::ExecutionPlan plan1(&chain1.sink);
+  plan1.compile();
+
+  Chain chain2(input, output2, 20);
+  ATK::ExecutionPlan plan2(&chain2.sink);
+  plan2.compile();
+  ATK::MemoryPlanner planner(plan2);
+  planner.plan(256);
+  ASSERT_GT(planner.get_planned_size(), 0);
+  ASSERT_LT(planner.get_planned_size(), planner.get_unplanned_size() / 2);
+
+  for(gsl::index i = 0; i < PROCESSSIZE; i += 256)
+  {
+    plan1.process(256);
+    plan2.process(256);
+  }
+
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    ASSERT_EQ(output1[i], output2[i]);
+  }
+}
+
+TEST(MemoryPlanner, buffer_aliasing_test)
+{
+  std::vector<double> input(PROCESSSIZE);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    input[i] = std::sin(i * 0.001);
+  }
+  std::vector<double> output1(PROCESSSIZE);
+  std::vector<double> output2(PROCESSSIZE);
+
+  Chain chain1(input, output1, 20);
+  ATK::ExecutionPlan plan1(&chain1.sink);
+  plan1.compile();
+  ATK::MemoryPlanner planner1(plan1);
+  planner1.plan(256);
+
+  Chain chain2(input, output2, 20);
+  ATK::ExecutionPlan plan2(&chain2.sink);
+  plan2.set_buffer_aliasing(true);
+  plan2.compile();
+  ATK::MemoryPlanner planner2(plan2);
+  planner2.plan(256);
+  ASSERT_LT(planner2.get_unplanned_size(), planner1.get_unplanned_size());
+
+  for(gsl::index i = 0; i < PROCESSSIZE; i += 256)
+  {
+    plan1.process(256);
+    plan2.process(256);
+  }
+
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    ASSERT_EQ(output1[i], output2[i]);
+  }
+}
+
+TEST(MemoryPlanner, too_big_test)
+{
+  std::vector<double> input(PROCESSSIZE);
+  std::vector<double> output(PROCESSSIZE);
+  Chain chain(input, output, 4);
+
+  ATK::ExecutionPlan plan(&chain.sink);
+  plan.compile();
+  ATK::MemoryPlanner planner(plan);
+  planner.plan(64);
+  ASSERT_NO_THROW(plan.process(32));
+  ASSERT_THROW(plan.process(128), std::runtime_error);
+}
+
+TEST(MemoryPlanner, release_test)
+{
+  std::vector<double> input(PROCESSSIZE);
+  std::vector<double> output(PROCESSSIZE);
+  Chain chain(input, output, 4);
+
+  ATK::ExecutionPlan plan(&chain.sink);
+  plan.compile();
+  ATK::MemoryPlanner planner(plan);
+  planner.plan(64);
+  planner.release();
+  ASSERT_EQ(planner.get_planned_size(), 0);
+  ASSERT_NO_THROW(plan.process(128));
+}
@@ -0,0 +1,209 @@
+/**
+ * \file ParallelExecutionPlan.cpp
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+#include <ATK/Core/ParallelExecutionPlan.h>
+#include <ATK/Core/TypedBaseFilter.h>
+#include <ATK/Core/Utilities.h>
+
+#include <ATK/Mock/TriangleCheckerFilter.h>
+#include <ATK/Mock/TriangleGeneratorFilter.h>
+
+#include <ATK/Tools/SumFilter.h>
+#include <ATK/Tools/VolumeFilter.h>
+
+#include <gtest/gtest.h>
+
+constexpr gsl::index PROCESSSIZE = (1024 * 64);
+
+namespace
+{
+  /// Input split in several branches of two volumes that are then summed back together
+  class Branches
+  {
+  public:
+    Branches(const std::vector<double>& input, std::vector<double>& output, gsl::index nb_branches)
+    :generator(input.data(), 1, input.size(), false), sink(output.data(), 1, output.size(), false)
+    {
+      generator.set_output_sampling_rate(48000);
+      for(gsl::index i = 0; i < nb_branches; ++i)
+      {
+        auto volume1 = std::make_unique<ATK::VolumeFilter<double>>();
+        volume1->set_input_sampling_rate(48000);
+        volume1->set_volume(i + 1);
+        volume1->set_input_port(0, &generator, 0);
+        auto volume2 = std::make_unique<ATK::VolumeFilter<double>>();
+        volume2->set_input_sampling_rate(48000);
+        volume2->set_volume(1. / (nb_branches * (i + 1)));
+        volume2->set_input_port(0, volume1.get(), 0);
+        volumes.push_back(std::move(volume1));
+        volumes.push_back(std::move(volume2));
+      }
+      sum = std::make_unique<ATK::SumFilter<double>>(1, nb_branches);
+      sum->set_input_sampling_rate(48000);
+      for(gsl::index i = 0; i < nb_branches; ++i)
+      {
+        sum->set_input_port(i, volumes[2 * i + 1].get(), 0);
+      }
+      sink.set_input_sampling_rate(48000);
+      sink.set_input_port(0, sum.get(), 0);
+    }
+
+    ATK::InPointerFilter<double> generator;
+    std::vector<std::unique_ptr<ATK::VolumeFilter<double>>> volumes;
+    std::unique_ptr<ATK::SumFilter<double>> sum;
+    ATK::OutPointerFilter<double> sink;
+  };
+
+  /// Copies its input, or throws when asked to
+  class ThrowingFilter final : public ATK::TypedBaseFilter<double>
+  {
+  public:
+    ThrowingFilter()
+    :TypedBaseFilter<double>(1, 1)
+    {
+    }
+
+    bool must_throw = false;
+
+  protected:
+    void process_impl(gsl::index size) const final
+    {
+      if(must_throw)
+      {
+        throw ATK::RuntimeError("Processing failed");
+      }
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        outputs[0][i] = converted_inputs[0][i];
+      }
+    }
+  };
+
+  void check_branches(gsl::index nb_threads, gsl::index nb_branches, gsl::index block_size)
+  {
+    std::vector<double> input(PROCESSSIZE);
+    for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+    {
+      input[i] = std::sin(i * 0.001);
+    }
+    std::vector<double> output(PROCESSSIZE);
+
+    Branches branches(input, output, nb_branches);
+    ATK::ParallelExecutionPlan plan(nb_threads);
+    plan.add_sink(&branches.sink);
+    plan.compile();
+    ASSERT_EQ(plan.get_nb_threads(), nb_threads);
+    ASSERT_EQ(plan.get_nb_nodes(), 2 * nb_branches + 3);
+
+    for(gsl::index i = 0; i < PROCESSSIZE; i += block_size)
+    {
+      plan.process(block_size);
+    }
+
+    for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+    {
+      ASSERT_NEAR(input[i], output[i], 1e-10);
+    }
+  }
+}
+
+TEST(ParallelExecutionPlan, constructor_test)
+{
+  ATK::ParallelExecutionPlan plan;
+  ASSERT_GE(plan.get_nb_threads(), 1);
+}
+
+TEST(ParallelExecutionPlan, not_compiled_test)
+{
+  ATK::TriangleGeneratorFilter<int64_t> generator;
+  generator.set_output_sampling_rate(48000);
+
+  ATK::ParallelExecutionPlan plan(2);
+  plan.add_sink(&generator);
+  ASSERT_THROW(plan.process(PROCESSSIZE), std::runtime_error);
+}
+
+TEST(ParallelExecutionPlan, 2sinks_test)
+{
+  ATK::TriangleGeneratorFilter<int64_t> generator;
+  generator.set_output_sampling_rate(48000);
+  generator.set_amplitude(1000000);
+  generator.set_frequency(1000);
+
+  ATK::TriangleCheckerFilter<int64_t> checker1;
+  checker1.set_input_sampling_rate(48000);
+  checker1.set_amplitude(1000000);
+  checker1.set_frequency(1000);
+  checker1.set_input_port(0, &generator, 0);
+
+  ATK::TriangleCheckerFilter<int64_t> checker2;
+  checker2.set_input_sampling_rate(48000);
+  checker2.set_amplitude(1000000);
+  checker2.set_frequency(1000);
+  checker2.set_input_port(0, &generator, 0);
+
+  ATK::ParallelExecutionPlan plan(2);
+  plan.add_sink(&checker1);
+  plan.add_sink(&checker2);
+  plan.compile();
+
+  for(gsl::index i = 0; i < PROCESSSIZE; i += 64)
+  {
+    plan.process(64);
+  }
+}
+
+TEST(ParallelExecutionPlan, 1thread_test)
+{
+  check_branches(1, 4, 64);
+}
+
+TEST(ParallelExecutionPlan, 2threads_test)
+{
+  check_branches(2, 4, 64);
+}
+
+TEST(ParallelExecutionPlan, 4threads_test)
+{
+  check_branches(4, 8, 32);
+}
+
+TEST(ParallelExecutionPlan, 8threads_test)
+{
+  check_branches(8, 16, 256);
+}
+
+TEST(ParallelExecutionPlan, exception_test)
+{
+  std::vector<double> input(PROCESSSIZE, 1);
+  std::vector<double> output(PROCESSSIZE);
+  Branches branches(input, output, 8);
+  ThrowingFilter thrower;
+  thrower.set_input_sampling_rate(48000);
+  thrower.set_input_port(0, branches.volumes[5].get(), 0);
+  branches.sum->set_input_port(2, &thrower, 0);
+
+  ATK::ParallelExecutionPlan plan(4);
+  plan.add_sink(&branches.sink);
+  plan.compile();
+
+  plan.process(64);
+  thrower.must_throw = true;
+  for(int i = 0; i < 10; ++i)
+  {
+    ASSERT_THROW(plan.process(64), ATK::RuntimeError);
+  }
+  // The plan can still process the next blocks
+  thrower.must_throw = false;
+  plan.process(64);
+  plan.process(64);
+  ASSERT_NEAR(1, output[3 * 64 - 1], 1e-10);
+}
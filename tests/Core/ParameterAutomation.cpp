@@ -0,0 +1,197 @@
+/**
+ * \file ParameterAutomation.cpp
+ */
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+#include <ATK/Core/ParameterAutomation.h>
+#include <ATK/Core/SmoothedParameter.h>
+#include <ATK/Core/SPSCQueue.h>
+
+#include <ATK/Tools/VolumeFilter.h>
+
+#include <gtest/gtest.h>
+
+constexpr gsl::index PROCESSSIZE = 1024;
+
+namespace
+{
+  /// A constant signal through a volume filter
+  class VolumePipeline
+  {
+  public:
+    VolumePipeline()
+    :input(PROCESSSIZE, 1), output(PROCESSSIZE), generator(input.data(), 1, PROCESSSIZE, false), sink(output.data(), 1, PROCESSSIZE, false)
+    {
+      generator.set_output_sampling_rate(48000);
+      volume.set_input_sampling_rate(48000);
+      volume.set_input_port(0, generator, 0);
+      sink.set_input_sampling_rate(48000);
+      sink.set_input_port(0, volume, 0);
+    }
+
+    std::vector<double> input;
+    std::vector<double> output;
+    ATK::InPointerFilter<double> generator;
+    ATK::VolumeFilter<double> volume;
+    ATK::OutPointerFilter<double> sink;
+  };
+}
+
+TEST(SPSCQueue, push_pop_test)
+{
+  ATK::SPSCQueue<int> queue(3);
+  ASSERT_EQ(queue.get_capacity(), 4);
+  ASSERT_TRUE(queue.empty());
+  for(int i = 0; i < 4; ++i)
+  {
+    ASSERT_TRUE(queue.push(i));
+  }
+  ASSERT_FALSE(queue.push(4));
+  int value = 0;
+  for(int i = 0; i < 4; ++i)
+  {
+    ASSERT_TRUE(queue.pop(value));
+    ASSERT_EQ(value, i);
+  }
+  ASSERT_FALSE(queue.pop(value));
+}
+
+TEST(SPSCQueue, threads_test)
+{
+  ATK::SPSCQueue<int> queue(16);
+  constexpr int nb_values = 10000;
+  std::thread producer([&queue]()
+  {
+    for(int i = 0; i < nb_values; )
+    {
+      if(queue.push(i))
+      {
+        ++i;
+      }
+      else
+      {
+        std::this_thread::yield();
+      }
+    }
+  });
+  for(int i = 0; i < nb_values; )
+  {
+    int value = 0;
+    if(queue.pop(value))
+    {
+      ASSERT_EQ(value, i);
+      ++i;
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+}
+
+TEST(SmoothedParameter, linear_test)
+{
+  ATK::SmoothedParameter<double> parameter(1, ATK::Smoothing::Linear, 10);
+  parameter.set_target(2);
+  ASSERT_TRUE(parameter.is_smoothing());
+  ASSERT_NEAR(parameter.advance(5), 1.5, 1e-12);
+  ASSERT_NEAR(parameter.advance(4), 1.9, 1e-12);
+  ASSERT_EQ(parameter.advance(), 2);
+  ASSERT_FALSE(parameter.is_smoothing());
+}
+
+TEST(SmoothedParameter, exponential_test)
+{
+  ATK::SmoothedParameter<double> parameter(100, ATK::Smoothing::Exponential, 10);
+  parameter.set_target(10000);
+  ASSERT_NEAR(parameter.advance(5), 1000, 1e-9);
+  ASSERT_EQ(parameter.advance(5), 10000);
+  // Not the same sign, the ramp is linear
+  parameter.set_target(-10000);
+  ASSERT_NEAR(parameter.advance(5), 0, 1e-9);
+}
+
+TEST(ParameterAutomation, timestamp_test)
+{
+  VolumePipeline pipeline;
+  ATK::ParameterAutomation automation;
+  auto volume = automation.add_parameter(pipeline.volume, &ATK::VolumeFilter<double>::set_volume, .5);
+  ASSERT_EQ(pipeline.volume.get_volume(), .5);
+
+  ASSERT_TRUE(automation.set_parameter(volume, 2, 100));
+  ASSERT_TRUE(automation.set_parameter(volume, 3, PROCESSSIZE / 2 + 10));
+  automation.process(pipeline.sink, PROCESSSIZE / 2);
+  automation.process(pipeline.sink, PROCESSSIZE / 2);
+
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    ASSERT_EQ(pipeline.output[i], i < 100 ? .5 : (i < PROCESSSIZE / 2 + 10 ? 2 : 3));
+  }
+}
+
+TEST(ParameterAutomation, smoothing_test)
+{
+  VolumePipeline pipeline;
+  ATK::ParameterAutomation automation;
+  automation.set_control_period(1);
+  auto volume = automation.add_parameter(pipeline.volume, &ATK::VolumeFilter<double>::set_volume, 0, ATK::Smoothing::Linear, 100);
+
+  automation.set_parameter(volume, 1, 50);
+  automation.process(pipeline.sink, PROCESSSIZE);
+
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    ASSERT_NEAR(pipeline.output[i], std::min(std::max<gsl::index>(i - 50, 0), gsl::index(100)) / 100., 1e-12);
+  }
+}
+
+TEST(ParameterAutomation, control_period_test)
+{
+  VolumePipeline pipeline;
+  ATK::ParameterAutomation automation;
+  automation.set_control_period(16);
+  auto volume = automation.add_parameter(pipeline.volume, &ATK::VolumeFilter<double>::set_volume, 0, ATK::Smoothing::Linear, 100);
+
+  automation.set_parameter(volume, 1);
+  automation.process(pipeline.sink, PROCESSSIZE);
+
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    // The volume is updated every 16 samples and at the end of the ramp
+    ASSERT_NEAR(pipeline.output[i], i >= 100 ? 1 : i / 16 * 16 / 100., 1e-12);
+  }
+}
+
+TEST(ParameterAutomation, deferred_test)
+{
+  VolumePipeline pipeline;
+  ATK::ParameterAutomation automation;
+  auto processing_thread = std::this_thread::get_id();
+  double computed_volume = 1;
+  bool computed_on_worker = false;
+  auto volume = automation.add_deferred_parameter([&](double value){computed_volume = value * value; computed_on_worker = std::this_thread::get_id() != processing_thread;}, [&](){pipeline.volume.set_volume(computed_volume);});
+
+  automation.set_parameter(volume, 3);
+  for(int i = 0; i < 1000 && pipeline.volume.get_volume() != 9; ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    pipeline.generator.set_pointer(pipeline.input.data(), PROCESSSIZE);
+    pipeline.sink.set_pointer(pipeline.output.data(), PROCESSSIZE);
+    automation.process(pipeline.sink, 1);
+  }
+  ASSERT_EQ(pipeline.volume.get_volume(), 9);
+  ASSERT_TRUE(computed_on_worker);
+}
+
+TEST(ParameterAutomation, wrong_parameter_test)
+{
+  ATK::ParameterAutomation automation;
+  ASSERT_THROW(automation.set_parameter(0, 1), ATK::RuntimeError);
+  ASSERT_THROW(automation.set_control_period(0), ATK::RuntimeError);
+}
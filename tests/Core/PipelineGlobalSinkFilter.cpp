@@ -3,7 +3,10 @@
  */
 
 #include <cstdint>
+#include <vector>
 
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
 #include <ATK/Core/PipelineGlobalSinkFilter.h>
 
 #include <ATK/Mock/TriangleCheckerFilter.h>
@@ -103,3 +106,66 @@ TEST(PipelineGlobalSinkFilter, no_set_input_test)
   ATK::PipelineGlobalSinkFilter globalsink;
   ASSERT_THROW(globalsink.set_input_port(0, &generator, 0), std::runtime_error);
 }
+
+TEST(PipelineGlobalSinkFilter, 2sinks_parallel_test)
+{
+  ATK::TriangleGeneratorFilter<int64_t> generator;
+  generator.set_output_sampling_rate(48000);
+  generator.set_amplitude(1000000);
+  generator.set_frequency(1000);
+
+  ATK::TriangleCheckerFilter<int64_t> checker1;
+  checker1.set_input_sampling_rate(48000);
+  checker1.set_amplitude(1000000);
+  checker1.set_frequency(1000);
+  checker1.set_input_port(0, &generator, 0);
+
+  ATK::TriangleCheckerFilter<int64_t> checker2;
+  checker2.set_input_sampling_rate(48000);
+  checker2.set_amplitude(1000000);
+  checker2.set_frequency(1000);
+  checker2.set_input_port(0, &generator, 0);
+
+  ATK::PipelineGlobalSinkFilter globalsink;
+  globalsink.set_input_sampling_rate(48000);
+  globalsink.set_parallel(true, 2);
+  globalsink.add_filter(&checker1);
+  globalsink.add_filter(&checker2);
+  for(gsl::index i = 0; i < PROCESSSIZE; i += 1024)
+  {
+    globalsink.process(1024);
+  }
+}
+
+TEST(PipelineGlobalSinkFilter, parallel_add_remove_test)
+{
+  std::vector<double> input(4096, 1);
+  ATK::InPointerFilter<double> generator(input.data(), 1, input.size(), false);
+  generator.set_output_sampling_rate(48000);
+
+  std::vector<double> output1(4096);
+  ATK::OutPointerFilter<double> sink1(output1.data(), 1, output1.size(), false);
+  sink1.set_input_sampling_rate(48000);
+  sink1.set_input_port(0, &generator, 0);
+  std::vector<double> output2(4096);
+  ATK::OutPointerFilter<double> sink2(output2.data(), 1, output2.size(), false);
+  sink2.set_input_sampling_rate(48000);
+  sink2.set_input_port(0, &generator, 0);
+
+  ATK::PipelineGlobalSinkFilter globalsink;
+  globalsink.set_input_sampling_rate(48000);
+  globalsink.set_parallel(true, 2);
+  globalsink.add_filter(&sink1);
+  globalsink.process(1024);
+
+  // The plan is compiled again with the new sink
+  globalsink.add_filter(&sink2);
+  globalsink.process(1024);
+  ASSERT_EQ(1, output2[1023]);
+
+  globalsink.remove_filter(&sink1);
+  globalsink.process(1024);
+  ASSERT_EQ(1, output1[2047]);
+  ASSERT_EQ(0, output1[2048]);
+  ASSERT_EQ(1, output2[2047]);
+}
@@ -0,0 +1,166 @@
+/**
+ * \file FeedbackDelayNetworkFilter.cpp
+ */
+
+#include <ATK/Delay/FeedbackDelayNetworkFilter.h>
+#include <ATK/Delay/HadamardMixture.h>
+#include <ATK/Delay/HouseholderMixture.h>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+#include <ATK/Core/Utilities.h>
+
+#include <gtest/gtest.h>
+
+#include <boost/math/constants/constants.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+constexpr gsl::index PROCESSSIZE = 1024 * 8;
+constexpr gsl::index SAMPLING_RATE = 48000;
+constexpr gsl::index MAX_DELAY = 1000;
+
+namespace
+{
+  /// The mixture matrices, computed the slow way
+  std::vector<std::vector<double>> hadamard(gsl::index nb_channels)
+  {
+    if(nb_channels == 1)
+    {
+      return {{1}};
+    }
+    auto half = hadamard(nb_channels / 2);
+    std::vector<std::vector<double>> matrix(nb_channels, std::vector<double>(nb_channels));
+    for(gsl::index i = 0; i < nb_channels / 2; ++i)
+    {
+      for(gsl::index j = 0; j < nb_channels / 2; ++j)
+      {
+        matrix[i][j] = half[i][j];
+        matrix[i][j + nb_channels / 2] = half[i][j];
+        matrix[i + nb_channels / 2][j] = -half[i][j];
+        matrix[i + nb_channels / 2][j + nb_channels / 2] = half[i][j];
+      }
+    }
+    return matrix;
+  }
+
+  std::vector<std::vector<double>> householder(gsl::index nb_channels)
+  {
+    std::vector<std::vector<double>> matrix(nb_channels, std::vector<double>(nb_channels, -2. / nb_channels));
+    for(gsl::index i = 0; i < nb_channels; ++i)
+    {
+      matrix[i][i] += 1;
+    }
+    return matrix;
+  }
+
+  /// Compares the filter with a sample by sample network with modulated lines and damping
+  template<typename Mixture>
+  void check_fdn(const std::vector<std::vector<double>>& matrix, double scale, bool modulated)
+  {
+    constexpr auto nb_channels = Mixture::nb_channels;
+    std::vector<double> input(PROCESSSIZE);
+    for(auto& value: input)
+    {
+      value = static_cast<double>(std::rand()) / RAND_MAX - .5;
+    }
+
+    ATK::InPointerFilter<double> generator(input.data(), 1, PROCESSSIZE, false);
+    generator.set_output_sampling_rate(SAMPLING_RATE);
+
+    ATK::FeedbackDelayNetworkFilter<Mixture> filter(MAX_DELAY);
+    filter.set_input_sampling_rate(SAMPLING_RATE);
+    filter.set_input_port(0, generator, 0);
+
+    std::vector<double> delay(nb_channels), depth(nb_channels), frequency(nb_channels), damping(nb_channels);
+    std::vector<double> ingain(nb_channels), outgain(nb_channels), feedback(nb_channels);
+    for(gsl::index channel = 0; channel < nb_channels; ++channel)
+    {
+      delay[channel] = 100 + 37 * channel + (modulated ? .3 : 0);
+      depth[channel] = modulated ? 4 + channel : 0;
+      frequency[channel] = modulated ? 1 + .5 * channel : 0;
+      damping[channel] = modulated ? .1 * (channel % 5) : 0;
+      ingain[channel] = 1 - .05 * channel;
+      outgain[channel] = .5 + .03 * channel;
+      feedback[channel] = (.9 - .01 * channel) * Mixture::gain_factor;
+      filter.set_fractional_delay(channel, delay[channel]);
+      filter.set_modulation_depth(channel, depth[channel]);
+      filter.set_modulation_frequency(channel, frequency[channel]);
+      filter.set_damping(channel, damping[channel]);
+      filter.set_ingain(channel, ingain[channel]);
+      filter.set_outgain(channel, outgain[channel]);
+      filter.set_feedback(channel, feedback[channel] / Mixture::gain_factor);
+    }
+
+    std::vector<double> output(PROCESSSIZE);
+    ATK::OutPointerFilter<double> sink(output.data(), 1, PROCESSSIZE, false);
+    sink.set_input_sampling_rate(SAMPLING_RATE);
+    sink.set_input_port(0, filter, 0);
+    for(gsl::index processed = 0; processed < PROCESSSIZE; processed += 333)
+    {
+      sink.process(std::min<gsl::index>(333, PROCESSSIZE - processed));
+    }
+
+    std::vector<std::vector<double>> lines(nb_channels, std::vector<double>(PROCESSSIZE + MAX_DELAY));
+    std::vector<double> delayed(nb_channels), state(nb_channels);
+    for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+    {
+      double expected = 0;
+      for(gsl::index channel = 0; channel < nb_channels; ++channel)
+      {
+        auto phase = 2 * boost::math::constants::pi<double>() * (static_cast<double>(channel) / nb_channels + frequency[channel] * i / SAMPLING_RATE);
+        auto current_delay = delay[channel] + depth[channel] * std::sin(phase);
+        auto integer_delay = static_cast<gsl::index>(current_delay);
+        auto fraction = current_delay - integer_delay;
+        const auto& line = lines[channel];
+        auto value = line[MAX_DELAY + i - integer_delay] + fraction * (line[MAX_DELAY + i - integer_delay - 1] - line[MAX_DELAY + i - integer_delay]);
+        state[channel] = (1 - damping[channel]) * value + damping[channel] * state[channel];
+        delayed[channel] = state[channel];
+        expected += outgain[channel] * delayed[channel];
+      }
+      for(gsl::index channel = 0; channel < nb_channels; ++channel)
+      {
+        double mixed = 0;
+        for(gsl::index j = 0; j < nb_channels; ++j)
+        {
+          mixed += matrix[channel][j] * delayed[j];
+        }
+        lines[channel][MAX_DELAY + i] = ingain[channel] * input[i] + feedback[channel] * scale * mixed;
+      }
+      ASSERT_NEAR(expected, output[i], 1e-8);
+    }
+  }
+}
+
+TEST(FeedbackDelayNetworkFilter, hadamard_test)
+{
+  check_fdn<ATK::HadamardMixture<double, 4>>(hadamard(16), .25, false);
+}
+
+TEST(FeedbackDelayNetworkFilter, hadamard_modulated_test)
+{
+  check_fdn<ATK::HadamardMixture<double, 3>>(hadamard(8), 1 / std::sqrt(8.), true);
+}
+
+TEST(FeedbackDelayNetworkFilter, householder_test)
+{
+  check_fdn<ATK::HouseholderMixture<double, 4>>(householder(4), 1, false);
+}
+
+TEST(FeedbackDelayNetworkFilter, householder_modulated_test)
+{
+  check_fdn<ATK::HouseholderMixture<double, 16>>(householder(16), 1, true);
+}
+
+TEST(FeedbackDelayNetworkFilter, modulation_range_test)
+{
+  ATK::FeedbackDelayNetworkFilter<ATK::HouseholderMixture<double, 2>> filter(128);
+  filter.set_delay(0, 10);
+  ASSERT_THROW(filter.set_modulation_depth(0, 9.5), ATK::RuntimeError);
+  ASSERT_THROW(filter.set_modulation_depth(0, -1), ATK::RuntimeError);
+  filter.set_modulation_depth(0, 5);
+  ASSERT_THROW(filter.set_fractional_delay(0, 123.5), ATK::RuntimeError);
+  ASSERT_THROW(filter.set_damping(0, 1), ATK::RuntimeError);
+}
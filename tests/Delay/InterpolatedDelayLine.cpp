@@ -0,0 +1,183 @@
+/**
+ * \file InterpolatedDelayLine.cpp
+ */
+
+#include <ATK/Delay/InterpolatedDelayLine.h>
+#include <ATK/Delay/VariableDelayLineFilter.h>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+
+#include <gtest/gtest.h>
+
+#include <boost/math/constants/constants.hpp>
+
+#include <cmath>
+#include <vector>
+
+constexpr gsl::index PROCESSSIZE = 1024 * 8;
+
+namespace
+{
+  double sine(double position)
+  {
+    return std::sin(2 * boost::math::constants::pi<double>() * position / 48000 * 1000);
+  }
+
+  /// Delays a sine by a slowly varying fractional delay and compares it with the exact delayed sine
+  void check_interpolation(ATK::DelayInterpolation interpolation, double tolerance)
+  {
+    std::vector<double> input(PROCESSSIZE);
+    std::vector<double> delay(PROCESSSIZE);
+    for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+    {
+      input[i] = sine(i);
+      delay[i] = 20 + 10 * std::sin(2 * boost::math::constants::pi<double>() * i / PROCESSSIZE);
+    }
+
+    ATK::InterpolatedDelayLine<double> line(100);
+    line.set_interpolation(interpolation);
+    std::vector<double> output(PROCESSSIZE);
+    for(gsl::index processed = 0; processed < PROCESSSIZE; processed += 100)
+    {
+      line.process(input.data() + processed, delay.data() + processed, output.data() + processed, std::min<gsl::index>(100, PROCESSSIZE - processed));
+    }
+
+    // The beginning is skipped, the line starts with zeros
+    for(gsl::index i = 200; i < PROCESSSIZE; ++i)
+    {
+      ASSERT_NEAR(sine(i - delay[i]), output[i], tolerance);
+    }
+  }
+}
+
+TEST(InterpolatedDelayLine, linear_test)
+{
+  check_interpolation(ATK::DelayInterpolation::Linear, 3e-3);
+}
+
+TEST(InterpolatedDelayLine, lagrange_test)
+{
+  check_interpolation(ATK::DelayInterpolation::Lagrange, 1e-5);
+}
+
+TEST(InterpolatedDelayLine, thiran_test)
+{
+  check_interpolation(ATK::DelayInterpolation::Thiran, 2e-3);
+}
+
+TEST(InterpolatedDelayLine, sinc8_test)
+{
+  check_interpolation(ATK::DelayInterpolation::Sinc8, 1e-3);
+}
+
+TEST(InterpolatedDelayLine, sinc16_test)
+{
+  check_interpolation(ATK::DelayInterpolation::Sinc16, 1e-4);
+}
+
+TEST(InterpolatedDelayLine, min_delay_test)
+{
+  ATK::InterpolatedDelayLine<double> line(100);
+  ASSERT_EQ(line.get_min_delay(), 0);
+  line.set_interpolation(ATK::DelayInterpolation::Lagrange);
+  ASSERT_EQ(line.get_min_delay(), 1);
+  line.set_interpolation(ATK::DelayInterpolation::Sinc16);
+  ASSERT_EQ(line.get_min_delay(), 7);
+}
+
+TEST(InterpolatedDelayLine, wrap_test)
+{
+  // Blocks larger than the buffer, and a sample by sample processing
+  constexpr gsl::index max_delay = 3000;
+  std::vector<double> input(PROCESSSIZE);
+  std::vector<double> delay(PROCESSSIZE);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    input[i] = i;
+    delay[i] = static_cast<double>(i % (max_delay - 2)) + .5;
+  }
+
+  ATK::InterpolatedDelayLine<double> line(max_delay);
+  ATK::InterpolatedDelayLine<double> sequential_line(max_delay);
+  std::vector<double> output(PROCESSSIZE);
+  line.process(input.data(), delay.data(), output.data(), PROCESSSIZE);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    auto expected = std::max(i - delay[i], 0.);
+    ASSERT_NEAR(expected, output[i], 1e-9);
+    // The sample is not written yet
+    ASSERT_NEAR(std::max(expected - 1, 0.), sequential_line.read(delay[i] + 1), 1e-9);
+    sequential_line.push(input[i]);
+    ASSERT_EQ(sequential_line.get(1), input[i]);
+  }
+}
+
+TEST(InterpolatedDelayLine, comb_test)
+{
+  // The block comb matches the sample by sample read, get and push
+  std::vector<double> input(PROCESSSIZE);
+  std::vector<double> delay(PROCESSSIZE);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    input[i] = sine(i);
+    delay[i] = 20 + 10 * std::sin(2 * boost::math::constants::pi<double>() * i / PROCESSSIZE);
+  }
+
+  for(auto interpolation: {ATK::DelayInterpolation::Linear, ATK::DelayInterpolation::Lagrange, ATK::DelayInterpolation::Allpass, ATK::DelayInterpolation::Thiran, ATK::DelayInterpolation::Sinc8, ATK::DelayInterpolation::Sinc16})
+  {
+    ATK::InterpolatedDelayLine<double> line(100);
+    line.set_interpolation(interpolation);
+    ATK::InterpolatedDelayLine<double> sequential_line(100);
+    sequential_line.set_interpolation(interpolation);
+
+    std::vector<double> output(PROCESSSIZE);
+    for(gsl::index processed = 0; processed < PROCESSSIZE; processed += 100)
+    {
+      line.process_comb(input.data() + processed, delay.data() + processed, output.data() + processed, std::min<gsl::index>(100, PROCESSSIZE - processed), 15, .5, .7, .3);
+    }
+    for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+    {
+      auto delayed = sequential_line.read(delay[i]);
+      auto processed = input[i] + .5 * sequential_line.get(15);
+      sequential_line.push(processed);
+      ASSERT_EQ(.7 * processed + .3 * delayed, output[i]);
+    }
+  }
+}
+
+TEST(VariableDelayLineFilter, sinc_test)
+{
+  std::vector<double> input(PROCESSSIZE);
+  std::vector<double> delay(PROCESSSIZE, 10.5);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    input[i] = sine(i);
+  }
+
+  ATK::InPointerFilter<double> generator(input.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(48000);
+  ATK::InPointerFilter<double> generatordelay(delay.data(), 1, PROCESSSIZE, false);
+  generatordelay.set_output_sampling_rate(48000);
+
+  ATK::VariableDelayLineFilter<double> filter(20000);
+  filter.set_interpolation(ATK::DelayInterpolation::Sinc16);
+  ASSERT_EQ(filter.get_interpolation(), ATK::DelayInterpolation::Sinc16);
+  filter.set_input_sampling_rate(48000);
+  filter.set_input_port(0, generator, 0);
+  filter.set_input_port(1, generatordelay, 0);
+
+  std::vector<double> output(PROCESSSIZE);
+  ATK::OutPointerFilter<double> sink(output.data(), 1, PROCESSSIZE, false);
+  sink.set_input_sampling_rate(48000);
+  sink.set_input_port(0, filter, 0);
+  for(gsl::index processed = 0; processed < PROCESSSIZE; processed += 333)
+  {
+    sink.process(std::min<gsl::index>(333, PROCESSSIZE - processed));
+  }
+
+  for(gsl::index i = 100; i < PROCESSSIZE; ++i)
+  {
+    ASSERT_NEAR(sine(i - 10.5), output[i], 1e-4);
+  }
+}
@@ -0,0 +1,149 @@
+/**
+ * \file MultiTapDelayFilter.cpp
+ */
+
+#include <ATK/Delay/MultiTapDelayFilter.h>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+#include <ATK/Core/Utilities.h>
+
+#include <gtest/gtest.h>
+
+#include <boost/math/constants/constants.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+constexpr gsl::index PROCESSSIZE = 1024 * 8;
+constexpr gsl::index MAX_DELAY = 3000;
+
+namespace
+{
+  /// Compares the filter with a tap by tap, sample by sample sum
+  void check_taps(gsl::index nb_outputs, gsl::index block_size)
+  {
+    std::vector<double> input(PROCESSSIZE);
+    for(auto& value: input)
+    {
+      value = static_cast<double>(std::rand()) / RAND_MAX - .5;
+    }
+
+    ATK::InPointerFilter<double> generator(input.data(), 1, PROCESSSIZE, false);
+    generator.set_output_sampling_rate(48000);
+
+    ATK::MultiTapDelayFilter<double> filter(MAX_DELAY, nb_outputs);
+    filter.set_input_sampling_rate(48000);
+    filter.set_input_port(0, generator, 0);
+
+    std::vector<double> delays;
+    std::vector<double> gains;
+    std::vector<double> pans;
+    for(gsl::index tap = 0; tap < 64; ++tap)
+    {
+      delays.push_back(static_cast<double>(std::rand() % (MAX_DELAY - 1)) + (tap % 2 ? .25 : 0));
+      gains.push_back(static_cast<double>(std::rand()) / RAND_MAX - .5);
+      pans.push_back(2 * static_cast<double>(std::rand()) / RAND_MAX - 1);
+      ASSERT_EQ(tap, filter.add_tap(delays.back(), gains.back(), pans.back()));
+    }
+    // The limits of the delay line
+    delays.push_back(0);
+    gains.push_back(1);
+    pans.push_back(-1);
+    filter.add_tap(delays.back(), gains.back(), pans.back());
+    delays.push_back(MAX_DELAY - 1);
+    gains.push_back(1);
+    pans.push_back(1);
+    filter.add_tap(delays.back(), gains.back(), pans.back());
+    ASSERT_EQ(66, filter.get_nb_taps());
+
+    std::vector<double> output(nb_outputs * PROCESSSIZE);
+    ATK::OutPointerFilter<double> sink(output.data(), static_cast<int>(nb_outputs), PROCESSSIZE, false);
+    sink.set_input_sampling_rate(48000);
+    for(gsl::index channel = 0; channel < nb_outputs; ++channel)
+    {
+      sink.set_input_port(channel, filter, channel);
+    }
+    for(gsl::index processed = 0; processed < PROCESSSIZE; processed += block_size)
+    {
+      sink.process(std::min(block_size, PROCESSSIZE - processed));
+    }
+
+    auto delayed = [&input](gsl::index i){return i < 0 ? 0 : input[i];};
+    std::vector<double> expected(nb_outputs * PROCESSSIZE);
+    for(std::size_t tap = 0; tap < delays.size(); ++tap)
+    {
+      std::vector<double> output_gains(nb_outputs, 0);
+      if(nb_outputs == 1)
+      {
+        output_gains[0] = gains[tap];
+      }
+      else
+      {
+        auto position = (pans[tap] + 1) / 2 * (nb_outputs - 1);
+        auto first_output = std::min(static_cast<gsl::index>(position), nb_outputs - 2);
+        auto angle = (position - first_output) * boost::math::constants::half_pi<double>();
+        output_gains[first_output] = gains[tap] * std::cos(angle);
+        output_gains[first_output + 1] = gains[tap] * std::sin(angle);
+      }
+      auto integer_delay = static_cast<gsl::index>(delays[tap]);
+      auto fraction = delays[tap] - integer_delay;
+      for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+      {
+        auto value = delayed(i - integer_delay) * (1 - fraction) + delayed(i - integer_delay - 1) * fraction;
+        for(gsl::index channel = 0; channel < nb_outputs; ++channel)
+        {
+          expected[channel * PROCESSSIZE + i] += output_gains[channel] * value;
+        }
+      }
+    }
+
+    for(gsl::index i = 0; i < nb_outputs * PROCESSSIZE; ++i)
+    {
+      ASSERT_NEAR(expected[i], output[i], 1e-10);
+    }
+  }
+}
+
+TEST(MultiTapDelayFilter, mono_test)
+{
+  check_taps(1, 333);
+}
+
+TEST(MultiTapDelayFilter, stereo_test)
+{
+  check_taps(2, 64);
+}
+
+TEST(MultiTapDelayFilter, large_blocks_test)
+{
+  // Blocks larger than the circular buffer
+  check_taps(5, PROCESSSIZE);
+}
+
+TEST(MultiTapDelayFilter, taps_test)
+{
+  ATK::MultiTapDelayFilter<double> filter(128);
+  filter.add_tap(10, 1);
+  filter.add_tap(20, .5, .5);
+  filter.set_tap(0, 30.5, .25, -.5);
+  ASSERT_EQ(filter.get_tap_delay(0), 30.5);
+  ASSERT_EQ(filter.get_tap_gain(0), .25);
+  ASSERT_EQ(filter.get_tap_pan(0), -.5);
+  filter.remove_tap(0);
+  ASSERT_EQ(filter.get_nb_taps(), 1);
+  ASSERT_EQ(filter.get_tap_delay(0), 20);
+  filter.clear_taps();
+  ASSERT_EQ(filter.get_nb_taps(), 0);
+}
+
+TEST(MultiTapDelayFilter, range_test)
+{
+  ATK::MultiTapDelayFilter<double> filter(128);
+  ASSERT_THROW(filter.add_tap(-1, 1), ATK::RuntimeError);
+  ASSERT_THROW(filter.add_tap(127.5, 1), ATK::RuntimeError);
+  ASSERT_THROW(filter.add_tap(10, 1, 2), ATK::RuntimeError);
+  ASSERT_THROW(filter.set_tap(0, 10, 1), ATK::RuntimeError);
+  ASSERT_THROW(filter.get_tap_delay(0), ATK::RuntimeError);
+}
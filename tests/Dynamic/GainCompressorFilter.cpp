@@ -12,6 +12,10 @@
 
 #include <boost/math/constants/constants.hpp>
 
+#include <atomic>
+#include <cmath>
+#include <thread>
+
 constexpr gsl::index PROCESSSIZE = 64;
 
 TEST(GainFilter, threshold_test)
@@ -250,3 +254,96 @@ TEST(GainCompressorFilter, const_1_threshold_05_ratio_4_test_LUT)
     ASSERT_NEAR(0.765739262, outdata[i], 0.1);
   }
 }
+
+TEST(GainCompressorFilter, LUT_low_levels_test)
+{
+  // From -100dB to +30dB around the threshold
+  std::array<double, PROCESSSIZE> data;
+  for (gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    data[i] = std::pow(10., -10 + 13. * i / (PROCESSSIZE - 1));
+  }
+
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(48000);
+
+  std::array<double, PROCESSSIZE> outdata;
+
+  ATK::GainFilter<ATK::GainCompressorFilter<double>> filter(1);
+  filter.set_input_sampling_rate(48000);
+  filter.set_input_port(0, &generator, 0);
+  filter.set_ratio(4);
+  filter.set_softness(1);
+  filter.wait_for_LUT_completion();
+
+  ATK::OutPointerFilter<double> output(outdata.data(), 1, PROCESSSIZE, false);
+  output.set_input_sampling_rate(48000);
+  output.set_input_port(0, &filter, 0);
+
+  output.process(PROCESSSIZE);
+
+  for (gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    double diff = 10 * std::log10(data[i]);
+    double gain = std::pow(10, -(std::sqrt(diff * diff + 1) + diff) / 40 * 3 / 4);
+    ASSERT_NEAR(gain, outdata[i], gain * 1e-5);
+  }
+}
+
+TEST(GainCompressorFilter, LUT_rebuild_while_processing_test)
+{
+  std::array<double, PROCESSSIZE> data;
+  for (gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    data[i] = 1;
+  }
+
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(48000);
+
+  std::array<double, PROCESSSIZE> outdata;
+
+  ATK::GainFilter<ATK::GainCompressorFilter<double>> filter(1, 1024);
+  filter.set_input_sampling_rate(48000);
+  filter.set_input_port(0, &generator, 0);
+  filter.set_threshold(0.5);
+  filter.set_softness(1);
+  filter.set_ratio(2);
+  filter.wait_for_LUT_completion();
+
+  ATK::OutPointerFilter<double> output(outdata.data(), 1, PROCESSSIZE, false);
+  output.set_input_sampling_rate(48000);
+  output.set_input_port(0, &filter, 0);
+
+  // The processing reads a complete LUT, for one ratio or the other, while they are rebuilt
+  std::atomic<bool> stop{false};
+  std::thread control([&filter, &stop]()
+  {
+    for (int i = 0; !stop; ++i)
+    {
+      filter.set_ratio(i % 2 ? 2 : 4);
+    }
+  });
+  for (gsl::index block = 0; block < 1000; ++block)
+  {
+    generator.set_pointer(data.data(), PROCESSSIZE);
+    output.set_pointer(outdata.data(), PROCESSSIZE);
+    output.process(PROCESSSIZE);
+    for (gsl::index i = 0; i < PROCESSSIZE; ++i)
+    {
+      ASSERT_TRUE(std::abs(outdata[i] - 0.836990654) < 1e-6 || std::abs(outdata[i] - 0.765739262) < 1e-6);
+    }
+  }
+  stop = true;
+  control.join();
+  filter.set_ratio(4);
+  filter.wait_for_LUT_completion();
+
+  generator.set_pointer(data.data(), PROCESSSIZE);
+  output.set_pointer(outdata.data(), PROCESSSIZE);
+  output.process(PROCESSSIZE);
+  for (gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    ASSERT_NEAR(0.765739262, outdata[i], 1e-6);
+  }
+}
@@ -0,0 +1,274 @@
+/**
+ * \ file MultibandDynamicsFilter.cpp
+ */
+
+#include <ATK/Dynamic/GainCompressorFilter.h>
+#include <ATK/Dynamic/MultibandDynamicsFilter.h>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+#include <ATK/Core/Utilities.h>
+
+#include <gtest/gtest.h>
+#include <boost/math/constants/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+constexpr gsl::index PROCESSSIZE = 1024 * 8;
+constexpr gsl::index SAMPLING_RATE = 48000;
+
+using MultibandCompressor = ATK::MultibandDynamicsFilter<ATK::GainCompressorFilter<double>>;
+
+namespace
+{
+  /// Processes channel major inputs by blocks of 64 samples, returns the channel major outputs
+  std::vector<double> process(MultibandCompressor& filter, const std::vector<double>& input)
+  {
+    auto nb_inputs = filter.get_nb_input_ports();
+    auto nb_outputs = filter.get_nb_output_ports();
+    ATK::InPointerFilter<double> generator(input.data(), static_cast<int>(nb_inputs), PROCESSSIZE, false);
+    generator.set_output_sampling_rate(SAMPLING_RATE);
+
+    filter.set_input_sampling_rate(SAMPLING_RATE);
+    filter.set_output_sampling_rate(SAMPLING_RATE);
+    for(gsl::index channel = 0; channel < nb_inputs; ++channel)
+    {
+      filter.set_input_port(channel, generator, channel);
+    }
+
+    std::vector<double> output(nb_outputs * PROCESSSIZE);
+    ATK::OutPointerFilter<double> sink(output.data(), static_cast<int>(nb_outputs), PROCESSSIZE, false);
+    sink.set_input_sampling_rate(SAMPLING_RATE);
+    for(gsl::index channel = 0; channel < nb_outputs; ++channel)
+    {
+      sink.set_input_port(channel, filter, channel);
+    }
+
+    for(gsl::index i = 0; i < PROCESSSIZE; i += 64)
+    {
+      sink.process(64);
+    }
+    return output;
+  }
+
+  /// A sine for each channel
+  std::vector<double> sines(const std::vector<double>& frequencies, double amplitude = 1)
+  {
+    std::vector<double> data;
+    for(auto frequency: frequencies)
+    {
+      for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+      {
+        data.push_back(amplitude * std::sin(2 * boost::math::constants::pi<double>() * frequency * i / SAMPLING_RATE));
+      }
+    }
+    return data;
+  }
+
+  /// Amplitude of the last half of a channel
+  double amplitude(const std::vector<double>& data, gsl::index channel)
+  {
+    auto begin = data.begin() + channel * PROCESSSIZE;
+    return std::abs(*std::max_element(begin + PROCESSSIZE / 2, begin + PROCESSSIZE, [](double a, double b){return std::abs(a) < std::abs(b);}));
+  }
+
+  /// Amplitude of a frequency in the last half of a channel, exact for a whole number of periods
+  double fundamental(const std::vector<double>& data, gsl::index channel, double frequency)
+  {
+    double real = 0;
+    double imaginary = 0;
+    for(gsl::index i = PROCESSSIZE / 2; i < PROCESSSIZE; ++i)
+    {
+      auto phase = 2 * boost::math::constants::pi<double>() * frequency * i / SAMPLING_RATE;
+      real += data[channel * PROCESSSIZE + i] * std::cos(phase);
+      imaginary += data[channel * PROCESSSIZE + i] * std::sin(phase);
+    }
+    return 2 * std::sqrt(real * real + imaginary * imaginary) / (PROCESSSIZE / 2);
+  }
+}
+
+TEST(MultibandDynamicsFilter, bands_test)
+{
+  ASSERT_THROW(MultibandCompressor(1, 1), ATK::RuntimeError);
+  ASSERT_THROW(MultibandCompressor(1, 9), ATK::RuntimeError);
+  MultibandCompressor filter(2, 4, true);
+  ASSERT_EQ(filter.get_nb_bands(), 4);
+  ASSERT_TRUE(filter.has_sidechain());
+  ASSERT_EQ(filter.get_nb_input_ports(), 4);
+  ASSERT_EQ(filter.get_nb_output_ports(), 2);
+  ASSERT_THROW(filter.get_gain_computer(4), ATK::RuntimeError);
+}
+
+TEST(MultibandDynamicsFilter, crossover_test)
+{
+  MultibandCompressor filter(1, 3);
+  filter.set_crossover(1, 2000);
+  ASSERT_EQ(filter.get_crossover(1), 2000);
+  ASSERT_THROW(filter.set_crossover(2, 2000), ATK::RuntimeError);
+  ASSERT_THROW(filter.set_crossover(0, 0), ATK::RuntimeError);
+}
+
+TEST(MultibandDynamicsFilter, ballistics_test)
+{
+  MultibandCompressor filter(1, 3);
+  filter.set_memory(2, 0.5);
+  ASSERT_EQ(filter.get_memory(2), 0.5);
+  filter.set_attack(1, 0.25);
+  ASSERT_EQ(filter.get_attack(1), 0.25);
+  filter.set_release(0, 0.75);
+  ASSERT_EQ(filter.get_release(0), 0.75);
+  ASSERT_THROW(filter.set_memory(0, 1), ATK::RuntimeError);
+  ASSERT_THROW(filter.set_attack(0, 2), ATK::RuntimeError);
+  ASSERT_THROW(filter.set_release(3, 0.5), ATK::RuntimeError);
+}
+
+TEST(MultibandDynamicsFilter, allpass_impulse_test)
+{
+  for(gsl::index nb_bands = 2; nb_bands <= 8; ++nb_bands)
+  {
+    std::vector<double> data(PROCESSSIZE, 0);
+    data[0] = 1;
+    MultibandCompressor filter(1, nb_bands);
+    auto output = process(filter, data);
+
+    double energy = 0;
+    for(auto value: output)
+    {
+      energy += value * value;
+    }
+    ASSERT_NEAR(1, energy, 1e-6);
+  }
+}
+
+TEST(MultibandDynamicsFilter, allpass_sines_test)
+{
+  // Whole numbers of periods in half of the samples, from 47Hz to 16kHz
+  std::vector<double> frequencies;
+  for(auto periods: {4, 13, 60, 256, 768, 1365})
+  {
+    frequencies.push_back(static_cast<double>(periods) * SAMPLING_RATE / (PROCESSSIZE / 2));
+  }
+  MultibandCompressor filter(frequencies.size(), 5);
+  auto output = process(filter, sines(frequencies));
+
+  for(gsl::index channel = 0; channel < static_cast<gsl::index>(frequencies.size()); ++channel)
+  {
+    ASSERT_NEAR(1, fundamental(output, channel, frequencies[channel]), 1e-6);
+  }
+}
+
+TEST(MultibandDynamicsFilter, band_compression_test)
+{
+  MultibandCompressor filter(2, 2);
+  filter.set_crossover(0, 1000);
+  filter.set_memory(1, 0.99);
+  filter.get_gain_computer(1).set_threshold(0.01);
+  filter.get_gain_computer(1).set_ratio(10);
+  filter.get_gain_computer(1).set_softness(1);
+  auto output = process(filter, sines({100, 10000}));
+
+  // Only the high band is compressed
+  ASSERT_NEAR(1, amplitude(output, 0), 1e-2);
+  ASSERT_LT(amplitude(output, 1), 0.2);
+}
+
+TEST(MultibandDynamicsFilter, sidechain_test)
+{
+  auto data = sines({100});
+  std::vector<double> silence(PROCESSSIZE, 0);
+
+  MultibandCompressor filter(1, 2, true);
+  filter.set_memory(0, 0.99);
+  filter.get_gain_computer(0).set_threshold(0.01);
+  filter.get_gain_computer(0).set_ratio(10);
+  filter.get_gain_computer(0).set_softness(1);
+
+  auto input = data;
+  input.insert(input.end(), silence.begin(), silence.end());
+  ASSERT_NEAR(1, amplitude(process(filter, input), 0), 1e-2);
+
+  MultibandCompressor sidechained(1, 2, true);
+  sidechained.set_memory(0, 0.99);
+  sidechained.get_gain_computer(0).set_threshold(0.01);
+  sidechained.get_gain_computer(0).set_ratio(10);
+  sidechained.get_gain_computer(0).set_softness(1);
+
+  input = silence;
+  input.insert(input.end(), data.begin(), data.end());
+  ASSERT_EQ(0, amplitude(process(sidechained, input), 0));
+
+  input = data;
+  input.insert(input.end(), data.begin(), data.end());
+  MultibandCompressor compressed(1, 2, true);
+  compressed.set_memory(0, 0.99);
+  compressed.get_gain_computer(0).set_threshold(0.01);
+  compressed.get_gain_computer(0).set_ratio(10);
+  compressed.get_gain_computer(0).set_softness(1);
+  ASSERT_LT(amplitude(process(compressed, input), 0), 0.2);
+}
+
+TEST(MultibandDynamicsFilter, lookahead_test)
+{
+  auto data = sines({440});
+
+  MultibandCompressor filter(1, 3);
+  auto reference = process(filter, data);
+
+  MultibandCompressor delayed(1, 3);
+  delayed.set_lookahead(100);
+  ASSERT_EQ(delayed.get_lookahead(), 100);
+  ASSERT_EQ(delayed.get_latency(), 100);
+  auto output = process(delayed, data);
+
+  for(gsl::index i = 0; i < 100; ++i)
+  {
+    ASSERT_EQ(0, output[i]);
+  }
+  for(gsl::index i = 100; i < PROCESSSIZE; ++i)
+  {
+    ASSERT_NEAR(reference[i - 100], output[i], 1e-12);
+  }
+}
+
+TEST(MultibandDynamicsFilter, channels_test)
+{
+  // The channels are independent, whatever their lanes
+  std::vector<double> frequencies{100, 300, 1000, 3000, 10000};
+  auto data = sines(frequencies, 2);
+
+  MultibandCompressor filter(frequencies.size(), 3);
+  filter.set_lookahead(10);
+  for(gsl::index band = 0; band < 3; ++band)
+  {
+    filter.set_memory(band, 0.9);
+    filter.set_attack(band, 0.1);
+    filter.set_release(band, 0.5);
+    filter.get_gain_computer(band).set_threshold(0.1);
+    filter.get_gain_computer(band).set_ratio(4);
+    filter.get_gain_computer(band).wait_for_LUT_completion();
+  }
+  auto output = process(filter, data);
+
+  for(gsl::index channel = 0; channel < static_cast<gsl::index>(frequencies.size()); ++channel)
+  {
+    MultibandCompressor single(1, 3);
+    single.set_lookahead(10);
+    for(gsl::index band = 0; band < 3; ++band)
+    {
+      single.set_memory(band, 0.9);
+      single.set_attack(band, 0.1);
+      single.set_release(band, 0.5);
+      single.get_gain_computer(band).set_threshold(0.1);
+      single.get_gain_computer(band).set_ratio(4);
+      single.get_gain_computer(band).wait_for_LUT_completion();
+    }
+    auto reference = process(single, std::vector<double>(data.begin() + channel * PROCESSSIZE, data.begin() + (channel + 1) * PROCESSSIZE));
+    ASSERT_LT(amplitude(reference, 0), 1.5);
+    for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+    {
+      ASSERT_NEAR(reference[i], output[channel * PROCESSSIZE + i], 1e-12);
+    }
+  }
+}
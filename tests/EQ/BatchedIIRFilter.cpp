@@ -0,0 +1,133 @@
+/**
+ * \ file BatchedIIRFilter.cpp
+ */
+
+#include <ATK/EQ/BatchedIIRFilter.h>
+#include <ATK/EQ/ButterworthFilter.h>
+#include <ATK/EQ/Chebyshev1Filter.h>
+#include <ATK/EQ/IIRFilter.h>
+#include <ATK/EQ/SimpleIIRFilter.h>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+constexpr gsl::index PROCESSSIZE = 1024*16;
+
+namespace
+{
+  template<typename Coefficients, typename Filter1, typename Filter2>
+  void compare(Filter1& filter1, Filter2& filter2, gsl::index nb_channels, typename Coefficients::DataType tolerance)
+  {
+    using DataType = typename Coefficients::DataType;
+    std::vector<DataType> input(nb_channels * PROCESSSIZE);
+    for(gsl::index channel = 0; channel < nb_channels; ++channel)
+    {
+      for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+      {
+        input[channel * PROCESSSIZE + i] = static_cast<DataType>(std::sin(i * 0.01 * (channel + 1)) + std::cos(i * 0.3 / (channel + 1)));
+      }
+    }
+    std::vector<DataType> output1(nb_channels * PROCESSSIZE);
+    std::vector<DataType> output2(nb_channels * PROCESSSIZE);
+
+    ATK::InPointerFilter<DataType> generator1(input.data(), static_cast<int>(nb_channels), PROCESSSIZE, false);
+    generator1.set_output_sampling_rate(48000);
+    ATK::InPointerFilter<DataType> generator2(input.data(), static_cast<int>(nb_channels), PROCESSSIZE, false);
+    generator2.set_output_sampling_rate(48000);
+    ATK::OutPointerFilter<DataType> sink1(output1.data(), static_cast<int>(nb_channels), PROCESSSIZE, false);
+    sink1.set_input_sampling_rate(48000);
+    ATK::OutPointerFilter<DataType> sink2(output2.data(), static_cast<int>(nb_channels), PROCESSSIZE, false);
+    sink2.set_input_sampling_rate(48000);
+
+    for(gsl::index channel = 0; channel < nb_channels; ++channel)
+    {
+      filter1.set_input_port(channel, &generator1, channel);
+      filter2.set_input_port(channel, &generator2, channel);
+      sink1.set_input_port(channel, &filter1, channel);
+      sink2.set_input_port(channel, &filter2, channel);
+    }
+
+    gsl::index processed = 0;
+    for(gsl::index i = 0; processed + 300 <= PROCESSSIZE; ++i)
+    {
+      auto size = 100 + (i % 3) * 100;
+      sink1.process(size);
+      sink2.process(size);
+      processed += size;
+    }
+
+    for(gsl::index i = 0; i < nb_channels * PROCESSSIZE; ++i)
+    {
+      ASSERT_NEAR(output1[i], output2[i], tolerance);
+    }
+  }
+}
+
+TEST(BatchedIIRFilter, ButterworthLowPassCoefficients_lanes_test)
+{
+  ATK::BatchedIIRFilter<ATK::ButterworthLowPassCoefficients<double>, 4> filter;
+  ASSERT_EQ(filter.get_nb_input_ports(), 1);
+  ASSERT_EQ(filter.get_nb_output_ports(), 1);
+}
+
+TEST(BatchedIIRFilter, ButterworthLowPassCoefficients_double_test)
+{
+  constexpr gsl::index nb_channels = 5;
+  ATK::IIRFilter<ATK::ButterworthLowPassCoefficients<double> > filter1(nb_channels);
+  ATK::BatchedIIRFilter<ATK::ButterworthLowPassCoefficients<double> > filter2(nb_channels);
+  for(auto filter: {static_cast<ATK::ButterworthLowPassCoefficients<double>*>(&filter1), static_cast<ATK::ButterworthLowPassCoefficients<double>*>(&filter2)})
+  {
+    filter->set_input_sampling_rate(48000);
+    filter->set_cut_frequency(1000);
+    filter->set_order(6);
+  }
+  compare<ATK::ButterworthLowPassCoefficients<double>>(filter1, filter2, nb_channels, 1e-6);
+}
+
+TEST(BatchedIIRFilter, ButterworthLowPassCoefficients_simple_test)
+{
+  constexpr gsl::index nb_channels = 5;
+  ATK::SimpleIIRFilter<ATK::ButterworthLowPassCoefficients<double> > filter1(nb_channels);
+  ATK::BatchedIIRFilter<ATK::ButterworthLowPassCoefficients<double> > filter2(nb_channels);
+  for(auto filter: {static_cast<ATK::ButterworthLowPassCoefficients<double>*>(&filter1), static_cast<ATK::ButterworthLowPassCoefficients<double>*>(&filter2)})
+  {
+    filter->set_input_sampling_rate(48000);
+    filter->set_cut_frequency(1000);
+    filter->set_order(6);
+  }
+  compare<ATK::ButterworthLowPassCoefficients<double>>(filter1, filter2, nb_channels, 1e-12);
+}
+
+TEST(BatchedIIRFilter, Chebyshev1HighPassCoefficients_double_test)
+{
+  constexpr gsl::index nb_channels = 16;
+  ATK::IIRFilter<ATK::Chebyshev1HighPassCoefficients<double> > filter1(nb_channels);
+  ATK::BatchedIIRFilter<ATK::Chebyshev1HighPassCoefficients<double>, 8> filter2(nb_channels);
+  for(auto filter: {static_cast<ATK::Chebyshev1HighPassCoefficients<double>*>(&filter1), static_cast<ATK::Chebyshev1HighPassCoefficients<double>*>(&filter2)})
+  {
+    filter->set_input_sampling_rate(48000);
+    filter->set_cut_frequency(500);
+    filter->set_ripple(1);
+    filter->set_order(4);
+  }
+  compare<ATK::Chebyshev1HighPassCoefficients<double>>(filter1, filter2, nb_channels, 1e-6);
+}
+
+TEST(BatchedIIRFilter, ButterworthBandPassCoefficients_float_test)
+{
+  constexpr gsl::index nb_channels = 32;
+  ATK::IIRFilter<ATK::ButterworthBandPassCoefficients<float> > filter1(nb_channels);
+  ATK::BatchedIIRFilter<ATK::ButterworthBandPassCoefficients<float> > filter2(nb_channels);
+  for(auto filter: {static_cast<ATK::ButterworthBandPassCoefficients<float>*>(&filter1), static_cast<ATK::ButterworthBandPassCoefficients<float>*>(&filter2)})
+  {
+    filter->set_input_sampling_rate(48000);
+    filter->set_cut_frequencies(1000, 4000);
+    filter->set_order(2);
+  }
+  compare<ATK::ButterworthBandPassCoefficients<float>>(filter1, filter2, nb_channels, 1e-3f);
+}
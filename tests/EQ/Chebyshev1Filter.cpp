@@ -5,6 +5,7 @@
 #include <ATK/EQ/Chebyshev1Filter.h>
 #include <ATK/EQ/IIRFilter.h>
 
+#include <ATK/Core/OutPointerFilter.h>
 #include <ATK/Mock/FFTCheckerFilter.h>
 #include <ATK/Mock/SimpleSinusGeneratorFilter.h>
 
@@ -12,6 +13,27 @@
 
 constexpr gsl::index PROCESSSIZE = 1024*64;
 
+namespace
+{
+  /// Output of a filter for a 1kHz sine
+  template<class Filter>
+  std::vector<double> process_sine(Filter& filter)
+  {
+    ATK::SimpleSinusGeneratorFilter<double> generator;
+    generator.set_output_sampling_rate(1024*64);
+    generator.set_amplitude(1);
+    generator.set_frequency(1000);
+
+    std::vector<double> output(1024);
+    ATK::OutPointerFilter<double> sink(output.data(), 1, output.size(), false);
+    sink.set_input_sampling_rate(1024*64);
+    sink.set_input_port(0, &filter, 0);
+    filter.set_input_port(0, &generator, 0);
+    sink.process(output.size());
+    return output;
+  }
+}
+
 TEST(IIRFilter, Chebyshev1LowPassCoefficients_frequency_test)
 {
   ATK::IIRFilter<ATK::Chebyshev1LowPassCoefficients<double> > filter;
@@ -637,3 +659,60 @@ TEST(IIRFilter, Chebyshev1BandStopCoefficients_200_test)
   
   checker.process(PROCESSSIZE);
 }
+
+TEST(IIRFilter, Chebyshev1LowPassCoefficients_staged_test)
+{
+  ATK::IIRFilter<ATK::Chebyshev1LowPassCoefficients<double> > reference;
+  reference.set_input_sampling_rate(1024*64);
+  reference.set_output_sampling_rate(1024*64);
+  reference.set_order(3);
+  reference.set_ripple(2);
+  reference.set_cut_frequency(1000);
+
+  ATK::IIRFilter<ATK::Chebyshev1LowPassCoefficients<double> > filter;
+  filter.set_input_sampling_rate(1024*64);
+  filter.set_output_sampling_rate(1024*64);
+  filter.set_order(3);
+  filter.set_ripple(2);
+  filter.set_cut_frequency(100);
+  filter.stage_cut_frequency(1000);
+  ASSERT_EQ(filter.get_cut_frequency(), 100);
+  filter.commit_staged_coefficients();
+  ASSERT_EQ(filter.get_cut_frequency(), 1000);
+
+  auto expected = process_sine(reference);
+  auto output = process_sine(filter);
+  for(gsl::index i = 0; i < static_cast<gsl::index>(output.size()); ++i)
+  {
+    ASSERT_EQ(expected[i], output[i]);
+  }
+}
+
+TEST(IIRFilter, Chebyshev1BandStopCoefficients_staged_order_test)
+{
+  ATK::IIRFilter<ATK::Chebyshev1BandStopCoefficients<double> > reference;
+  reference.set_input_sampling_rate(1024*64);
+  reference.set_output_sampling_rate(1024*64);
+  reference.set_order(4);
+  reference.set_ripple(1);
+  reference.set_cut_frequencies(500, 2000);
+
+  ATK::IIRFilter<ATK::Chebyshev1BandStopCoefficients<double> > filter;
+  filter.set_input_sampling_rate(1024*64);
+  filter.set_output_sampling_rate(1024*64);
+  filter.set_order(2);
+  filter.set_ripple(1);
+  filter.set_cut_frequencies(100, 200);
+  filter.stage_cut_frequencies(500, 2000);
+  // The staged coefficients don't match the new order, the commit designs them again
+  filter.set_order(4);
+  filter.commit_staged_coefficients();
+  ASSERT_EQ(filter.get_cut_frequencies(), std::make_pair(500., 2000.));
+
+  auto expected = process_sine(reference);
+  auto output = process_sine(filter);
+  for(gsl::index i = 0; i < static_cast<gsl::index>(output.size()); ++i)
+  {
+    ASSERT_EQ(expected[i], output[i]);
+  }
+}
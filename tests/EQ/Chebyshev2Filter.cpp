@@ -5,13 +5,39 @@
 #include <ATK/EQ/Chebyshev2Filter.h>
 #include <ATK/EQ/IIRFilter.h>
 
+#include <ATK/Core/OutPointerFilter.h>
+#include <ATK/Core/ParameterAutomation.h>
 #include <ATK/Mock/FFTCheckerFilter.h>
 #include <ATK/Mock/SimpleSinusGeneratorFilter.h>
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <thread>
+
 constexpr gsl::index PROCESSSIZE = 1024*64;
 
+namespace
+{
+  /// Output of a filter for a 1kHz sine
+  template<class Filter>
+  std::vector<double> process_sine(Filter& filter)
+  {
+    ATK::SimpleSinusGeneratorFilter<double> generator;
+    generator.set_output_sampling_rate(1024*64);
+    generator.set_amplitude(1);
+    generator.set_frequency(1000);
+
+    std::vector<double> output(1024);
+    ATK::OutPointerFilter<double> sink(output.data(), 1, output.size(), false);
+    sink.set_input_sampling_rate(1024*64);
+    sink.set_input_port(0, &filter, 0);
+    filter.set_input_port(0, &generator, 0);
+    sink.process(output.size());
+    return output;
+  }
+}
+
 TEST(IIRFilter, Chebyshev2LowPassCoefficients_frequency_test)
 {
   ATK::IIRFilter<ATK::Chebyshev2LowPassCoefficients<double> > filter;
@@ -637,3 +663,58 @@ TEST(IIRFilter, Chebyshev2BandStopCoefficients_200_test)
   
   checker.process(PROCESSSIZE);
 }
+
+TEST(IIRFilter, Chebyshev2HighPassCoefficients_staged_test)
+{
+  ATK::IIRFilter<ATK::Chebyshev2HighPassCoefficients<double> > reference;
+  reference.set_input_sampling_rate(1024*64);
+  reference.set_output_sampling_rate(1024*64);
+  reference.set_order(3);
+  reference.set_ripple(20);
+  reference.set_cut_frequency(500);
+
+  ATK::IIRFilter<ATK::Chebyshev2HighPassCoefficients<double> > filter;
+  filter.set_input_sampling_rate(1024*64);
+  filter.set_output_sampling_rate(1024*64);
+  filter.set_order(3);
+  filter.set_ripple(3);
+  filter.set_cut_frequency(500);
+  filter.stage_ripple(20);
+  filter.commit_staged_coefficients();
+  ASSERT_EQ(filter.get_ripple(), 20);
+  // Nothing staged since the last commit
+  filter.commit_staged_coefficients();
+
+  auto expected = process_sine(reference);
+  auto output = process_sine(filter);
+  for(gsl::index i = 0; i < static_cast<gsl::index>(output.size()); ++i)
+  {
+    ASSERT_EQ(expected[i], output[i]);
+  }
+}
+
+TEST(IIRFilter, Chebyshev2LowPassCoefficients_automation_test)
+{
+  ATK::IIRFilter<ATK::Chebyshev2LowPassCoefficients<double> > filter;
+  filter.set_input_sampling_rate(1024*64);
+  filter.set_output_sampling_rate(1024*64);
+  filter.set_order(3);
+  filter.set_ripple(20);
+  filter.set_cut_frequency(100);
+
+  ATK::SimpleSinusGeneratorFilter<double> generator;
+  generator.set_output_sampling_rate(1024*64);
+  generator.set_amplitude(1);
+  generator.set_frequency(1000);
+  filter.set_input_port(0, &generator, 0);
+
+  ATK::ParameterAutomation automation;
+  auto cut_frequency = automation.add_deferred_parameter(filter, &ATK::Chebyshev2LowPassCoefficients<double>::stage_cut_frequency);
+  automation.set_parameter(cut_frequency, 2000);
+  for(int i = 0; i < 1000 && filter.get_cut_frequency() != 2000; ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    automation.process(filter, 1);
+  }
+  ASSERT_EQ(filter.get_cut_frequency(), 2000);
+}
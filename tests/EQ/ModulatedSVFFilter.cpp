@@ -0,0 +1,125 @@
+/**
+ * \ file ModulatedSVFFilter.cpp
+ */
+
+#include <ATK/EQ/ModulatedSVFFilter.h>
+#include <ATK/EQ/TimeVaryingSecondOrderSVFFilter.h>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+#include <ATK/Core/Utilities.h>
+
+#include <gtest/gtest.h>
+
+#include <boost/math/constants/constants.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+constexpr gsl::index PROCESSSIZE = 1024 * 4;
+constexpr gsl::index SAMPLING_RATE = 48000;
+
+namespace
+{
+  /// Compares the filter with TimeVaryingSecondOrderSVFFilter on a cut frequency sweep
+  template<typename Coefficients>
+  void check_modulated_svf(ATK::ModulatedSVFFilter<double>::Mode mode, gsl::index nb_channels, gsl::index control_period)
+  {
+    constexpr double Q = 2;
+    std::vector<double> cut_frequencies(PROCESSSIZE);
+    std::vector<double> g(PROCESSSIZE);
+    for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+    {
+      cut_frequencies[i] = 100 * std::pow(200., static_cast<double>(i) / PROCESSSIZE);
+    }
+    // The reference reads the cut frequency at the same samples
+    for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+    {
+      g[i] = std::tan(boost::math::constants::pi<double>() * cut_frequencies[i / control_period * control_period] / SAMPLING_RATE);
+    }
+    std::vector<double> input(nb_channels * PROCESSSIZE);
+    for(auto& value: input)
+    {
+      value = static_cast<double>(std::rand()) / RAND_MAX - .5;
+    }
+
+    ATK::InPointerFilter<double> cut_generator(cut_frequencies.data(), 1, PROCESSSIZE, false);
+    cut_generator.set_output_sampling_rate(SAMPLING_RATE);
+    ATK::InPointerFilter<double> g_generator(g.data(), 1, PROCESSSIZE, false);
+    g_generator.set_output_sampling_rate(SAMPLING_RATE);
+    ATK::InPointerFilter<double> generator(input.data(), static_cast<int>(nb_channels), PROCESSSIZE, false);
+    generator.set_output_sampling_rate(SAMPLING_RATE);
+
+    ATK::ModulatedSVFFilter<double> filter(nb_channels);
+    filter.set_input_sampling_rate(SAMPLING_RATE);
+    filter.set_mode(mode);
+    filter.set_Q(Q);
+    filter.set_control_period(control_period);
+    filter.set_input_port(0, cut_generator, 0);
+
+    ATK::TimeVaryingSecondOrderSVFFilter<Coefficients> reference(nb_channels);
+    reference.set_input_sampling_rate(SAMPLING_RATE);
+    reference.set_Q(Q);
+    reference.set_input_port(0, g_generator, 0);
+
+    for(gsl::index channel = 0; channel < nb_channels; ++channel)
+    {
+      filter.set_input_port(channel + 1, generator, channel);
+      reference.set_input_port(channel + 1, generator, channel);
+    }
+
+    // Both filters are processed by the same sink so that they read the same input blocks
+    std::vector<double> output(2 * nb_channels * PROCESSSIZE);
+    ATK::OutPointerFilter<double> sink(output.data(), static_cast<int>(2 * nb_channels), PROCESSSIZE, false);
+    sink.set_input_sampling_rate(SAMPLING_RATE);
+    for(gsl::index channel = 0; channel < nb_channels; ++channel)
+    {
+      sink.set_input_port(channel, filter, channel);
+      sink.set_input_port(nb_channels + channel, reference, channel);
+    }
+
+    for(gsl::index processed = 0; processed < PROCESSSIZE; processed += 100)
+    {
+      sink.process(std::min<gsl::index>(100, PROCESSSIZE - processed));
+    }
+
+    for(gsl::index i = 0; i < nb_channels * PROCESSSIZE; ++i)
+    {
+      ASSERT_NEAR(output[nb_channels * PROCESSSIZE + i], output[i], 1e-5);
+    }
+  }
+}
+
+TEST(ModulatedSVFFilter, lowpass_test)
+{
+  check_modulated_svf<ATK::TimeVaryingSecondOrderSVFLowPassCoefficients<double> >(ATK::ModulatedSVFFilter<double>::Mode::LowPass, 1, 1);
+}
+
+TEST(ModulatedSVFFilter, bandpass_channels_test)
+{
+  check_modulated_svf<ATK::TimeVaryingSecondOrderSVFBandPassCoefficients<double> >(ATK::ModulatedSVFFilter<double>::Mode::BandPass, 5, 1);
+}
+
+TEST(ModulatedSVFFilter, highpass_control_rate_test)
+{
+  check_modulated_svf<ATK::TimeVaryingSecondOrderSVFHighPassCoefficients<double> >(ATK::ModulatedSVFFilter<double>::Mode::HighPass, 3, 32);
+}
+
+TEST(ModulatedSVFFilter, notch_test)
+{
+  check_modulated_svf<ATK::TimeVaryingSecondOrderSVFNotchCoefficients<double> >(ATK::ModulatedSVFFilter<double>::Mode::Notch, 2, 1);
+}
+
+TEST(ModulatedSVFFilter, peak_test)
+{
+  check_modulated_svf<ATK::TimeVaryingSecondOrderSVFPeakCoefficients<double> >(ATK::ModulatedSVFFilter<double>::Mode::Peak, 2, 1);
+}
+
+TEST(ModulatedSVFFilter, parameters_test)
+{
+  ATK::ModulatedSVFFilter<double> filter;
+  ASSERT_THROW(filter.set_Q(0), std::out_of_range);
+  ASSERT_THROW(filter.set_control_period(0), ATK::RuntimeError);
+  ASSERT_THROW(filter.set_table_size(0), ATK::RuntimeError);
+}
@@ -5,6 +5,7 @@
 #include <ATK/EQ/FIRFilter.h>
 #include <ATK/EQ/RemezBasedFilter.h>
 
+#include <ATK/Core/OutPointerFilter.h>
 #include <ATK/Mock/FFTCheckerFilter.h>
 #include <ATK/Mock/SimpleSinusGeneratorFilter.h>
 
@@ -12,6 +13,27 @@
 
 constexpr gsl::index PROCESSSIZE = (1024 * 64);
 
+namespace
+{
+  /// Output of a filter for a 1kHz sine
+  template<class Filter>
+  std::vector<double> process_sine(Filter& filter)
+  {
+    ATK::SimpleSinusGeneratorFilter<double> generator;
+    generator.set_output_sampling_rate(1024*64);
+    generator.set_amplitude(1);
+    generator.set_frequency(1000);
+
+    std::vector<double> output(1024);
+    ATK::OutPointerFilter<double> sink(output.data(), 1, output.size(), false);
+    sink.set_input_sampling_rate(1024*64);
+    sink.set_input_port(0, &filter, 0);
+    filter.set_input_port(0, &generator, 0);
+    sink.process(output.size());
+    return output;
+  }
+}
+
 TEST(FIRFilter, Remez_bad_template_test)
 {
   ATK::FIRFilter<ATK::RemezBasedCoefficients<double> > filter;
@@ -69,3 +91,36 @@ TEST(FIRFilter, Remez_LowPassCoefficients_16k_test)
   
   checker.process(PROCESSSIZE);
 }
+
+TEST(FIRFilter, Remez_staged_test)
+{
+  std::vector<std::pair<std::pair<double, double>, std::pair<double, double>> > target;
+  target.push_back(std::make_pair(std::make_pair(0, 0.4), std::make_pair(1, 1)));
+  target.push_back(std::make_pair(std::make_pair(0.5, 1), std::make_pair(0, 2)));
+  std::vector<std::pair<std::pair<double, double>, std::pair<double, double>> > other_target;
+  other_target.push_back(std::make_pair(std::make_pair(0, 0.2), std::make_pair(1, 1)));
+  other_target.push_back(std::make_pair(std::make_pair(0.3, 1), std::make_pair(0, 2)));
+
+  ATK::FIRFilter<ATK::RemezBasedCoefficients<double> > reference;
+  reference.set_input_sampling_rate(1024*64);
+  reference.set_output_sampling_rate(1024*64);
+  reference.set_order(12);
+  reference.set_template(target);
+
+  ATK::FIRFilter<ATK::RemezBasedCoefficients<double> > filter;
+  filter.set_input_sampling_rate(1024*64);
+  filter.set_output_sampling_rate(1024*64);
+  filter.set_order(12);
+  filter.set_template(other_target);
+  filter.stage_template(target);
+  ASSERT_EQ(filter.get_template(), other_target);
+  filter.commit_staged_coefficients();
+  ASSERT_EQ(filter.get_template(), target);
+
+  auto expected = process_sine(reference);
+  auto output = process_sine(filter);
+  for(gsl::index i = 0; i < static_cast<gsl::index>(output.size()); ++i)
+  {
+    ASSERT_EQ(expected[i], output[i]);
+  }
+}
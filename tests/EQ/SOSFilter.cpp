@@ -0,0 +1,193 @@
+/**
+ * \ file SOSFilter.cpp
+ */
+
+#include <ATK/EQ/BesselFilter.h>
+#include <ATK/EQ/ButterworthFilter.h>
+#include <ATK/EQ/Chebyshev1Filter.h>
+#include <ATK/EQ/Chebyshev2Filter.h>
+#include <ATK/EQ/IIRFilter.h>
+#include <ATK/EQ/SOSFilter.h>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+constexpr gsl::index PROCESSSIZE = 1024*16;
+
+namespace
+{
+  template<typename DataType, typename Filter1, typename Filter2>
+  void compare(Filter1& filter1, Filter2& filter2, gsl::index nb_channels, DataType tolerance)
+  {
+    std::vector<DataType> input(nb_channels * PROCESSSIZE);
+    for(gsl::index channel = 0; channel < nb_channels; ++channel)
+    {
+      for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+      {
+        input[channel * PROCESSSIZE + i] = static_cast<DataType>(std::sin(i * 0.01 * (channel + 1)) + std::cos(i * 0.3 / (channel + 1)));
+      }
+    }
+    std::vector<DataType> output1(nb_channels * PROCESSSIZE);
+    std::vector<DataType> output2(nb_channels * PROCESSSIZE);
+
+    ATK::InPointerFilter<DataType> generator1(input.data(), static_cast<int>(nb_channels), PROCESSSIZE, false);
+    generator1.set_output_sampling_rate(48000);
+    ATK::InPointerFilter<DataType> generator2(input.data(), static_cast<int>(nb_channels), PROCESSSIZE, false);
+    generator2.set_output_sampling_rate(48000);
+    ATK::OutPointerFilter<DataType> sink1(output1.data(), static_cast<int>(nb_channels), PROCESSSIZE, false);
+    sink1.set_input_sampling_rate(48000);
+    ATK::OutPointerFilter<DataType> sink2(output2.data(), static_cast<int>(nb_channels), PROCESSSIZE, false);
+    sink2.set_input_sampling_rate(48000);
+
+    for(gsl::index channel = 0; channel < nb_channels; ++channel)
+    {
+      filter1.set_input_port(channel, &generator1, channel);
+      filter2.set_input_port(channel, &generator2, channel);
+      sink1.set_input_port(channel, &filter1, channel);
+      sink2.set_input_port(channel, &filter2, channel);
+    }
+
+    gsl::index processed = 0;
+    for(gsl::index i = 0; processed + 300 <= PROCESSSIZE; ++i)
+    {
+      auto size = 100 + (i % 3) * 100;
+      sink1.process(size);
+      sink2.process(size);
+      processed += size;
+    }
+
+    for(gsl::index i = 0; i < nb_channels * PROCESSSIZE; ++i)
+    {
+      ASSERT_NEAR(output1[i], output2[i], tolerance);
+    }
+  }
+}
+
+TEST(SOSFilter, ButterworthLowPassCoefficients_sections_test)
+{
+  ATK::SOSFilter<ATK::ButterworthLowPassCoefficients<double> > filter;
+  filter.set_input_sampling_rate(48000);
+  filter.set_cut_frequency(1000);
+  filter.set_order(5);
+  ASSERT_EQ(filter.get_nb_sections(), 3);
+  ASSERT_EQ(filter.get_coefficients_sections().size(), 15);
+}
+
+TEST(SOSFilter, ButterworthLowPassCoefficients_test)
+{
+  constexpr gsl::index nb_channels = 3;
+  ATK::IIRFilter<ATK::ButterworthLowPassCoefficients<double> > filter1(nb_channels);
+  ATK::SOSFilter<ATK::ButterworthLowPassCoefficients<double> > filter2(nb_channels);
+  for(auto filter: {static_cast<ATK::ButterworthLowPassCoefficients<double>*>(&filter1), static_cast<ATK::ButterworthLowPassCoefficients<double>*>(&filter2)})
+  {
+    filter->set_input_sampling_rate(48000);
+    filter->set_cut_frequency(1000);
+    filter->set_order(5);
+  }
+  compare<double>(filter1, filter2, nb_channels, 1e-6);
+}
+
+TEST(SOSFilter, ButterworthHighPassCoefficients_test)
+{
+  ATK::IIRFilter<ATK::ButterworthHighPassCoefficients<double> > filter1;
+  ATK::SOSFilter<ATK::ButterworthHighPassCoefficients<double> > filter2;
+  for(auto filter: {static_cast<ATK::ButterworthHighPassCoefficients<double>*>(&filter1), static_cast<ATK::ButterworthHighPassCoefficients<double>*>(&filter2)})
+  {
+    filter->set_input_sampling_rate(48000);
+    filter->set_cut_frequency(1000);
+    filter->set_order(4);
+  }
+  compare<double>(filter1, filter2, 1, 1e-6);
+}
+
+TEST(SOSFilter, Chebyshev1BandPassCoefficients_test)
+{
+  constexpr gsl::index nb_channels = 5;
+  ATK::IIRFilter<ATK::Chebyshev1BandPassCoefficients<double> > filter1(nb_channels);
+  ATK::SOSFilter<ATK::Chebyshev1BandPassCoefficients<double> > filter2(nb_channels);
+  for(auto filter: {static_cast<ATK::Chebyshev1BandPassCoefficients<double>*>(&filter1), static_cast<ATK::Chebyshev1BandPassCoefficients<double>*>(&filter2)})
+  {
+    filter->set_input_sampling_rate(48000);
+    filter->set_cut_frequencies(200, 2000);
+    filter->set_ripple(1);
+    filter->set_order(3);
+  }
+  compare<double>(filter1, filter2, nb_channels, 1e-6);
+}
+
+TEST(SOSFilter, Chebyshev2BandStopCoefficients_test)
+{
+  ATK::IIRFilter<ATK::Chebyshev2BandStopCoefficients<double> > filter1;
+  ATK::SOSFilter<ATK::Chebyshev2BandStopCoefficients<double> > filter2;
+  for(auto filter: {static_cast<ATK::Chebyshev2BandStopCoefficients<double>*>(&filter1), static_cast<ATK::Chebyshev2BandStopCoefficients<double>*>(&filter2)})
+  {
+    filter->set_input_sampling_rate(48000);
+    filter->set_cut_frequencies(200, 2000);
+    filter->set_ripple(20);
+    filter->set_order(2);
+  }
+  compare<double>(filter1, filter2, 1, 1e-6);
+}
+
+TEST(SOSFilter, BesselHighPassCoefficients_test)
+{
+  ATK::IIRFilter<ATK::BesselHighPassCoefficients<double> > filter1;
+  ATK::SOSFilter<ATK::BesselHighPassCoefficients<double> > filter2;
+  for(auto filter: {static_cast<ATK::BesselHighPassCoefficients<double>*>(&filter1), static_cast<ATK::BesselHighPassCoefficients<double>*>(&filter2)})
+  {
+    filter->set_input_sampling_rate(48000);
+    filter->set_cut_frequency(1000);
+    filter->set_order(7);
+  }
+  compare<double>(filter1, filter2, 1, 1e-6);
+}
+
+TEST(SOSFilter, ButterworthLowPassCoefficients_float_low_cut_test)
+{
+  constexpr gsl::index size = 192000;
+  ATK::SOSFilter<ATK::ButterworthLowPassCoefficients<double> > filter1;
+  ATK::SOSFilter<ATK::ButterworthLowPassCoefficients<float> > filter2;
+  filter1.set_input_sampling_rate(192000);
+  filter1.set_cut_frequency(20);
+  filter1.set_order(8);
+  filter2.set_input_sampling_rate(192000);
+  filter2.set_cut_frequency(20);
+  filter2.set_order(8);
+
+  std::vector<double> input1(size, 1);
+  std::vector<float> input2(size, 1);
+  std::vector<double> output1(size);
+  std::vector<float> output2(size);
+
+  ATK::InPointerFilter<double> generator1(input1.data(), 1, size, false);
+  generator1.set_output_sampling_rate(192000);
+  ATK::InPointerFilter<float> generator2(input2.data(), 1, size, false);
+  generator2.set_output_sampling_rate(192000);
+  ATK::OutPointerFilter<double> sink1(output1.data(), 1, size, false);
+  sink1.set_input_sampling_rate(192000);
+  ATK::OutPointerFilter<float> sink2(output2.data(), 1, size, false);
+  sink2.set_input_sampling_rate(192000);
+
+  filter1.set_input_port(0, &generator1, 0);
+  filter2.set_input_port(0, &generator2, 0);
+  sink1.set_input_port(0, &filter1, 0);
+  sink2.set_input_port(0, &filter2, 0);
+
+  for(gsl::index i = 0; i < 4; ++i)
+  {
+    sink1.process(size / 4);
+    sink2.process(size / 4);
+  }
+
+  for(gsl::index i = 0; i < size; ++i)
+  {
+    ASSERT_NEAR(output1[i], output2[i], 1e-3);
+  }
+  // The step response converges to 1
+  ASSERT_NEAR(output2[size - 1], 1, 1e-2);
+}
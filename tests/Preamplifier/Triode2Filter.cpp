@@ -3,6 +3,7 @@
  */
 
 #include <array>
+#include <cmath>
 #include <fstream>
 
 #include <ATK/config.h>
@@ -125,3 +126,48 @@ TEST(Triode2Filter, Koren_sin1k)
   
   checker.process(PROCESSSIZE);
 }
+
+TEST(Triode2Filter, Koren_table_sin1k)
+{
+  std::array<double, PROCESSSIZE> data;
+  {
+    std::ifstream input(ATK_SOURCE_TREE "/tests/data/input.dat", std::ios::binary);
+    input.read(reinterpret_cast<char*>(data.data()), PROCESSSIZE * sizeof(double));
+  }
+  ATK::InPointerFilter<double> reference_generator(data.data(), 1, PROCESSSIZE, false);
+  reference_generator.set_output_sampling_rate(48000 * 4);
+  ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(48000 * 4);
+
+  auto reference_filter = ATK::Triode2Filter<double, ATK::KorenTriodeFunction<double>>::build_standard_filter();
+  reference_filter.set_input_sampling_rate(48000 * 4);
+  reference_filter.set_output_sampling_rate(48000 * 4);
+  reference_filter.set_input_port(0, &reference_generator, 0);
+
+  auto filter = ATK::Triode2Filter<double, ATK::KorenTriodeFunction<double>>::build_standard_filter();
+  filter.set_solver(ATK::TriodeSolver::CubicTable);
+  filter.set_input_sampling_rate(48000 * 4);
+  filter.set_output_sampling_rate(48000 * 4);
+  filter.set_input_port(0, &generator, 0);
+
+  std::array<double, PROCESSSIZE> reference;
+  ATK::OutPointerFilter<double> reference_output(reference.data(), 1, PROCESSSIZE, false);
+  reference_output.set_input_sampling_rate(48000 * 4);
+  reference_output.set_input_port(0, &reference_filter, 0);
+  std::array<double, PROCESSSIZE> outdata;
+  ATK::OutPointerFilter<double> output(outdata.data(), 1, PROCESSSIZE, false);
+  output.set_input_sampling_rate(48000 * 4);
+  output.set_input_port(0, &filter, 0);
+
+  reference_output.process(PROCESSSIZE);
+  output.process(PROCESSSIZE);
+
+  // The output swings over 35V
+  double error = 0;
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    ASSERT_NEAR(reference[i], outdata[i], 1);
+    error += (reference[i] - outdata[i]) * (reference[i] - outdata[i]);
+  }
+  ASSERT_LT(std::sqrt(error / PROCESSSIZE), 0.05);
+}
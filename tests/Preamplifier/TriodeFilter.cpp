@@ -3,7 +3,10 @@
  */
 
 #include <array>
+#include <cmath>
+#include <filesystem>
 #include <fstream>
+#include <string>
 
 #include <ATK/config.h>
 
@@ -385,3 +388,79 @@ TEST(TriodeFilter, Dempwolf_sin1k)
   
   checker.process(PROCESSSIZE);
 }
+
+namespace
+{
+  /// Processes the test signal with the standard Koren filter and the given solver
+  std::array<double, PROCESSSIZE> process_koren(ATK::TriodeSolver solver, gsl::index table_size = 256, double input_range = 10, const std::string& cache = "")
+  {
+    std::array<double, PROCESSSIZE> data;
+    {
+      std::ifstream input(ATK_SOURCE_TREE "/tests/data/input.dat", std::ios::binary);
+      input.read(reinterpret_cast<char*>(data.data()), PROCESSSIZE * sizeof(double));
+    }
+    ATK::InPointerFilter<double> generator(data.data(), 1, PROCESSSIZE, false);
+    generator.set_output_sampling_rate(48000 * 4);
+
+    auto filter = ATK::TriodeFilter<double, ATK::KorenTriodeFunction<double>>::build_standard_filter();
+    filter.set_table_cache(cache);
+    filter.set_table_size(table_size);
+    filter.set_table_input_range(input_range);
+    filter.set_solver(solver);
+    filter.set_input_sampling_rate(48000 * 4);
+    filter.set_output_sampling_rate(48000 * 4);
+    filter.set_input_port(0, &generator, 0);
+
+    std::array<double, PROCESSSIZE> outdata;
+    ATK::OutPointerFilter<double> output(outdata.data(), 1, PROCESSSIZE, false);
+    output.set_input_sampling_rate(48000 * 4);
+    output.set_input_port(0, &filter, 0);
+    output.process(PROCESSSIZE);
+    return outdata;
+  }
+
+  /// Checks the largest and the RMS errors against the Newton-Raphson solver, the output swings over 35V
+  void check_table_error(const std::array<double, PROCESSSIZE>& reference, const std::array<double, PROCESSSIZE>& table)
+  {
+    double error = 0;
+    for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+    {
+      ASSERT_NEAR(reference[i], table[i], 1);
+      error += (reference[i] - table[i]) * (reference[i] - table[i]);
+    }
+    ASSERT_LT(std::sqrt(error / PROCESSSIZE), 0.05);
+  }
+}
+
+TEST(TriodeFilter, Koren_table_sin1k)
+{
+  auto reference = process_koren(ATK::TriodeSolver::NewtonRaphson);
+  check_table_error(reference, process_koren(ATK::TriodeSolver::LinearTable));
+  check_table_error(reference, process_koren(ATK::TriodeSolver::CubicTable));
+}
+
+TEST(TriodeFilter, Koren_table_out_of_range)
+{
+  // Most of the samples are outside of the table and solved by Newton-Raphson
+  auto reference = process_koren(ATK::TriodeSolver::NewtonRaphson);
+  check_table_error(reference, process_koren(ATK::TriodeSolver::CubicTable, 256, 1));
+}
+
+TEST(TriodeFilter, Koren_table_cache)
+{
+  auto directory = std::filesystem::temp_directory_path() / "atk_triode_table_test";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+
+  auto computed = process_koren(ATK::TriodeSolver::LinearTable, 64, 10, directory.string());
+  ASSERT_EQ(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator()), 1);
+  auto loaded = process_koren(ATK::TriodeSolver::LinearTable, 64, 10, directory.string());
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    ASSERT_EQ(computed[i], loaded[i]);
+  }
+  // Another table size is another table
+  process_koren(ATK::TriodeSolver::LinearTable, 32, 10, directory.string());
+  ASSERT_EQ(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator()), 2);
+  std::filesystem::remove_all(directory);
+}
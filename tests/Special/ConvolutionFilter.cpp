@@ -4,6 +4,9 @@
 
 #include <ATK/config.h>
 
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+
 #include <ATK/Mock/TriangleGeneratorFilter.h>
 #include <ATK/Mock/TriangleCheckerFilter.h>
 
@@ -16,8 +19,84 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+#include <vector>
+
 constexpr gsl::index PROCESSSIZE = (2048);
 
+namespace
+{
+  /// Compares the convolution filter with a direct convolution, processing blocks of block_size samples
+  template<typename DataType>
+  void check_direct_convolution(gsl::index impulse_size, unsigned int split_size, gsl::index block_size, DataType tolerance)
+  {
+    std::vector<DataType> input(PROCESSSIZE);
+    for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+    {
+      input[i] = static_cast<DataType>(std::sin(i * 0.1) + std::cos(i * 0.0123));
+    }
+    typename ATK::ConvolutionFilter<DataType>::AlignedScalarVector impulse(impulse_size);
+    for(gsl::index i = 0; i < impulse_size; ++i)
+    {
+      impulse[i] = static_cast<DataType>(std::exp(-i * 0.01) * std::cos(i * 0.3));
+    }
+    std::vector<double> expected(PROCESSSIZE, 0);
+    for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+    {
+      for(gsl::index j = 0; j < impulse_size && j <= i; ++j)
+      {
+        expected[i] += static_cast<double>(impulse[j]) * input[i - j];
+      }
+    }
+
+    ATK::InPointerFilter<DataType> generator(input.data(), 1, PROCESSSIZE, false);
+    generator.set_output_sampling_rate(48000);
+    ATK::ConvolutionFilter<DataType> convolution;
+    convolution.set_input_sampling_rate(48000);
+    convolution.set_split_size(split_size);
+    convolution.set_impulse(std::move(impulse));
+    convolution.set_input_port(0, &generator, 0);
+    std::vector<DataType> output(PROCESSSIZE);
+    ATK::OutPointerFilter<DataType> sink(output.data(), 1, PROCESSSIZE, false);
+    sink.set_input_sampling_rate(48000);
+    sink.set_input_port(0, &convolution, 0);
+
+    for(gsl::index processed = 0; processed < PROCESSSIZE; processed += block_size)
+    {
+      sink.process(std::min(block_size, PROCESSSIZE - processed));
+    }
+
+    for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+    {
+      ASSERT_NEAR(expected[i], output[i], tolerance) << "impulse size " << impulse_size << ", block size " << block_size << ", sample " << i;
+    }
+  }
+}
+
+TEST(ConvolutionFilter, direct_impulse_sizes_test)
+{
+  for(gsl::index impulse_size: {1, 2, 63, 64, 65, 127, 128, 129, 200})
+  {
+    check_direct_convolution<double>(impulse_size, 64, 64, 1e-10);
+  }
+}
+
+TEST(ConvolutionFilter, direct_block_sizes_test)
+{
+  for(gsl::index block_size: {1, 17, 63, 65, 100, 333})
+  {
+    check_direct_convolution<double>(129, 64, block_size, 1e-10);
+  }
+}
+
+TEST(ConvolutionFilter, direct_float_test)
+{
+  for(gsl::index impulse_size: {63, 64, 65, 129})
+  {
+    check_direct_convolution<float>(impulse_size, 64, 100, 1e-4f);
+  }
+}
+
 // Original time (FIR time): 20s
 // Split convolution: 7.4s
 // fast FFT: 1s
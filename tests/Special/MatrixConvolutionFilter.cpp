@@ -0,0 +1,119 @@
+/**
+ * \ file MatrixConvolutionFilter.cpp
+ */
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+#include <ATK/Core/Utilities.h>
+
+#include <ATK/Special/MatrixConvolutionFilter.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <vector>
+
+constexpr gsl::index PROCESSSIZE = 1024*8;
+
+namespace
+{
+  using AlignedScalarVector = ATK::MatrixConvolutionFilter<double>::AlignedScalarVector;
+
+  AlignedScalarVector create_impulse(gsl::index impulse_size)
+  {
+    AlignedScalarVector impulse(impulse_size);
+    for(gsl::index i = 0; i < impulse_size; ++i)
+    {
+      impulse[i] = (static_cast<double>(std::rand()) / RAND_MAX - .5) * std::exp(-3. * i / impulse_size);
+    }
+    return impulse;
+  }
+
+  /// Checks the filter against direct convolutions, impulses are given output after output
+  void check_convolution(ATK::MatrixConvolutionFilter<double>& convolution, gsl::index nb_inputs, gsl::index nb_outputs, const std::vector<AlignedScalarVector>& impulses)
+  {
+    std::vector<double> input(nb_inputs * PROCESSSIZE);
+    for(auto& value: input)
+    {
+      value = static_cast<double>(std::rand()) / RAND_MAX - .5;
+    }
+    std::vector<double> output(nb_outputs * PROCESSSIZE);
+
+    ATK::InPointerFilter<double> generator(input.data(), static_cast<int>(nb_inputs), PROCESSSIZE, false);
+    generator.set_output_sampling_rate(48000);
+    convolution.set_input_sampling_rate(48000);
+    for(gsl::index input_port = 0; input_port < nb_inputs; ++input_port)
+    {
+      convolution.set_input_port(input_port, generator, input_port);
+    }
+    ATK::OutPointerFilter<double> sink(output.data(), static_cast<int>(nb_outputs), PROCESSSIZE, false);
+    sink.set_input_sampling_rate(48000);
+    for(gsl::index output_port = 0; output_port < nb_outputs; ++output_port)
+    {
+      sink.set_input_port(output_port, convolution, output_port);
+    }
+
+    gsl::index processed = 0;
+    for(gsl::index i = 0; processed < PROCESSSIZE; ++i)
+    {
+      auto size = std::min<gsl::index>(PROCESSSIZE - processed, 1 + (i * 37) % 300);
+      sink.process(size);
+      processed += size;
+    }
+
+    for(gsl::index output_port = 0; output_port < nb_outputs; ++output_port)
+    {
+      for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+      {
+        double expected = 0;
+        for(gsl::index input_port = 0; input_port < nb_inputs; ++input_port)
+        {
+          const auto& impulse = impulses[output_port * nb_inputs + input_port];
+          for(gsl::index j = 0; j < std::min<gsl::index>(i + 1, impulse.size()); ++j)
+          {
+            expected += impulse[j] * input[input_port * PROCESSSIZE + i - j];
+          }
+        }
+        ASSERT_NEAR(expected, output[output_port * PROCESSSIZE + i], 1e-8);
+      }
+    }
+  }
+}
+
+TEST(MatrixConvolutionFilter, true_stereo_test)
+{
+  std::vector<AlignedScalarVector> impulses;
+  ATK::MatrixConvolutionFilter<double> convolution(2, 2);
+  convolution.set_split_size(64);
+  for(gsl::index output_port = 0; output_port < 2; ++output_port)
+  {
+    for(gsl::index input_port = 0; input_port < 2; ++input_port)
+    {
+      impulses.push_back(create_impulse(3000));
+      convolution.set_impulse(input_port, output_port, impulses.back());
+    }
+  }
+  check_convolution(convolution, 2, 2, impulses);
+}
+
+TEST(MatrixConvolutionFilter, sparse_test)
+{
+  std::vector<AlignedScalarVector> impulses{create_impulse(1000), AlignedScalarVector(), create_impulse(30), create_impulse(2500), create_impulse(100), AlignedScalarVector()};
+  ATK::MatrixConvolutionFilter<double> convolution(3, 2);
+  convolution.set_split_size(128);
+  for(gsl::index output_port = 0; output_port < 2; ++output_port)
+  {
+    for(gsl::index input_port = 0; input_port < 3; ++input_port)
+    {
+      convolution.set_impulse(input_port, output_port, impulses[output_port * 3 + input_port]);
+    }
+  }
+  check_convolution(convolution, 3, 2, impulses);
+}
+
+TEST(MatrixConvolutionFilter, wrong_port_test)
+{
+  ATK::MatrixConvolutionFilter<double> convolution(2, 2);
+  ASSERT_THROW(convolution.set_impulse(2, 0, create_impulse(10)), ATK::RuntimeError);
+  ASSERT_THROW(convolution.set_impulse(0, 2, create_impulse(10)), ATK::RuntimeError);
+}
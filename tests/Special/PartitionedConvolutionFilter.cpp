@@ -0,0 +1,114 @@
+/**
+ * \ file PartitionedConvolutionFilter.cpp
+ */
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+
+#include <ATK/Special/PartitionedConvolutionFilter.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <vector>
+
+constexpr gsl::index PROCESSSIZE = 1024*16;
+
+namespace
+{
+  ATK::PartitionedConvolutionFilter<double>::AlignedScalarVector create_impulse(gsl::index impulse_size)
+  {
+    ATK::PartitionedConvolutionFilter<double>::AlignedScalarVector impulse(impulse_size);
+    for(gsl::index i = 0; i < impulse_size; ++i)
+    {
+      impulse[i] = (static_cast<double>(std::rand()) / RAND_MAX - .5) * std::exp(-3. * i / impulse_size);
+    }
+    return impulse;
+  }
+
+  void check_convolution(ATK::PartitionedConvolutionFilter<double>& convolution, const ATK::PartitionedConvolutionFilter<double>::AlignedScalarVector& impulse)
+  {
+    std::vector<double> input(PROCESSSIZE);
+    for(auto& value: input)
+    {
+      value = static_cast<double>(std::rand()) / RAND_MAX - .5;
+    }
+    std::vector<double> output(PROCESSSIZE);
+
+    ATK::InPointerFilter<double> generator(input.data(), 1, PROCESSSIZE, false);
+    generator.set_output_sampling_rate(48000);
+    convolution.set_input_sampling_rate(48000);
+    convolution.set_input_port(0, generator, 0);
+    ATK::OutPointerFilter<double> sink(output.data(), 1, PROCESSSIZE, false);
+    sink.set_input_sampling_rate(48000);
+    sink.set_input_port(0, convolution, 0);
+
+    gsl::index processed = 0;
+    for(gsl::index i = 0; processed < PROCESSSIZE; ++i)
+    {
+      auto size = std::min<gsl::index>(PROCESSSIZE - processed, 1 + (i * 37) % 300);
+      sink.process(size);
+      processed += size;
+    }
+
+    for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+    {
+      double expected = 0;
+      for(gsl::index j = 0; j < std::min<gsl::index>(i + 1, impulse.size()); ++j)
+      {
+        expected += impulse[j] * input[i - j];
+      }
+      ASSERT_NEAR(expected, output[i], 1e-8);
+    }
+  }
+}
+
+TEST(PartitionedConvolutionFilter, partition_test)
+{
+  ATK::PartitionedConvolutionFilter<double> convolution;
+  convolution.set_head_size(64);
+  convolution.set_max_partition_size(512);
+  convolution.set_impulse(create_impulse(64 * 100));
+
+  ASSERT_EQ(convolution.get_nb_stages(), 4);
+  ASSERT_EQ(convolution.get_partition_size(0), 64);
+  ASSERT_EQ(convolution.get_nb_partitions(0), 3);
+  ASSERT_EQ(convolution.get_partition_size(1), 128);
+  ASSERT_EQ(convolution.get_nb_partitions(1), 2);
+  ASSERT_EQ(convolution.get_partition_size(2), 256);
+  ASSERT_EQ(convolution.get_nb_partitions(2), 2);
+  ASSERT_EQ(convolution.get_partition_size(3), 512);
+  ASSERT_EQ(convolution.get_nb_partitions(3), 11);
+}
+
+TEST(PartitionedConvolutionFilter, short_impulse_test)
+{
+  auto impulse = create_impulse(50);
+  ATK::PartitionedConvolutionFilter<double> convolution;
+  convolution.set_head_size(64);
+  convolution.set_impulse(impulse);
+  ASSERT_EQ(convolution.get_nb_stages(), 0);
+  check_convolution(convolution, impulse);
+}
+
+TEST(PartitionedConvolutionFilter, convolution_test)
+{
+  auto impulse = create_impulse(5000);
+  ATK::PartitionedConvolutionFilter<double> convolution;
+  convolution.set_head_size(32);
+  convolution.set_max_partition_size(1024);
+  convolution.set_impulse(impulse);
+  check_convolution(convolution, impulse);
+}
+
+TEST(PartitionedConvolutionFilter, background_convolution_test)
+{
+  auto impulse = create_impulse(5000);
+  ATK::PartitionedConvolutionFilter<double> convolution;
+  convolution.set_head_size(32);
+  convolution.set_max_partition_size(1024);
+  convolution.set_background_processing(true);
+  convolution.set_impulse(impulse);
+  ASSERT_TRUE(convolution.get_background_processing());
+  check_convolution(convolution, impulse);
+}
@@ -0,0 +1,96 @@
+/**
+ * \ file FusedFilter.cpp
+ */
+
+#include <ATK/Tools/FusedFilter.h>
+#include <ATK/Tools/FusedOperators.h>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+#include <ATK/Tools/ApplyGainFilter.h>
+#include <ATK/Tools/DryWetFilter.h>
+#include <ATK/Tools/OffsetVolumeFilter.h>
+#include <ATK/Tools/TanFilter.h>
+#include <ATK/Tools/VolumeFilter.h>
+
+#include <gtest/gtest.h>
+
+#include <boost/math/constants/constants.hpp>
+
+#include <array>
+
+constexpr gsl::index PROCESSSIZE = 1024;
+
+TEST(FusedFilter, chain_test)
+{
+  std::array<double, 2 * PROCESSSIZE> data;
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    data[i] = std::sin(2 * boost::math::constants::pi<double>() * (i+1.)/48000 * 1000);
+    data[PROCESSSIZE + i] = std::cos(2 * boost::math::constants::pi<double>() * (i+1.)/48000 * 100);
+  }
+
+  ATK::InPointerFilter<double> generator(data.data(), 2, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(48000);
+
+  ATK::VolumeFilter<double> volume;
+  volume.set_input_sampling_rate(48000);
+  volume.set_volume(2000);
+  volume.set_input_port(0, generator, 0);
+  ATK::OffsetVolumeFilter<double> offset_volume;
+  offset_volume.set_input_sampling_rate(48000);
+  offset_volume.set_volume(.5);
+  offset_volume.set_offset(1000);
+  offset_volume.set_input_port(0, volume, 0);
+  ATK::TanFilter<double> tan;
+  tan.set_input_sampling_rate(48000);
+  tan.set_input_port(0, offset_volume, 0);
+  ATK::DryWetFilter<double> drywet;
+  drywet.set_input_sampling_rate(48000);
+  drywet.set_dry(.3);
+  drywet.set_input_port(0, tan, 0);
+  drywet.set_input_port(1, generator, 0);
+  ATK::ApplyGainFilter<double> gain;
+  gain.set_input_sampling_rate(48000);
+  gain.set_input_port(0, drywet, 0);
+  gain.set_input_port(1, generator, 1);
+
+  using DataType = double;
+  ATK::FusedFilter<DataType, ATK::FusedOperators::Volume<DataType>, ATK::FusedOperators::OffsetVolume<DataType>, ATK::FusedOperators::Tan<DataType>, ATK::FusedOperators::DryWet<DataType>, ATK::FusedOperators::ApplyGain<DataType> > fused;
+  fused.get_operator<0>().set_volume(2000);
+  fused.get_operator<1>().set_volume(.5);
+  fused.get_operator<1>().set_offset(1000);
+  fused.get_operator<3>().set_dry(.3);
+  fused.set_input_sampling_rate(48000);
+  fused.set_input_port(0, generator, 0);
+  fused.set_input_port(1, generator, 1);
+
+  std::array<double, 2 * PROCESSSIZE> outdata;
+  ATK::OutPointerFilter<double> output(outdata.data(), 2, PROCESSSIZE, false);
+  output.set_input_sampling_rate(48000);
+  output.set_input_port(0, gain, 0);
+  output.set_input_port(1, fused, 0);
+
+  output.process(PROCESSSIZE / 2);
+  output.process(PROCESSSIZE / 2);
+
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    ASSERT_NEAR(outdata[i], outdata[PROCESSSIZE + i], 1e-10 * std::abs(outdata[i]) + 1e-10);
+  }
+}
+
+TEST(FusedFilter, ports_test)
+{
+  ATK::FusedFilter<double, ATK::FusedOperators::ApplyGain<double>, ATK::FusedOperators::Volume<double>, ATK::FusedOperators::ApplyGain<double> > fused(3);
+  ASSERT_EQ(fused.get_nb_input_ports(), 9);
+  ASSERT_EQ(fused.get_nb_output_ports(), 3);
+}
+
+TEST(FusedFilter, tanh_shaper_coefficient_test)
+{
+  ATK::FusedOperators::TanhShaper<double> shaper;
+  ASSERT_THROW(shaper.set_coefficient(0), std::out_of_range);
+  shaper.set_coefficient(2);
+  ASSERT_NEAR(shaper(10, 0, nullptr, 0), std::tanh(20) / 2, 1e-6);
+}
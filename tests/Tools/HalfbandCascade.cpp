@@ -0,0 +1,132 @@
+/**
+ * \file HalfbandCascade.cpp
+ */
+
+#include <ATK/Tools/HalfbandCascade.h>
+
+#include <ATK/Core/Utilities.h>
+
+#include <gtest/gtest.h>
+
+#include <boost/math/constants/constants.hpp>
+
+#include <cmath>
+#include <complex>
+#include <vector>
+
+constexpr gsl::index SAMPLING_RATE = 48000;
+/// Two analysis windows of 0.1s, the frequencies multiple of 10Hz are on the bins of the DFT
+constexpr gsl::index PROCESSSIZE = 2 * 4800;
+
+namespace
+{
+  std::vector<double> sine(double frequency, gsl::index sampling_rate, gsl::index size, double latency = 0)
+  {
+    std::vector<double> signal(size);
+    for(gsl::index i = 0; i < size; ++i)
+    {
+      signal[i] = std::sin(2 * boost::math::constants::pi<double>() * frequency * (i - latency) / sampling_rate);
+    }
+    return signal;
+  }
+
+  /// Amplitude of a frequency in the second half of the signal
+  double amplitude(const std::vector<double>& signal, double frequency, gsl::index sampling_rate)
+  {
+    auto size = static_cast<gsl::index>(signal.size()) / 2;
+    std::complex<double> sum = 0;
+    for(gsl::index i = 0; i < size; ++i)
+    {
+      sum += signal[size + i] * std::polar(1., -2 * boost::math::constants::pi<double>() * frequency * i / sampling_rate);
+    }
+    return 2 * std::abs(sum) / size;
+  }
+
+  void check_upsampling(gsl::index factor, ATK::HalfbandDesign design, double tolerance)
+  {
+    ATK::HalfbandCascade<double> cascade(factor, design);
+    auto input = sine(1000, SAMPLING_RATE, PROCESSSIZE);
+    std::vector<double> output(PROCESSSIZE * factor);
+    for(gsl::index processed = 0; processed < PROCESSSIZE; processed += 1000)
+    {
+      auto size = std::min<gsl::index>(1000, PROCESSSIZE - processed);
+      cascade.upsample(input.data() + processed, output.data() + processed * factor, size);
+    }
+
+    auto expected = sine(1000, SAMPLING_RATE * factor, PROCESSSIZE * factor, cascade.get_upsampling_latency());
+    for(gsl::index i = PROCESSSIZE * factor / 2; i < PROCESSSIZE * factor; ++i)
+    {
+      ASSERT_NEAR(expected[i], output[i], tolerance);
+    }
+
+    // The image of a 10kHz sine
+    cascade.reset();
+    input = sine(10000, SAMPLING_RATE, PROCESSSIZE);
+    cascade.upsample(input.data(), output.data(), PROCESSSIZE);
+    ASSERT_NEAR(1, amplitude(output, 10000, SAMPLING_RATE * factor), 1e-3);
+    ASSERT_LT(amplitude(output, SAMPLING_RATE - 10000, SAMPLING_RATE * factor), 1e-5);
+  }
+
+  void check_downsampling(gsl::index factor, ATK::HalfbandDesign design, double tolerance)
+  {
+    ATK::HalfbandCascade<double> cascade(factor, design);
+    auto input = sine(1000, SAMPLING_RATE * factor, PROCESSSIZE * factor);
+    std::vector<double> output(PROCESSSIZE);
+    for(gsl::index processed = 0; processed < PROCESSSIZE; processed += 1000)
+    {
+      auto size = std::min<gsl::index>(1000, PROCESSSIZE - processed);
+      cascade.downsample(input.data() + processed * factor, output.data() + processed, size);
+    }
+
+    auto expected = sine(1000, SAMPLING_RATE, PROCESSSIZE, cascade.get_downsampling_latency() / factor);
+    for(gsl::index i = PROCESSSIZE / 2; i < PROCESSSIZE; ++i)
+    {
+      ASSERT_NEAR(expected[i], output[i], tolerance);
+    }
+
+    // A 30kHz sine would alias at 18kHz
+    cascade.reset();
+    input = sine(30000, SAMPLING_RATE * factor, PROCESSSIZE * factor);
+    cascade.downsample(input.data(), output.data(), PROCESSSIZE);
+    ASSERT_LT(amplitude(output, SAMPLING_RATE - 30000, SAMPLING_RATE), 1e-5);
+  }
+}
+
+TEST(HalfbandCascade, fir_upsampling_test)
+{
+  for(gsl::index factor = 2; factor <= 32; factor *= 2)
+  {
+    check_upsampling(factor, ATK::HalfbandDesign::LinearPhaseFIR, 1e-5);
+  }
+}
+
+TEST(HalfbandCascade, iir_upsampling_test)
+{
+  for(gsl::index factor = 2; factor <= 32; factor *= 2)
+  {
+    check_upsampling(factor, ATK::HalfbandDesign::AllpassIIR, 5e-4);
+  }
+}
+
+TEST(HalfbandCascade, fir_downsampling_test)
+{
+  for(gsl::index factor = 2; factor <= 32; factor *= 2)
+  {
+    check_downsampling(factor, ATK::HalfbandDesign::LinearPhaseFIR, 1e-5);
+  }
+}
+
+TEST(HalfbandCascade, iir_downsampling_test)
+{
+  for(gsl::index factor = 2; factor <= 32; factor *= 2)
+  {
+    check_downsampling(factor, ATK::HalfbandDesign::AllpassIIR, 5e-4);
+  }
+}
+
+TEST(HalfbandCascade, factor_test)
+{
+  ASSERT_THROW(ATK::HalfbandCascade<double>(1, ATK::HalfbandDesign::LinearPhaseFIR), ATK::RuntimeError);
+  ASSERT_THROW(ATK::HalfbandCascade<double>(6, ATK::HalfbandDesign::LinearPhaseFIR), ATK::RuntimeError);
+  ASSERT_THROW(ATK::HalfbandCascade<double>(64, ATK::HalfbandDesign::AllpassIIR), ATK::RuntimeError);
+}
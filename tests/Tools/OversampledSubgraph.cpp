@@ -0,0 +1,170 @@
+/**
+ * \file OversampledSubgraph.cpp
+ */
+
+#include <ATK/Tools/OversampledSubgraph.h>
+
+#include <ATK/Core/AllocationTripwire.h>
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+#include <ATK/Core/Utilities.h>
+#include <ATK/Tools/ApplyGainFilter.h>
+#include <ATK/Tools/VolumeFilter.h>
+
+#include <gtest/gtest.h>
+
+#include <boost/math/constants/constants.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+constexpr gsl::index SAMPLING_RATE = 48000;
+constexpr gsl::index PROCESSSIZE = 1024 * 8;
+
+namespace
+{
+  /// Applies a gain and a volume to the first input, the second one is the gain
+  void build_gain(ATK::BaseFilter& oversampling, ATK::BaseFilter& decimation, std::vector<gsl::unique_ptr<ATK::BaseFilter>>& filters)
+  {
+    auto gain = std::make_unique<ATK::ApplyGainFilter<double>>();
+    gain->set_input_port(0, oversampling, 0);
+    gain->set_input_port(1, oversampling, 1);
+    auto volume = std::make_unique<ATK::VolumeFilter<double>>();
+    volume->set_volume(.5);
+    volume->set_input_port(0, *gain, 0);
+    decimation.set_input_port(0, *volume, 0);
+    filters.push_back(std::move(gain));
+    filters.push_back(std::move(volume));
+  }
+}
+
+TEST(OversampledSubgraph, sampling_rate_change_test)
+{
+  // The polyphase filters never see an unsupported ratio between the new input and the old output rates
+  ATK::OversampledSubgraph<double> subgraph(2, 1, 4, build_gain);
+  subgraph.set_input_sampling_rate(SAMPLING_RATE);
+  ASSERT_NO_THROW(subgraph.set_input_sampling_rate(44100));
+  ASSERT_NO_THROW(subgraph.set_output_sampling_rate(44100));
+}
+
+TEST(OversampledSubgraph, manual_wiring_test)
+{
+  std::vector<double> input(2 * PROCESSSIZE);
+  for(auto& value: input)
+  {
+    value = static_cast<double>(std::rand()) / RAND_MAX - .5;
+  }
+  ATK::InPointerFilter<double> generator(input.data(), 2, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(SAMPLING_RATE);
+
+  ATK::OversampledSubgraph<double> subgraph(2, 1, 8, build_gain);
+  ASSERT_EQ(subgraph.get_factor(), 8);
+  subgraph.set_input_sampling_rate(SAMPLING_RATE);
+  subgraph.set_input_port(0, generator, 0);
+  subgraph.set_input_port(1, generator, 1);
+
+  // The same graph without the wrapper
+  ATK::InPointerFilter<double> expected_generator(input.data(), 2, PROCESSSIZE, false);
+  expected_generator.set_output_sampling_rate(SAMPLING_RATE);
+  ATK::PolyphaseOversamplingFilter<double> oversampling(2);
+  oversampling.set_input_sampling_rate(SAMPLING_RATE);
+  oversampling.set_output_sampling_rate(SAMPLING_RATE * 8);
+  oversampling.set_input_port(0, expected_generator, 0);
+  oversampling.set_input_port(1, expected_generator, 1);
+  ATK::ApplyGainFilter<double> gain;
+  gain.set_input_sampling_rate(SAMPLING_RATE * 8);
+  gain.set_input_port(0, oversampling, 0);
+  gain.set_input_port(1, oversampling, 1);
+  ATK::VolumeFilter<double> volume;
+  volume.set_input_sampling_rate(SAMPLING_RATE * 8);
+  volume.set_volume(.5);
+  volume.set_input_port(0, gain, 0);
+  ATK::PolyphaseDecimationFilter<double> decimation;
+  decimation.set_input_sampling_rate(SAMPLING_RATE * 8);
+  decimation.set_output_sampling_rate(SAMPLING_RATE);
+  decimation.set_input_port(0, volume, 0);
+
+  std::vector<double> output(PROCESSSIZE);
+  ATK::OutPointerFilter<double> sink(output.data(), 1, PROCESSSIZE, false);
+  sink.set_input_sampling_rate(SAMPLING_RATE);
+  sink.set_input_port(0, subgraph, 0);
+  std::vector<double> expected(PROCESSSIZE);
+  ATK::OutPointerFilter<double> expected_sink(expected.data(), 1, PROCESSSIZE, false);
+  expected_sink.set_input_sampling_rate(SAMPLING_RATE);
+  expected_sink.set_input_port(0, decimation, 0);
+
+  for(gsl::index processed = 0; processed < PROCESSSIZE; processed += 333)
+  {
+    auto size = std::min<gsl::index>(333, PROCESSSIZE - processed);
+    sink.process(size);
+    expected_sink.process(size);
+  }
+
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    ASSERT_EQ(expected[i], output[i]);
+  }
+}
+
+TEST(OversampledSubgraph, latency_test)
+{
+  std::vector<double> input(PROCESSSIZE);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    input[i] = std::sin(2 * boost::math::constants::pi<double>() * 100 * i / SAMPLING_RATE);
+  }
+  ATK::InPointerFilter<double> generator(input.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(SAMPLING_RATE);
+
+  ATK::OversampledSubgraph<double> subgraph(1, 1, 4, [](ATK::BaseFilter& oversampling, ATK::BaseFilter& decimation, std::vector<gsl::unique_ptr<ATK::BaseFilter>>& filters)
+  {
+    decimation.set_input_port(0, oversampling, 0);
+  });
+  subgraph.set_input_sampling_rate(SAMPLING_RATE);
+  subgraph.set_input_port(0, generator, 0);
+  ASSERT_GT(subgraph.get_latency(), 0);
+
+  std::vector<double> output(PROCESSSIZE);
+  ATK::OutPointerFilter<double> sink(output.data(), 1, PROCESSSIZE, false);
+  sink.set_input_sampling_rate(SAMPLING_RATE);
+  sink.set_input_port(0, subgraph, 0);
+  sink.process(PROCESSSIZE);
+
+  for(gsl::index i = subgraph.get_latency(); i < PROCESSSIZE; ++i)
+  {
+    ASSERT_NEAR(input[i - subgraph.get_latency()], output[i], 0.01);
+  }
+}
+
+TEST(OversampledSubgraph, factor_test)
+{
+  auto fun = [](ATK::BaseFilter& oversampling, ATK::BaseFilter& decimation, std::vector<gsl::unique_ptr<ATK::BaseFilter>>& filters){};
+  ASSERT_THROW(ATK::OversampledSubgraph<double>(1, 1, 3, fun), ATK::RuntimeError);
+}
+
+TEST(OversampledSubgraph, allocation_free_test)
+{
+  if(!ATK::AllocationTripwire::is_available())
+  {
+    GTEST_SKIP() << "AudioTK was built without ENABLE_ALLOCATION_TRIPWIRE";
+  }
+  std::vector<double> input(2 * PROCESSSIZE);
+  ATK::InPointerFilter<double> generator(input.data(), 2, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(SAMPLING_RATE);
+
+  ATK::OversampledSubgraph<double> subgraph(2, 1, 16, build_gain, ATK::HalfbandDesign::AllpassIIR);
+  subgraph.set_input_sampling_rate(SAMPLING_RATE);
+  subgraph.set_input_port(0, generator, 0);
+  subgraph.set_input_port(1, generator, 1);
+
+  std::vector<double> output(PROCESSSIZE);
+  ATK::OutPointerFilter<double> sink(output.data(), 1, PROCESSSIZE, false);
+  sink.set_input_sampling_rate(SAMPLING_RATE);
+  sink.set_input_port(0, subgraph, 0);
+  sink.set_max_block_size(256);
+  for(gsl::index i = 0; i < PROCESSSIZE; i += 256)
+  {
+    ASSERT_NO_THROW(sink.process(256));
+  }
+}
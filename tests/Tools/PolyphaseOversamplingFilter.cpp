@@ -0,0 +1,173 @@
+/**
+ * \file PolyphaseOversamplingFilter.cpp
+ */
+
+#include <ATK/Tools/PolyphaseDecimationFilter.h>
+#include <ATK/Tools/PolyphaseOversamplingFilter.h>
+
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+#include <ATK/Core/Utilities.h>
+
+#include <gtest/gtest.h>
+
+#include <boost/math/constants/constants.hpp>
+
+#include <cmath>
+#include <vector>
+
+constexpr gsl::index SAMPLING_RATE = 48000;
+constexpr gsl::index PROCESSSIZE = 1024 * 8;
+
+namespace
+{
+  double sine(double position)
+  {
+    return std::sin(2 * boost::math::constants::pi<double>() * position / SAMPLING_RATE * 1000);
+  }
+
+  /// Oversamples and decimates a sine, the round trip only delays it by the global latency
+  void check_round_trip(gsl::index factor, ATK::HalfbandDesign design)
+  {
+    std::vector<double> input(PROCESSSIZE);
+    for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+    {
+      input[i] = sine(i);
+    }
+    ATK::InPointerFilter<double> generator(input.data(), 1, PROCESSSIZE, false);
+    generator.set_output_sampling_rate(SAMPLING_RATE);
+
+    ATK::PolyphaseOversamplingFilter<double> oversampling(1, design);
+    oversampling.set_input_sampling_rate(SAMPLING_RATE);
+    oversampling.set_output_sampling_rate(SAMPLING_RATE * factor);
+    oversampling.set_input_port(0, generator, 0);
+    ASSERT_GT(oversampling.get_latency(), 0);
+
+    ATK::PolyphaseDecimationFilter<double> decimation(1, design);
+    decimation.set_input_sampling_rate(SAMPLING_RATE * factor);
+    decimation.set_output_sampling_rate(SAMPLING_RATE);
+    decimation.set_input_port(0, oversampling, 0);
+    ASSERT_GT(decimation.get_latency(), 0);
+
+    std::vector<double> output(PROCESSSIZE);
+    ATK::OutPointerFilter<double> sink(output.data(), 1, PROCESSSIZE, false);
+    sink.set_input_sampling_rate(SAMPLING_RATE);
+    sink.set_input_port(0, decimation, 0);
+    for(gsl::index processed = 0; processed < PROCESSSIZE; processed += 100)
+    {
+      sink.process(std::min<gsl::index>(100, PROCESSSIZE - processed));
+    }
+
+    // The latencies are rounded to whole samples
+    auto latency = static_cast<double>(oversampling.get_latency()) / factor + decimation.get_latency();
+    for(gsl::index i = PROCESSSIZE / 2; i < PROCESSSIZE; ++i)
+    {
+      ASSERT_NEAR(sine(i - latency), output[i], 0.1);
+    }
+  }
+}
+
+TEST(PolyphaseOversamplingFilter, fir_test)
+{
+  for(gsl::index factor = 2; factor <= 32; factor *= 2)
+  {
+    check_round_trip(factor, ATK::HalfbandDesign::LinearPhaseFIR);
+  }
+}
+
+TEST(PolyphaseOversamplingFilter, iir_test)
+{
+  for(gsl::index factor = 2; factor <= 32; factor *= 2)
+  {
+    check_round_trip(factor, ATK::HalfbandDesign::AllpassIIR);
+  }
+}
+
+TEST(PolyphaseOversamplingFilter, design_test)
+{
+  ATK::PolyphaseOversamplingFilter<double> filter;
+  ASSERT_EQ(filter.get_design(), ATK::HalfbandDesign::LinearPhaseFIR);
+  filter.set_input_sampling_rate(SAMPLING_RATE);
+  filter.set_output_sampling_rate(SAMPLING_RATE * 8);
+  auto latency = filter.get_latency();
+  filter.set_design(ATK::HalfbandDesign::AllpassIIR);
+  ASSERT_EQ(filter.get_design(), ATK::HalfbandDesign::AllpassIIR);
+  ASSERT_LT(filter.get_latency(), latency);
+}
+
+TEST(PolyphaseOversamplingFilter, unsupported_factor_test)
+{
+  ATK::PolyphaseOversamplingFilter<double> oversampling;
+  oversampling.set_input_sampling_rate(SAMPLING_RATE);
+  ASSERT_THROW(oversampling.set_output_sampling_rate(SAMPLING_RATE * 3), ATK::RuntimeError);
+  ASSERT_THROW(oversampling.set_output_sampling_rate(SAMPLING_RATE * 64), ATK::RuntimeError);
+  ASSERT_THROW(oversampling.set_output_sampling_rate(SAMPLING_RATE * 3 / 2), ATK::RuntimeError);
+  ASSERT_THROW(oversampling.set_output_sampling_rate(SAMPLING_RATE / 2), ATK::RuntimeError);
+
+  ATK::PolyphaseDecimationFilter<double> decimation;
+  decimation.set_input_sampling_rate(SAMPLING_RATE);
+  ASSERT_THROW(decimation.set_output_sampling_rate(SAMPLING_RATE / 3), ATK::RuntimeError);
+  ASSERT_THROW(decimation.set_output_sampling_rate(SAMPLING_RATE / 64), ATK::RuntimeError);
+  ASSERT_THROW(decimation.set_output_sampling_rate(SAMPLING_RATE * 2), ATK::RuntimeError);
+}
+
+TEST(PolyphaseOversamplingFilter, block_size_test)
+{
+  std::vector<double> input(PROCESSSIZE);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    input[i] = sine(i);
+  }
+  ATK::InPointerFilter<double> generator(input.data(), 1, PROCESSSIZE, false);
+  generator.set_output_sampling_rate(SAMPLING_RATE);
+
+  ATK::PolyphaseOversamplingFilter<double> oversampling;
+  oversampling.set_input_sampling_rate(SAMPLING_RATE);
+  oversampling.set_output_sampling_rate(SAMPLING_RATE * 4);
+  oversampling.set_input_port(0, generator, 0);
+
+  std::vector<double> output(PROCESSSIZE * 4);
+  ATK::OutPointerFilter<double> sink(output.data(), 1, PROCESSSIZE * 4, false);
+  sink.set_input_sampling_rate(SAMPLING_RATE * 4);
+  sink.set_input_port(0, oversampling, 0);
+  sink.process(64);
+  ASSERT_THROW(sink.process(66), ATK::RuntimeError);
+}
+
+TEST(PolyphaseDecimationFilter, block_size_test)
+{
+  // Output blocks that are not a multiple of the factor give the same result
+  constexpr gsl::index factor = 4;
+  std::vector<double> input(PROCESSSIZE * factor);
+  for(gsl::index i = 0; i < PROCESSSIZE * factor; ++i)
+  {
+    input[i] = sine(static_cast<double>(i) / factor);
+  }
+
+  std::vector<std::vector<double>> outputs;
+  for(gsl::index block_size: {64, 7})
+  {
+    ATK::InPointerFilter<double> generator(input.data(), 1, PROCESSSIZE * factor, false);
+    generator.set_output_sampling_rate(SAMPLING_RATE * factor);
+
+    ATK::PolyphaseDecimationFilter<double> decimation;
+    decimation.set_input_sampling_rate(SAMPLING_RATE * factor);
+    decimation.set_output_sampling_rate(SAMPLING_RATE);
+    decimation.set_input_port(0, generator, 0);
+
+    std::vector<double> output(PROCESSSIZE);
+    ATK::OutPointerFilter<double> sink(output.data(), 1, PROCESSSIZE, false);
+    sink.set_input_sampling_rate(SAMPLING_RATE);
+    sink.set_input_port(0, decimation, 0);
+    for(gsl::index processed = 0; processed < PROCESSSIZE; processed += block_size)
+    {
+      sink.process(std::min<gsl::index>(block_size, PROCESSSIZE - processed));
+    }
+    outputs.push_back(std::move(output));
+  }
+
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    ASSERT_NEAR(outputs[0][i], outputs[1][i], 1e-12);
+  }
+}
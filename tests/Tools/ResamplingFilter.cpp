@@ -0,0 +1,259 @@
+/**
+ * \file ResamplingFilter.cpp
+ */
+
+#include <ATK/Tools/ResamplingFilter.h>
+
+#include <ATK/Core/ExecutionPlan.h>
+#include <ATK/Core/InPointerFilter.h>
+#include <ATK/Core/OutPointerFilter.h>
+#include <ATK/Core/Utilities.h>
+
+#include <gtest/gtest.h>
+
+#include <boost/math/constants/constants.hpp>
+
+#include <cmath>
+#include <vector>
+
+constexpr gsl::index PROCESSSIZE = 1024 * 16;
+
+namespace
+{
+  /// Resamples a sine by blocks, returns the output
+  std::vector<double> resample(gsl::index input_rate, gsl::index output_rate, double frequency, gsl::index block_size, double drift = 0)
+  {
+    std::vector<double> input(4 * PROCESSSIZE);
+    for(gsl::index i = 0; i < 4 * PROCESSSIZE; ++i)
+    {
+      input[i] = std::sin(2 * boost::math::constants::pi<double>() * frequency * i / input_rate);
+    }
+    ATK::InPointerFilter<double> generator(input.data(), 1, 4 * PROCESSSIZE, false);
+    generator.set_output_sampling_rate(input_rate);
+
+    ATK::ResamplingFilter<double> filter;
+    if(drift != 0)
+    {
+      filter.set_asynchronous(true);
+      filter.set_drift(drift);
+    }
+    filter.set_input_sampling_rate(input_rate);
+    filter.set_output_sampling_rate(output_rate);
+    filter.set_input_port(0, generator, 0);
+
+    std::vector<double> output(PROCESSSIZE);
+    ATK::OutPointerFilter<double> sink(output.data(), 1, PROCESSSIZE, false);
+    sink.set_input_sampling_rate(output_rate);
+    sink.set_input_port(0, filter, 0);
+    for(gsl::index processed = 0; processed < PROCESSSIZE; processed += block_size)
+    {
+      sink.process(std::min(block_size, PROCESSSIZE - processed));
+    }
+    return output;
+  }
+
+  /// Fits a sine of the given frequency on the second half of the signal, returns the largest error
+  double sine_error(const std::vector<double>& output, double frequency)
+  {
+    auto pulsation = 2 * boost::math::constants::pi<double>() * frequency;
+    double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0;
+    for(gsl::index i = PROCESSSIZE / 2; i < PROCESSSIZE; ++i)
+    {
+      auto s = std::sin(pulsation * i);
+      auto c = std::cos(pulsation * i);
+      ss += s * s;
+      sc += s * c;
+      cc += c * c;
+      ys += output[i] * s;
+      yc += output[i] * c;
+    }
+    auto determinant = ss * cc - sc * sc;
+    auto a = (ys * cc - yc * sc) / determinant;
+    auto b = (yc * ss - ys * sc) / determinant;
+    EXPECT_NEAR(std::sqrt(a * a + b * b), 1, 1e-4);
+
+    double error = 0;
+    for(gsl::index i = PROCESSSIZE / 2; i < PROCESSSIZE; ++i)
+    {
+      error = std::max(error, std::abs(output[i] - a * std::sin(pulsation * i) - b * std::cos(pulsation * i)));
+    }
+    return error;
+  }
+
+  /// Sine generator counting the samples read by its reader
+  class CountingGenerator final : public ATK::TypedBaseFilter<double>
+  {
+  public:
+    CountingGenerator()
+    :ATK::TypedBaseFilter<double>(0, 1)
+    {
+    }
+
+    mutable gsl::index produced{0};
+
+  protected:
+    void process_impl(gsl::index size) const final
+    {
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        outputs[0][i] = std::sin(2 * boost::math::constants::pi<double>() * 1000 * (produced + i) / 44100);
+      }
+      produced += size;
+    }
+  };
+}
+
+TEST(ResamplingFilter, upsample_44100_48000_test)
+{
+  auto output = resample(44100, 48000, 1000, 256);
+  ASSERT_LT(sine_error(output, 1000. / 48000), 1e-5);
+}
+
+TEST(ResamplingFilter, downsample_48000_44100_test)
+{
+  auto output = resample(48000, 44100, 1000, 256);
+  ASSERT_LT(sine_error(output, 1000. / 44100), 1e-5);
+}
+
+TEST(ResamplingFilter, downsample_96000_44100_test)
+{
+  auto output = resample(96000, 44100, 15000, 100);
+  ASSERT_LT(sine_error(output, 15000. / 44100), 1e-5);
+}
+
+TEST(ResamplingFilter, interpolated_phases_test)
+{
+  // The denominator of the ratio is too large to precompute all the phases
+  auto output = resample(44100, 47999, 1000, 256);
+  ASSERT_LT(sine_error(output, 1000. / 47999), 1e-4);
+}
+
+TEST(ResamplingFilter, block_size_test)
+{
+  auto output = resample(44100, 48000, 1000, PROCESSSIZE);
+  auto blocks = resample(44100, 48000, 1000, 333);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    ASSERT_EQ(output[i], blocks[i]);
+  }
+}
+
+TEST(ResamplingFilter, latency_test)
+{
+  auto output = resample(44100, 48000, 100, 256);
+  ATK::ResamplingFilter<double> filter;
+  filter.set_input_sampling_rate(44100);
+  filter.set_output_sampling_rate(48000);
+  auto latency = filter.get_latency();
+  ASSERT_GT(latency, 0);
+  for(gsl::index i = latency; i < PROCESSSIZE; ++i)
+  {
+    ASSERT_NEAR(std::sin(2 * boost::math::constants::pi<double>() * 100 * (i - latency) / 48000), output[i], 0.01);
+  }
+}
+
+TEST(ResamplingFilter, asynchronous_test)
+{
+  // The input clock runs faster than its nominal rate, the sine is read faster
+  auto output = resample(44100, 48000, 1000, 256, 0.005);
+  ASSERT_LT(sine_error(output, 1000 * 1.005 / 48000), 1e-4);
+}
+
+TEST(ResamplingFilter, drift_tracking_test)
+{
+  ATK::ResamplingFilter<double> filter;
+  filter.set_asynchronous(true);
+  filter.set_input_sampling_rate(44100);
+  filter.set_output_sampling_rate(48000);
+  ASSERT_THROW(filter.set_drift(0.1), ATK::RuntimeError);
+
+  // Enough blocks for the drift to be reached
+  std::vector<double> input(PROCESSSIZE * 4);
+  ATK::InPointerFilter<double> generator(input.data(), 1, PROCESSSIZE * 4, false);
+  generator.set_output_sampling_rate(44100);
+  filter.set_input_port(0, generator, 0);
+  std::vector<double> output(PROCESSSIZE * 4);
+  ATK::OutPointerFilter<double> sink(output.data(), 1, PROCESSSIZE * 4, false);
+  sink.set_input_sampling_rate(48000);
+  sink.set_input_port(0, filter, 0);
+
+  filter.set_drift(0.01);
+  sink.process(256);
+  // The ratio moves smoothly towards the drift
+  ASSERT_GT(filter.get_ratio(), 44100. / 48000);
+  ASSERT_LT(filter.get_ratio(), 44100. / 48000 * 1.01);
+  for(gsl::index processed = 256; processed < PROCESSSIZE * 4; processed += 256)
+  {
+    sink.process(256);
+  }
+  ASSERT_NEAR(filter.get_ratio(), 44100. / 48000 * 1.01, 1e-5);
+}
+
+TEST(ResamplingFilter, fill_level_test)
+{
+  ATK::ResamplingFilter<double> filter;
+  filter.set_input_sampling_rate(44100);
+  filter.set_output_sampling_rate(48000);
+  ASSERT_THROW(filter.set_fill_level(0), ATK::RuntimeError);
+  filter.set_asynchronous(true);
+  ASSERT_THROW(filter.set_target_fill_level(-1), ATK::RuntimeError);
+  filter.set_target_fill_level(1024);
+  ASSERT_EQ(filter.get_target_fill_level(), 1024);
+
+  CountingGenerator generator;
+  generator.set_output_sampling_rate(44100);
+  filter.set_input_port(0, generator, 0);
+  // 40s of output, the input clock is 0.3% faster than its nominal rate
+  constexpr gsl::index block_size = 256;
+  constexpr gsl::index nb_blocks = 48000 * 40 / block_size;
+  std::vector<double> output(nb_blocks * block_size);
+  ATK::OutPointerFilter<double> sink(output.data(), 1, output.size(), false);
+  sink.set_input_sampling_rate(48000);
+  sink.set_input_port(0, filter, 0);
+
+  double level = 0;
+  for(gsl::index block = 0; block < nb_blocks; ++block)
+  {
+    auto arrived = static_cast<gsl::index>(block * block_size * 44100 * 1.003 / 48000);
+    level = static_cast<double>(1024 + arrived - generator.produced);
+    filter.set_fill_level(level);
+    sink.process(block_size);
+  }
+  // The estimated drift is locked, and the buffer neither overflows nor runs dry
+  ASSERT_NEAR(filter.get_drift(), 0.003, 2e-4);
+  ASSERT_NEAR(level, 1024, 300);
+}
+
+TEST(ResamplingFilter, execution_plan_test)
+{
+  std::vector<double> input(2 * PROCESSSIZE);
+  for(gsl::index i = 0; i < 2 * PROCESSSIZE; ++i)
+  {
+    input[i] = std::sin(2 * boost::math::constants::pi<double>() * 1000 * i / 44100);
+  }
+  ATK::InPointerFilter<double> generator(input.data(), 1, 2 * PROCESSSIZE, false);
+  generator.set_output_sampling_rate(44100);
+  ATK::ResamplingFilter<double> filter;
+  filter.set_input_sampling_rate(44100);
+  filter.set_output_sampling_rate(48000);
+  filter.set_input_port(0, generator, 0);
+  std::vector<double> output(PROCESSSIZE);
+  ATK::OutPointerFilter<double> sink(output.data(), 1, PROCESSSIZE, false);
+  sink.set_input_sampling_rate(48000);
+  sink.set_input_port(0, filter, 0);
+
+  ATK::ExecutionPlan plan(&sink);
+  plan.compile();
+  plan.set_max_block_size(333);
+  for(gsl::index processed = 0; processed < PROCESSSIZE; processed += 333)
+  {
+    plan.process(std::min<gsl::index>(333, PROCESSSIZE - processed));
+  }
+
+  // The plan consumes the same number of input samples per block as the recursive processing
+  auto expected = resample(44100, 48000, 1000, 333);
+  for(gsl::index i = 0; i < PROCESSSIZE; ++i)
+  {
+    ASSERT_EQ(expected[i], output[i]);
+  }
+}
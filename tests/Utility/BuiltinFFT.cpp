@@ -0,0 +1,138 @@
+/**
+ * \ file BuiltinFFT.cpp
+ */
+
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <vector>
+
+#include <ATK/Utility/BuiltinFFT.h>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+  /// Powers of 2, even and odd sizes for Bluestein algorithm
+  const std::vector<gsl::index> sizes{1, 2, 4, 8, 256, 3, 7, 45, 90, 100, 1000};
+
+  /// Not normalized DFT, sign is -1 for the forward transform
+  std::vector<std::complex<double> > dft(const std::vector<std::complex<double> >& input, double sign)
+  {
+    const double pi = std::acos(-1.);
+    auto size = static_cast<gsl::index>(input.size());
+    std::vector<std::complex<double> > output(size);
+    for(gsl::index k = 0; k < size; ++k)
+    {
+      for(gsl::index i = 0; i < size; ++i)
+      {
+        output[k] += input[i] * std::polar(1., sign * 2 * pi * static_cast<double>((i * k) % size) / size);
+      }
+    }
+    return output;
+  }
+
+  std::vector<std::complex<double> > signal(gsl::index size)
+  {
+    std::vector<std::complex<double> > data(size);
+    for(gsl::index i = 0; i < size; ++i)
+    {
+      data[i] = std::complex<double>(std::sin(i * .1) + 1, std::cos(i * .3));
+    }
+    return data;
+  }
+}
+
+TEST(BuiltinFFT, size_test)
+{
+  ATK::BuiltinFFT processor;
+  processor.set_size(90);
+  ASSERT_EQ(90, processor.get_size());
+}
+
+TEST(BuiltinFFT, forward_test)
+{
+  for(auto size: sizes)
+  {
+    auto input = signal(size);
+    auto expected = dft(input, -1);
+    std::vector<std::complex<double> > output(size);
+
+    ATK::BuiltinFFT processor;
+    processor.set_size(size);
+    processor.forward(input.data(), output.data());
+    for(gsl::index k = 0; k < size; ++k)
+    {
+      ASSERT_NEAR(0, std::abs(output[k] - expected[k]), 1e-9 * size) << "size " << size << ", bin " << k;
+    }
+  }
+}
+
+TEST(BuiltinFFT, backward_test)
+{
+  for(auto size: sizes)
+  {
+    auto input = signal(size);
+    auto expected = dft(input, 1);
+
+    ATK::BuiltinFFT processor;
+    processor.set_size(size);
+    // In place
+    processor.backward(input.data(), input.data());
+    for(gsl::index k = 0; k < size; ++k)
+    {
+      ASSERT_NEAR(0, std::abs(input[k] - expected[k]), 1e-9 * size) << "size " << size << ", sample " << k;
+    }
+  }
+}
+
+TEST(BuiltinFFT, real_test)
+{
+  for(auto size: sizes)
+  {
+    std::vector<double> input(size);
+    std::vector<std::complex<double> > complex_input(size);
+    for(gsl::index i = 0; i < size; ++i)
+    {
+      complex_input[i] = input[i] = std::sin(i * .1) + i;
+    }
+    auto expected = dft(complex_input, -1);
+    std::vector<std::complex<double> > spectrum(size / 2 + 1);
+    std::vector<double> output(size);
+
+    ATK::BuiltinFFT processor;
+    processor.set_size(size);
+    processor.forward_real(input.data(), spectrum.data());
+    for(gsl::index k = 0; k <= size / 2; ++k)
+    {
+      ASSERT_NEAR(0, std::abs(spectrum[k] - expected[k]), 1e-9 * size * size) << "size " << size << ", bin " << k;
+    }
+
+    processor.backward_real(spectrum.data(), output.data());
+    for(gsl::index i = 0; i < size; ++i)
+    {
+      ASSERT_NEAR(input[i], output[i] / size, 1e-9 * size) << "size " << size << ", sample " << i;
+    }
+  }
+}
+
+TEST(BuiltinFFT, shared_plan_test)
+{
+  auto input = signal(100);
+  std::vector<std::complex<double> > reference(100);
+  std::vector<std::complex<double> > output(100);
+
+  auto first = std::make_unique<ATK::BuiltinFFT>();
+  first->set_size(100);
+  first->forward(input.data(), reference.data());
+
+  // The plans are still valid when the object that created them is destroyed
+  ATK::BuiltinFFT second;
+  second.set_size(100);
+  first.reset();
+  second.forward(input.data(), output.data());
+  for(gsl::index k = 0; k < 100; ++k)
+  {
+    ASSERT_EQ(reference[k], output[k]);
+  }
+}
@@ -3,21 +3,21 @@
  */
 
 #include <cmath>
+#include <thread>
+#include <vector>
 
 #include <ATK/Utility/FFT.h>
 
-#define BOOST_TEST_DYN_LINK
-#define BOOST_TEST_NO_MAIN
-#include <boost/test/unit_test.hpp>
+#include <gtest/gtest.h>
 
-BOOST_AUTO_TEST_CASE( FFT_size_test )
+TEST(FFT, size_test)
 {
   ATK::FFT<double> processor;
   processor.set_size(128);
-  BOOST_CHECK_EQUAL(processor.get_size(), 128);
+  ASSERT_EQ(processor.get_size(), 128);
 }
 
-BOOST_AUTO_TEST_CASE( FFT_test )
+TEST(FFT, real_roundtrip_test)
 {
   std::vector<double> input(128);
   std::vector<double> ref(128);
@@ -35,11 +35,11 @@ BOOST_AUTO_TEST_CASE( FFT_test )
   
   for(int i = 0; i < 100; ++i)
   {
-    BOOST_REQUIRE_CLOSE(input[i], ref[i], 0.0001);
+    ASSERT_NEAR(input[i], ref[i], 1e-6);
   }
 }
 
-BOOST_AUTO_TEST_CASE( doubleFFT_test )
+TEST(FFT, two_signals_test)
 {
   std::vector<double> input(128);
   std::vector<double> double_input(128);
@@ -61,20 +61,20 @@ BOOST_AUTO_TEST_CASE( doubleFFT_test )
   std::vector<double> angle;
   processor.get_angle(angle);
 
-  BOOST_REQUIRE_SMALL(angle[0], 0.0001);
+  ASSERT_NEAR(0, angle[0], 0.0001);
   
   processor.process_backward(frequency.data(), input.data(), 128);
   processor.process_backward(double_frequency.data(), double_input.data(), 128);
   
   for(int i = 0; i < 100; ++i)
   {
-    BOOST_REQUIRE_CLOSE(input[i], ref[i], 0.0001);
-    BOOST_REQUIRE_CLOSE(double_input[i], 2*ref[i], 0.0001);
+    ASSERT_NEAR(input[i], ref[i], 1e-6);
+    ASSERT_NEAR(double_input[i], 2*ref[i], 1e-6);
   }
 }
 
 
-BOOST_AUTO_TEST_CASE( FFT_complex_test )
+TEST(FFT, complex_roundtrip_test)
 {
   std::vector<std::complex<double>> input(128);
   std::vector<std::complex<double>> ref(128);
@@ -92,12 +92,12 @@ BOOST_AUTO_TEST_CASE( FFT_complex_test )
   
   for(int i = 0; i < 100; ++i)
   {
-    BOOST_REQUIRE_CLOSE(input[i].real(), ref[i].real(), 0.0001);
-    BOOST_REQUIRE_SMALL(input[i].imag(), 0.0001);
+    ASSERT_NEAR(input[i].real(), ref[i].real(), 1e-6);
+    ASSERT_NEAR(0, input[i].imag(), 0.0001);
   }
 }
 
-BOOST_AUTO_TEST_CASE( doubleFFT_complex_test )
+TEST(FFT, two_complex_signals_test)
 {
   std::vector<std::complex<double>> input(128);
   std::vector<std::complex<double>> double_input(128);
@@ -120,9 +120,133 @@ BOOST_AUTO_TEST_CASE( doubleFFT_complex_test )
   
   for(int i = 0; i < 100; ++i)
   {
-    BOOST_REQUIRE_CLOSE(input[i].real(), ref[i].real(), 0.0001);
-    BOOST_REQUIRE_CLOSE(double_input[i].real(), 2*ref[i].real(), 0.0001);
-    BOOST_REQUIRE_SMALL(input[i].imag(), 0.0001);
-    BOOST_REQUIRE_SMALL(double_input[i].imag(), 0.0001);
+    ASSERT_NEAR(input[i].real(), ref[i].real(), 1e-6);
+    ASSERT_NEAR(double_input[i].real(), 2*ref[i].real(), 1e-6);
+    ASSERT_NEAR(0, input[i].imag(), 0.0001);
+    ASSERT_NEAR(0, double_input[i].imag(), 0.0001);
+  }
+}
+
+TEST(FFT, non_power_of_two_test)
+{
+  std::vector<std::complex<double>> input(100);
+  for(int i = 0; i < 100; ++i)
+  {
+    input[i] = std::complex<double>(std::sin(i * .1), std::cos(i * .3));
+  }
+  std::vector<std::complex<double> > frequency(100);
+
+  ATK::FFT<double> processor;
+  processor.set_size(100);
+  processor.process_forward(input.data(), frequency.data(), 100);
+
+  const double pi = std::acos(-1.);
+  for(int k = 0; k < 100; ++k)
+  {
+    std::complex<double> expected;
+    for(int i = 0; i < 100; ++i)
+    {
+      expected += input[i] * std::polar(1., -2 * pi * i * k / 100) / 100.;
+    }
+    ASSERT_NEAR(0, std::abs(frequency[k] - expected), 0.0001);
+  }
+}
+
+TEST(FFT, half_spectrum_test)
+{
+  for(int size: {128, 90, 45})
+  {
+    std::vector<double> input(size);
+    for(int i = 0; i < size; ++i)
+    {
+      input[i] = std::sin(i * .1) + i;
+    }
+    std::vector<std::complex<double> > full_frequency(size);
+    std::vector<std::complex<double> > frequency(size / 2 + 1);
+    std::vector<double> output(size);
+
+    ATK::FFT<double> processor;
+    processor.set_size(size);
+    processor.process_forward(input.data(), full_frequency.data(), size);
+    processor.process_forward_real(input.data(), frequency.data(), size);
+    for(int k = 0; k < size / 2 + 1; ++k)
+    {
+      ASSERT_NEAR(0, std::abs(frequency[k] - full_frequency[k]), 0.0001);
+    }
+
+    processor.process_backward_real(frequency.data(), output.data(), size);
+    for(int i = 0; i < size; ++i)
+    {
+      ASSERT_NEAR(output[i], input[i], 1e-6);
+    }
+  }
+}
+
+TEST(FFT, batch_test)
+{
+  std::vector<double> input(3 * 64);
+  for(int i = 0; i < 3 * 64; ++i)
+  {
+    input[i] = i % 7 + 1;
+  }
+  std::vector<std::complex<double> > frequency(3 * 65);
+  std::vector<std::complex<double> > channel_frequency(65);
+  std::vector<double> output(3 * 64);
+
+  ATK::FFT<double> processor;
+  processor.set_size(128);
+  processor.process_forward_real(input.data(), frequency.data(), 64, 3);
+  for(int channel = 0; channel < 3; ++channel)
+  {
+    processor.process_forward_real(input.data() + channel * 64, channel_frequency.data(), 64);
+    for(int k = 0; k < 65; ++k)
+    {
+      ASSERT_NEAR(0, std::abs(frequency[channel * 65 + k] - channel_frequency[k]), 0.0001);
+    }
+  }
+
+  processor.process_backward_real(frequency.data(), output.data(), 64, 3);
+  for(int i = 0; i < 3 * 64; ++i)
+  {
+    ASSERT_NEAR(output[i], input[i], 1e-6);
+  }
+}
+
+TEST(FFT, plan_cache_test)
+{
+  std::vector<double> input(90);
+  for(int i = 0; i < 90; ++i)
+  {
+    input[i] = std::sin(i * .1) + i;
+  }
+  std::vector<std::complex<double> > reference(90);
+  {
+    ATK::FFT<double> processor;
+    processor.set_size(90);
+    processor.process_forward(input.data(), reference.data(), 90);
+  }
+
+  // Plans are created and shared concurrently, each object keeps its own buffers
+  std::vector<std::vector<std::complex<double> > > outputs(8, std::vector<std::complex<double> >(90));
+  std::vector<std::thread> threads;
+  for(auto& output: outputs)
+  {
+    threads.emplace_back([&input, &output]()
+    {
+      ATK::FFT<double> processor;
+      processor.set_size(90);
+      processor.process_forward(input.data(), output.data(), 90);
+    });
+  }
+  for(auto& thread: threads)
+  {
+    thread.join();
+  }
+  for(const auto& output: outputs)
+  {
+    for(int k = 0; k < 90; ++k)
+    {
+      ASSERT_EQ(reference[k], output[k]);
+    }
   }
 }
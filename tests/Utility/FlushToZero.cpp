@@ -3,15 +3,22 @@
  */
 
 #include <cmath>
+#include <limits>
 
 #include <ATK/Utility/FlushToZero.h>
 
-#define BOOST_TEST_DYN_LINK
-#define BOOST_TEST_NO_MAIN
-#include <boost/test/unit_test.hpp>
+#include <gtest/gtest.h>
 
-BOOST_AUTO_TEST_CASE(FTZ_test)
+TEST(FlushToZero, denormal_test)
 {
-  ATK::FlushToZero ftz;
-  BOOST_CHECK_EQUAL(0, 0); // to make unit test happy
+  volatile float denormal = std::numeric_limits<float>::min() / 4;
+  {
+    ATK::FlushToZero ftz;
+#if defined(__x86_64__) || defined(_M_X64)
+    // Denormal inputs are read as zero
+    ASSERT_EQ(0, denormal * 2);
+#endif
+  }
+  // The previous state is restored
+  ASSERT_NE(0, denormal * 2);
 }
@@ -3,73 +3,195 @@
  */
 
 #include <cmath>
+#include <limits>
+#include <vector>
 
 #include <ATK/Utility/fmath.h>
 
-#define BOOST_TEST_DYN_LINK
-#define BOOST_TEST_NO_MAIN
-#include <boost/test/unit_test.hpp>
+#include <gtest/gtest.h>
 
-BOOST_AUTO_TEST_CASE(fmath_exp_float_test)
+TEST(fmath, exp_float_test)
 {
   for (int i = 0; i < 10; ++i)
   {
-    BOOST_REQUIRE_CLOSE(std::exp(float(i)), fmath::exp(float(i)), 0.0001);
+    ASSERT_NEAR(std::exp(float(i)), fmath::exp(float(i)), std::abs(std::exp(float(i))) * 1e-6);
   }
 }
 
-BOOST_AUTO_TEST_CASE(fmath_exp_double_test)
+TEST(fmath, exp_double_test)
 {
   for (int i = 0; i < 100; ++i)
   {
-    BOOST_REQUIRE_CLOSE(std::exp(double(i)), fmath::exp(double(i)), 0.0001);
+    ASSERT_NEAR(std::exp(double(i)), fmath::exp(double(i)), std::abs(std::exp(double(i))) * 1e-6);
   }
 }
 
-BOOST_AUTO_TEST_CASE(fmath_log_float_test)
+TEST(fmath, log_float_test)
 {
   for (int i = 1; i < 100; ++i)
   {
-    BOOST_REQUIRE_CLOSE(std::log(float(i)), fmath::log(float(i)), 0.0001);
+    ASSERT_NEAR(std::log(float(i)), fmath::log(float(i)), std::abs(std::log(float(i))) * 1e-6);
   }
 }
 
-BOOST_AUTO_TEST_CASE(fmath_log_double_test)
+TEST(fmath, log_double_test)
 {
   for (int i = 1; i < 100; ++i)
   {
-    BOOST_REQUIRE_CLOSE(std::log(double(i)), fmath::log(double(i)), 0.0001);
+    ASSERT_NEAR(std::log(double(i)), fmath::log(double(i)), std::abs(std::log(double(i))) * 1e-6);
   }
 }
 
-BOOST_AUTO_TEST_CASE(fmath_log10_float_test)
+TEST(fmath, log10_float_test)
 {
   for (int i = 1; i < 100; ++i)
   {
-    BOOST_REQUIRE_CLOSE(std::log10(float(i)), fmath::log10(float(i)), 0.0001);
+    ASSERT_NEAR(std::log10(float(i)), fmath::log10(float(i)), std::abs(std::log10(float(i))) * 1e-6);
   }
 }
 
-BOOST_AUTO_TEST_CASE(fmath_log10_double_test)
+TEST(fmath, log10_double_test)
 {
   for (int i = 1; i < 100; ++i)
   {
-    BOOST_REQUIRE_CLOSE(std::log10(double(i)), fmath::log10(double(i)), 0.0001);
+    ASSERT_NEAR(std::log10(double(i)), fmath::log10(double(i)), std::abs(std::log10(double(i))) * 1e-6);
   }
 }
 
-BOOST_AUTO_TEST_CASE(fmath_pow_float_test)
+TEST(fmath, pow_float_test)
 {
   for (int i = 1; i < 10; ++i)
   {
-    BOOST_REQUIRE_CLOSE(std::pow(10, float(i)), fmath::pow(10, float(i)), 0.001);
+    ASSERT_NEAR(std::pow(10, float(i)), fmath::pow(10, float(i)), std::abs(std::pow(10, float(i))) * 1e-5);
   }
 }
 
-BOOST_AUTO_TEST_CASE(fmath_pow_double_test)
+TEST(fmath, pow_double_test)
 {
   for (int i = 1; i < 100; ++i)
   {
-    BOOST_REQUIRE_CLOSE(std::pow(10, double(i)), fmath::pow(10, double(i)), 0.0001);
+    ASSERT_NEAR(std::pow(10, double(i)), fmath::pow(10, double(i)), std::abs(std::pow(10, double(i))) * 1e-6);
   }
-}
\ No newline at end of file
+}
+
+namespace
+{
+  /// Returns the largest error in ulp of a batch function on a geometric or linear range, against the long double function
+  template<typename T>
+  long double max_ulp_error(void (*function)(const T*, T*, size_t), long double (*reference)(long double), T min, T max, bool geometric)
+  {
+    constexpr size_t size = 100000;
+    std::vector<T> input(size);
+    std::vector<T> output(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+      long double t = static_cast<long double>(i) / (size - 1);
+      input[i] = static_cast<T>(geometric ? min * std::pow(static_cast<long double>(max) / min, t) : min + (max - min) * t);
+    }
+    function(input.data(), output.data(), size);
+
+    long double error = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+      long double expected = reference(input[i]);
+      T rounded = static_cast<T>(expected);
+      T ulp = std::nextafter(std::abs(rounded), std::numeric_limits<T>::infinity()) - std::abs(rounded);
+      error = std::max(error, std::abs(output[i] - expected) / ulp);
+    }
+    return error;
+  }
+
+  long double reference_exp(long double x)
+  {
+    return std::exp(x);
+  }
+
+  long double reference_log(long double x)
+  {
+    return std::log(x);
+  }
+
+  long double reference_log10(long double x)
+  {
+    return std::log10(x);
+  }
+
+  long double reference_pow10(long double x)
+  {
+    return std::pow(10.L, x);
+  }
+
+  long double reference_tanh(long double x)
+  {
+    return std::tanh(x);
+  }
+
+  long double reference_sinh(long double x)
+  {
+    return std::sinh(x);
+  }
+
+  long double reference_asinh(long double x)
+  {
+    return std::asinh(x);
+  }
+
+  template<typename T>
+  void check_batch_functions(T max_exp)
+  {
+    EXPECT_LE(max_ulp_error<T>(fmath::exp<T>, reference_exp, -max_exp, max_exp, false), sizeof(T) == sizeof(float) ? 2 : 1);
+    EXPECT_LE(max_ulp_error<T>(fmath::log<T>, reference_log, std::numeric_limits<T>::denorm_min(), std::numeric_limits<T>::max(), true), 1);
+    EXPECT_LE(max_ulp_error<T>(fmath::log<T>, reference_log, T(.5), T(2), false), 1);
+    EXPECT_LE(max_ulp_error<T>(fmath::log10<T>, reference_log10, std::numeric_limits<T>::min(), std::numeric_limits<T>::max(), true), 2);
+    EXPECT_LE(max_ulp_error<T>(fmath::pow10<T>, reference_pow10, -max_exp / 3, max_exp / 3, false), 2);
+    EXPECT_LE(max_ulp_error<T>(fmath::tanh<T>, reference_tanh, -30, 30, false), 3);
+    EXPECT_LE(max_ulp_error<T>(fmath::tanh<T>, reference_tanh, T(1e-30), T(1), true), 3);
+    EXPECT_LE(max_ulp_error<T>(fmath::sinh<T>, reference_sinh, -max_exp, max_exp, false), 3);
+    EXPECT_LE(max_ulp_error<T>(fmath::sinh<T>, reference_sinh, T(1e-30), T(1), true), 3);
+    EXPECT_LE(max_ulp_error<T>(fmath::asinh<T>, reference_asinh, -1e30, 1e30, false), 2);
+    EXPECT_LE(max_ulp_error<T>(fmath::asinh<T>, reference_asinh, T(1e-30), T(1e30), true), 2);
+  }
+}
+
+TEST(fmath, batch_float_test)
+{
+  check_batch_functions<float>(87);
+}
+
+TEST(fmath, batch_double_test)
+{
+  check_batch_functions<double>(700);
+}
+
+TEST(fmath, batch_special_test)
+{
+  double input[] = {0, -1, std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), 1000, -1000};
+  double output[6];
+  fmath::log(input, output, 2);
+  EXPECT_EQ(-std::numeric_limits<double>::infinity(), output[0]);
+  EXPECT_TRUE(std::isnan(output[1]));
+  fmath::exp(input + 2, output, 4);
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), output[0]);
+  EXPECT_EQ(0, output[1]);
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), output[2]);
+  EXPECT_EQ(0, output[3]);
+  fmath::tanh(input + 2, output, 4);
+  EXPECT_EQ(1, output[0]);
+  EXPECT_EQ(-1, output[1]);
+  EXPECT_EQ(1, output[2]);
+  EXPECT_EQ(-1, output[3]);
+}
+
+TEST(fmath, batch_register_test)
+{
+  ATK::Batch<float> x;
+  for (gsl::index i = 0; i < x.size; ++i)
+  {
+    x[i] = static_cast<float>(i) / 4;
+  }
+  auto y = fmath::tanh(x);
+  for (gsl::index i = 0; i < x.size; ++i)
+  {
+    ASSERT_NEAR(std::tanh(x[i]), y[i], std::abs(std::tanh(x[i])) * 1e-6);
+  }
+}